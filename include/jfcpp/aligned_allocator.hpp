@@ -0,0 +1,163 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_ALIGNED_ALLOCATOR
+#define H_JFCPP_ALIGNED_ALLOCATOR
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+#include "common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * A standard allocator which returns memory aligned on a given boundary (by
+ * default 64 bytes, the size of a cache line and of an AVX-512 register).
+ *
+ * The memory is obtained with “::operator new()”: a bit more is allocated
+ * and the address of the block is stored just before the aligned pointer.
+ *
+ * @template T         The type of allocated elements.
+ * @template Alignment A power of two, at least “sizeof(void *)”.
+ */
+template <typename T, size_t Alignment = 64>
+class aligned_allocator
+{
+public:
+
+	typedef T value_type;
+
+	typedef T *pointer;
+
+	typedef const T *const_pointer;
+
+	typedef T &reference;
+
+	typedef const T &const_reference;
+
+	typedef size_t size_type;
+
+	typedef ptrdiff_t difference_type;
+
+	enum { alignment = Alignment };
+
+	template <typename U>
+	struct rebind
+	{
+		typedef aligned_allocator<U, Alignment> other;
+	};
+
+	aligned_allocator()
+	{}
+
+	template <typename U>
+	aligned_allocator(const aligned_allocator<U, Alignment> &)
+	{}
+
+	pointer
+	address(reference x) const
+	{
+		return &x;
+	}
+
+	const_pointer
+	address(const_reference x) const
+	{
+		return &x;
+	}
+
+	/**
+	 * Allocates (but does not construct) n elements.
+	 *
+	 * @throw std::bad_alloc If there is not enough memory.
+	 */
+	pointer
+	allocate(size_type n, const void * = NULL)
+	{
+		if (n > this->max_size())
+		{
+			throw std::bad_alloc();
+		}
+
+		char *block = static_cast<char *>(
+			::operator new(n * sizeof(T) + Alignment + sizeof(void *)));
+
+		// Leaves room for the address of the block.
+		const size_t address = reinterpret_cast<size_t>(block + sizeof(void *));
+		char *aligned = block + sizeof(void *)
+			+ ((Alignment - address % Alignment) % Alignment);
+
+		reinterpret_cast<void **>(aligned)[-1] = block;
+
+		return reinterpret_cast<pointer>(aligned);
+	}
+
+	void
+	deallocate(pointer p, size_type)
+	{
+		if (p != NULL)
+		{
+			::operator delete(reinterpret_cast<void **>(p)[-1]);
+		}
+	}
+
+	size_type
+	max_size() const
+	{
+		return ((std::numeric_limits<size_type>::max() - Alignment
+		         - sizeof(void *)) / sizeof(T));
+	}
+
+	void
+	construct(pointer p, const T &value)
+	{
+		new (static_cast<void *>(p)) T(value);
+	}
+
+	void
+	destroy(pointer p)
+	{
+		p->~T();
+	}
+};
+
+/**
+ * This allocator has no state: any instance can free the memory allocated by
+ * another.
+ */
+template <typename T1, typename T2, size_t Alignment>
+bool
+operator==(const aligned_allocator<T1, Alignment> &,
+           const aligned_allocator<T2, Alignment> &)
+{
+	return true;
+}
+
+template <typename T1, typename T2, size_t Alignment>
+bool
+operator!=(const aligned_allocator<T1, Alignment> &,
+           const aligned_allocator<T2, Alignment> &)
+{
+	return false;
+}
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_ALIGNED_ALLOCATOR
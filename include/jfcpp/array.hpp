@@ -33,6 +33,7 @@
 
 #ifdef __GXX_EXPERIMENTAL_CXX0X__
 #include <initializer_list>
+#include <utility>
 #endif
 
 JFCPP_NAMESPACE_BEGIN
@@ -173,6 +174,17 @@ public:
 		*this = a;
 	}
 
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+	/**
+	 * Takes the storage of “a”, which can then only be destroyed or
+	 * move-assigned.
+	 */
+	array(array &&a) : _data(a._data), _size(a._size)
+	{
+		a._data = NULL;
+	}
+#endif
+
 	/**
 	 *
 	 */
@@ -206,8 +218,27 @@ public:
 	 */
 	~array()
 	{
-		this->_deallocate();
+		// The storage may have been moved.
+		if (this->_data != NULL)
+		{
+			this->_deallocate();
+		}
+	}
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+	/**
+	 * Exchanges the storages (the sizes must be equal).
+	 */
+	array &
+	operator=(array &&a)
+	{
+		requires(this->_size == a._size);
+
+		this->swap(a);
+
+		return *this;
 	}
+#endif
 
 	/**
 	 *
@@ -0,0 +1,209 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_BINARY
+#define H_JFCPP_BINARY
+
+#include <cstddef>
+#include <vector>
+
+#include <stdint.h>
+
+#include <contracts.h>
+
+#include "array.hpp"
+#include "array_view.hpp"
+#include "common.hpp"
+#include "matrix.hpp"
+#include "matrix/layout.hpp"
+#include "matrix/view.hpp"
+#include "meta/is_arithmetic.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Binary serialization of matrices and arrays.
+ *
+ * A record is a 64-byte header followed by the values, exactly as they are
+ * stored in memory, and by a padding up to a multiple of 64 bytes.  Writing
+ * and reading are therefore bulk copies, and records written one after
+ * another stay aligned: a buffer or a mapped file which holds them can be
+ * used in place, without parsing (see “load_matrix()” and “load_array()”).
+ * A file containing a single matrix can also be opened by “mapped_matrix”.
+ *
+ * The header contains the version of the format, the byte order of the
+ * writer, the type of the values, the layout and the dimensions.  An array
+ * is stored as a one-column matrix.
+ *
+ * Only the built-in arithmetic types are supported and reading a record
+ * written by a machine with another byte order or for another type fails.
+ *
+ * The file descriptors are used with the POSIX “read()” and “write()”, the
+ * format is thus usable with files, pipes and sockets.
+ */
+namespace binary
+{
+	namespace details
+	{
+		/**
+		 * Records are aligned on this boundary (a cache line).
+		 */
+		const size_t alignment = 64;
+
+		/**
+		 * The header of a record.
+		 */
+		struct header
+		{
+			/**
+			 * “JFCPPMAT”.
+			 */
+			char magic[8];
+
+			/**
+			 * Version of the format, currently 1.
+			 */
+			uint32_t version;
+
+			/**
+			 * 0x01020304 as written by the machine which created the
+			 * record: the values are stored in its byte order.
+			 */
+			uint32_t byte_order;
+
+			/**
+			 * The type of the values (see “type_tag”).
+			 */
+			uint32_t type;
+
+			/**
+			 * The layout (“Layout::order”).
+			 */
+			uint32_t layout;
+
+			uint64_t rows;
+
+			uint64_t columns;
+
+			char padding[24];
+		};
+
+		/**
+		 * Identifies the type of the values: its kind (‘i’ for signed
+		 * integers, ‘u’ for unsigned ones and ‘f’ for floating point
+		 * numbers) followed by its size.
+		 *
+		 * Only built-in arithmetic types are defined.
+		 */
+		template <typename T, bool = meta::is_arithmetic<T>::value>
+		struct type_tag;
+	} // namespace details
+
+	/**
+	 * Gets the size in bytes of the record of n values.
+	 */
+	template <typename T>
+	size_t record_size(size_t n);
+
+	/**
+	 * Writes a record in a file descriptor.
+	 *
+	 * A view which is not contiguous is copied first.
+	 *
+	 * @throw std::runtime_error If the writing fails.
+	 */
+	template <typename T, class Allocator, class Layout>
+	void write(int fd, const matrix<T, Allocator, Layout> &m);
+
+	template <typename T>
+	void write(int fd, const const_matrix_view<T> &v);
+
+	template <typename T, size_t S>
+	void write(int fd, const array<T, S> &a);
+
+	template <typename T>
+	void write(int fd, const array_view<T> &a);
+
+	/**
+	 * Appends a record to a buffer.
+	 */
+	template <typename T, class Allocator, class Layout>
+	void write(std::vector<char> &buffer, const matrix<T, Allocator, Layout> &m);
+
+	template <typename T>
+	void write(std::vector<char> &buffer, const const_matrix_view<T> &v);
+
+	template <typename T, size_t S>
+	void write(std::vector<char> &buffer, const array<T, S> &a);
+
+	template <typename T>
+	void write(std::vector<char> &buffer, const array_view<T> &a);
+
+	/**
+	 * Reads a record from a file descriptor in a matrix, which is resized.
+	 *
+	 * A record with another layout is converted.
+	 *
+	 * @throw std::runtime_error If the reading fails or if the record is not
+	 *                           a matrix of T.
+	 */
+	template <typename T, class Allocator, class Layout>
+	void read(int fd, matrix<T, Allocator, Layout> &m);
+
+	/**
+	 * Reads a record from a file descriptor in an array, in the storage
+	 * order of the record.
+	 *
+	 * @throw std::runtime_error Same as “read(int, matrix &)” or if the
+	 *                           number of values differs.
+	 */
+	template <typename T, size_t S>
+	void read(int fd, array<T, S> &a);
+
+	template <typename T>
+	void read(int fd, array_view<T> a);
+
+	/**
+	 * Gets a view on the matrix stored in the record at “first” (which is
+	 * moved to the next record), nothing is copied.
+	 *
+	 * Requirement:
+	 * - “first” must be aligned for T, e.g. at the beginning of a buffer
+	 *   returned by “malloc()” or of a mapped file.
+	 *
+	 * @throw std::runtime_error If the record is truncated or is not a
+	 *                           matrix of T.
+	 */
+	template <typename T>
+	const_matrix_view<T> load_matrix(const char *&first, const char *last);
+
+	/**
+	 * Same as “load_matrix()” but gets the values in their storage order.
+	 *
+	 * @throw std::runtime_error Same as “load_matrix()” or if the record is
+	 *                           empty.
+	 */
+	template <typename T>
+	array_view<const T> load_array(const char *&first, const char *last);
+} // namespace binary
+
+JFCPP_NAMESPACE_END
+
+#include "binary/implementation.hpp"
+
+#endif // H_JFCPP_BINARY
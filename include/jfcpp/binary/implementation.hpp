@@ -0,0 +1,562 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include <contracts.h>
+
+#include "../common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace binary
+{
+	namespace details
+	{
+		template <typename T>
+		struct type_tag<T, true>
+		{
+			static const uint32_t value =
+				((std::numeric_limits<T>::is_integer
+				  ? (std::numeric_limits<T>::is_signed ? 'i' : 'u')
+				  : 'f') << 8) | sizeof(T);
+		};
+
+		/**
+		 * Number of bytes which follow n bytes of values up to the next
+		 * record.
+		 */
+		inline
+		size_t
+		padding(size_t n)
+		{
+			return (alignment - n % alignment) % alignment;
+		}
+
+		inline
+		header
+		make_header(uint32_t type, uint32_t layout, size_t rows,
+		            size_t columns)
+		{
+			header h;
+
+			std::memset(&h, 0, sizeof(h));
+			std::memcpy(h.magic, "JFCPPMAT", sizeof(h.magic));
+			h.version = 1;
+			h.byte_order = 0x01020304;
+			h.type = type;
+			h.layout = layout;
+			h.rows = rows;
+			h.columns = columns;
+
+			return h;
+		}
+
+		/**
+		 * @param context Prefixes the error messages (e.g. a path).
+		 *
+		 * @throw std::runtime_error If the header is not the one of a
+		 *                           matrix of the given type or if the
+		 *                           size of its record does not fit in a
+		 *                           size_t.
+		 */
+		inline
+		void
+		check_header(const header &h, const std::string &context,
+		             uint32_t type)
+		{
+			if (std::memcmp(h.magic, "JFCPPMAT", sizeof(h.magic)) != 0)
+			{
+				throw std::runtime_error(context + ": not a matrix");
+			}
+			if (h.version != 1)
+			{
+				throw std::runtime_error(context + ": unsupported version");
+			}
+			if (h.byte_order != 0x01020304)
+			{
+				throw std::runtime_error(context + ": foreign byte order");
+			}
+			if (h.type != type)
+			{
+				throw std::runtime_error(context + ": wrong value type");
+			}
+			if ((h.layout != row_major::order)
+			    && (h.layout != column_major::order))
+			{
+				throw std::runtime_error(context + ": unknown layout");
+			}
+
+			// The low byte of the type tag is the size of the values, the
+			// header and the padding must fit as well.
+			const uint64_t limit =
+				(std::numeric_limits<size_t>::max() - sizeof(header)
+				 - alignment) / (type & 0xff);
+			if ((h.rows > limit) || (h.columns > limit)
+			    || ((h.columns != 0) && (h.rows > limit / h.columns)))
+			{
+				throw std::runtime_error(context + ": invalid dimensions");
+			}
+		}
+
+		/**
+		 * Throws the error described by errno.
+		 */
+		inline
+		void
+		fail(const char *what)
+		{
+			throw std::runtime_error(std::string("binary: ") + what + ": "
+			                         + std::strerror(errno));
+		}
+
+		/**
+		 * Writes n bytes, whatever the number of calls to “write()” it
+		 * takes.
+		 */
+		inline
+		void
+		write_all(int fd, const void *data, size_t n)
+		{
+			const char *p = static_cast<const char *>(data);
+
+			while (n != 0)
+			{
+				const ssize_t written = ::write(fd, p, n);
+				if (written == -1)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					fail("cannot write");
+				}
+
+				p += written;
+				n -= written;
+			}
+		}
+
+		/**
+		 * Reads up to n bytes, less only if the end of the file is
+		 * reached.
+		 *
+		 * @return The number of bytes read.
+		 */
+		inline
+		size_t
+		read_some(int fd, void *data, size_t n)
+		{
+			char *p = static_cast<char *>(data);
+			size_t total = 0;
+
+			while (total != n)
+			{
+				const ssize_t count = ::read(fd, p + total, n - total);
+				if (count == -1)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					fail("cannot read");
+				}
+				if (count == 0)
+				{
+					break;
+				}
+
+				total += count;
+			}
+
+			return total;
+		}
+
+		/**
+		 * Reads exactly n bytes.
+		 */
+		inline
+		void
+		read_all(int fd, void *data, size_t n)
+		{
+			if (read_some(fd, data, n) != n)
+			{
+				throw std::runtime_error("binary: truncated record");
+			}
+		}
+
+		/**
+		 * Reads a header and checks it is the one of a matrix of T.
+		 */
+		template <typename T>
+		header
+		read_header(int fd)
+		{
+			header h;
+
+			read_all(fd, &h, sizeof(h));
+			check_header(h, "binary", type_tag<T>::value);
+
+			return h;
+		}
+
+		/**
+		 * Skips the padding which follows n bytes of values.
+		 *
+		 * The padding of the last record of a stream may be missing.
+		 */
+		inline
+		void
+		skip_padding(int fd, size_t n)
+		{
+			char buffer[alignment];
+
+			read_some(fd, buffer, padding(n));
+		}
+
+		/**
+		 * Writes to a file descriptor.
+		 */
+		class fd_sink
+		{
+		public:
+
+			explicit
+			fd_sink(int fd)
+				: _fd(fd)
+			{}
+
+			void
+			operator()(const void *data, size_t n) const
+			{
+				write_all(this->_fd, data, n);
+			}
+
+		private:
+
+			/**
+			 *
+			 */
+			int _fd;
+		};
+
+		/**
+		 * Appends to a buffer.
+		 */
+		class buffer_sink
+		{
+		public:
+
+			explicit
+			buffer_sink(std::vector<char> &buffer)
+				: _buffer(buffer)
+			{}
+
+			void
+			operator()(const void *data, size_t n) const
+			{
+				const char *p = static_cast<const char *>(data);
+
+				this->_buffer.insert(this->_buffer.end(), p, p + n);
+			}
+
+		private:
+
+			/**
+			 *
+			 */
+			std::vector<char> &_buffer;
+		};
+
+		/**
+		 * Writes the record of rows × columns values stored contiguously
+		 * in the given layout.
+		 */
+		template <typename T, class Sink>
+		void
+		write_record(const Sink &sink, const T *values, size_t rows,
+		             size_t columns, uint32_t layout)
+		{
+			static const char zeros[alignment] = {};
+
+			const header h =
+				make_header(type_tag<T>::value, layout, rows, columns);
+			const size_t n = rows * columns * sizeof(T);
+
+			sink(&h, sizeof(h));
+			if (n != 0)
+			{
+				sink(values, n);
+			}
+			sink(zeros, padding(n));
+		}
+
+		/**
+		 * A view whose elements are contiguous in either layout is
+		 * written directly, any other one is copied first.
+		 */
+		template <typename T, class Sink>
+		void
+		write_view(const Sink &sink, const const_matrix_view<T> &v)
+		{
+			if (v.is_contiguous())
+			{
+				write_record(sink, v.data(), v.rows(), v.columns(),
+				             row_major::order);
+			}
+			else if (v.transposed_view().is_contiguous())
+			{
+				write_record(sink, v.data(), v.rows(), v.columns(),
+				             column_major::order);
+			}
+			else
+			{
+				const matrix<T> m(v);
+
+				write_record(sink, m.begin(), m.rows(), m.columns(),
+				             row_major::order);
+			}
+		}
+
+		/**
+		 * Reads the values of a record whose header has been read.
+		 */
+		template <typename T>
+		void
+		read_values(int fd, const header &h, T *values)
+		{
+			const size_t n = h.rows * h.columns * sizeof(T);
+
+			read_all(fd, values, n);
+			skip_padding(fd, n);
+		}
+
+		/**
+		 * Reads a record whose number of values must be n.
+		 */
+		template <typename T>
+		void
+		read_array(int fd, T *values, size_t n)
+		{
+			const header h = read_header<T>(fd);
+
+			if (h.rows * h.columns != n)
+			{
+				throw std::runtime_error("binary: wrong size");
+			}
+
+			read_values(fd, h, values);
+		}
+
+		/**
+		 * Parses the record at “first” (which is moved to the next
+		 * record).
+		 *
+		 * @return The address of the values.
+		 */
+		template <typename T>
+		const T *
+		parse(const char *&first, const char *last, header &h)
+		{
+			requires(first <= last);
+
+			if (static_cast<size_t>(last - first) < sizeof(h))
+			{
+				throw std::runtime_error("binary: truncated record");
+			}
+
+			// The header is copied since it may not be aligned.
+			std::memcpy(&h, first, sizeof(h));
+			check_header(h, "binary", type_tag<T>::value);
+
+			const char *values = first + sizeof(h);
+			const size_t n = h.rows * h.columns * sizeof(T);
+
+			requires(reinterpret_cast<uintptr_t>(values) % sizeof(T) == 0);
+
+			if (static_cast<size_t>(last - values) < n)
+			{
+				throw std::runtime_error("binary: truncated record");
+			}
+
+			first = values + n;
+			first += std::min(padding(n), static_cast<size_t>(last - first));
+
+			return reinterpret_cast<const T *>(values);
+		}
+	} // namespace details
+
+	template <typename T>
+	size_t
+	record_size(size_t n)
+	{
+		const size_t bytes = n * sizeof(T);
+
+		return sizeof(details::header) + bytes + details::padding(bytes);
+	}
+
+	template <typename T, class Allocator, class Layout>
+	void
+	write(int fd, const matrix<T, Allocator, Layout> &m)
+	{
+		details::write_record(details::fd_sink(fd), m.begin(), m.rows(),
+		                      m.columns(), Layout::order);
+	}
+
+	template <typename T>
+	void
+	write(int fd, const const_matrix_view<T> &v)
+	{
+		details::write_view(details::fd_sink(fd), v);
+	}
+
+	template <typename T, size_t S>
+	void
+	write(int fd, const array<T, S> &a)
+	{
+		details::write_record(details::fd_sink(fd), a.begin(), a.size(), 1,
+		                      row_major::order);
+	}
+
+	template <typename T>
+	void
+	write(int fd, const array_view<T> &a)
+	{
+		details::write_record(details::fd_sink(fd), a.raw(), a.size(), 1,
+		                      row_major::order);
+	}
+
+	template <typename T, class Allocator, class Layout>
+	void
+	write(std::vector<char> &buffer, const matrix<T, Allocator, Layout> &m)
+	{
+		buffer.reserve(buffer.size() + record_size<T>(m.size()));
+
+		details::write_record(details::buffer_sink(buffer), m.begin(),
+		                      m.rows(), m.columns(), Layout::order);
+	}
+
+	template <typename T>
+	void
+	write(std::vector<char> &buffer, const const_matrix_view<T> &v)
+	{
+		buffer.reserve(buffer.size() + record_size<T>(v.rows() * v.columns()));
+
+		details::write_view(details::buffer_sink(buffer), v);
+	}
+
+	template <typename T, size_t S>
+	void
+	write(std::vector<char> &buffer, const array<T, S> &a)
+	{
+		buffer.reserve(buffer.size() + record_size<T>(a.size()));
+
+		details::write_record(details::buffer_sink(buffer), a.begin(),
+		                      a.size(), 1, row_major::order);
+	}
+
+	template <typename T>
+	void
+	write(std::vector<char> &buffer, const array_view<T> &a)
+	{
+		typedef typename array_view<T>::value_type value_type;
+
+		buffer.reserve(buffer.size() + record_size<value_type>(a.size()));
+
+		details::write_record(details::buffer_sink(buffer), a.raw(),
+		                      a.size(), 1, row_major::order);
+	}
+
+	template <typename T, class Allocator, class Layout>
+	void
+	read(int fd, matrix<T, Allocator, Layout> &m)
+	{
+		const details::header h = details::read_header<T>(fd);
+
+		if (h.layout == Layout::order)
+		{
+			m.resize(h.rows, h.columns);
+			details::read_values(fd, h, m.begin());
+		}
+		else if (h.layout == row_major::order)
+		{
+			matrix<T, Allocator, row_major> tmp(h.rows, h.columns);
+			details::read_values(fd, h, tmp.begin());
+			m = tmp;
+		}
+		else
+		{
+			matrix<T, Allocator, column_major> tmp(h.rows, h.columns);
+			details::read_values(fd, h, tmp.begin());
+			m = tmp;
+		}
+	}
+
+	template <typename T, size_t S>
+	void
+	read(int fd, array<T, S> &a)
+	{
+		details::read_array(fd, a.begin(), a.size());
+	}
+
+	template <typename T>
+	void
+	read(int fd, array_view<T> a)
+	{
+		details::read_array(fd, a.raw(), a.size());
+	}
+
+	template <typename T>
+	const_matrix_view<T>
+	load_matrix(const char *&first, const char *last)
+	{
+		details::header h;
+		const T *values = details::parse<T>(first, last, h);
+
+		if (h.layout == row_major::order)
+		{
+			return const_matrix_view<T>(values, h.rows, h.columns,
+			                            h.columns, 1);
+		}
+		return const_matrix_view<T>(values, h.rows, h.columns, 1, h.rows);
+	}
+
+	template <typename T>
+	array_view<const T>
+	load_array(const char *&first, const char *last)
+	{
+		details::header h;
+		const T *values = details::parse<T>(first, last, h);
+
+		if ((h.rows == 0) || (h.columns == 0))
+		{
+			throw std::runtime_error("binary: empty array");
+		}
+
+		return array_view<const T>(h.rows * h.columns, values);
+	}
+} // namespace binary
+
+JFCPP_NAMESPACE_END
@@ -0,0 +1,252 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_FIXED_MATRIX
+#define H_JFCPP_FIXED_MATRIX
+
+#include <cstddef>
+#include <ostream>
+
+#include <contracts.h>
+
+#include "array.hpp"
+#include "common.hpp"
+#include "matrix.hpp"
+#include "operators.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * A matrix whose dimensions are known at compile time (e.g. 3 × 3 rotations
+ * or 4 × 4 transforms).
+ *
+ * The values are stored in the object itself (no heap allocation), row by
+ * row, and every loop has constant bounds so that the compiler can unroll
+ * it; the determinant and the inverse use the explicit formulas up to the
+ * dimension 4.
+ *
+ * It can be converted to and from a dynamic “matrix<T>” (explicitly) and an
+ * “array<T, R × C>” (its values, row by row), and multiplied by an
+ * “array<T, C>” (seen as a column vector).
+ *
+ * General requirements:
+ * - T must have a default constructor;
+ * - the method “T &T::operator=(const T &)” must be defined.
+ *
+ * @template T The type of contained elements.
+ * @template R The number of rows (not 0).
+ * @template C The number of columns (not 0).
+ */
+template <typename T, size_t R, size_t C = R>
+class fixed_matrix : public operators::addable<fixed_matrix<T, R, C> >,
+                     public operators::dividable<fixed_matrix<T, R, C> >,
+                     public operators::equality_comparable<fixed_matrix<T, R, C> >,
+                     public operators::multipliable<fixed_matrix<T, R, C> >,
+                     public operators::subtractable<fixed_matrix<T, R, C> >
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 *
+	 */
+	typedef T &reference;
+
+	/**
+	 *
+	 */
+	typedef const T &const_reference;
+
+	/**
+	 *
+	 */
+	typedef T *iterator;
+
+	/**
+	 *
+	 */
+	typedef const T *const_iterator;
+
+	/**
+	 * Constructs a matrix whose values are default-initialized (i.e. not
+	 * initialized for built-in types).
+	 */
+	fixed_matrix();
+
+	/**
+	 * Constructs a matrix filled with a value.
+	 */
+	explicit fixed_matrix(const T &value);
+
+	/**
+	 * Constructs a matrix from its values, row by row.
+	 */
+	explicit fixed_matrix(const array<T, R * C> &values);
+
+	/**
+	 * Constructs a matrix from a dynamic one, which must have the same
+	 * dimensions.
+	 */
+	template <class Allocator, class Layout>
+	explicit fixed_matrix(const matrix<T, Allocator, Layout> &m);
+
+	/**
+	 * Constructs the identity matrix.
+	 */
+	static fixed_matrix identity(const_reference zero = T(0),
+	                             const_reference one = T(1));
+
+	iterator begin();
+	const_iterator begin() const;
+
+	iterator end();
+	const_iterator end() const;
+
+	/**
+	 *
+	 */
+	static size_t columns();
+
+	/**
+	 * Gets a column as an array.
+	 */
+	array<T, R> column(size_t j) const;
+
+	/**
+	 * Computes the determinant.
+	 *
+	 * Requirement:
+	 * - This matrix must be square (checked at compile time).
+	 */
+	T det() const;
+
+	/**
+	 * Computes the inverse.
+	 *
+	 * Requirement:
+	 * - This matrix must be square (checked at compile time).
+	 *
+	 * @throw std::runtime_error If this matrix is not invertible.
+	 */
+	fixed_matrix inverse() const;
+
+	/**
+	 *
+	 */
+	static bool is_square();
+
+	/**
+	 * Matrix product.
+	 */
+	template <size_t C2>
+	fixed_matrix<T, R, C2> mprod(const fixed_matrix<T, C, C2> &m) const;
+
+	/**
+	 * Product with a column vector.
+	 */
+	array<T, R> mprod(const array<T, C> &v) const;
+
+	/**
+	 * Gets a row as an array.
+	 */
+	array<T, C> row(size_t i) const;
+
+	/**
+	 *
+	 */
+	static size_t rows();
+
+	/**
+	 *
+	 */
+	static size_t size();
+
+	/**
+	 * Converts this matrix to an array of its values, row by row.
+	 */
+	array<T, R * C> to_array() const;
+
+	/**
+	 * Computes the trace (the sum of the diagonal).
+	 */
+	T trace() const;
+
+	/**
+	 * Computes the transpose.
+	 */
+	fixed_matrix<T, C, R> transpose() const;
+
+	/**
+	 * Element-wise equality.
+	 */
+	bool operator==(const fixed_matrix &m) const;
+
+	/**
+	 * Gets the i-th value (row by row).
+	 */
+	reference operator()(size_t i);
+	const_reference operator()(size_t i) const;
+
+	/**
+	 * Gets the value at the row i and the column j.
+	 */
+	reference operator()(size_t i, size_t j);
+	const_reference operator()(size_t i, size_t j) const;
+
+	/**
+	 * Element-wise operations, with another matrix or with a scalar.
+	 */
+	fixed_matrix &operator+=(const fixed_matrix &m);
+	fixed_matrix &operator-=(const fixed_matrix &m);
+	fixed_matrix &operator*=(const fixed_matrix &m);
+	fixed_matrix &operator/=(const fixed_matrix &m);
+
+	template <typename T2> fixed_matrix &operator+=(const T2 &s);
+	template <typename T2> fixed_matrix &operator-=(const T2 &s);
+	template <typename T2> fixed_matrix &operator*=(const T2 &s);
+	template <typename T2> fixed_matrix &operator/=(const T2 &s);
+
+	/**
+	 *
+	 */
+	fixed_matrix operator-() const;
+
+private:
+
+	/**
+	 *
+	 */
+	T _values[R * C];
+};
+
+JFCPP_NAMESPACE_END
+
+/**
+ * Same format as the dynamic matrices.
+ */
+template <typename T, size_t R, size_t C>
+std::ostream &
+operator<<(std::ostream &os, const JFCPP_NS()fixed_matrix<T, R, C> &m);
+
+#include "fixed_matrix/implementation.hpp"
+
+#endif // H_JFCPP_FIXED_MATRIX
@@ -0,0 +1,688 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+#include <contracts.h>
+
+#include "../common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace fixed_matrix_details
+{
+	/**
+	 * Determinant and inverse of a N × N matrix.
+	 *
+	 * The general case uses a Gaussian elimination with partial pivoting,
+	 * the small dimensions the explicit formulas.
+	 */
+	template <typename T, size_t N>
+	struct square
+	{
+		typedef fixed_matrix<T, N, N> matrix_type;
+
+		static
+		size_t
+		pivot(const matrix_type &a, size_t k)
+		{
+			size_t p = k;
+			for (size_t i = k + 1; i < N; ++i)
+			{
+				if (matrix_details::pivoting<T>::is_better(a(i, k), a(p, k)))
+				{
+					p = i;
+				}
+			}
+
+			return p;
+		}
+
+		static
+		void
+		swap_rows(matrix_type &a, size_t i, size_t j)
+		{
+			std::swap_ranges(&a(i, 0), &a(i, 0) + N, &a(j, 0));
+		}
+
+		static
+		T
+		det(matrix_type a)
+		{
+			T result(1);
+
+			for (size_t k = 0; k < N; ++k)
+			{
+				const size_t p = pivot(a, k);
+
+				if (a(p, k) == T(0))
+				{
+					return T(0);
+				}
+
+				if (p != k)
+				{
+					swap_rows(a, k, p);
+					result = T(0) - result;
+				}
+
+				for (size_t i = k + 1; i < N; ++i)
+				{
+					const T f = a(i, k) / a(k, k);
+
+					for (size_t j = k + 1; j < N; ++j)
+					{
+						a(i, j) -= f * a(k, j);
+					}
+				}
+
+				result = result * a(k, k);
+			}
+
+			return result;
+		}
+
+		/**
+		 * Gauss-Jordan elimination.
+		 */
+		static
+		matrix_type
+		inverse(matrix_type a)
+		{
+			matrix_type result = matrix_type::identity();
+
+			for (size_t k = 0; k < N; ++k)
+			{
+				const size_t p = pivot(a, k);
+
+				if (a(p, k) == T(0))
+				{
+					throw std::runtime_error("singular matrix");
+				}
+
+				if (p != k)
+				{
+					swap_rows(a, k, p);
+					swap_rows(result, k, p);
+				}
+
+				const T pivot_value = a(k, k);
+				for (size_t j = 0; j < N; ++j)
+				{
+					a(k, j) = a(k, j) / pivot_value;
+					result(k, j) = result(k, j) / pivot_value;
+				}
+
+				for (size_t i = 0; i < N; ++i)
+				{
+					const T f = a(i, k);
+
+					if ((i == k) || (f == T(0)))
+					{
+						continue;
+					}
+
+					for (size_t j = 0; j < N; ++j)
+					{
+						a(i, j) -= f * a(k, j);
+						result(i, j) -= f * result(k, j);
+					}
+				}
+			}
+
+			return result;
+		}
+	};
+
+	/**
+	 * Divides the adjugate by the determinant.
+	 */
+	template <typename T, size_t N>
+	fixed_matrix<T, N, N>
+	divide_adjugate(fixed_matrix<T, N, N> adjugate, const T &det)
+	{
+		if (det == T(0))
+		{
+			throw std::runtime_error("singular matrix");
+		}
+
+		for (size_t i = 0; i < N * N; ++i)
+		{
+			adjugate(i) = adjugate(i) / det;
+		}
+
+		return adjugate;
+	}
+
+	template <typename T>
+	struct square<T, 1>
+	{
+		static
+		T
+		det(const fixed_matrix<T, 1, 1> &a)
+		{
+			return a(0);
+		}
+
+		static
+		fixed_matrix<T, 1, 1>
+		inverse(const fixed_matrix<T, 1, 1> &a)
+		{
+			return divide_adjugate(fixed_matrix<T, 1, 1>(T(1)), a(0));
+		}
+	};
+
+	template <typename T>
+	struct square<T, 2>
+	{
+		static
+		T
+		det(const fixed_matrix<T, 2, 2> &a)
+		{
+			return (a(0) * a(3) - a(1) * a(2));
+		}
+
+		static
+		fixed_matrix<T, 2, 2>
+		inverse(const fixed_matrix<T, 2, 2> &a)
+		{
+			fixed_matrix<T, 2, 2> b;
+
+			b(0) = a(3);
+			b(1) = T(0) - a(1);
+			b(2) = T(0) - a(2);
+			b(3) = a(0);
+
+			return divide_adjugate(b, det(a));
+		}
+	};
+
+	template <typename T>
+	struct square<T, 3>
+	{
+		static
+		T
+		det(const fixed_matrix<T, 3, 3> &a)
+		{
+			return (a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1))
+			        + a(0, 1) * (a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2))
+			        + a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0)));
+		}
+
+		static
+		fixed_matrix<T, 3, 3>
+		inverse(const fixed_matrix<T, 3, 3> &a)
+		{
+			fixed_matrix<T, 3, 3> b;
+
+			b(0, 0) = a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1);
+			b(0, 1) = a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2);
+			b(0, 2) = a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1);
+			b(1, 0) = a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2);
+			b(1, 1) = a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0);
+			b(1, 2) = a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2);
+			b(2, 0) = a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0);
+			b(2, 1) = a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1);
+			b(2, 2) = a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+
+			return divide_adjugate(b, a(0, 0) * b(0, 0) + a(0, 1) * b(1, 0)
+			                          + a(0, 2) * b(2, 0));
+		}
+	};
+
+	/**
+	 * Uses the 2 × 2 minors of the two first rows (s) and of the two last
+	 * ones (c).
+	 */
+	template <typename T>
+	struct square<T, 4>
+	{
+		static
+		void
+		minors(const fixed_matrix<T, 4, 4> &a, T *s, T *c)
+		{
+			s[0] = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1);
+			s[1] = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+			s[2] = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3);
+			s[3] = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+			s[4] = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3);
+			s[5] = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+
+			c[0] = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1);
+			c[1] = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+			c[2] = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3);
+			c[3] = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+			c[4] = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3);
+			c[5] = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+		}
+
+		static
+		T
+		det(const T *s, const T *c)
+		{
+			return (s[0] * c[5] - s[1] * c[4] + s[2] * c[3]
+			        + s[3] * c[2] - s[4] * c[1] + s[5] * c[0]);
+		}
+
+		static
+		T
+		det(const fixed_matrix<T, 4, 4> &a)
+		{
+			T s[6], c[6];
+
+			minors(a, s, c);
+
+			return det(s, c);
+		}
+
+		static
+		fixed_matrix<T, 4, 4>
+		inverse(const fixed_matrix<T, 4, 4> &a)
+		{
+			T s[6], c[6];
+
+			minors(a, s, c);
+
+			fixed_matrix<T, 4, 4> b;
+
+			b(0, 0) = a(1, 1) * c[5] - a(1, 2) * c[4] + a(1, 3) * c[3];
+			b(0, 1) = a(0, 2) * c[4] - a(0, 1) * c[5] - a(0, 3) * c[3];
+			b(0, 2) = a(3, 1) * s[5] - a(3, 2) * s[4] + a(3, 3) * s[3];
+			b(0, 3) = a(2, 2) * s[4] - a(2, 1) * s[5] - a(2, 3) * s[3];
+
+			b(1, 0) = a(1, 2) * c[2] - a(1, 0) * c[5] - a(1, 3) * c[1];
+			b(1, 1) = a(0, 0) * c[5] - a(0, 2) * c[2] + a(0, 3) * c[1];
+			b(1, 2) = a(3, 2) * s[2] - a(3, 0) * s[5] - a(3, 3) * s[1];
+			b(1, 3) = a(2, 0) * s[5] - a(2, 2) * s[2] + a(2, 3) * s[1];
+
+			b(2, 0) = a(1, 0) * c[4] - a(1, 1) * c[2] + a(1, 3) * c[0];
+			b(2, 1) = a(0, 1) * c[2] - a(0, 0) * c[4] - a(0, 3) * c[0];
+			b(2, 2) = a(3, 0) * s[4] - a(3, 1) * s[2] + a(3, 3) * s[0];
+			b(2, 3) = a(2, 1) * s[2] - a(2, 0) * s[4] - a(2, 3) * s[0];
+
+			b(3, 0) = a(1, 1) * c[1] - a(1, 0) * c[3] - a(1, 2) * c[0];
+			b(3, 1) = a(0, 0) * c[3] - a(0, 1) * c[1] + a(0, 2) * c[0];
+			b(3, 2) = a(3, 1) * s[1] - a(3, 0) * s[3] - a(3, 2) * s[0];
+			b(3, 3) = a(2, 0) * s[3] - a(2, 1) * s[1] + a(2, 2) * s[0];
+
+			return divide_adjugate(b, det(s, c));
+		}
+	};
+} // namespace fixed_matrix_details
+
+template <typename T, size_t R, size_t C>
+fixed_matrix<T, R, C>::fixed_matrix()
+{}
+
+template <typename T, size_t R, size_t C>
+fixed_matrix<T, R, C>::fixed_matrix(const T &value)
+{
+	std::fill(this->begin(), this->end(), value);
+}
+
+template <typename T, size_t R, size_t C>
+fixed_matrix<T, R, C>::fixed_matrix(const array<T, R * C> &values)
+{
+	std::copy(values.begin(), values.end(), this->begin());
+}
+
+template <typename T, size_t R, size_t C>
+template <class Allocator, class Layout>
+fixed_matrix<T, R, C>::fixed_matrix(const matrix<T, Allocator, Layout> &m)
+{
+	requires(m.rows() == R);
+	requires(m.columns() == C);
+
+	for (size_t i = 0; i < R; ++i)
+	{
+		for (size_t j = 0; j < C; ++j)
+		{
+			(*this)(i, j) = m(i, j);
+		}
+	}
+}
+
+template <typename T, size_t R, size_t C>
+fixed_matrix<T, R, C>
+fixed_matrix<T, R, C>::identity(const_reference zero, const_reference one)
+{
+	fixed_matrix result(zero);
+
+	for (size_t i = 0; (i < R) && (i < C); ++i)
+	{
+		result(i, i) = one;
+	}
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::iterator
+fixed_matrix<T, R, C>::begin()
+{
+	return this->_values;
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::const_iterator
+fixed_matrix<T, R, C>::begin() const
+{
+	return this->_values;
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::iterator
+fixed_matrix<T, R, C>::end()
+{
+	return this->_values + R * C;
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::const_iterator
+fixed_matrix<T, R, C>::end() const
+{
+	return this->_values + R * C;
+}
+
+template <typename T, size_t R, size_t C>
+size_t
+fixed_matrix<T, R, C>::columns()
+{
+	return C;
+}
+
+template <typename T, size_t R, size_t C>
+array<T, R>
+fixed_matrix<T, R, C>::column(size_t j) const
+{
+	requires(j < C);
+
+	array<T, R> result;
+
+	for (size_t i = 0; i < R; ++i)
+	{
+		result[i] = (*this)(i, j);
+	}
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+T
+fixed_matrix<T, R, C>::det() const
+{
+	// Only compiles for square matrices.
+	return fixed_matrix_details::square<T, R>::det(*this);
+}
+
+template <typename T, size_t R, size_t C>
+fixed_matrix<T, R, C>
+fixed_matrix<T, R, C>::inverse() const
+{
+	// Only compiles for square matrices.
+	return fixed_matrix_details::square<T, R>::inverse(*this);
+}
+
+template <typename T, size_t R, size_t C>
+bool
+fixed_matrix<T, R, C>::is_square()
+{
+	return (R == C);
+}
+
+template <typename T, size_t R, size_t C>
+template <size_t C2>
+fixed_matrix<T, R, C2>
+fixed_matrix<T, R, C>::mprod(const fixed_matrix<T, C, C2> &m) const
+{
+	fixed_matrix<T, R, C2> result(T(0));
+
+	// The order (i, k, j) reads both matrices row by row.
+	for (size_t i = 0; i < R; ++i)
+	{
+		for (size_t k = 0; k < C; ++k)
+		{
+			const T &a = (*this)(i, k);
+
+			for (size_t j = 0; j < C2; ++j)
+			{
+				result(i, j) += a * m(k, j);
+			}
+		}
+	}
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+array<T, R>
+fixed_matrix<T, R, C>::mprod(const array<T, C> &v) const
+{
+	array<T, R> result;
+
+	for (size_t i = 0; i < R; ++i)
+	{
+		T tmp(0);
+		for (size_t j = 0; j < C; ++j)
+		{
+			tmp += (*this)(i, j) * v[j];
+		}
+		result[i] = tmp;
+	}
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+array<T, C>
+fixed_matrix<T, R, C>::row(size_t i) const
+{
+	requires(i < R);
+
+	array<T, C> result;
+
+	std::copy(this->_values + i * C, this->_values + (i + 1) * C,
+	          result.begin());
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+size_t
+fixed_matrix<T, R, C>::rows()
+{
+	return R;
+}
+
+template <typename T, size_t R, size_t C>
+size_t
+fixed_matrix<T, R, C>::size()
+{
+	return R * C;
+}
+
+template <typename T, size_t R, size_t C>
+array<T, R * C>
+fixed_matrix<T, R, C>::to_array() const
+{
+	array<T, R * C> result;
+
+	std::copy(this->begin(), this->end(), result.begin());
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+T
+fixed_matrix<T, R, C>::trace() const
+{
+	T result(0);
+
+	for (size_t i = 0; (i < R) && (i < C); ++i)
+	{
+		result += (*this)(i, i);
+	}
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+fixed_matrix<T, C, R>
+fixed_matrix<T, R, C>::transpose() const
+{
+	fixed_matrix<T, C, R> result;
+
+	for (size_t i = 0; i < R; ++i)
+	{
+		for (size_t j = 0; j < C; ++j)
+		{
+			result(j, i) = (*this)(i, j);
+		}
+	}
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C>
+bool
+fixed_matrix<T, R, C>::operator==(const fixed_matrix &m) const
+{
+	return std::equal(this->begin(), this->end(), m.begin());
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::reference
+fixed_matrix<T, R, C>::operator()(size_t i)
+{
+	requires(i < R * C);
+
+	return this->_values[i];
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::const_reference
+fixed_matrix<T, R, C>::operator()(size_t i) const
+{
+	requires(i < R * C);
+
+	return this->_values[i];
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::reference
+fixed_matrix<T, R, C>::operator()(size_t i, size_t j)
+{
+	requires(i < R);
+	requires(j < C);
+
+	return this->_values[i * C + j];
+}
+
+template <typename T, size_t R, size_t C>
+typename fixed_matrix<T, R, C>::const_reference
+fixed_matrix<T, R, C>::operator()(size_t i, size_t j) const
+{
+	requires(i < R);
+	requires(j < C);
+
+	return this->_values[i * C + j];
+}
+
+#define JFCPP_FIXED_MATRIX_OPERATION(OP) \
+template <typename T, size_t R, size_t C> \
+fixed_matrix<T, R, C> & \
+fixed_matrix<T, R, C>::operator OP##=(const fixed_matrix &m) \
+{ \
+	for (size_t i = 0; i < R * C; ++i) \
+	{ \
+		this->_values[i] OP##= m._values[i]; \
+	} \
+ \
+	return *this; \
+} \
+ \
+template <typename T, size_t R, size_t C> \
+template <typename T2> \
+fixed_matrix<T, R, C> & \
+fixed_matrix<T, R, C>::operator OP##=(const T2 &s) \
+{ \
+	for (size_t i = 0; i < R * C; ++i) \
+	{ \
+		this->_values[i] OP##= s; \
+	} \
+ \
+	return *this; \
+}
+
+JFCPP_FIXED_MATRIX_OPERATION(+)
+JFCPP_FIXED_MATRIX_OPERATION(-)
+JFCPP_FIXED_MATRIX_OPERATION(*)
+JFCPP_FIXED_MATRIX_OPERATION(/)
+
+#undef JFCPP_FIXED_MATRIX_OPERATION
+
+template <typename T, size_t R, size_t C>
+fixed_matrix<T, R, C>
+fixed_matrix<T, R, C>::operator-() const
+{
+	fixed_matrix result;
+
+	for (size_t i = 0; i < R * C; ++i)
+	{
+		result._values[i] = -this->_values[i];
+	}
+
+	return result;
+}
+
+template <typename T, class Allocator, class Layout>
+template <size_t R, size_t C>
+matrix<T, Allocator, Layout>::matrix(const fixed_matrix<T, R, C> &m)
+	: _rows(R), _columns(C), _size(R * C), _values(NULL), _allocator()
+{
+	this->allocate();
+
+	for (size_t i = 0; i < R; ++i)
+	{
+		for (size_t j = 0; j < C; ++j)
+		{
+			(*this)(i, j) = m(i, j);
+		}
+	}
+}
+
+JFCPP_NAMESPACE_END
+
+template <typename T, size_t R, size_t C>
+std::ostream &
+operator<<(std::ostream &os, const JFCPP_NS()fixed_matrix<T, R, C> &m)
+{
+	for (size_t i = 0; i < R; ++i)
+	{
+		size_t j = 0;
+		for (; j < C - 1; ++j)
+		{
+			os << m(i, j) << '\t';
+		}
+		os << m(i, j) << std::endl;
+	}
+
+	return os;
+}
@@ -0,0 +1,258 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_ITERATIVE
+#define H_JFCPP_ITERATIVE
+
+#include <cstddef>
+#include <vector>
+
+#include "common.hpp"
+#include "matrix.hpp"
+#include "sparse_matrix.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * Iterative (Krylov) solvers of “A × x = b”.
+ *
+ * Unlike the elimination, they only need the products by A, which makes
+ * them suited to large sparse systems.
+ *
+ * A can be a dense “matrix<T>”, a “sparse_matrix<T>” or any type which
+ * provides:
+ * - “size_t rows() const”;
+ * - “void mprod(const T *x, T *y, executor &e) const” (y = A × x).
+ *
+ * A preconditioner M (which approximates A) must provide:
+ * - “void apply(const T *r, T *z) const” (z = M⁻¹ × r).
+ *
+ * x contains the initial guess and receives the solution.
+ *
+ * The products by A are split between the threads of the executor, the
+ * other operations are done by the calling thread.
+ *
+ * Requirement:
+ * - T must be a floating point type.
+ */
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ *
+ */
+template <typename T>
+struct iterative_parameters
+{
+	/**
+	 * Constructs the default parameters.
+	 *
+	 * The default tolerance is the square root of the machine epsilon.
+	 */
+	iterative_parameters();
+
+	/**
+	 * The iteration stops when ‖b - A × x‖ ≤ tolerance × ‖b‖.
+	 */
+	T tolerance;
+
+	/**
+	 *
+	 */
+	size_t max_iterations;
+
+	/**
+	 * Number of iterations between two restarts of GMRES.
+	 */
+	size_t restart;
+};
+
+/**
+ * What happened during the resolution.
+ */
+template <typename T>
+struct iterative_statistics
+{
+	/**
+	 *
+	 */
+	iterative_statistics();
+
+	/**
+	 * Whether the tolerance has been reached.
+	 */
+	bool converged;
+
+	/**
+	 * Number of iterations (products by A for GMRES, loops otherwise).
+	 */
+	size_t iterations;
+
+	/**
+	 * The relative residual (‖b - A × x‖ / ‖b‖) before the first iteration
+	 * and after each of them.
+	 */
+	std::vector<T> residuals;
+};
+
+/**
+ * No preconditioning.
+ */
+template <typename T>
+class identity_preconditioner
+{
+public:
+
+	/**
+	 * @param n The dimension of A.
+	 */
+	explicit identity_preconditioner(size_t n);
+
+	void apply(const T *r, T *z) const;
+
+private:
+
+	/**
+	 *
+	 */
+	size_t _n;
+};
+
+/**
+ * Divides by the diagonal of A.
+ */
+template <typename T>
+class jacobi_preconditioner
+{
+public:
+
+	/**
+	 * @throw std::runtime_error If a diagonal element is zero.
+	 */
+	template <class Matrix>
+	explicit jacobi_preconditioner(const Matrix &a);
+
+	void apply(const T *r, T *z) const;
+
+private:
+
+	/**
+	 * The inverses of the diagonal elements.
+	 */
+	std::vector<T> _inverses;
+};
+
+/**
+ * Incomplete LU factorization without fill-in: L and U have the non-zero
+ * pattern of A.
+ *
+ * Its application (two triangular solves) is sequential.
+ */
+template <typename T>
+class ilu0_preconditioner
+{
+public:
+
+	/**
+	 * @throw std::runtime_error If a pivot is zero.
+	 */
+	explicit ilu0_preconditioner(const sparse_matrix<T> &a);
+
+	/**
+	 * The zeros of a dense matrix are not part of the pattern.
+	 */
+	template <class Allocator, class Layout>
+	explicit ilu0_preconditioner(const matrix<T, Allocator, Layout> &a);
+
+	void apply(const T *r, T *z) const;
+
+private:
+
+	/**
+	 * L (without its unit diagonal) and U in the CSR format, with the
+	 * pattern of A.
+	 */
+	std::vector<size_t> _row_offsets;
+	std::vector<size_t> _column_indices;
+	std::vector<T> _values;
+
+	/**
+	 * Position of the diagonal element of each row.
+	 */
+	std::vector<size_t> _diagonal;
+
+	/**
+	 *
+	 */
+	void factorize(const sparse_matrix<T> &a);
+};
+
+/**
+ * Preconditioned conjugate gradient.
+ *
+ * Requirements:
+ * - A must be symmetric positive definite;
+ * - so must be M.
+ */
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+conjugate_gradient(const Matrix &a, const Preconditioner &m, const T *b,
+                   T *x,
+                   const iterative_parameters<T> &p = iterative_parameters<T>());
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+conjugate_gradient(const Matrix &a, const Preconditioner &m, const T *b,
+                   T *x, const iterative_parameters<T> &p, executor &e);
+
+/**
+ * Right-preconditioned BiCGSTAB, for non-symmetric matrices.
+ *
+ * It stops without converging if a breakdown happens.
+ */
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+bicgstab(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+         const iterative_parameters<T> &p = iterative_parameters<T>());
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+bicgstab(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+         const iterative_parameters<T> &p, executor &e);
+
+/**
+ * Right-preconditioned GMRES restarted every “p.restart” iterations, for
+ * non-symmetric matrices.
+ *
+ * The Krylov basis is orthogonalized with the modified Gram-Schmidt
+ * process, the memory used is O(restart × n).
+ */
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+gmres(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+      const iterative_parameters<T> &p = iterative_parameters<T>());
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+gmres(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+      const iterative_parameters<T> &p, executor &e);
+
+JFCPP_NAMESPACE_END
+
+#include "iterative/implementation.hpp"
+
+#endif // H_JFCPP_ITERATIVE
@@ -0,0 +1,724 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../common.hpp"
+#include "../math.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace iterative_details
+{
+	/**
+	 * y = A × x for a dense matrix, by tiles of rows.
+	 */
+	template <typename T>
+	class dense_product_task : public parallel_task
+	{
+	public:
+
+		static const size_t rows_by_tile = 64;
+
+		dense_product_task(size_t rows, size_t columns, const T *a,
+		                   const T *x, T *y)
+			: _rows(rows), _columns(columns), _a(a), _x(x), _y(y)
+		{}
+
+		size_t
+		tiles() const
+		{
+			return ((_rows + rows_by_tile - 1) / rows_by_tile);
+		}
+
+		void
+		operator()(size_t tile)
+		{
+			const size_t
+				first = tile * rows_by_tile,
+				last = std::min(first + rows_by_tile, _rows);
+
+			for (size_t i = first; i < last; ++i)
+			{
+				const T *row = _a + i * _columns;
+
+				_y[i] = JFCPP_MATH_NS()details::dot(row, row + _columns, _x);
+			}
+		}
+
+	private:
+
+		size_t _rows;
+		size_t _columns;
+		const T *_a;
+		const T *_x;
+		T *_y;
+	};
+
+	/**
+	 * y = A × x.
+	 */
+	template <typename T, class Matrix>
+	void
+	mprod(const Matrix &a, const T *x, T *y, executor &e)
+	{
+		a.mprod(x, y, e);
+	}
+
+	template <typename T, class Allocator>
+	void
+	mprod(const matrix<T, Allocator> &a, const T *x, T *y, executor &e)
+	{
+		requires(a.is_square());
+
+		dense_product_task<T> task(a.rows(), a.columns(), a.begin(), x, y);
+
+		e.run(task, task.tiles());
+	}
+
+	/**
+	 * The columns are contiguous: y is a combination of them, computed by
+	 * the GEMM engine.
+	 */
+	template <typename T, class Allocator>
+	void
+	mprod(const matrix<T, Allocator, column_major> &a, const T *x, T *y,
+	      executor &e)
+	{
+		requires(a.is_square());
+
+		matrix_details::gemm(e, a.rows(), 1, a.columns(), T(1),
+		                     a.begin(), 1, a.rows(),
+		                     x, 1, 1,
+		                     T(0), y, 1, 1);
+	}
+
+	template <typename T>
+	T
+	dot(const std::vector<T> &x, const std::vector<T> &y)
+	{
+		return JFCPP_MATH_NS()details::dot(&x[0], &x[0] + x.size(), &y[0]);
+	}
+
+	template <typename T>
+	T
+	norm(const std::vector<T> &x)
+	{
+		return std::sqrt(dot(x, x));
+	}
+
+	/**
+	 * y += a × x.
+	 */
+	template <typename T>
+	void
+	axpy(const T &a, const std::vector<T> &x, std::vector<T> &y)
+	{
+		for (size_t i = 0; i < y.size(); ++i)
+		{
+			y[i] += a * x[i];
+		}
+	}
+
+	/**
+	 * r = b - A × x and returns ‖r‖.
+	 */
+	template <typename T, class Matrix>
+	T
+	residual(const Matrix &a, const T *b, const T *x, std::vector<T> &r,
+	         executor &e)
+	{
+		mprod(a, x, &r[0], e);
+		for (size_t i = 0; i < r.size(); ++i)
+		{
+			r[i] = b[i] - r[i];
+		}
+
+		return norm(r);
+	}
+
+	/**
+	 * Records the relative residual and tells whether the iteration must
+	 * stop.
+	 *
+	 * A NaN residual (breakdown or non-finite input) has not converged and
+	 * stops the iteration, it would not get better.
+	 */
+	template <typename T>
+	bool
+	record(iterative_statistics<T> &statistics, const T &residual,
+	       const iterative_parameters<T> &p)
+	{
+		statistics.residuals.push_back(residual);
+		statistics.converged = (residual <= p.tolerance);
+
+		return (statistics.converged
+		        || (statistics.iterations >= p.max_iterations)
+		        || (residual != residual));
+	}
+
+	/**
+	 * Handles the right-hand side zero (the solution is zero) and records
+	 * the initial residual in “r”.
+	 *
+	 * Returns ‖b‖ or 0 if the iteration must not start.
+	 */
+	template <typename T, class Matrix>
+	T
+	start(const Matrix &a, const T *b, T *x, std::vector<T> &r,
+	      const iterative_parameters<T> &p, iterative_statistics<T> &statistics,
+	      executor &e)
+	{
+		const size_t n = r.size();
+
+		T norm_b = JFCPP_MATH_NS()details::dot(b, b + n, b);
+		norm_b = std::sqrt(norm_b);
+
+		if (norm_b == T(0))
+		{
+			std::fill(x, x + n, T(0));
+			std::fill(r.begin(), r.end(), T(0));
+			record(statistics, T(0), p);
+
+			return T(0);
+		}
+
+		if (record(statistics, residual(a, b, x, r, e) / norm_b, p))
+		{
+			return T(0);
+		}
+
+		return norm_b;
+	}
+} // namespace iterative_details
+
+////////////////////////////////////////
+// Parameters.
+
+template <typename T>
+iterative_parameters<T>::iterative_parameters()
+	: tolerance(std::sqrt(std::numeric_limits<T>::epsilon())),
+	  max_iterations(1000), restart(30)
+{}
+
+template <typename T>
+iterative_statistics<T>::iterative_statistics()
+	: converged(false), iterations(0)
+{}
+
+////////////////////////////////////////
+// Preconditioners.
+
+template <typename T>
+identity_preconditioner<T>::identity_preconditioner(size_t n)
+	: _n(n)
+{}
+
+template <typename T>
+void
+identity_preconditioner<T>::apply(const T *r, T *z) const
+{
+	std::copy(r, r + this->_n, z);
+}
+
+template <typename T>
+template <class Matrix>
+jacobi_preconditioner<T>::jacobi_preconditioner(const Matrix &a)
+	: _inverses(a.rows())
+{
+	for (size_t i = 0; i < this->_inverses.size(); ++i)
+	{
+		const T d = a(i, i);
+
+		if (d == T(0))
+		{
+			throw std::runtime_error("zero on the diagonal");
+		}
+
+		this->_inverses[i] = T(1) / d;
+	}
+}
+
+template <typename T>
+void
+jacobi_preconditioner<T>::apply(const T *r, T *z) const
+{
+	for (size_t i = 0; i < this->_inverses.size(); ++i)
+	{
+		z[i] = r[i] * this->_inverses[i];
+	}
+}
+
+template <typename T>
+ilu0_preconditioner<T>::ilu0_preconditioner(const sparse_matrix<T> &a)
+{
+	this->factorize(a);
+}
+
+template <typename T>
+template <class Allocator, class Layout>
+ilu0_preconditioner<T>::ilu0_preconditioner(
+	const matrix<T, Allocator, Layout> &a)
+{
+	this->factorize(sparse_matrix<T>(a));
+}
+
+template <typename T>
+void
+ilu0_preconditioner<T>::factorize(const sparse_matrix<T> &a)
+{
+	requires(a.rows() == a.columns());
+
+	const size_t n = a.rows(), none = size_t(-1);
+
+	this->_row_offsets = a.row_offsets();
+	this->_column_indices = a.column_indices();
+	this->_values = a.values();
+	this->_diagonal.assign(n, none);
+
+	const std::vector<size_t>
+		&offsets = this->_row_offsets,
+		&columns = this->_column_indices;
+	std::vector<T> &values = this->_values;
+
+	// Position of each column in the current row.
+	std::vector<size_t> positions(n, none);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+		{
+			positions[columns[k]] = k;
+		}
+
+		// The row i is combined with the previous rows in order (IKJ).
+		size_t k = offsets[i];
+		for (; (k < offsets[i + 1]) && (columns[k] < i); ++k)
+		{
+			const size_t row = columns[k];
+
+			values[k] = values[k] / values[this->_diagonal[row]];
+
+			for (size_t l = this->_diagonal[row] + 1; l < offsets[row + 1];
+			     ++l)
+			{
+				const size_t position = positions[columns[l]];
+
+				// The fill-in is dropped.
+				if (position != none)
+				{
+					values[position] -= values[k] * values[l];
+				}
+			}
+		}
+
+		if ((k == offsets[i + 1]) || (columns[k] != i)
+		    || (values[k] == T(0)))
+		{
+			throw std::runtime_error("zero pivot");
+		}
+		this->_diagonal[i] = k;
+
+		for (k = offsets[i]; k < offsets[i + 1]; ++k)
+		{
+			positions[columns[k]] = none;
+		}
+	}
+}
+
+template <typename T>
+void
+ilu0_preconditioner<T>::apply(const T *r, T *z) const
+{
+	const size_t n = this->_diagonal.size();
+
+	const std::vector<size_t>
+		&offsets = this->_row_offsets,
+		&columns = this->_column_indices;
+	const std::vector<T> &values = this->_values;
+
+	// L × y = r (L has a unit diagonal).
+	for (size_t i = 0; i < n; ++i)
+	{
+		T sum(r[i]);
+		for (size_t k = offsets[i]; k < this->_diagonal[i]; ++k)
+		{
+			sum -= values[k] * z[columns[k]];
+		}
+		z[i] = sum;
+	}
+
+	// U × z = y.
+	for (size_t i = n; i-- > 0;)
+	{
+		T sum(z[i]);
+		for (size_t k = this->_diagonal[i] + 1; k < offsets[i + 1]; ++k)
+		{
+			sum -= values[k] * z[columns[k]];
+		}
+		z[i] = sum / values[this->_diagonal[i]];
+	}
+}
+
+////////////////////////////////////////
+// Solvers.
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+conjugate_gradient(const Matrix &a, const Preconditioner &m, const T *b,
+                   T *x, const iterative_parameters<T> &p)
+{
+	sequential_executor e;
+
+	return conjugate_gradient(a, m, b, x, p, e);
+}
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+conjugate_gradient(const Matrix &a, const Preconditioner &m, const T *b,
+                   T *x, const iterative_parameters<T> &p, executor &e)
+{
+	using namespace iterative_details;
+
+	const size_t n = a.rows();
+
+	iterative_statistics<T> statistics;
+	if (n == 0)
+	{
+		statistics.converged = true;
+		return statistics;
+	}
+
+	std::vector<T> r(n), z(n), d(n), q(n);
+
+	const T norm_b = start(a, b, x, r, p, statistics, e);
+	if (norm_b == T(0))
+	{
+		return statistics;
+	}
+
+	m.apply(&r[0], &z[0]);
+	d = z;
+
+	T rz = dot(r, z);
+
+	for (;;)
+	{
+		++statistics.iterations;
+
+		mprod(a, &d[0], &q[0], e);
+
+		const T alpha = rz / dot(d, q);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] += alpha * d[i];
+			r[i] -= alpha * q[i];
+		}
+
+		if (record(statistics, norm(r) / norm_b, p))
+		{
+			break;
+		}
+
+		m.apply(&r[0], &z[0]);
+
+		const T previous = rz;
+		rz = dot(r, z);
+
+		const T beta = rz / previous;
+		for (size_t i = 0; i < n; ++i)
+		{
+			d[i] = z[i] + beta * d[i];
+		}
+	}
+
+	return statistics;
+}
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+bicgstab(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+         const iterative_parameters<T> &p)
+{
+	sequential_executor e;
+
+	return bicgstab(a, m, b, x, p, e);
+}
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+bicgstab(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+         const iterative_parameters<T> &p, executor &e)
+{
+	using namespace iterative_details;
+
+	const size_t n = a.rows();
+
+	iterative_statistics<T> statistics;
+	if (n == 0)
+	{
+		statistics.converged = true;
+		return statistics;
+	}
+
+	std::vector<T> r(n), r0(n), v(n, T(0)), d(n, T(0)), y(n), s(n), z(n), t(n);
+
+	const T norm_b = start(a, b, x, r, p, statistics, e);
+	if (norm_b == T(0))
+	{
+		return statistics;
+	}
+
+	r0 = r;
+
+	T rho(1), alpha(1), omega(1);
+
+	for (;;)
+	{
+		const T previous = rho;
+		rho = dot(r0, r);
+
+		if ((rho == T(0)) || (omega == T(0)))
+		{
+			// Breakdown.
+			break;
+		}
+
+		++statistics.iterations;
+
+		const T beta = (rho / previous) * (alpha / omega);
+		for (size_t i = 0; i < n; ++i)
+		{
+			d[i] = r[i] + beta * (d[i] - omega * v[i]);
+		}
+
+		m.apply(&d[0], &y[0]);
+		mprod(a, &y[0], &v[0], e);
+
+		const T r0v = dot(r0, v);
+		if (r0v == T(0))
+		{
+			// Breakdown.
+			break;
+		}
+		alpha = rho / r0v;
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			s[i] = r[i] - alpha * v[i];
+		}
+
+		const T norm_s = norm(s) / norm_b;
+		if (!(norm_s > p.tolerance))
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				x[i] += alpha * y[i];
+			}
+			record(statistics, norm_s, p);
+			break;
+		}
+
+		m.apply(&s[0], &z[0]);
+		mprod(a, &z[0], &t[0], e);
+
+		const T tt = dot(t, t);
+		omega = (tt == T(0) ? T(0) : dot(t, s) / tt);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] += alpha * y[i] + omega * z[i];
+			r[i] = s[i] - omega * t[i];
+		}
+
+		if (record(statistics, norm(r) / norm_b, p))
+		{
+			break;
+		}
+	}
+
+	return statistics;
+}
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+gmres(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+      const iterative_parameters<T> &p)
+{
+	sequential_executor e;
+
+	return gmres(a, m, b, x, p, e);
+}
+
+template <typename T, class Matrix, class Preconditioner>
+iterative_statistics<T>
+gmres(const Matrix &a, const Preconditioner &m, const T *b, T *x,
+      const iterative_parameters<T> &p, executor &e)
+{
+	requires(p.restart > 0);
+
+	using namespace iterative_details;
+
+	const size_t n = a.rows(), restart = std::min(p.restart, n);
+
+	iterative_statistics<T> statistics;
+	if (n == 0)
+	{
+		statistics.converged = true;
+		return statistics;
+	}
+
+	std::vector<T> r(n), w(n), z(n);
+
+	const T norm_b = start(a, b, x, r, p, statistics, e);
+	if (norm_b == T(0))
+	{
+		return statistics;
+	}
+
+	// The Krylov basis, the Hessenberg matrix (column by column), the
+	// Givens rotations and the right-hand side of the least squares
+	// problem.
+	std::vector<std::vector<T> > basis(restart + 1, std::vector<T>(n));
+	std::vector<std::vector<T> > h(restart, std::vector<T>(restart + 1));
+	std::vector<T> cosines(restart), sines(restart), g(restart + 1), y(restart);
+
+	bool done = false;
+	while (!done)
+	{
+		T beta = norm(r);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			basis[0][i] = r[i] / beta;
+		}
+		std::fill(g.begin(), g.end(), T(0));
+		g[0] = beta;
+
+		size_t k = 0;
+		while (k < restart)
+		{
+			++statistics.iterations;
+
+			std::vector<T> &column = h[k];
+
+			m.apply(&basis[k][0], &z[0]);
+			mprod(a, &z[0], &w[0], e);
+
+			// Modified Gram-Schmidt.
+			for (size_t i = 0; i <= k; ++i)
+			{
+				column[i] = dot(w, basis[i]);
+				axpy(T(0) - column[i], basis[i], w);
+			}
+			column[k + 1] = norm(w);
+
+			if (!(column[k + 1] == T(0)))
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					basis[k + 1][i] = w[i] / column[k + 1];
+				}
+			}
+
+			// Applies the previous rotations then computes the one which
+			// cancels “column[k + 1]”.
+			for (size_t i = 0; i < k; ++i)
+			{
+				const T tmp = cosines[i] * column[i] + sines[i] * column[i + 1];
+
+				column[i + 1] = cosines[i] * column[i + 1] - sines[i] * column[i];
+				column[i] = tmp;
+			}
+
+			const T hypotenuse = std::sqrt(column[k] * column[k]
+			                               + column[k + 1] * column[k + 1]);
+			if (hypotenuse == T(0))
+			{
+				cosines[k] = T(1);
+				sines[k] = T(0);
+			}
+			else
+			{
+				cosines[k] = column[k] / hypotenuse;
+				sines[k] = column[k + 1] / hypotenuse;
+			}
+
+			column[k] = hypotenuse;
+			column[k + 1] = T(0);
+
+			g[k + 1] = T(0) - sines[k] * g[k];
+			g[k] = cosines[k] * g[k];
+
+			++k;
+
+			done = record(statistics, std::abs(g[k]) / norm_b, p);
+			if (done || (hypotenuse == T(0)))
+			{
+				break;
+			}
+		}
+
+		// Solves the triangular system H × y = g and updates x with the
+		// preconditioned combination of the basis.
+		for (size_t i = k; i-- > 0;)
+		{
+			T sum(g[i]);
+			for (size_t j = i + 1; j < k; ++j)
+			{
+				sum -= h[j][i] * y[j];
+			}
+			y[i] = (h[i][i] == T(0) ? T(0) : sum / h[i][i]);
+		}
+
+		std::fill(w.begin(), w.end(), T(0));
+		for (size_t j = 0; j < k; ++j)
+		{
+			axpy(y[j], basis[j], w);
+		}
+		m.apply(&w[0], &z[0]);
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] += z[i];
+		}
+
+		if (!done)
+		{
+			// The true residual avoids the drift of the estimate.
+			const T relative = residual(a, b, x, r, e) / norm_b;
+
+			statistics.residuals.back() = relative;
+			statistics.converged = (relative <= p.tolerance);
+			done = (statistics.converged
+			        || (statistics.iterations >= p.max_iterations)
+			        || (relative == T(0)) || (relative != relative));
+		}
+	}
+
+	return statistics;
+}
+
+JFCPP_NAMESPACE_END
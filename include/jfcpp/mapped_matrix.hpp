@@ -0,0 +1,275 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MAPPED_MATRIX
+#define H_JFCPP_MAPPED_MATRIX
+
+#include <cstddef>
+#include <string>
+
+#include <contracts.h>
+
+#include "binary.hpp"
+#include "common.hpp"
+#include "matrix.hpp"
+#include "matrix/layout.hpp"
+#include "matrix/view.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * How a file is mapped.
+ */
+struct mapping
+{
+	enum mode
+	{
+		read_only,
+		read_write
+	};
+};
+
+/**
+ * A matrix whose values are stored in a file mapped in memory (“mmap()”).
+ *
+ * Opening a matrix does not read it: the pages are loaded by the system
+ * when the values are accessed and evicted under memory pressure, which
+ * allows to work on matrices larger than the memory.  Creating a matrix
+ * allocates a sparse file filled with zeros.
+ *
+ * The algorithms of “matrix/view.hpp” (blocks, element-wise expressions,
+ * GEMM, …) work on the views of a mapped matrix, e.g. a product can be
+ * streamed by panels of rows:
+ *
+ *   for (size_t i = 0; i < a.rows(); i += panel)
+ *   {
+ *       const size_t n = std::min(panel, a.rows() - i);
+ *       a.prefetch(i, 0, n, a.columns());
+ *       c.block(i, 0, n, c.columns())
+ *           .gemm(1, a.const_block(i, 0, n, a.columns()), b, 0);
+ *       a.release(i, 0, n, a.columns());
+ *   }
+ *
+ * The mutable accessors (“block()”, “data()”, “view()” and “operator()”
+ * of a non-const matrix) throw if the file is mapped in read-only mode,
+ * “const_block()” and “const_view()” work in both modes.
+ *
+ * A matrix can be loaded in memory with “matrix<T>(m.view())”.
+ *
+ * The file holds a record of the binary format (see “binary.hpp”): a matrix
+ * written by “binary::write()” can be mapped and conversely.  It is specific
+ * to the machine which wrote it (byte order and representation of T),
+ * opening it elsewhere fails.
+ *
+ * This is a POSIX facility.
+ *
+ * @template T      A built-in arithmetic type.
+ * @template Layout “row_major” or “column_major” (see “matrix/layout.hpp”).
+ */
+template <typename T, class Layout = row_major>
+class mapped_matrix
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Creates a file (replacing any existing one) for a rows × columns
+	 * matrix of zeros, mapped in read-write mode.
+	 *
+	 * @throw std::runtime_error If the file cannot be created or mapped, or
+	 *                           if its size does not fit in a size_t.
+	 */
+	mapped_matrix(const std::string &path, size_t rows, size_t columns);
+
+	/**
+	 * Maps an existing file.
+	 *
+	 * @throw std::runtime_error If the file cannot be mapped or if its
+	 *                           header does not match T and Layout.
+	 */
+	explicit mapped_matrix(const std::string &path,
+	                       mapping::mode mode = mapping::read_only);
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+	/**
+	 * Takes the mapping of another matrix, which is left empty.
+	 */
+	mapped_matrix(mapped_matrix &&m);
+#endif
+
+	/**
+	 * Unmaps the file, the modifications are written back by the system
+	 * (see “flush()”).
+	 */
+	~mapped_matrix();
+
+	/**
+	 * Gets the view on the rows × columns block whose first element is (i,
+	 * j).
+	 *
+	 * @throw std::runtime_error If the mapping is read-only (non-const
+	 *                           version).
+	 */
+	matrix_view<T> block(size_t i, size_t j, size_t rows, size_t columns);
+	const_matrix_view<T> block(size_t i, size_t j, size_t rows,
+	                           size_t columns) const;
+
+	/**
+	 *
+	 */
+	size_t columns() const;
+
+	/**
+	 * Same as “block() const”, even if this matrix is not const.
+	 */
+	const_matrix_view<T> const_block(size_t i, size_t j, size_t rows,
+	                                 size_t columns) const;
+
+	/**
+	 * Same as “view() const”, even if this matrix is not const.
+	 */
+	const_matrix_view<T> const_view() const;
+
+	/**
+	 * Gets the values, in the order of the layout.
+	 *
+	 * @throw std::runtime_error If the mapping is read-only (non-const
+	 *                           version).
+	 */
+	T *data();
+	const T *data() const;
+
+	/**
+	 * Writes the modifications to the file and waits for the completion.
+	 */
+	void flush();
+
+	/**
+	 * Whether the file is mapped in read-write mode.
+	 */
+	bool is_writable() const;
+
+	/**
+	 * Tells the system that the block will be accessed soon, so that it
+	 * starts reading it (the pages spanned by the block are concerned).
+	 */
+	void prefetch(size_t i, size_t j, size_t rows, size_t columns) const;
+
+	/**
+	 * Tells the system that the block will not be accessed soon, so that
+	 * its pages can be evicted from the memory (they are read again from
+	 * the file if needed, the modifications are not lost).
+	 */
+	void release(size_t i, size_t j, size_t rows, size_t columns) const;
+
+	/**
+	 *
+	 */
+	size_t rows() const;
+
+	/**
+	 *
+	 */
+	size_t size() const;
+
+	/**
+	 *
+	 */
+	void swap(mapped_matrix &m);
+
+	/**
+	 * Gets the view on the whole matrix.
+	 *
+	 * @throw std::runtime_error If the mapping is read-only (non-const
+	 *                           version).
+	 */
+	matrix_view<T> view();
+	const_matrix_view<T> view() const;
+
+	/**
+	 * @throw std::runtime_error If the mapping is read-only (non-const
+	 *                           version).
+	 */
+	T &operator()(size_t i, size_t j);
+	const T &operator()(size_t i, size_t j) const;
+
+private:
+
+	/**
+	 * The mapped file, header included.
+	 */
+	void *_mapping;
+
+	/**
+	 *
+	 */
+	size_t _length;
+
+	/**
+	 *
+	 */
+	T *_values;
+
+	/**
+	 *
+	 */
+	size_t _rows;
+
+	/**
+	 *
+	 */
+	size_t _columns;
+
+	/**
+	 *
+	 */
+	bool _writable;
+
+	/**
+	 * Maps the file opened as fd (which is closed), its size must be
+	 * “_length”.
+	 */
+	void map(int fd, const std::string &path);
+
+	/**
+	 * @throw std::runtime_error If the mapping is read-only.
+	 */
+	void check_writable() const;
+
+	/**
+	 * Applies “madvise()” to the pages spanned by the block.
+	 */
+	void advise(size_t i, size_t j, size_t rows, size_t columns,
+	            int advice) const;
+
+	/**
+	 * Non-copyable.
+	 */
+	mapped_matrix(const mapped_matrix &);
+	mapped_matrix &operator=(const mapped_matrix &);
+};
+
+JFCPP_NAMESPACE_END
+
+#include "mapped_matrix/implementation.hpp"
+
+#endif // H_JFCPP_MAPPED_MATRIX
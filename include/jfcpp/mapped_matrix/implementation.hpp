@@ -0,0 +1,403 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <contracts.h>
+
+#include "../binary.hpp"
+#include "../common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace mapped_matrix_details
+{
+	/**
+	 * Throws the error described by errno.
+	 */
+	inline
+	void
+	fail(const std::string &path, const char *what)
+	{
+		throw std::runtime_error(path + ": " + what + ": "
+		                         + std::strerror(errno));
+	}
+
+	/**
+	 * Closes fd without changing errno.
+	 */
+	inline
+	void
+	close(int fd)
+	{
+		const int error = errno;
+
+		::close(fd);
+
+		errno = error;
+	}
+}
+
+template <typename T, class Layout>
+mapped_matrix<T, Layout>::mapped_matrix(const std::string &path, size_t rows,
+                                        size_t columns)
+	: _mapping(NULL), _length(0), _values(NULL), _rows(rows),
+	  _columns(columns), _writable(true)
+{
+	// The header and the padding must fit as well.
+	if ((columns != 0)
+	    && (rows > (std::numeric_limits<size_t>::max()
+	                - sizeof(binary::details::header)
+	                - binary::details::alignment) / sizeof(T) / columns))
+	{
+		throw std::runtime_error(path + ": too large");
+	}
+
+	this->_length = binary::record_size<T>(rows * columns);
+
+	const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+	if (fd == -1)
+	{
+		mapped_matrix_details::fail(path, "cannot create");
+	}
+
+	// The file is sparse: no blocks are written.
+	if (::ftruncate(fd, static_cast<off_t>(this->_length)) != 0)
+	{
+		mapped_matrix_details::close(fd);
+		mapped_matrix_details::fail(path, "cannot resize");
+	}
+
+	this->map(fd, path);
+
+	*static_cast<binary::details::header *>(this->_mapping) =
+		binary::details::make_header(binary::details::type_tag<T>::value,
+		                             Layout::order, rows, columns);
+}
+
+template <typename T, class Layout>
+mapped_matrix<T, Layout>::mapped_matrix(const std::string &path,
+                                        mapping::mode mode)
+	: _mapping(NULL), _length(0), _values(NULL), _rows(0), _columns(0),
+	  _writable(mode == mapping::read_write)
+{
+	const int fd = ::open(path.c_str(), this->_writable ? O_RDWR : O_RDONLY);
+	if (fd == -1)
+	{
+		mapped_matrix_details::fail(path, "cannot open");
+	}
+
+	struct stat status;
+	if (::fstat(fd, &status) != 0)
+	{
+		mapped_matrix_details::close(fd);
+		mapped_matrix_details::fail(path, "cannot stat");
+	}
+
+	if (static_cast<size_t>(status.st_size)
+	    < sizeof(binary::details::header))
+	{
+		::close(fd);
+		throw std::runtime_error(path + ": not a matrix");
+	}
+
+	this->_length = status.st_size;
+
+	this->map(fd, path);
+
+	try
+	{
+		const binary::details::header &h =
+			*static_cast<const binary::details::header *>(this->_mapping);
+
+		binary::details::check_header(h, path,
+		                              binary::details::type_tag<T>::value);
+		if (h.layout != Layout::order)
+		{
+			throw std::runtime_error(path + ": wrong layout");
+		}
+
+		this->_rows = h.rows;
+		this->_columns = h.columns;
+
+		// The record may be followed by its padding.
+		if (this->_length < (sizeof(h) + this->size() * sizeof(T)))
+		{
+			throw std::runtime_error(path + ": wrong size");
+		}
+	}
+	catch (...)
+	{
+		::munmap(this->_mapping, this->_length);
+
+		throw;
+	}
+}
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+template <typename T, class Layout>
+mapped_matrix<T, Layout>::mapped_matrix(mapped_matrix &&m)
+	: _mapping(m._mapping), _length(m._length), _values(m._values),
+	  _rows(m._rows), _columns(m._columns), _writable(m._writable)
+{
+	m._mapping = NULL;
+	m._values = NULL;
+	m._length = m._rows = m._columns = 0;
+}
+#endif
+
+template <typename T, class Layout>
+mapped_matrix<T, Layout>::~mapped_matrix()
+{
+	if (this->_mapping != NULL)
+	{
+		::munmap(this->_mapping, this->_length);
+	}
+}
+
+template <typename T, class Layout>
+matrix_view<T>
+mapped_matrix<T, Layout>::block(size_t i, size_t j, size_t rows,
+                                size_t columns)
+{
+	return this->view().block(i, j, rows, columns);
+}
+
+template <typename T, class Layout>
+const_matrix_view<T>
+mapped_matrix<T, Layout>::block(size_t i, size_t j, size_t rows,
+                                size_t columns) const
+{
+	return this->view().block(i, j, rows, columns);
+}
+
+template <typename T, class Layout>
+size_t
+mapped_matrix<T, Layout>::columns() const
+{
+	return this->_columns;
+}
+
+template <typename T, class Layout>
+const_matrix_view<T>
+mapped_matrix<T, Layout>::const_block(size_t i, size_t j, size_t rows,
+                                      size_t columns) const
+{
+	return this->const_view().block(i, j, rows, columns);
+}
+
+template <typename T, class Layout>
+const_matrix_view<T>
+mapped_matrix<T, Layout>::const_view() const
+{
+	return const_matrix_view<T>(this->_values, this->_rows, this->_columns,
+	                            Layout::row_stride(this->_rows,
+	                                               this->_columns),
+	                            Layout::column_stride(this->_rows,
+	                                                  this->_columns));
+}
+
+template <typename T, class Layout>
+T *
+mapped_matrix<T, Layout>::data()
+{
+	this->check_writable();
+
+	return this->_values;
+}
+
+template <typename T, class Layout>
+const T *
+mapped_matrix<T, Layout>::data() const
+{
+	return this->_values;
+}
+
+template <typename T, class Layout>
+void
+mapped_matrix<T, Layout>::flush()
+{
+	if (!this->_writable)
+	{
+		return;
+	}
+
+	if (::msync(this->_mapping, this->_length, MS_SYNC) != 0)
+	{
+		mapped_matrix_details::fail("mapped matrix", "cannot flush");
+	}
+}
+
+template <typename T, class Layout>
+bool
+mapped_matrix<T, Layout>::is_writable() const
+{
+	return this->_writable;
+}
+
+template <typename T, class Layout>
+void
+mapped_matrix<T, Layout>::prefetch(size_t i, size_t j, size_t rows,
+                                   size_t columns) const
+{
+	this->advise(i, j, rows, columns, MADV_WILLNEED);
+}
+
+template <typename T, class Layout>
+void
+mapped_matrix<T, Layout>::release(size_t i, size_t j, size_t rows,
+                                  size_t columns) const
+{
+	this->advise(i, j, rows, columns, MADV_DONTNEED);
+}
+
+template <typename T, class Layout>
+size_t
+mapped_matrix<T, Layout>::rows() const
+{
+	return this->_rows;
+}
+
+template <typename T, class Layout>
+size_t
+mapped_matrix<T, Layout>::size() const
+{
+	return (this->_rows * this->_columns);
+}
+
+template <typename T, class Layout>
+void
+mapped_matrix<T, Layout>::swap(mapped_matrix &m)
+{
+	std::swap(this->_mapping, m._mapping);
+	std::swap(this->_length, m._length);
+	std::swap(this->_values, m._values);
+	std::swap(this->_rows, m._rows);
+	std::swap(this->_columns, m._columns);
+	std::swap(this->_writable, m._writable);
+}
+
+template <typename T, class Layout>
+matrix_view<T>
+mapped_matrix<T, Layout>::view()
+{
+	this->check_writable();
+
+	return matrix_view<T>(this->_values, this->_rows, this->_columns,
+	                      Layout::row_stride(this->_rows, this->_columns),
+	                      Layout::column_stride(this->_rows, this->_columns));
+}
+
+template <typename T, class Layout>
+const_matrix_view<T>
+mapped_matrix<T, Layout>::view() const
+{
+	return this->const_view();
+}
+
+template <typename T, class Layout>
+T &
+mapped_matrix<T, Layout>::operator()(size_t i, size_t j)
+{
+	this->check_writable();
+	requires(i < this->_rows);
+	requires(j < this->_columns);
+
+	return this->_values[Layout::index(i, j, this->_rows, this->_columns)];
+}
+
+template <typename T, class Layout>
+const T &
+mapped_matrix<T, Layout>::operator()(size_t i, size_t j) const
+{
+	requires(i < this->_rows);
+	requires(j < this->_columns);
+
+	return this->_values[Layout::index(i, j, this->_rows, this->_columns)];
+}
+
+template <typename T, class Layout>
+void
+mapped_matrix<T, Layout>::map(int fd, const std::string &path)
+{
+	void *const mapping =
+		::mmap(NULL, this->_length,
+		       PROT_READ | (this->_writable ? PROT_WRITE : 0), MAP_SHARED,
+		       fd, 0);
+
+	// The mapping stays valid after closing the file.
+	mapped_matrix_details::close(fd);
+
+	if (mapping == MAP_FAILED)
+	{
+		mapped_matrix_details::fail(path, "cannot map");
+	}
+
+	this->_mapping = mapping;
+	this->_values = reinterpret_cast<T *>(
+		static_cast<char *>(mapping) + sizeof(binary::details::header));
+}
+
+template <typename T, class Layout>
+void
+mapped_matrix<T, Layout>::check_writable() const
+{
+	if (!this->_writable)
+	{
+		throw std::runtime_error("mapped matrix: read-only mapping");
+	}
+}
+
+template <typename T, class Layout>
+void
+mapped_matrix<T, Layout>::advise(size_t i, size_t j, size_t rows,
+                                 size_t columns, int advice) const
+{
+	requires(i + rows <= this->_rows);
+	requires(j + columns <= this->_columns);
+
+	if ((rows == 0) || (columns == 0))
+	{
+		return;
+	}
+
+	const size_t
+		page = ::sysconf(_SC_PAGESIZE),
+		first = sizeof(binary::details::header) + sizeof(T)
+		        * Layout::index(i, j, this->_rows, this->_columns),
+		last = sizeof(binary::details::header) + sizeof(T)
+		       * (Layout::index(i + rows - 1, j + columns - 1, this->_rows,
+		                        this->_columns) + 1),
+		begin = first - first % page;
+
+	// This is only a hint, the errors are ignored.
+	::madvise(static_cast<char *>(this->_mapping) + begin, last - begin,
+	          advice);
+}
+
+JFCPP_NAMESPACE_END
@@ -94,6 +94,13 @@ template <typename T>
 T
 lcm(const T &a, const T &b);
 
+/**
+ * Computes the residue of x modulo n, in [0, n) even if x is negative.
+ */
+template <typename T>
+unsigned long
+mod(const T &x, unsigned long n);
+
 /**
  *
  */
@@ -6,6 +6,7 @@
 JFCPP_MATH_NAMESPACE_BEGIN
 
 template <>
+inline
 bool
 is_even<mpz_class>(const mpz_class &x)
 {
@@ -13,6 +14,7 @@ is_even<mpz_class>(const mpz_class &x)
 }
 
 template <>
+inline
 bool
 is_odd<mpz_class>(const mpz_class &x)
 {
@@ -20,6 +22,7 @@ is_odd<mpz_class>(const mpz_class &x)
 }
 
 template <>
+inline
 mpz_class
 exp_mod<mpz_class>(const mpz_class &x, const mpz_class &k, const mpz_class &n)
 {
@@ -31,6 +34,7 @@ exp_mod<mpz_class>(const mpz_class &x, const mpz_class &k, const mpz_class &n)
 }
 
 template <>
+inline
 mpz_class
 gcd<mpz_class>(const mpz_class &a, const mpz_class &b)
 {
@@ -42,6 +46,7 @@ gcd<mpz_class>(const mpz_class &a, const mpz_class &b)
 }
 
 template <>
+inline
 mpz_class
 inverse_mod<mpz_class>(const mpz_class &x, const mpz_class &n)
 {
@@ -53,6 +58,15 @@ inverse_mod<mpz_class>(const mpz_class &x, const mpz_class &n)
 }
 
 template <>
+inline
+unsigned long
+mod<mpz_class>(const mpz_class &x, unsigned long n)
+{
+	return mpz_fdiv_ui(x.get_mpz_t(), n);
+}
+
+template <>
+inline
 mpz_class
 lcm<mpz_class>(const mpz_class &a, const mpz_class &b)
 {
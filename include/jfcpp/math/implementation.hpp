@@ -3,13 +3,40 @@
 
 // Specializations for mpz_class.
 #ifdef __GMP_PLUSPLUS__
-#include "math/gmp.hpp"
+#include "gmp.hpp"
 #endif
 
+#include "../simd.hpp"
 #include "common.hpp"
 
 JFCPP_MATH_NAMESPACE_BEGIN
 
+namespace details
+{
+	template <typename T>
+	T
+	dot(const T *first, const T *last, const T *other)
+	{
+		return std::inner_product(first, last, other, T(0));
+	}
+
+	/**
+	 * “float” and “double” use the SIMD kernels.
+	 */
+	inline
+	float
+	dot(const float *first, const float *last, const float *other)
+	{
+		return simd::kernels<float>::get().dot(last - first, first, other);
+	}
+	inline
+	double
+	dot(const double *first, const double *last, const double *other)
+	{
+		return simd::kernels<double>::get().dot(last - first, first, other);
+	}
+}
+
 template <typename T>
 T
 abs(const T &x)
@@ -143,6 +170,15 @@ lcm(const T &a, const T &b)
 	return (g != zero ? a / g * b : zero);
 }
 
+template <typename T>
+unsigned long
+mod(const T &x, unsigned long n)
+{
+	const T r = x % T(n);
+
+	return static_cast<unsigned long>(r < T(0) ? r + T(n) : r);
+}
+
 template <typename T, size_t S>
 T
 norm_1(const array<T, S> &v)
@@ -206,7 +242,7 @@ sprod(const array<T, S1> &u, const array<T, S2> &v)
 {
 	requires(u.size() == v.size());
 
-	return std::inner_product(u.begin(), u.end(), v.begin(), T(0));
+	return details::dot(u.begin(), u.end(), v.begin());
 }
 
 template <typename T>
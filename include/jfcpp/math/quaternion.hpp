@@ -6,6 +6,7 @@
 #include <ostream>
 
 #include "../array.hpp"
+#include "../fixed_matrix.hpp"
 #include "../math.hpp"
 #include "../matrix.hpp"
 #include "../operators.hpp"
@@ -190,58 +191,81 @@ quaternion_from_rotation(array<T, 3> u, array<T, 3> v)
 	return quaternion_from_rotation(vprod(u, v), angle);
 }
 
+namespace quaternion_details
+{
+	/**
+	 * Shared by the dynamic and the fixed-size 3 × 3 matrices.
+	 */
+	template <typename T, class M>
+	quaternion<T>
+	from_rotation(const M &m)
+	{
+		const T
+			epsilon(1e-8),
+			quarter(.25),
+			one(1),
+			two(2);
+
+		T trace(m.trace() + one);
+
+		if (trace > epsilon)
+		{
+			const T s = sqrt(trace) * two;
+
+			return quaternion<T>(s * quarter,
+			                     (m(2, 1) - m(1, 2)) / s,
+			                     (m(0, 2) - m(2, 0)) / s,
+			                     (m(1, 0) - m(0, 1)) / s);
+		}
+		if ((m(0, 0) > m(1, 1)) && (m(0, 0) > m(2, 2)))
+		{
+			const T s = one + sqrt(m(0, 0) - m(1, 1) - m(2, 2));
+
+			return quaternion<T>((m(1, 2) - m(2, 1)) / s,
+			                     quarter * s,
+			                     (m(1, 0) + m(0, 1)) / s,
+			                     (m(0, 2) + m(2, 0)) / s);
+		}
+		if (m(1, 1) > m(2, 2))
+		{
+			const T s = one + sqrt(m(1, 1) - m(0, 0) - m(2, 2));
+
+			return quaternion<T>((m(0, 2) - m(2, 0)) / s,
+			                     (m(1, 0) + m(0, 1)) / s,
+			                     quarter * s,
+			                     (m(1, 2) + m(2, 1)) / s);
+		}
+
+		const T s = one + sqrt(m(2, 2) - m(0, 0) - m(1, 1));
+
+		return quaternion<T>((m(0, 1) - m(1, 0)) / s,
+		                     (m(0, 2) + m(2, 0)) / s,
+		                     (m(1, 2) + m(2, 1)) / s,
+		                     quarter * s);
+	}
+} // namespace quaternion_details
+
 /**
  * Constructs a quaternion from a rotation matrix.
  */
-template <typename T>
+template <typename T, class Allocator>
 quaternion<T>
-quaternion_from_rotation(const matrix<T> &m)
+quaternion_from_rotation(const matrix<T, Allocator> &m)
 {
 	requires(m.is_square());
 	requires(m.rows() == 3);
 
-	const T
-		epsilon(1e-8),
-		quarter(.25),
-		one(1),
-		two(2);
-
-	T trace(m.trace() + one);
-
-	if (trace > epsilon)
-	{
-		const T s = sqrt(trace) * two;
-
-		return quaternion<T>(s * quarter,
-		                     (m(2, 1) - m(1, 2)) / s,
-		                     (m(0, 2) - m(2, 0)) / s,
-		                     (m(1, 0) - m(0, 1)) / s);
-	}
-	if ((m(0, 0) > m(1, 1)) && (m(0, 0) > m(2, 2)))
-	{
-		const T s = one + sqrt(m(0, 0) - m(1, 1) - m(2, 2));
-
-		return quaternion<T>((m(1, 2) - m(2, 1)) / s,
-		                     quarter * s,
-		                     (m(1, 0) + m(0, 1)) / s,
-		                     (m(0, 2) + m(2, 0)) / s);
-	}
-	if (m(1, 1) > m(2, 2))
-	{
-		const T s = one + sqrt(m(1, 1) - m(0, 0) - m(2, 2));
-
-		return quaternion<T>((m(0, 2) - m(2, 0)) / s,
-		                     (m(1, 0) + m(0, 1)) / s,
-		                     quarter * s,
-		                     (m(1, 2) + m(2, 1)) / s);
-	}
-
-	const T s = one + sqrt(m(2, 2) - m(0, 0) - m(1, 1));
+	return quaternion_details::from_rotation<T>(m);
+}
 
-	return quaternion<T>((m(0, 1) - m(1, 0)) / s,
-	                     (m(0, 2) + m(2, 0)) / s,
-	                     (m(1, 2) + m(2, 1)) / s,
-	                     quarter * s);
+/**
+ * Constructs a quaternion from a fixed-size rotation matrix.
+ */
+template <typename T>
+quaternion<T>
+quaternion_from_rotation(const fixed_matrix<T, 3, 3> &m)
+{
+	return quaternion_details::from_rotation<T>(m);
 }
 
 /**
@@ -25,13 +25,51 @@
 
 #include <contracts.h>
 
+#include "aligned_allocator.hpp"
 #include "common.hpp"
 #include "operators.hpp"
+#include "thread_pool.hpp"
+#include "matrix/expression.hpp"
+#include "matrix/layout.hpp"
+#include "matrix/triangular.hpp"
 
 JFCPP_NAMESPACE_BEGIN
 
+template <typename T = double, class Allocator = aligned_allocator<T>,
+          class Layout = row_major>
+class lu;
+
+template <typename T, class Allocator = aligned_allocator<T> >
+class bareiss;
+
+template <typename T = double, class Allocator = aligned_allocator<T> >
+class symmetric_eigen;
+
+template <typename T = double, class Allocator = aligned_allocator<T>,
+          class Layout = row_major>
+class qr;
+
+template <typename T = double, class Allocator = aligned_allocator<T>,
+          class Layout = row_major>
+class cholesky;
+
+template <typename T = double, class Allocator = aligned_allocator<T> >
+class svd;
+
+template <typename T, size_t R, size_t C>
+class fixed_matrix;
+
+template <typename T>
+class sparse_matrix;
+
+template <typename T>
+class matrix_view;
+
 namespace matrix_details
 {
+	template <typename T>
+	struct elimination;
+
 	template <typename T>
 	class column_iterator;
 
@@ -42,20 +80,67 @@ namespace matrix_details
 /**
  *
  *
+ * The element-wise operators (“+”, “-”, “*”, “/” and “%”) do not compute
+ * anything but return lazy expressions (see “matrix/expression.hpp”) which
+ * are evaluated in a single pass when assigned to a matrix, e.g. “a = b + c *
+ * 2” does not create any temporary matrix.
+ *
+ * An expression holds references to its operands, it must therefore be used
+ * before the end of the statement which created it.
+ *
+ * In C++11, matrices are movable and an operation whose left operand is a
+ * temporary matrix (e.g. “a.mprod(b) + c”) is directly computed in its
+ * storage and returns a matrix.
+ *
+ * The values are stored in a single block obtained from the allocator (by
+ * default aligned on 64 bytes), row by row or column by column depending on
+ * the layout (see “matrix/layout.hpp”): the element (i, j) is at the
+ * position “Layout::index(i, j, rows(), columns())”.
+ *
+ * Every operation gives the same result whatever the layout, which only
+ * changes the speed: “op_row()” and “swap_rows()” walk a contiguous range of
+ * a row-major matrix, “op_column()”, “swap_columns()” and the column
+ * iterators the one of a column-major matrix.  The element-wise operations
+ * are done in a single pass over the storage when the operands have the
+ * same layout as the destination.  Copying a matrix into another layout
+ * (“matrix<T, A, column_major> b(a)”) transposes its storage with the
+ * cache-oblivious algorithm of “matrix/transpose.hpp”.
+ *
+ * “lu”, “cholesky” and “qr” take the layout as a third template parameter
+ * and work on the storage of the matrix through its strides: “det()”,
+ * “log_det()”, “inverse()” and “solve()” of a floating point column-major
+ * matrix are done in place.  The fraction-free elimination (“bareiss”, for
+ * exact types), “svd”, “symmetric_eigen” and “sparse_matrix::mprod()” work
+ * on row-major matrices and convert the other ones.
+ *
  * General requirements:
  * - T must have a default constructor;
  * - the method “T &T::operator=(const T &)” must be defined.
+ *
+ * @template T         The type of contained elements.
+ * @template Allocator A standard allocator of T (only “allocate()” and
+ *                     “deallocate()” are used), e.g. to use an arena or
+ *                     huge pages.
+ * @template Layout    The storage order: “row_major” or “column_major”.
  */
-template <typename T = double>
-class matrix : public operators::addable<matrix<T> >,
-               public operators::dividable<matrix<T> >,
-               public operators::equality_comparable<matrix<T> >,
-               public operators::modable<matrix<T> >,
-               public operators::multipliable<matrix<T> >,
-               public operators::subtractable<matrix<T> >
+template <typename T = double, class Allocator = aligned_allocator<T>,
+          class Layout = row_major>
+class matrix
+	: public matrix_details::expression<matrix<T, Allocator, Layout> >,
+	  public operators::equality_comparable<matrix<T, Allocator, Layout> >
 {
 public:
 
+	/**
+	 *
+	 */
+	typedef Allocator allocator_type;
+
+	/**
+	 *
+	 */
+	typedef Layout layout_type;
+
 	/**
 	 *
 	 */
@@ -114,7 +199,8 @@ public:
 	 * @param one  The value which will be used to fill the matrix's diagonal.
 	 */
 	static matrix identity(size_t dim, const_reference zero = T(0),
-	                       const_reference one = T(1));
+	                       const_reference one = T(1),
+	                       const Allocator &allocator = Allocator());
 
 	/**
 	 * Constructs a square matrix with a given dimension.
@@ -130,20 +216,24 @@ public:
 	 *
 	 * The values inside it are constructed using T's default constructor.
 	 *
-	 * @param rows    The number of rows.
-	 * @param columns The number of columns.
+	 * @param rows      The number of rows.
+	 * @param columns   The number of columns.
+	 * @param allocator The allocator to use.
 	 */
-	matrix(size_t rows, size_t columns);
+	matrix(size_t rows, size_t columns,
+	       const Allocator &allocator = Allocator());
 
 	/**
 	 * Constructs a matrix with given dimensions and initializes each cell with
 	 * a given value.
 	 *
-	 * @param rows    The number of rows.
-	 * @param columns The number of columns.
-	 * @param value   The initial value.
+	 * @param rows      The number of rows.
+	 * @param columns   The number of columns.
+	 * @param value     The initial value.
+	 * @param allocator The allocator to use.
 	 */
-	matrix(size_t rows, size_t columns, const_reference value);
+	matrix(size_t rows, size_t columns, const_reference value,
+	       const Allocator &allocator = Allocator());
 
 	/**
 	 * Constructs a matrix from another.
@@ -155,12 +245,51 @@ public:
 	matrix(const matrix &m);
 
 	/**
-	 * Constructs a matrix from another.
+	 * Constructs a matrix from a fixed-size one (see “fixed_matrix.hpp”).
 	 *
 	 * @param m The matrix.
 	 */
-	template <typename T2>
-	matrix(const matrix<T2> &m);
+	template <size_t R, size_t C>
+	explicit matrix(const fixed_matrix<T, R, C> &m);
+
+	/**
+	 * Constructs a dense matrix from a sparse one (see “sparse_matrix.hpp”).
+	 *
+	 * @param m The matrix.
+	 */
+	explicit matrix(const sparse_matrix<T> &m);
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+	/**
+	 * Takes the values of another matrix, which is left empty.
+	 *
+	 * Calculus complexity: O(1)
+	 *
+	 * @param m The matrix.
+	 */
+	matrix(matrix &&m);
+#endif
+
+	/**
+	 * Constructs a matrix from another, whose type and layout may differ.
+	 *
+	 * The allocator of m is copied if it has the same type.
+	 *
+	 * @param m The matrix.
+	 */
+	template <typename T2, class A2, class L2>
+	matrix(const matrix<T2, A2, L2> &m);
+
+	/**
+	 * Constructs a matrix by evaluating an expression.
+	 *
+	 * The allocator of the leftmost matrix of e is copied if it has the
+	 * same type.
+	 *
+	 * @param e The expression.
+	 */
+	template <class E>
+	matrix(const matrix_details::expression<E> &e);
 
 	/**
 	 *
@@ -186,17 +315,26 @@ public:
 	/**
 	 * Gets an iterator referring to the first element in this matrix.
 	 *
-	 * This iterator iterates line by line.
+	 * This iterator iterates in the storage order (line by line for the
+	 * default layout).
 	 *
 	 * @return A random access iterator positioned on the first element.
 	 */
 	iterator begin();
 	const_iterator begin() const;
 
+	/**
+	 * Gets a view on the rows × columns block whose first element is (i, j)
+	 * (see “matrix/view.hpp”), nothing is copied.
+	 */
+	matrix_view<T> block(size_t i, size_t j, size_t rows, size_t columns);
+	const_matrix_view<T> block(size_t i, size_t j, size_t rows,
+	                           size_t columns) const;
+
 	/**
 	 * Gets a column iterator referring to the first element in this matrix.
 	 *
-	 * This iterator iterates line by line.
+	 * This iterator iterates column by column.
 	 *
 	 * @return A forward iterator positioned on the first element.
 	 */
@@ -229,25 +367,50 @@ public:
 	/**
 	 * Computes the deteminant of this matrix.
 	 *
+	 * Up to the dimension 3, the expanded formula is used, otherwise the
+	 * determinant is computed from a LU decomposition (see the class “lu”)
+	 * for floating point types and with the fraction-free elimination (see
+	 * the class “bareiss”) for the others, which is exact.
+	 *
+	 * The determinant of an empty matrix is 1.
+	 *
+	 * Calculus complexity: O(n³).
+	 *
 	 * Requirements:
 	 * - This matrix must be square.
-	 * - This matrix must not be empty (size = 0).
-	 *
-	 * /!\ : Currently only works when the dimension is less than 4.
+	 * - Same as “lu” or “bareiss” when the dimension is greater than 3.
 	 */
 	T det() const;
 
+	/**
+	 * Computes the logarithm of the absolute value of the determinant of this
+	 * matrix, which does not overflow even when the determinant does.
+	 *
+	 * Requirements:
+	 * - This matrix must be square.
+	 * - T must be a floating point type.
+	 *
+	 * @param sign Receives the sign of the determinant: -1, 0 or 1.
+	 *
+	 * @return The logarithm (-∞ if the determinant is null).
+	 */
+	T log_det(int &sign) const;
 
 	/**
 	 * Gets an iterator referring to the past-the-end element in this matrix.
 	 *
-	 * This iterator iterates line by line.
+	 * This iterator iterates in the storage order.
 	 *
 	 * @return A random access iterator positioned on the past-the-end element.
 	 */
 	iterator end();
 	const_iterator end() const;
 
+	/**
+	 * Gets a copy of the allocator used by this matrix.
+	 */
+	allocator_type get_allocator() const;
+
 	/**
 	 * Tests whether this matrix and “m” have same dimensions (i.e. number of
 	 * rows and columns).
@@ -256,8 +419,8 @@ public:
 	 *
 	 * @return Whether they have same dimensions.
 	 */
-	template <typename T2>
-	bool has_same_dimensions(const matrix<T2> &m) const;
+	template <typename T2, class A2, class L2>
+	bool has_same_dimensions(const matrix<T2, A2, L2> &m) const;
 
 	/**
 	 * Computes the inverse of this matrix.
@@ -274,11 +437,16 @@ public:
 	 */
 	matrix inverse() const;
 
+	/**
+	 * Same as “inverse() const” but the work is split by the given executor.
+	 */
+	matrix inverse(executor &e) const;
+
 	/**
 	 * Computes the inverse of this matrix.
 	 *
 	 * Contrary to the method “inverse() const”, this method does not create a
-	 * copy of this matrix.
+	 * copy of this matrix, which is left empty.
 	 *
 	 * Requirement:
 	 * - This matrix must be square.
@@ -289,6 +457,11 @@ public:
 	 */
 	matrix inverse_perf();
 
+	/**
+	 * Same as “inverse_perf()” but the work is split by the given executor.
+	 */
+	matrix inverse_perf(executor &e);
+
 	/**
 	 * Tests whether this matrix is square (i.e. has the same number of rows
 	 * than columns).
@@ -297,6 +470,11 @@ public:
 	 */
 	bool is_square() const;
 
+	/**
+	 * Tests whether this matrix is square and equal to its transpose.
+	 */
+	bool is_symmetric() const;
+
 	/**
 	 *
 	 */
@@ -320,12 +498,48 @@ public:
 	/**
 	 * Matrix product.
 	 *
+	 * When T and T2 are the same arithmetic type, a packed and cache-blocked
+	 * algorithm is used (see “matrix/gemm.hpp”), otherwise this is the
+	 * classical triple loop.
+	 *
+	 * The result uses the allocator of this matrix.
+	 *
+	 * Calculus complexity: O(rows × columns × m.columns()).
+	 *
 	 * Requirements:
 	 * - the method “T &T::operator+=(const T &)” must be defined;
 	 * - the function “T operator*(const T &, const T &)” must be defined.
 	 */
-	template <typename T2>
-	matrix mprod(const matrix<T2> &m) const;
+	template <typename T2, class A2, class L2>
+	matrix mprod(const matrix<T2, A2, L2> &m) const;
+
+	/**
+	 * Parallel matrix product.
+	 *
+	 * The result is split in tiles which are computed by the given executor
+	 * (e.g. a “thread_pool”).
+	 *
+	 * Requirements:
+	 * - same as “mprod(const matrix<T2, A2, L2> &)”;
+	 * - the operations on T must be thread-safe.
+	 */
+	template <typename T2, class A2, class L2>
+	matrix mprod(const matrix<T2, A2, L2> &m, executor &e) const;
+
+	/**
+	 * Parallel matrix product using a given number of threads.
+	 *
+	 * A product too small to be split, or with 1 thread, is sequential and
+	 * does not touch any pool.  Otherwise, with 0 threads (or as many as
+	 * “thread_pool::instance()”), the shared pool is used, else a pool is
+	 * created and destroyed by each call: this is meant for large one-off
+	 * products, pass a “thread_pool” to “mprod(m, e)” to run many of them.
+	 *
+	 * @param threads The number of threads (0 means the number of available
+	 *                processors).
+	 */
+	template <typename T2, class A2, class L2>
+	matrix mprod(const matrix<T2, A2, L2> &m, size_t threads) const;
 
 	/**
 	 * Applies an operation to the column i and store it in the column j.
@@ -418,6 +632,16 @@ public:
 	 * To prevent this matrix from being modified, a copy is created, if you
 	 * want to avoid this, use the method “solve_perf(matrix)”.
 	 *
+	 * Floating point types use a Cholesky decomposition when this matrix is
+	 * symmetric positive-definite and a LU decomposition otherwise,
+	 * rationals and integer types the fraction-free elimination (for
+	 * integer types, X is exact only if its values are integers, see the
+	 * class “bareiss” otherwise).
+	 *
+	 * To solve several systems with the same matrix, use directly the class
+	 * “lu” which computes the decomposition only once.  For rectangular
+	 * systems (least squares), see the class “qr”.
+	 *
 	 * @throw std::runtime_error If there is no solutions.
 	 *
 	 * @param B
@@ -426,12 +650,18 @@ public:
 	 */
 	void solve(matrix &B) const;
 
+	/**
+	 * Same as “solve(matrix &) const” but the work is split by the given
+	 * executor.
+	 */
+	void solve(matrix &B, executor &e) const;
+
 	/**
 	 * Solves the following equations where A is this matrix and X the solution:
 	 * A * X = B.
 	 *
 	 * Contrary to the method “solve(matrix) const”, this method does not create a
-	 * copy of this matrix.
+	 * copy of this matrix, which is left empty.
 	 *
 	 * @throw std::runtime_error If there is no solutions.
 	 *
@@ -441,6 +671,12 @@ public:
 	 */
 	void solve_perf(matrix &B);
 
+	/**
+	 * Same as “solve_perf(matrix &)” but the work is split by the given
+	 * executor.
+	 */
+	void solve_perf(matrix &B, executor &e);
+
 	/**
 	 * Swaps the content between this matrix and another.
 	 *
@@ -493,15 +729,77 @@ public:
 	/**
 	 * Computes the transpose of this matrix.
 	 *
+	 * It uses a cache-oblivious algorithm with SIMD kernels for “float” and
+	 * “double”.
+	 *
 	 * @return The transpose.
 	 */
 	matrix transpose() const;
 
 	/**
+	 * Gets the transpose of this matrix as a lazy expression.
 	 *
+	 * It can be assigned to this matrix (e.g. “a = a.transposed() + a”), a
+	 * temporary is then used (see “transpose_in_place()” to avoid it).
+	 *
+	 * Assigning it directly (e.g. “b = a.transposed()”) is as fast as
+	 * “transpose()”.
+	 *
+	 * @return The transpose, which refers to this matrix.
 	 */
-	template <typename T2>
-	bool operator==(const matrix<T2> &m) const;
+	matrix_details::transposition<matrix> transposed() const;
+
+	/**
+	 * Transposes this matrix without allocating another one.
+	 *
+	 * A square matrix is transposed by exchanging blocks, recursively (cache
+	 * oblivious), a rectangular one by following the cycles of the
+	 * permutation, which only needs one bit by element.
+	 *
+	 * Calculus complexity: O(size).
+	 */
+	void transpose_in_place();
+
+	/**
+	 * Same as “matrix_view::trmm()” on this whole matrix.
+	 */
+	void trmm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a);
+	void trmm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a, executor &e);
+
+	/**
+	 * Same as “matrix_view::trsm()” on this whole matrix: solves “A × X =
+	 * alpha × this” or “X × A = alpha × this” where A is triangular, this
+	 * matrix is replaced by X.
+	 */
+	void trsm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a);
+	void trsm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a, executor &e);
+
+	/**
+	 * Gets a view on this whole matrix.
+	 */
+	matrix_view<T> view();
+	const_matrix_view<T> view() const;
+
+	/**
+	 *
+	 */
+	template <typename T2, class A2, class L2>
+	bool operator==(const matrix<T2, A2, L2> &m) const;
+
+	/**
+	 * Compares this matrix with the result of an expression, without
+	 * evaluating it in a temporary matrix.
+	 */
+	template <class E>
+	bool operator==(const matrix_details::expression<E> &e) const;
 
 	/**
 	 *
@@ -515,8 +813,27 @@ public:
 	/**
 	 *
 	 */
-	template <typename T2>
-	matrix &operator=(const matrix<T2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator=(const matrix<T2, A2, L2> &m);
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+	/**
+	 * Takes the values of another matrix, which is left empty.
+	 *
+	 * Calculus complexity: O(1)
+	 */
+	matrix &operator=(matrix &&m);
+#endif
+
+	/**
+	 * Evaluates an expression in this matrix.
+	 *
+	 * If the expression reads the values of this matrix at other positions
+	 * than the ones being written (e.g. “a = a.transposed()”), it is evaluated
+	 * in a temporary matrix first.
+	 */
+	template <class E>
+	matrix &operator=(const matrix_details::expression<E> &e);
 
 	/**
 	 * Element-with unary operations.
@@ -533,65 +850,104 @@ public:
 	/**
 	 * Element-wise arithmetics operations.
 	 */
-	template <typename T2>
-	matrix &operator+=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator-=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator*=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator/=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator%=(const matrix<T2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator+=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator-=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator*=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator/=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator%=(const matrix<T2, A2, L2> &m);
 
 	/**
 	 * Element-wise bitwise operations.
 	 */
-	template <typename T2>
-	matrix &operator&=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator|=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator<<=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator>>=(const matrix<T2> &m);
-	template <typename T2>
-	matrix &operator^=(const matrix<T2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator&=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator|=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator<<=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator>>=(const matrix<T2, A2, L2> &m);
+	template <typename T2, class A2, class L2>
+	matrix &operator^=(const matrix<T2, A2, L2> &m);
+
+	/**
+	 * Element-wise operations with an expression (evaluated in a temporary
+	 * matrix first if needed, see “operator=(const expression<E> &)”).
+	 */
+	template <class E>
+	matrix &operator+=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator-=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator*=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator/=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator%=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator&=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator|=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator<<=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator>>=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix &operator^=(const matrix_details::expression<E> &e);
 
 	/**
 	 * Fills the matrix with a scalar value.
 	 */
 	template <typename T2>
-	matrix &operator=(const T2 &s);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator=(const T2 &s);
 
 	/**
 	 * Scalar arithmetics operations.
 	 */
 	template <typename T2>
-	matrix &operator+=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator+=(const T2 &value);
 	template <typename T2>
-	matrix &operator-=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator-=(const T2 &value);
 	template <typename T2>
-	matrix &operator*=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator*=(const T2 &value);
 	template <typename T2>
-	matrix &operator/=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator/=(const T2 &value);
 	template <typename T2>
-	matrix &operator%=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator%=(const T2 &value);
 
 	/**
 	 * Scalar bitwise operations.
 	 */
 	template <typename T2>
-	matrix &operator&=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator&=(const T2 &value);
 	template <typename T2>
-	matrix &operator|=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator|=(const T2 &value);
 	template <typename T2>
-	matrix &operator<<=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator<<=(const T2 &value);
 	template <typename T2>
-	matrix &operator>>=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator>>=(const T2 &value);
 	template <typename T2>
-	matrix &operator^=(const T2 &value);
+	typename matrix_details::if_scalar<T2, matrix &>::type
+	operator^=(const T2 &value);
 
+	/**
+	 * Gets the i-th value in the storage order.
+	 */
 	reference operator()(size_t i);
 	const_reference operator()(size_t i) const;
 
@@ -621,27 +977,6 @@ public:
 
 private:
 
-	/**
-	 * Used in “solve_perf(matrix B)”.
-	 */
-	class my_op : std::binary_function<const T &, const T &, T>
-	{
-	public:
-
-		my_op(const T &coeff) : _coeff(coeff)
-		{}
-
-		T operator()(const T &a, const T &b)
-		{
-			return (a - this->_coeff * b);
-		}
-
-	private:
-
-		T _coeff;
-	};
-
-
 	/**
 	 *
 	 */
@@ -665,10 +1000,10 @@ private:
 	/**
 	 *
 	 */
-	T **_values_by_rows;
+	Allocator _allocator;
 
 	/**
-	 *
+	 * Allocates and default-constructs the values.
 	 */
 	void allocate();
 
@@ -686,8 +1021,8 @@ private:
 	 *
 	 * @param The matrix (must have the same dimension than this matrix).
 	 */
-	template <typename T2>
-	void copy_values(const matrix<T2> &m);
+	template <typename T2, class A2, class L2>
+	void copy_values(const matrix<T2, A2, L2> &m);
 
 	/**
 	 *
@@ -703,8 +1038,8 @@ private:
 	 *
 	 * @return True if they are, otherwise false.
 	 */
-	template <typename T2>
-	bool has_same_values(const matrix<T2> &m) const;
+	template <typename T2, class A2, class L2>
+	bool has_same_values(const matrix<T2, A2, L2> &m) const;
 
 	/**
 	 * Returns whether the current matrix is in a coherent state.
@@ -719,9 +1054,16 @@ JFCPP_NAMESPACE_END
 /**
  *
  */
-template <typename T>
+template <typename T, class Allocator, class Layout>
+std::ostream &
+operator<<(std::ostream &os, const JFCPP_NS()matrix<T, Allocator, Layout> &m);
+
+/**
+ * Evaluates the expression and prints the result.
+ */
+template <class E>
 std::ostream &
-operator<<(std::ostream &os, const JFCPP_NS()matrix<T> &m);
+operator<<(std::ostream &os, const JFCPP_NS()matrix_details::expression<E> &e);
 
 #include "matrix/column_iterator.hpp"
 
@@ -729,4 +1071,20 @@ operator<<(std::ostream &os, const JFCPP_NS()matrix<T> &m);
 
 #include "matrix/implementation.hpp"
 
+#include "matrix/lu.hpp"
+
+#include "matrix/cholesky.hpp"
+
+#include "matrix/bareiss.hpp"
+
+#include "matrix/elimination.hpp"
+
+#include "matrix/view.hpp"
+
+#include "matrix/symmetric_eigen.hpp"
+
+#include "matrix/qr.hpp"
+
+#include "matrix/svd.hpp"
+
 #endif
@@ -0,0 +1,154 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_BAREISS
+#define H_JFCPP_MATRIX_BAREISS
+
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Fraction-free Gaussian elimination (Bareiss) of a square matrix.
+ *
+ * Every division done during the elimination is exact, so integer types
+ * (“int”, “mpz_class”, …) can be used and the size of the intermediate
+ * values stays bounded by the size of the minors of the matrix (instead of
+ * exploding as with the usual elimination over rationals).
+ *
+ * The determinant is exact, and a system A × X = B with integer values is
+ * solved as det(A) × X, which has integer values too (Cramer's rule).
+ *
+ * Requirements:
+ * - the ones of “matrix<T>”;
+ * - T must be an integral domain: constructible from 0 and 1, comparable
+ *   with “==” and with “operator-”, “operator*” and an exact “operator/”.
+ */
+template <typename T, class Allocator>
+class bareiss
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef matrix<T, Allocator> matrix_type;
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Constructs an empty elimination, see “factorize()”.
+	 */
+	bareiss();
+
+	/**
+	 * Eliminates a matrix.
+	 *
+	 * @param a The matrix (must be square).
+	 */
+	explicit bareiss(const matrix_type &a);
+
+	/**
+	 * Eliminates a matrix, replacing the current one.
+	 *
+	 * @param a The matrix (must be square).
+	 */
+	void factorize(const matrix_type &a);
+
+	/**
+	 * Eliminates a matrix.
+	 *
+	 * Contrary to the method “factorize(const matrix_type &)”, “a” is not
+	 * copied: its storage is taken and it is left empty.
+	 *
+	 * @param a The matrix (must be square).
+	 */
+	void factorize_perf(matrix_type &a);
+
+	/**
+	 * Gets the determinant of the eliminated matrix.
+	 *
+	 * Calculus complexity: O(1).
+	 */
+	T det() const;
+
+	/**
+	 * Gets the dimension of the eliminated matrix.
+	 */
+	size_t dimension() const;
+
+	/**
+	 * Tests whether the eliminated matrix is singular (i.e. its determinant
+	 * is null).
+	 */
+	bool is_singular() const;
+
+	/**
+	 * Solves A × X = B, B is replaced by det(A) × X.
+	 *
+	 * Calculus complexity: O(n² × B.columns()).
+	 *
+	 * @param B A matrix with as many rows as A.
+	 *
+	 * @throw std::runtime_error If the matrix is singular.
+	 */
+	template <class A2>
+	void solve(matrix<T, A2> &B) const;
+
+private:
+
+	/**
+	 * The upper triangle (diagonal included) contains the eliminated matrix,
+	 * the strict lower one the values which have been eliminated (needed to
+	 * replay the elimination on a right-hand side).
+	 */
+	matrix_type _a;
+
+	/**
+	 * Same as “lu::pivots()”.
+	 */
+	std::vector<size_t> _pivots;
+
+	/**
+	 * Whether the permutation is odd.
+	 */
+	bool _odd;
+
+	/**
+	 *
+	 */
+	bool _singular;
+
+	/**
+	 * Eliminates “_a” in place.
+	 */
+	void eliminate();
+};
+
+JFCPP_NAMESPACE_END
+
+#include "bareiss/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_BAREISS
@@ -0,0 +1,220 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <stdexcept>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+template <typename T, class Allocator>
+bareiss<T, Allocator>::bareiss()
+	: _a(0), _odd(false), _singular(false)
+{}
+
+template <typename T, class Allocator>
+bareiss<T, Allocator>::bareiss(const matrix_type &a)
+	: _a(a), _odd(false), _singular(false)
+{
+	requires(a.is_square());
+
+	this->eliminate();
+}
+
+template <typename T, class Allocator>
+void
+bareiss<T, Allocator>::factorize(const matrix_type &a)
+{
+	requires(a.is_square());
+
+	this->_a = a;
+
+	this->eliminate();
+}
+
+template <typename T, class Allocator>
+void
+bareiss<T, Allocator>::factorize_perf(matrix_type &a)
+{
+	requires(a.is_square());
+
+	this->_a.swap(a);
+	a.clear();
+
+	this->eliminate();
+}
+
+template <typename T, class Allocator>
+T
+bareiss<T, Allocator>::det() const
+{
+	const size_t n = this->dimension();
+
+	if (this->_singular)
+	{
+		return T(0);
+	}
+
+	if (n == 0)
+	{
+		return T(1);
+	}
+
+	const T &result = this->_a(n - 1, n - 1);
+
+	return (this->_odd ? T(0) - result : result);
+}
+
+template <typename T, class Allocator>
+size_t
+bareiss<T, Allocator>::dimension() const
+{
+	return this->_a.rows();
+}
+
+template <typename T, class Allocator>
+bool
+bareiss<T, Allocator>::is_singular() const
+{
+	return this->_singular;
+}
+
+template <typename T, class Allocator>
+template <class A2>
+void
+bareiss<T, Allocator>::solve(matrix<T, A2> &B) const
+{
+	requires(B.rows() == this->dimension());
+
+	if (this->_singular)
+	{
+		throw std::runtime_error("singular matrix");
+	}
+
+	const size_t n = this->dimension(), m = B.columns();
+
+	// P × B.
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (this->_pivots[i] != i)
+		{
+			B.swap_rows(i, this->_pivots[i]);
+		}
+	}
+
+	// Replays the elimination.
+	T previous(1);
+	for (size_t k = 0; k < n; ++k)
+	{
+		const T &pivot = this->_a(k, k);
+
+		for (size_t i = k + 1; i < n; ++i)
+		{
+			const T &x = this->_a(i, k);
+
+			for (size_t j = 0; j < m; ++j)
+			{
+				B(i, j) = (pivot * B(i, j) - x * B(k, j)) / previous;
+			}
+		}
+
+		previous = pivot;
+	}
+
+	// Backward substitution on d × X where d = det(P × A): every division is
+	// exact because d × X has integer values.
+	const T &d = previous;
+	for (size_t i = n; i-- > 0;)
+	{
+		for (size_t j = 0; j < m; ++j)
+		{
+			T tmp = d * B(i, j);
+
+			for (size_t k = i + 1; k < n; ++k)
+			{
+				tmp -= this->_a(i, k) * B(k, j);
+			}
+
+			B(i, j) = tmp / this->_a(i, i);
+		}
+	}
+
+	if (this->_odd)
+	{
+		for (size_t i = 0; i < B.size(); ++i)
+		{
+			B(i) = T(0) - B(i);
+		}
+	}
+}
+
+template <typename T, class Allocator>
+void
+bareiss<T, Allocator>::eliminate()
+{
+	const size_t n = this->_a.rows();
+
+	this->_pivots.resize(n);
+	this->_odd = false;
+	this->_singular = false;
+
+	T previous(1);
+	for (size_t k = 0; k < n; ++k)
+	{
+		// The first non-zero value is used as pivot.
+		size_t p = k;
+		while ((p < n) && (this->_a(p, k) == T(0)))
+		{
+			++p;
+		}
+
+		// The elimination cannot go on but the determinant is known.
+		if (p == n)
+		{
+			this->_singular = true;
+			return;
+		}
+
+		this->_pivots[k] = p;
+		if (p != k)
+		{
+			this->_a.swap_rows(k, p);
+			this->_odd = !this->_odd;
+		}
+
+		const T &pivot = this->_a(k, k);
+
+		// The eliminated value “a(i, k)” is kept for “solve()”.
+		for (size_t i = k + 1; i < n; ++i)
+		{
+			const T &x = this->_a(i, k);
+
+			for (size_t j = k + 1; j < n; ++j)
+			{
+				this->_a(i, j) = (pivot * this->_a(i, j) - x * this->_a(k, j))
+					/ previous;
+			}
+		}
+
+		previous = pivot;
+	}
+}
+
+JFCPP_NAMESPACE_END
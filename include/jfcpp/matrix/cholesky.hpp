@@ -0,0 +1,195 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_CHOLESKY
+#define H_JFCPP_MATRIX_CHOLESKY
+
+#include <cstddef>
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Cholesky decomposition of a symmetric matrix: A = L × Lᵀ, or A = L × D ×
+ * Lᵀ (L with a unit diagonal, D diagonal) which does not need square roots.
+ *
+ * It costs half the operations of the LU decomposition and needs no
+ * pivoting, but only applies to positive-definite matrices (for L × Lᵀ) or
+ * to matrices whose leading minors are not null (for L × D × Lᵀ, which is
+ * only stable for definite matrices).
+ *
+ * Only the lower triangle of A is read and replaced by L: the strict upper
+ * triangle is kept as it is.
+ *
+ * The decomposition and the substitutions are blocked: most of the work is
+ * done by matrix products on the cache-blocked GEMM engine, which can be
+ * parallelized by giving an executor, as can be the triangular solves of the
+ * panels.
+ *
+ * Like “lu”, the decomposition is done in the layout of the matrix (the
+ * diagonal blocks and the panels of a column-major matrix are transposed
+ * while they are worked on) and the right-hand sides may have any layout.
+ *
+ * “matrix::solve()” uses it automatically for symmetric matrices (see
+ * “try_factorize_perf()”).
+ *
+ * Requirement:
+ * - T must be a floating point type.
+ */
+template <typename T, class Allocator, class Layout>
+class cholesky
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef matrix<T, Allocator, Layout> matrix_type;
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Constructs an empty decomposition, see “factorize()”.
+	 */
+	cholesky();
+
+	/**
+	 * Computes the decomposition of a matrix.
+	 *
+	 * @param a    The matrix (must be square).
+	 * @param ldlt Whether to compute L × D × Lᵀ instead of L × Lᵀ.
+	 *
+	 * @throw std::runtime_error If the decomposition does not exist.
+	 */
+	explicit cholesky(const matrix_type &a, bool ldlt = false);
+
+	/**
+	 * Same as “cholesky(const matrix_type &, bool)” but using an executor.
+	 */
+	cholesky(const matrix_type &a, bool ldlt, executor &e);
+
+	/**
+	 * Computes the decomposition of a matrix, replacing the current one.
+	 *
+	 * @throw std::runtime_error If the decomposition does not exist.
+	 */
+	void factorize(const matrix_type &a, bool ldlt = false);
+
+	/**
+	 * Same as “factorize(const matrix_type &, bool)” but using an executor.
+	 */
+	void factorize(const matrix_type &a, bool ldlt, executor &e);
+
+	/**
+	 * Tries to compute the decomposition of a matrix without copying it.
+	 *
+	 * On success, the storage of “a” is taken and it is left empty.  On
+	 * failure, “a” is restored (its lower triangle from the upper one, so
+	 * “a” must be symmetric) and the decomposition is empty: this is the
+	 * cheap way to detect a positive-definite matrix (for L × Lᵀ) before
+	 * falling back to another decomposition.
+	 *
+	 * @return Whether the decomposition exists.
+	 */
+	bool try_factorize_perf(matrix_type &a, bool ldlt = false);
+
+	/**
+	 * Same as “try_factorize_perf(matrix_type &, bool)” but using an
+	 * executor.
+	 */
+	bool try_factorize_perf(matrix_type &a, bool ldlt, executor &e);
+
+	/**
+	 * Computes the determinant of the decomposed matrix.
+	 *
+	 * Calculus complexity: O(n).
+	 */
+	T det() const;
+
+	/**
+	 * Computes the logarithm of the absolute value of the determinant of the
+	 * decomposed matrix (see “lu::log_det()”).
+	 *
+	 * @param sign Receives the sign of the determinant: -1, 0 or 1.
+	 */
+	T log_det(int &sign) const;
+
+	/**
+	 * Gets the dimension of the decomposed matrix.
+	 */
+	size_t dimension() const;
+
+	/**
+	 * Gets L in the lower triangle (with D on the diagonal for L × D × Lᵀ,
+	 * the unit diagonal of L being implicit), the strict upper triangle is
+	 * the one of A.
+	 */
+	const matrix_type &factors() const;
+
+	/**
+	 * Whether the decomposition is L × D × Lᵀ.
+	 */
+	bool is_ldlt() const;
+
+	/**
+	 * Solves A × X = B, the solution replaces B.
+	 *
+	 * Calculus complexity: O(n² × B.columns()).
+	 *
+	 * @param B A matrix with as many rows as A.
+	 */
+	template <class A2, class L2>
+	void solve(matrix<T, A2, L2> &B) const;
+
+	/**
+	 * Same as “solve(matrix<T, A2, L2> &)” but using an executor.
+	 */
+	template <class A2, class L2>
+	void solve(matrix<T, A2, L2> &B, executor &e) const;
+
+private:
+
+	/**
+	 * L (and D) packed.
+	 */
+	matrix_type _factors;
+
+	/**
+	 *
+	 */
+	bool _ldlt;
+
+	/**
+	 * Decomposes “_factors” in place.
+	 *
+	 * @return Whether the decomposition exists.
+	 */
+	bool decompose(executor &e);
+};
+
+JFCPP_NAMESPACE_END
+
+#include "cholesky/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_CHOLESKY
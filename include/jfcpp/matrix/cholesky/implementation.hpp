@@ -0,0 +1,519 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+#include "../../thread_pool.hpp"
+#include "../gemm.hpp"
+#include "../householder.hpp"
+#include "../transpose.hpp"
+#include "../triangular.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Number of columns by block of the decomposition and of the
+	 * substitutions.
+	 */
+	enum { cholesky_block = 128 };
+
+	/**
+	 * Decomposes in place the lower triangle of the k × k block a (leading
+	 * dimension lda), row by row.
+	 *
+	 * For L × D × Lᵀ, w receives the row i of L × D while the row i is
+	 * computed (k values).
+	 *
+	 * @return false if a pivot is not positive (L × Lᵀ) or is null (L × D ×
+	 *         Lᵀ).
+	 */
+	template <typename T>
+	bool
+	cholesky_diagonal(bool ldlt, size_t k, T *a, size_t lda, T *w)
+	{
+		for (size_t i = 0; i < k; ++i)
+		{
+			T *ri = a + i * lda;
+
+			if (ldlt)
+			{
+				for (size_t j = 0; j < i; ++j)
+				{
+					const T *rj = a + j * lda;
+
+					w[j] = ri[j] - dot(j, w, rj);
+					ri[j] = w[j] / rj[j];
+				}
+
+				ri[i] -= dot(i, w, ri);
+				if (!(std::abs(ri[i]) > T(0)))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				for (size_t j = 0; j < i; ++j)
+				{
+					const T *rj = a + j * lda;
+
+					ri[j] = (ri[j] - dot(j, ri, rj)) / rj[j];
+				}
+
+				const T s = ri[i] - dot(i, ri, ri);
+				if (!(s > T(0)))
+				{
+					return false;
+				}
+				ri[i] = std::sqrt(s);
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Computes the rows of L21 from the ones of A21 and L11 (k × k, with D
+	 * on its diagonal for L × D × Lᵀ), by tiles of rows.
+	 *
+	 * Both are stored row by row, with the leading dimensions lda and ldl.
+	 *
+	 * For L × D × Lᵀ, the rows of L21 × D (needed by the update of the
+	 * trailing matrix) go to w (k values by row).
+	 */
+	template <typename T>
+	class cholesky_panel_task : public parallel_task
+	{
+	public:
+
+		static const size_t rows_by_tile = 64;
+
+		cholesky_panel_task(bool ldlt, size_t k, const T *l, size_t ldl,
+		                    size_t rows, T *a, size_t lda, T *w)
+			: _ldlt(ldlt), _k(k), _l(l), _ldl(ldl), _rows(rows), _a(a),
+			  _lda(lda), _w(w)
+		{}
+
+		size_t
+		tiles() const
+		{
+			return ((_rows + rows_by_tile - 1) / rows_by_tile);
+		}
+
+		void
+		operator()(size_t tile)
+		{
+			const size_t
+				first = tile * rows_by_tile,
+				last = std::min(first + rows_by_tile, _rows);
+
+			for (size_t i = first; i < last; ++i)
+			{
+				T *x = _a + i * _lda;
+
+				if (_ldlt)
+				{
+					T *w = _w + i * _k;
+
+					for (size_t j = 0; j < _k; ++j)
+					{
+						const T *lj = _l + j * _ldl;
+
+						w[j] = x[j] - dot(j, w, lj);
+						x[j] = w[j] / lj[j];
+					}
+				}
+				else
+				{
+					for (size_t j = 0; j < _k; ++j)
+					{
+						const T *lj = _l + j * _ldl;
+
+						x[j] = (x[j] - dot(j, x, lj)) / lj[j];
+					}
+				}
+			}
+		}
+
+	private:
+
+		const bool _ldlt;
+
+		const size_t _k;
+
+		const T *const _l;
+
+		const size_t _ldl;
+
+		const size_t _rows;
+
+		T *const _a;
+
+		const size_t _lda;
+
+		T *const _w;
+	};
+
+	/**
+	 * A22 -= W × L21ᵀ on the lower triangle of A22 (m × m) only, by blocks
+	 * of rows: the part on the left of the diagonal block is updated in
+	 * place, the diagonal block through a temporary.
+	 *
+	 * W (m × k) is L21 or L21 × D, both stored row by row, and A22 has
+	 * the row and column strides rsa and csa.
+	 */
+	template <typename T>
+	void
+	cholesky_update(executor &e, size_t m, size_t k, const T *w, size_t ldw,
+	                const T *l, size_t ldl, T *a, ptrdiff_t rsa,
+	                ptrdiff_t csa)
+	{
+		const size_t nb = cholesky_block;
+
+		std::vector<T> diagonal(nb * nb);
+
+		for (size_t r0 = 0; r0 < m; r0 += nb)
+		{
+			const size_t h = std::min(nb, m - r0);
+			const T *wr = w + r0 * ldw;
+			T *ar = a + r0 * rsa;
+
+			gemm(e, h, r0, k, T(-1), wr, ldw, 1, l, 1, ldl, T(1), ar, rsa,
+			     csa);
+
+			gemm(e, h, h, k, T(1), wr, ldw, 1, l + r0 * ldl, 1, ldl, T(0),
+			     &diagonal[0], h, 1);
+			for (size_t i = 0; i < h; ++i)
+			{
+				for (size_t j = 0; j <= i; ++j)
+				{
+					ar[i * rsa + (r0 + j) * csa] -= diagonal[i * h + j];
+				}
+			}
+		}
+	}
+} // namespace matrix_details
+
+template <typename T, class Allocator, class Layout>
+cholesky<T, Allocator, Layout>::cholesky()
+	: _factors(0), _ldlt(false)
+{}
+
+template <typename T, class Allocator, class Layout>
+cholesky<T, Allocator, Layout>::cholesky(const matrix_type &a, bool ldlt)
+	: _factors(0), _ldlt(ldlt)
+{
+	this->factorize(a, ldlt);
+}
+
+template <typename T, class Allocator, class Layout>
+cholesky<T, Allocator, Layout>::cholesky(const matrix_type &a, bool ldlt,
+                                 executor &e)
+	: _factors(0), _ldlt(ldlt)
+{
+	this->factorize(a, ldlt, e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+cholesky<T, Allocator, Layout>::factorize(const matrix_type &a, bool ldlt)
+{
+	sequential_executor e;
+
+	this->factorize(a, ldlt, e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+cholesky<T, Allocator, Layout>::factorize(const matrix_type &a, bool ldlt,
+                                  executor &e)
+{
+	requires(a.is_square());
+
+	this->_factors = a;
+	this->_ldlt = ldlt;
+
+	if (!this->decompose(e))
+	{
+		this->_factors.clear();
+		throw std::runtime_error(ldlt
+		                         ? "null pivot"
+		                         : "matrix not positive definite");
+	}
+}
+
+template <typename T, class Allocator, class Layout>
+bool
+cholesky<T, Allocator, Layout>::try_factorize_perf(matrix_type &a, bool ldlt)
+{
+	sequential_executor e;
+
+	return this->try_factorize_perf(a, ldlt, e);
+}
+
+template <typename T, class Allocator, class Layout>
+bool
+cholesky<T, Allocator, Layout>::try_factorize_perf(matrix_type &a, bool ldlt,
+                                           executor &e)
+{
+	requires(a.is_square());
+
+	const size_t n = a.rows();
+
+	std::vector<T> diagonal(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		diagonal[i] = a(i, i);
+	}
+
+	this->_factors.swap(a);
+	a.clear();
+	this->_ldlt = ldlt;
+
+	if (this->decompose(e))
+	{
+		return true;
+	}
+
+	// The strict upper triangle has not been modified.
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < i; ++j)
+		{
+			this->_factors(i, j) = this->_factors(j, i);
+		}
+		this->_factors(i, i) = diagonal[i];
+	}
+
+	a.swap(this->_factors);
+	this->_factors.clear();
+
+	return false;
+}
+
+template <typename T, class Allocator, class Layout>
+T
+cholesky<T, Allocator, Layout>::det() const
+{
+	T result(1);
+
+	for (size_t i = 0, n = this->dimension(); i < n; ++i)
+	{
+		const T &d = this->_factors(i, i);
+
+		result *= (this->_ldlt ? d : d * d);
+	}
+
+	return result;
+}
+
+template <typename T, class Allocator, class Layout>
+T
+cholesky<T, Allocator, Layout>::log_det(int &sign) const
+{
+	T result(0);
+
+	sign = 1;
+
+	for (size_t i = 0, n = this->dimension(); i < n; ++i)
+	{
+		const T &d = this->_factors(i, i);
+
+		if (d < T(0))
+		{
+			sign = -sign;
+		}
+
+		result += std::log(std::abs(d));
+	}
+
+	return (this->_ldlt ? result : T(2) * result);
+}
+
+template <typename T, class Allocator, class Layout>
+size_t
+cholesky<T, Allocator, Layout>::dimension() const
+{
+	return this->_factors.rows();
+}
+
+template <typename T, class Allocator, class Layout>
+const typename cholesky<T, Allocator, Layout>::matrix_type &
+cholesky<T, Allocator, Layout>::factors() const
+{
+	return this->_factors;
+}
+
+template <typename T, class Allocator, class Layout>
+bool
+cholesky<T, Allocator, Layout>::is_ldlt() const
+{
+	return this->_ldlt;
+}
+
+template <typename T, class Allocator, class Layout>
+template <class A2, class L2>
+void
+cholesky<T, Allocator, Layout>::solve(matrix<T, A2, L2> &B) const
+{
+	sequential_executor e;
+
+	this->solve(B, e);
+}
+
+template <typename T, class Allocator, class Layout>
+template <class A2, class L2>
+void
+cholesky<T, Allocator, Layout>::solve(matrix<T, A2, L2> &B,
+                                      executor &e) const
+{
+	requires(B.rows() == this->dimension());
+
+	const size_t
+		n = this->dimension(),
+		m = B.columns(),
+		rsl = Layout::row_stride(n, n),
+		csl = Layout::column_stride(n, n),
+		rsb = L2::row_stride(n, m),
+		csb = L2::column_stride(n, m);
+	const T *l = this->_factors.begin();
+	T *b = B.begin();
+
+	if ((n == 0) || (m == 0))
+	{
+		return;
+	}
+
+	// L × Y = B.
+	matrix_details::trsm(e, false, this->_ldlt, n, m, T(1), l, rsl, csl, b,
+	                     rsb, csb);
+
+	// D × Z = Y.
+	if (this->_ldlt)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			const T d = l[i * (rsl + csl)];
+
+			for (size_t j = 0; j < m; ++j)
+			{
+				b[i * rsb + j * csb] /= d;
+			}
+		}
+	}
+
+	// Lᵀ × X = Z.
+	matrix_details::trsm(e, true, this->_ldlt, n, m, T(1), l, csl, rsl, b,
+	                     rsb, csb);
+}
+
+template <typename T, class Allocator, class Layout>
+bool
+cholesky<T, Allocator, Layout>::decompose(executor &e)
+{
+	typedef matrix_details::cholesky_panel_task<T> panel;
+
+	const size_t
+		n = this->_factors.rows(),
+		nb = matrix_details::cholesky_block,
+		rs = Layout::row_stride(n, n),
+		cs = Layout::column_stride(n, n);
+	T *a = this->_factors.begin();
+
+	// The rows of L21 × D for L × D × Lᵀ.
+	std::vector<T> w(this->_ldlt ? n * nb : nb);
+
+	// The diagonal block and the panel are worked on row by row: when the
+	// rows are not contiguous, they are transposed in these buffers.
+	std::vector<T> diagonal, rows;
+
+	// Right-looking blocked algorithm: the diagonal block is decomposed,
+	// then the rest of its columns and the trailing matrix is updated with
+	// matrix products.
+	for (size_t k0 = 0; k0 < n; k0 += nb)
+	{
+		const size_t kb = std::min(nb, n - k0), k1 = k0 + kb, m = n - k1;
+		T *l11 = a + k0 * (rs + cs), *a21 = a + k1 * rs + k0 * cs;
+		T *d = l11, *x = a21;
+		size_t ldd = rs, ldx = rs;
+
+		if (cs != 1)
+		{
+			diagonal.resize(kb * kb);
+			d = &diagonal[0];
+			ldd = kb;
+			matrix_details::transpose(kb, kb, l11, cs, d, ldd);
+		}
+
+		if (!matrix_details::cholesky_diagonal(this->_ldlt, kb, d, ldd,
+		                                       &w[0]))
+		{
+			return false;
+		}
+
+		if (cs != 1)
+		{
+			matrix_details::transpose(kb, kb, d, ldd, l11, cs);
+		}
+
+		if (k1 == n)
+		{
+			break;
+		}
+
+		if (cs != 1)
+		{
+			rows.resize(m * kb);
+			x = &rows[0];
+			ldx = kb;
+			matrix_details::transpose(kb, m, a21, cs, x, ldx);
+		}
+
+		panel p(this->_ldlt, kb, d, ldd, m, x, ldx, &w[0]);
+		e.run(p, p.tiles());
+
+		if (cs != 1)
+		{
+			matrix_details::transpose(m, kb, x, ldx, a21, cs);
+		}
+
+		if (this->_ldlt)
+		{
+			matrix_details::cholesky_update(e, m, kb, &w[0], kb, x, ldx,
+			                                a + k1 * (rs + cs), rs, cs);
+		}
+		else
+		{
+			matrix_details::cholesky_update(e, m, kb, x, ldx, x, ldx,
+			                                a + k1 * (rs + cs), rs, cs);
+		}
+	}
+
+	return true;
+}
+
+JFCPP_NAMESPACE_END
@@ -47,7 +47,9 @@ namespace matrix_details
 		/**
 		 *
 		 */
-		column_iterator(matrix<T> &m, size_t i, size_t j);
+		column_iterator(T *values, size_t rows,
+		                size_t row_stride, size_t column_stride,
+		                size_t i, size_t j);
 
 		/**
 		 *
@@ -81,10 +83,26 @@ namespace matrix_details
 
 	private:
 
+		/**
+		 * The values of the matrix, the element (i, j) is at “i ×
+		 * row_stride + j × column_stride”.
+		 */
+		T *_values;
+
+		/**
+		 *
+		 */
+		size_t _rows;
+
+		/**
+		 *
+		 */
+		size_t _row_stride;
+
 		/**
 		 *
 		 */
-		matrix<T> *_matrix;
+		size_t _column_stride;
 
 		/**
 		 *
@@ -18,24 +18,29 @@
 
 template<typename T> inline
 column_iterator<T>::column_iterator()
-	: _matrix(NULL)
+	: _values(NULL), _rows(0), _row_stride(0), _column_stride(0),
+	  _i(0), _j(0)
 {}
 
 template<typename T> inline
 column_iterator<T>::column_iterator(const column_iterator &it)
-	: _matrix(it._matrix), _i(it._i), _j(it._j)
+	: _values(it._values), _rows(it._rows), _row_stride(it._row_stride),
+	  _column_stride(it._column_stride), _i(it._i), _j(it._j)
 {}
 
 template<typename T> inline
-column_iterator<T>::column_iterator(matrix<T> &m, size_t i, size_t j)
-	: _matrix(&m), _i(i), _j(j)
+column_iterator<T>::column_iterator(T *values, size_t rows,
+                                    size_t row_stride, size_t column_stride,
+                                    size_t i, size_t j)
+	: _values(values), _rows(rows), _row_stride(row_stride),
+	  _column_stride(column_stride), _i(i), _j(j)
 {}
 
 template<typename T> inline
 bool
 column_iterator<T>::operator==(const column_iterator &it) const
 {
-	return ((_matrix == it._matrix) // Same matrix.
+	return ((_values == it._values) // Same matrix.
 	        && (_i == it._i)
 	        && (_j == it._j));
 }
@@ -51,7 +56,8 @@ template<typename T> inline
 T &
 column_iterator<T>::operator*()
 {
-	return (*(this->_matrix))(this->_i, this->_j);
+	return this->_values[this->_i * this->_row_stride
+	                    + this->_j * this->_column_stride];
 }
 
 template<typename T> inline
@@ -59,7 +65,7 @@ column_iterator<T> &
 column_iterator<T>::operator++()
 {
 	++(this->_i);
-	if (this->_i >= this->_matrix->rows())
+	if (this->_i >= this->_rows)
 	{
 		this->_i = 0;
 		++(this->_j);
@@ -81,5 +87,6 @@ template<typename T> inline
 T *
 column_iterator<T>::operator->()
 {
-	return &(*(this->_matrix))(this->_i, this->_j);
+	return &this->_values[this->_i * this->_row_stride
+	                      + this->_j * this->_column_stride];
 }
@@ -52,7 +52,9 @@ namespace matrix_details
 		/**
 		 *
 		 */
-		const_column_iterator(const matrix<T> &m, size_t i, size_t j);
+		const_column_iterator(const T *values, size_t rows,
+		                      size_t row_stride, size_t column_stride,
+		                      size_t i, size_t j);
 
 		/**
 		 *
@@ -86,10 +88,26 @@ namespace matrix_details
 
 	private:
 
+		/**
+		 * The values of the matrix, the element (i, j) is at “i ×
+		 * row_stride + j × column_stride”.
+		 */
+		const T *_values;
+
+		/**
+		 *
+		 */
+		size_t _rows;
+
+		/**
+		 *
+		 */
+		size_t _row_stride;
+
 		/**
 		 *
 		 */
-		const matrix<T> *_matrix;
+		size_t _column_stride;
 
 		/**
 		 *
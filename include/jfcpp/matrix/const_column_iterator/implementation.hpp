@@ -18,30 +18,37 @@
 
 template<typename T> inline
 const_column_iterator<T>::const_column_iterator()
-	: _matrix(NULL)
+	: _values(NULL), _rows(0), _row_stride(0), _column_stride(0),
+	  _i(0), _j(0)
 {}
 
 template<typename T> inline
 const_column_iterator<T>::const_column_iterator(const column_iterator<T> &it)
-	: _matrix(it._matrix), _i(it._i), _j(it._j)
+	: _values(it._values), _rows(it._rows), _row_stride(it._row_stride),
+	  _column_stride(it._column_stride), _i(it._i), _j(it._j)
 {}
 
 template<typename T> inline
 const_column_iterator<T>::const_column_iterator(const const_column_iterator &it)
-	: _matrix(it._matrix), _i(it._i), _j(it._j)
+	: _values(it._values), _rows(it._rows), _row_stride(it._row_stride),
+	  _column_stride(it._column_stride), _i(it._i), _j(it._j)
 {}
 
 template<typename T> inline
-const_column_iterator<T>::const_column_iterator(const matrix<T> &m, size_t i,
-                                                size_t j)
-	: _matrix(&m), _i(i), _j(j)
+const_column_iterator<T>::const_column_iterator(const T *values,
+                                                size_t rows,
+                                                size_t row_stride,
+                                                size_t column_stride,
+                                                size_t i, size_t j)
+	: _values(values), _rows(rows), _row_stride(row_stride),
+	  _column_stride(column_stride), _i(i), _j(j)
 {}
 
 template<typename T> inline
 bool
 const_column_iterator<T>::operator==(const const_column_iterator &it) const
 {
-	return ((_matrix == it._matrix)
+	return ((_values == it._values)
 	        && (_i == it._i)
 	        && (_j == it._j));
 }
@@ -57,7 +64,8 @@ template<typename T> inline
 const T &
 const_column_iterator<T>::operator*() const
 {
-	return (*(this->_matrix))(this->_i, this->_j);
+	return this->_values[this->_i * this->_row_stride
+	                    + this->_j * this->_column_stride];
 }
 
 template<typename T> inline
@@ -65,7 +73,7 @@ const_column_iterator<T> &
 const_column_iterator<T>::operator++()
 {
 	++(this->_i);
-	if (this->_i >= this->_matrix->rows())
+	if (this->_i >= this->_rows)
 	{
 		this->_i = 0;
 		++(this->_j);
@@ -87,5 +95,6 @@ template<typename T> inline
 const T *
 const_column_iterator<T>::operator->() const
 {
-	return &(*(this->_matrix))(this->_i, this->_j);
+	return &this->_values[this->_i * this->_row_stride
+	                      + this->_j * this->_column_stride];
 }
@@ -0,0 +1,247 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_ELIMINATION
+#define H_JFCPP_MATRIX_ELIMINATION
+
+#include <cstddef>
+
+#include "../common.hpp"
+#include "../math.hpp"
+#include "../matrix.hpp"
+#include "../thread_pool.hpp"
+#include "bareiss.hpp"
+#include "cholesky.hpp"
+#include "lu.hpp"
+
+JFCPP_MATH_NAMESPACE_BEGIN
+
+template <typename T>
+class rational;
+
+JFCPP_MATH_NAMESPACE_END
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Chooses the elimination used by “matrix::det()”, “matrix::solve()”
+	 * and “matrix::inverse()”.
+	 *
+	 * By default (integers, “mpz_class”, …), the fraction-free elimination
+	 * is used: the determinant is exact and so is the solution when it has
+	 * integer values.  It works on row-major matrices, the other layouts are
+	 * converted.
+	 */
+	template <typename T>
+	struct elimination
+	{
+		template <class A, class L>
+		static
+		T
+		det(const matrix<T, A, L> &a)
+		{
+			return bareiss<T, A>(a).det();
+		}
+
+		template <class A, class L>
+		static
+		void
+		solve(matrix<T, A, L> &a, matrix<T, A, L> &B, executor &e)
+		{
+			matrix<T, A> ra(a), rb(B);
+
+			a.clear();
+
+			solve(ra, rb, e);
+
+			B = rb;
+		}
+
+		template <class A>
+		static
+		void
+		solve(matrix<T, A> &a, matrix<T, A> &B, executor &)
+		{
+			bareiss<T, A> decomposition;
+
+			decomposition.factorize_perf(a);
+			decomposition.solve(B);
+
+			const T d = decomposition.det();
+			for (size_t i = 0; i < B.size(); ++i)
+			{
+				B(i) = B(i) / d;
+			}
+		}
+	};
+
+	/**
+	 * Floating point types use the LU decomposition, or the Cholesky one
+	 * (half the operations) for symmetric positive-definite matrices: it
+	 * fails early on the other symmetric matrices, which are restored.
+	 *
+	 * Both work in the layout of the matrices, which are not converted.
+	 */
+	template <typename T>
+	struct lu_elimination
+	{
+		template <class A, class L>
+		static
+		T
+		det(const matrix<T, A, L> &a)
+		{
+			return lu<T, A, L>(a).det();
+		}
+
+		template <class A, class L>
+		static
+		void
+		solve(matrix<T, A, L> &a, matrix<T, A, L> &B, executor &e)
+		{
+			if (a.is_symmetric())
+			{
+				cholesky<T, A, L> c;
+
+				if (c.try_factorize_perf(a, false, e))
+				{
+					c.solve(B, e);
+					return;
+				}
+			}
+
+			lu<T, A, L> decomposition;
+
+			decomposition.factorize_perf(a, e);
+			decomposition.solve(B, e);
+		}
+	};
+
+	template <>
+	struct elimination<float> : public lu_elimination<float>
+	{};
+
+	template <>
+	struct elimination<double> : public lu_elimination<double>
+	{};
+
+	template <>
+	struct elimination<long double> : public lu_elimination<long double>
+	{};
+
+	/**
+	 * Rationals: each row is multiplied by the least common multiple of its
+	 * denominators and the fraction-free elimination is done on the
+	 * resulting integers, which avoids the growth of the fractions.
+	 */
+	template <typename T>
+	struct elimination<JFCPP_MATH_NS()rational<T> >
+	{
+		typedef JFCPP_MATH_NS()rational<T> rational;
+
+		/**
+		 * Multiplies the row i of “a” (and of “b” if not NULL) by the least
+		 * common multiple of their denominators which is returned, the
+		 * results are stored in “ia” and “ib”.
+		 */
+		template <class A, class L, class IA>
+		static
+		T
+		scale_row(size_t i, const matrix<rational, A, L> &a,
+		          const matrix<rational, A, L> *b, matrix<T, IA> &ia,
+		          matrix<T, IA> &ib)
+		{
+			T scale(1);
+
+			for (size_t j = 0; j < a.columns(); ++j)
+			{
+				scale = JFCPP_MATH_NS()lcm<T>(scale, a(i, j).denominator());
+			}
+			for (size_t j = 0; (b != NULL) && (j < b->columns()); ++j)
+			{
+				scale = JFCPP_MATH_NS()lcm<T>(scale, (*b)(i, j).denominator());
+			}
+
+			for (size_t j = 0; j < a.columns(); ++j)
+			{
+				ia(i, j) = scale / a(i, j).denominator() * a(i, j).numerator();
+			}
+			for (size_t j = 0; (b != NULL) && (j < b->columns()); ++j)
+			{
+				ib(i, j) = scale / (*b)(i, j).denominator()
+					* (*b)(i, j).numerator();
+			}
+
+			return scale;
+		}
+
+		template <class A, class L>
+		static
+		rational
+		det(const matrix<rational, A, L> &a)
+		{
+			const size_t n = a.rows();
+
+			const matrix<rational, A, L> *const none = NULL;
+			matrix<T> ia(n, n), unused(0);
+
+			T scale(1);
+			for (size_t i = 0; i < n; ++i)
+			{
+				scale *= scale_row(i, a, none, ia, unused);
+			}
+
+			return rational(bareiss<T>(ia).det(), scale);
+		}
+
+		template <class A, class L>
+		static
+		void
+		solve(matrix<rational, A, L> &a, matrix<rational, A, L> &B,
+		      executor &)
+		{
+			const size_t n = a.rows();
+
+			matrix<T> ia(n, n), ib(n, B.columns());
+			for (size_t i = 0; i < n; ++i)
+			{
+				scale_row(i, a, &B, ia, ib);
+			}
+			a.clear();
+
+			bareiss<T> decomposition;
+
+			decomposition.factorize_perf(ia);
+			decomposition.solve(ib);
+
+			const T d = decomposition.det();
+			for (size_t i = 0; i < B.rows(); ++i)
+			{
+				for (size_t j = 0; j < B.columns(); ++j)
+				{
+					B(i, j) = rational(ib(i, j), d);
+				}
+			}
+		}
+	};
+} // namespace matrix_details
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_MATRIX_ELIMINATION
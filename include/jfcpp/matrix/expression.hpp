@@ -0,0 +1,818 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_EXPRESSION
+#define H_JFCPP_MATRIX_EXPRESSION
+
+#include <cstddef>
+#include <functional>
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+#	include <utility>
+#endif
+
+#include <contracts.h>
+
+#include "../common.hpp"
+#include "../meta/enable_if.hpp"
+#include "../meta/is_a.hpp"
+#include "../operators.hpp"
+#include "layout.hpp"
+#include "transpose.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+template <typename T, class Allocator, class Layout>
+class matrix;
+
+template <typename T>
+class const_matrix_view;
+
+/**
+ * Lazy element-wise matrix expressions.
+ *
+ * “a + b * 2” does not compute anything, it builds a small tree of nodes
+ * which is evaluated in a single pass, without temporaries, when it is
+ * assigned to a matrix (or used to construct one).
+ *
+ * Each node (the matrix itself included) provides:
+ * - the type “value_type”;
+ * - “linear”: the order (“linear_order” of “matrix/layout.hpp”) in which
+ *   the elements can be accessed with a single index
+ *   (“operator()(size_t)”), if any;
+ * - “rows()” and “columns()”;
+ * - “operator()(size_t, size_t)” which computes one element;
+ * - “references(m)”: whether the values of the matrix “m” are read;
+ * - “aliases(m)”: whether evaluating the expression directly in “m” would
+ *   give a wrong result, which is the case when an element of “m” is read at
+ *   another position than the one being written (e.g. in “transpose()”).
+ */
+namespace matrix_details
+{
+	/**
+	 * Common base of every expression, used to distinguish them from
+	 * scalars.
+	 */
+	struct expression_tag : public operators::non_scalar
+	{};
+
+	/**
+	 * “if_scalar<S, R>::type” is R if S is not an expression.
+	 */
+	template <typename S, typename R>
+	struct if_scalar : public meta::enable_if<!meta::is_a<expression_tag, S>::value, R>
+	{};
+
+	template <class E>
+	class transposition;
+
+	/**
+	 * Where the values of a matrix or of a view are stored: the element (i,
+	 * j) is at “origin + i × row_stride + j × column_stride”.
+	 */
+	template <typename T>
+	struct memory_layout
+	{
+		const T *origin;
+		size_t rows;
+		size_t columns;
+		size_t row_stride;
+		size_t column_stride;
+	};
+
+	template <typename T, class Allocator, class Layout>
+	memory_layout<T>
+	layout_of(const matrix<T, Allocator, Layout> &m)
+	{
+		const size_t rows = m.rows(), columns = m.columns();
+		const memory_layout<T> layout =
+			{m.begin(), rows, columns, Layout::row_stride(rows, columns),
+			 Layout::column_stride(rows, columns)};
+
+		return layout;
+	}
+
+	template <typename T>
+	memory_layout<T>
+	layout_of(const const_matrix_view<T> &v);
+
+	/**
+	 * Whether two layouts share at least one byte (the bounds of their
+	 * storages are compared).
+	 */
+	template <typename T1, typename T2>
+	bool
+	overlaps(const memory_layout<T1> &a, const memory_layout<T2> &b)
+	{
+		if ((a.rows == 0) || (a.columns == 0)
+		    || (b.rows == 0) || (b.columns == 0))
+		{
+			return false;
+		}
+
+		const char
+			*first_a = reinterpret_cast<const char *>(a.origin),
+			*last_a = reinterpret_cast<const char *>(
+				a.origin + (a.rows - 1) * a.row_stride
+				+ (a.columns - 1) * a.column_stride + 1),
+			*first_b = reinterpret_cast<const char *>(b.origin),
+			*last_b = reinterpret_cast<const char *>(
+				b.origin + (b.rows - 1) * b.row_stride
+				+ (b.columns - 1) * b.column_stride + 1);
+
+		const std::less<const char *> less;
+
+		return (less(first_a, last_b) && less(first_b, last_a));
+	}
+
+	/**
+	 * Whether each element is at the same address in both layouts.
+	 */
+	template <typename T1, typename T2>
+	bool
+	same_layout(const memory_layout<T1> &, const memory_layout<T2> &)
+	{
+		return false;
+	}
+
+	template <typename T>
+	bool
+	same_layout(const memory_layout<T> &a, const memory_layout<T> &b)
+	{
+		return ((a.origin == b.origin)
+		        && (a.rows == b.rows)
+		        && (a.columns == b.columns)
+		        && ((a.rows < 2) || (a.row_stride == b.row_stride))
+		        && ((a.columns < 2) || (a.column_stride == b.column_stride)));
+	}
+
+	/**
+	 * The order of an expression whose operands are accessed in the orders
+	 * Lhs and Rhs: linear only if they are the same.
+	 */
+	template <int Lhs, int Rhs>
+	struct common_order
+	{
+		enum { value = ((Lhs == Rhs) ? Lhs : linear_none) };
+	};
+
+	/**
+	 * The order of the transpose of an expression accessed in the order O:
+	 * the rows of the one are the columns of the other.
+	 */
+	template <int O>
+	struct transposed_order
+	{
+		enum { value = linear_none };
+	};
+
+	template <>
+	struct transposed_order<linear_rows>
+	{
+		enum { value = linear_columns };
+	};
+
+	template <>
+	struct transposed_order<linear_columns>
+	{
+		enum { value = linear_rows };
+	};
+
+	template <class E>
+	struct expression : public expression_tag
+	{
+		const E &
+		derived() const
+		{
+			return static_cast<const E &>(*this);
+		}
+
+		/**
+		 * @see matrix::transposed()
+		 */
+		transposition<E> transposed() const;
+
+		/**
+		 * Same as “transposed()”, an expression being already lazy.
+		 */
+		transposition<E> transpose() const;
+	};
+
+	/**
+	 * Leaf of an expression tree: a reference to a matrix.
+	 */
+	template <typename T, class Allocator, class Layout>
+	class matrix_reference
+	{
+	public:
+
+		typedef T value_type;
+
+		typedef Allocator allocator_type;
+
+		enum { linear = Layout::order };
+
+		matrix_reference(const matrix<T, Allocator, Layout> &m) : _m(m)
+		{}
+
+		allocator_type
+		get_allocator() const
+		{
+			return _m.get_allocator();
+		}
+
+		size_t
+		rows() const
+		{
+			return _m.rows();
+		}
+
+		size_t
+		columns() const
+		{
+			return _m.columns();
+		}
+
+		const value_type &
+		operator()(size_t i) const
+		{
+			return _m(i);
+		}
+
+		const value_type &
+		operator()(size_t i, size_t j) const
+		{
+			return _m(i, j);
+		}
+
+		/**
+		 * Gets the values, in the storage order of the layout.
+		 */
+		const value_type *
+		begin() const
+		{
+			return _m.begin();
+		}
+
+		template <class M>
+		bool
+		references(const M &m) const
+		{
+			return overlaps(layout_of(_m), layout_of(m));
+		}
+
+		/**
+		 * An element is only read at the position where it is written,
+		 * unless m is a view on other elements of this matrix.
+		 */
+		template <class M>
+		bool
+		aliases(const M &m) const
+		{
+			return (this->references(m)
+			        && !same_layout(layout_of(_m), layout_of(m)));
+		}
+
+	private:
+
+		const matrix<T, Allocator, Layout> &_m;
+	};
+
+	/**
+	 * The allocator type of the leaves which do not own their values (the
+	 * views).
+	 */
+	struct no_allocator
+	{};
+
+	/**
+	 * The allocator of a matrix built from an operand whose allocator has
+	 * the type A2: a copy if it is the same type, otherwise a default one.
+	 */
+	template <class Allocator, class A2>
+	struct allocator_from
+	{
+		static
+		Allocator
+		get(const A2 &)
+		{
+			return Allocator();
+		}
+	};
+
+	template <class Allocator>
+	struct allocator_from<Allocator, Allocator>
+	{
+		static
+		Allocator
+		get(const Allocator &a)
+		{
+			return a;
+		}
+	};
+
+	/**
+	 * How the operands are stored in the nodes: matrices by reference,
+	 * other nodes (which are small) by value.
+	 */
+	template <class E>
+	struct operand
+	{
+		typedef E type;
+	};
+
+	template <typename T, class Allocator, class Layout>
+	struct operand<matrix<T, Allocator, Layout> >
+	{
+		typedef matrix_reference<T, Allocator, Layout> type;
+	};
+
+	/**
+	 * The result of an element-wise operation between two expressions has
+	 * the type of the left one and is computed as “lhs OP= rhs”, like the
+	 * assignment operators of “matrix”.
+	 */
+#	define JFCPP_MATRIX_BINARY_EXPRESSION(NAME, OP) \
+	template <class E1, class E2> \
+	class NAME : public expression<NAME<E1, E2> > \
+	{ \
+	public: \
+ \
+		typedef typename operand<E1>::type lhs_type; \
+ \
+		typedef typename operand<E2>::type rhs_type; \
+ \
+		typedef typename lhs_type::value_type value_type; \
+ \
+		typedef typename lhs_type::allocator_type allocator_type; \
+ \
+		enum { linear = common_order<lhs_type::linear, \
+		                             rhs_type::linear>::value }; \
+ \
+		NAME(const E1 &lhs, const E2 &rhs) : _lhs(lhs), _rhs(rhs) \
+		{ \
+			requires(_lhs.rows() == _rhs.rows()); \
+			requires(_lhs.columns() == _rhs.columns()); \
+		} \
+ \
+		allocator_type \
+		get_allocator() const \
+		{ \
+			return _lhs.get_allocator(); \
+		} \
+ \
+		size_t \
+		rows() const \
+		{ \
+			return _lhs.rows(); \
+		} \
+ \
+		size_t \
+		columns() const \
+		{ \
+			return _lhs.columns(); \
+		} \
+ \
+		value_type \
+		operator()(size_t i) const \
+		{ \
+			value_type result(_lhs(i)); \
+			result OP##= _rhs(i); \
+			return result; \
+		} \
+ \
+		value_type \
+		operator()(size_t i, size_t j) const \
+		{ \
+			value_type result(_lhs(i, j)); \
+			result OP##= _rhs(i, j); \
+			return result; \
+		} \
+ \
+		template <class M> \
+		bool \
+		references(const M &m) const \
+		{ \
+			return (_lhs.references(m) || _rhs.references(m)); \
+		} \
+ \
+		template <class M> \
+		bool \
+		aliases(const M &m) const \
+		{ \
+			return (_lhs.aliases(m) || _rhs.aliases(m)); \
+		} \
+ \
+	private: \
+ \
+		const lhs_type _lhs; \
+ \
+		const rhs_type _rhs; \
+	}; \
+ \
+	template <class E, typename S> \
+	class NAME##_scalar : public expression<NAME##_scalar<E, S> > \
+	{ \
+	public: \
+ \
+		typedef typename operand<E>::type operand_type; \
+ \
+		typedef typename operand_type::value_type value_type; \
+ \
+		typedef typename operand_type::allocator_type allocator_type; \
+ \
+		enum { linear = operand_type::linear }; \
+ \
+		NAME##_scalar(const E &e, const S &s) : _e(e), _s(s) \
+		{} \
+ \
+		allocator_type \
+		get_allocator() const \
+		{ \
+			return _e.get_allocator(); \
+		} \
+ \
+		size_t \
+		rows() const \
+		{ \
+			return _e.rows(); \
+		} \
+ \
+		size_t \
+		columns() const \
+		{ \
+			return _e.columns(); \
+		} \
+ \
+		value_type \
+		operator()(size_t i) const \
+		{ \
+			value_type result(_e(i)); \
+			result OP##= _s; \
+			return result; \
+		} \
+ \
+		value_type \
+		operator()(size_t i, size_t j) const \
+		{ \
+			value_type result(_e(i, j)); \
+			result OP##= _s; \
+			return result; \
+		} \
+ \
+		template <class M> \
+		bool \
+		references(const M &m) const \
+		{ \
+			return _e.references(m); \
+		} \
+ \
+		template <class M> \
+		bool \
+		aliases(const M &m) const \
+		{ \
+			return _e.aliases(m); \
+		} \
+ \
+	private: \
+ \
+		const operand_type _e; \
+ \
+		const S _s; \
+	}; \
+ \
+	template <class E1, class E2> \
+	NAME<E1, E2> \
+	operator OP(const expression<E1> &lhs, const expression<E2> &rhs) \
+	{ \
+		return NAME<E1, E2>(lhs.derived(), rhs.derived()); \
+	} \
+ \
+	template <class E, typename S> \
+	typename if_scalar<S, NAME##_scalar<E, S> >::type \
+	operator OP(const expression<E> &lhs, const S &rhs) \
+	{ \
+		return NAME##_scalar<E, S>(lhs.derived(), rhs); \
+	}
+
+	/**
+	 * Like “operators::addable” and “operators::multipliable”, “s + m” is
+	 * computed as “m + s”.
+	 */
+#	define JFCPP_MATRIX_BINARY_EXPRESSION_COMMUTATIVE(NAME, OP) \
+	JFCPP_MATRIX_BINARY_EXPRESSION(NAME, OP) \
+ \
+	template <class E, typename S> \
+	typename if_scalar<S, NAME##_scalar<E, S> >::type \
+	operator OP(const S &lhs, const expression<E> &rhs) \
+	{ \
+		return NAME##_scalar<E, S>(rhs.derived(), lhs); \
+	}
+
+	JFCPP_MATRIX_BINARY_EXPRESSION(divides, /)
+	JFCPP_MATRIX_BINARY_EXPRESSION(minus, -)
+	JFCPP_MATRIX_BINARY_EXPRESSION(modulus, %)
+
+	JFCPP_MATRIX_BINARY_EXPRESSION_COMMUTATIVE(multiplies, *)
+	JFCPP_MATRIX_BINARY_EXPRESSION_COMMUTATIVE(plus, +)
+
+#	undef JFCPP_MATRIX_BINARY_EXPRESSION
+#	undef JFCPP_MATRIX_BINARY_EXPRESSION_COMMUTATIVE
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+	/**
+	 * When the left operand is a temporary matrix, its storage is reused for
+	 * the result instead of allocating a new one: these overloads are better
+	 * matches than the ones above and return a matrix.
+	 */
+#	define JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE(OP) \
+	template <typename T, class A, class L, class E> \
+	matrix<T, A, L> \
+	operator OP(matrix<T, A, L> &&lhs, const expression<E> &rhs) \
+	{ \
+		lhs OP##= rhs.derived(); \
+		return std::move(lhs); \
+	} \
+ \
+	template <typename T, class A, class L, typename S> \
+	typename if_scalar<S, matrix<T, A, L> >::type \
+	operator OP(matrix<T, A, L> &&lhs, const S &rhs) \
+	{ \
+		lhs OP##= rhs; \
+		return std::move(lhs); \
+	}
+
+#	define JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE_COMMUTATIVE(OP) \
+	JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE(OP) \
+ \
+	template <typename T, class A, class L, typename S> \
+	typename if_scalar<S, matrix<T, A, L> >::type \
+	operator OP(const S &lhs, matrix<T, A, L> &&rhs) \
+	{ \
+		rhs OP##= lhs; \
+		return std::move(rhs); \
+	}
+
+	JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE(/)
+	JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE(-)
+	JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE(%)
+
+	JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE_COMMUTATIVE(*)
+	JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE_COMMUTATIVE(+)
+
+#	undef JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE
+#	undef JFCPP_MATRIX_BINARY_EXPRESSION_RVALUE_COMMUTATIVE
+#endif
+
+	/**
+	 * The transpose of an expression, returned by “matrix::transposed()”.
+	 */
+	template <class E>
+	class transposition : public expression<transposition<E> >
+	{
+	public:
+
+		typedef typename operand<E>::type operand_type;
+
+		typedef typename operand_type::value_type value_type;
+
+		typedef typename operand_type::allocator_type allocator_type;
+
+		/**
+		 * The transpose of a row-major matrix is linear in column-major
+		 * order and vice versa.
+		 */
+		enum { linear = transposed_order<operand_type::linear>::value };
+
+		transposition(const E &e) : _e(e)
+		{}
+
+		allocator_type
+		get_allocator() const
+		{
+			return _e.get_allocator();
+		}
+
+		size_t
+		rows() const
+		{
+			return _e.columns();
+		}
+
+		size_t
+		columns() const
+		{
+			return _e.rows();
+		}
+
+		value_type
+		operator()(size_t i) const
+		{
+			return _e(i);
+		}
+
+		value_type
+		operator()(size_t i, size_t j) const
+		{
+			return _e(j, i);
+		}
+
+		/**
+		 * Gets the transposed expression.
+		 */
+		const operand_type &
+		operand() const
+		{
+			return _e;
+		}
+
+		template <class M>
+		bool
+		references(const M &m) const
+		{
+			return _e.references(m);
+		}
+
+		/**
+		 * Except on the diagonal, the elements are read at another position.
+		 */
+		template <class M>
+		bool
+		aliases(const M &m) const
+		{
+			return _e.references(m);
+		}
+
+	private:
+
+		const operand_type _e;
+	};
+
+	template <class E>
+	transposition<E>
+	expression<E>::transposed() const
+	{
+		return transposition<E>(this->derived());
+	}
+
+	template <class E>
+	transposition<E>
+	expression<E>::transpose() const
+	{
+		return this->transposed();
+	}
+
+	/**
+	 * Plain assignment, used like the functors of “functional” (e.g.
+	 * “functional::plus_assign”).
+	 */
+	template <typename T1, typename T2>
+	struct assign : public std::binary_function<T1, T2, void>
+	{
+		void
+		operator()(T1 &x, const T2 &y) const
+		{
+			x = y;
+		}
+	};
+
+	/**
+	 * Applies “op(first[k], e(…))” to each element of the expression, where
+	 * k is the position of the element in the storage order Order of the
+	 * destination.
+	 *
+	 * By default, the elements are computed row by row.
+	 */
+	template <int Order, bool Linear>
+	struct evaluator
+	{
+		template <typename T, class E, class Operation>
+		static
+		void
+		run(T *first, const E &e, Operation op)
+		{
+			const size_t rows = e.rows(), columns = e.columns();
+
+			for (size_t i = 0; i < rows; ++i)
+			{
+				for (size_t j = 0; j < columns; ++j, ++first)
+				{
+					op(*first, e(i, j));
+				}
+			}
+		}
+	};
+
+	template <>
+	struct evaluator<linear_columns, false>
+	{
+		template <typename T, class E, class Operation>
+		static
+		void
+		run(T *first, const E &e, Operation op)
+		{
+			const size_t rows = e.rows(), columns = e.columns();
+
+			for (size_t j = 0; j < columns; ++j)
+			{
+				for (size_t i = 0; i < rows; ++i, ++first)
+				{
+					op(*first, e(i, j));
+				}
+			}
+		}
+	};
+
+	/**
+	 * The expression is linear in the order of the destination.
+	 */
+	template <int Order>
+	struct evaluator<Order, true>
+	{
+		template <typename T, class E, class Operation>
+		static
+		void
+		run(T *first, const E &e, Operation op)
+		{
+			const size_t size = e.rows() * e.columns();
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				op(first[i], e(i));
+			}
+		}
+	};
+
+	/**
+	 * @param first The storage of the destination, whose layout is Layout.
+	 */
+	template <typename T, class E, class Operation, class Layout>
+	void
+	evaluate(T *first, const E &e, Operation op, Layout)
+	{
+		typedef typename operand<E>::type node_type;
+
+		evaluator<Layout::order,
+		          (static_cast<int>(node_type::linear)
+		           == static_cast<int>(Layout::order))>::run(first,
+		                                                     node_type(e),
+		                                                     op);
+	}
+
+	/**
+	 * Assigning the transpose of a matrix to a matrix with the same layout
+	 * uses the cache-oblivious transposition instead of reading the source
+	 * across its storage.
+	 */
+	template <typename T, class Allocator, class Layout>
+	void
+	evaluate(T *first, const transposition<matrix<T, Allocator, Layout> > &e,
+	         assign<T, T>, Layout)
+	{
+		const size_t
+			outer = Layout::outer(e.columns(), e.rows()),
+			inner = Layout::inner(e.columns(), e.rows());
+
+		transpose(outer, inner, e.operand().begin(), inner, first, outer);
+	}
+
+	/**
+	 * Converting the layout of a matrix is the transposition of its storage.
+	 */
+	template <typename T, class Allocator>
+	void
+	evaluate(T *first, const matrix<T, Allocator, row_major> &m, assign<T, T>,
+	         column_major)
+	{
+		transpose(m.rows(), m.columns(), m.begin(), m.columns(), first,
+		          m.rows());
+	}
+
+	template <typename T, class Allocator>
+	void
+	evaluate(T *first, const matrix<T, Allocator, column_major> &m,
+	         assign<T, T>, row_major)
+	{
+		transpose(m.columns(), m.rows(), m.begin(), m.rows(), first,
+		          m.columns());
+	}
+} // namespace matrix_details
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_MATRIX_EXPRESSION
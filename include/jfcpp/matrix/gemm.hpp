@@ -0,0 +1,637 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_GEMM
+#define H_JFCPP_MATRIX_GEMM
+
+#include <algorithm>
+#include <cstddef>
+
+#include "../aligned_allocator.hpp"
+#include "../common.hpp"
+#include "../simd.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Blocking parameters of the GEMM engine.
+	 *
+	 * - mr × nr is the block of C which is kept in registers by the
+	 *   micro-kernel;
+	 * - kc is chosen so that a kc × nr sliver of packed B stays in L1;
+	 * - mc is chosen so that the mc × kc packed block of A stays in L2;
+	 * - nc is chosen so that the kc × nc packed panel of B stays in L3.
+	 *
+	 * For “float” and “double”, mr × nr is the shape of the SIMD
+	 * micro-kernel selected at run time, which depends on the instruction
+	 * set.
+	 */
+	template <typename T>
+	struct gemm_blocking
+	{
+		/**
+		 * The micro-kernel: computes the mr × nr block ab (stored row by
+		 * row) from kc columns of a packed panel of A and kc rows of a
+		 * packed panel of B.
+		 */
+		typedef void (*accumulator)(size_t kc, const T *a, const T *b,
+		                            T *ab);
+
+		/**
+		 * Gets the parameters used for T on this processor.
+		 */
+		static
+		const gemm_blocking &
+		get();
+
+		gemm_blocking(size_t mr, size_t nr, accumulator accumulate)
+			: mr(mr), nr(nr), kc(256),
+			  mc(std::max(mr, (128 * 1024) / (kc * sizeof(T)) / mr * mr)),
+			  nc(std::max(nr, (2048 * 1024) / (kc * sizeof(T)) / nr * nr)),
+			  accumulate(accumulate)
+		{}
+
+		size_t mr, nr, kc, mc, nc;
+
+		accumulator accumulate;
+	};
+
+	/**
+	 * The micro-kernel of the other types, with a fixed shape.
+	 */
+	template <typename T, size_t MR, size_t NR>
+	void
+	gemm_accumulate(size_t kc, const T *a, const T *b, T *ab)
+	{
+		std::fill(ab, ab + MR * NR, T(0));
+
+		for (size_t p = 0; p < kc; ++p, a += MR, b += NR)
+		{
+			for (size_t i = 0; i < MR; ++i)
+			{
+				for (size_t j = 0; j < NR; ++j)
+				{
+					ab[i * NR + j] += a[i] * b[j];
+				}
+			}
+		}
+	}
+
+	template <typename T>
+	const gemm_blocking<T> &
+	gemm_blocking<T>::get()
+	{
+		static const gemm_blocking result(4, 4, gemm_accumulate<T, 4, 4>);
+
+		return result;
+	}
+
+	/**
+	 * “float” and “double” use the SIMD kernels.
+	 */
+	template <>
+	inline
+	const gemm_blocking<float> &
+	gemm_blocking<float>::get()
+	{
+		static const simd::kernels<float> &k = simd::kernels<float>::get();
+		static const gemm_blocking result(k.mr, k.nr, k.gemm);
+
+		return result;
+	}
+	template <>
+	inline
+	const gemm_blocking<double> &
+	gemm_blocking<double>::get()
+	{
+		static const simd::kernels<double> &k = simd::kernels<double>::get();
+		static const gemm_blocking result(k.mr, k.nr, k.gemm);
+
+		return result;
+	}
+
+	/**
+	 * Uninitialized and aligned storage for the packed blocks, which are
+	 * entirely written before being read.
+	 *
+	 * Requirements:
+	 * - T must be an arithmetic type (its values are neither constructed
+	 *   nor destroyed).
+	 */
+	template <typename T>
+	class gemm_buffer
+	{
+	public:
+
+		explicit
+		gemm_buffer(size_t n)
+			: _size(n), _values(_allocator.allocate(n))
+		{}
+
+		~gemm_buffer()
+		{
+			_allocator.deallocate(_values, _size);
+		}
+
+		T *
+		get()
+		{
+			return _values;
+		}
+
+	private:
+
+		aligned_allocator<T> _allocator;
+
+		const size_t _size;
+
+		T *const _values;
+
+		gemm_buffer(const gemm_buffer &);
+		gemm_buffer &operator=(const gemm_buffer &);
+	};
+
+	/**
+	 * Computes C = alpha * A * B + beta * C with plain loops, for the
+	 * products which are too small to amortize the packing.
+	 *
+	 * When beta is zero, C is not read.
+	 */
+	template <typename T>
+	void
+	gemm_small(size_t m, size_t n, size_t k, T alpha,
+	           const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	           const T *b, ptrdiff_t rsb, ptrdiff_t csb,
+	           T beta, T *c, ptrdiff_t rsc, ptrdiff_t csc)
+	{
+		for (size_t i = 0; i < m; ++i, a += rsa, c += rsc)
+		{
+			for (size_t j = 0; j < n; ++j)
+			{
+				const T *ap = a, *bp = b + j * csb;
+				T tmp(0);
+				for (size_t p = 0; p < k; ++p, ap += csa, bp += rsb)
+				{
+					tmp += *ap * *bp;
+				}
+
+				T &cij = c[j * csc];
+				cij = (beta == T(0) ? alpha * tmp : alpha * tmp + beta * cij);
+			}
+		}
+	}
+
+	/**
+	 * Packs a mc × kc block of A into MR-row panels.
+	 *
+	 * Each panel is stored column after column (i.e. MR consecutive values
+	 * per k) and the last one is padded with zeros, so that the micro-kernel
+	 * never has to care about edges.
+	 */
+	template <typename T>
+	void
+	gemm_pack_a(size_t MR, size_t mc, size_t kc, const T *a, ptrdiff_t rsa,
+	            ptrdiff_t csa, T *buffer)
+	{
+		for (size_t ir = 0; ir < mc; ir += MR)
+		{
+			const size_t mr = std::min<size_t>(MR, mc - ir);
+			const T *panel = a + ir * rsa;
+
+			for (size_t p = 0; p < kc; ++p)
+			{
+				size_t i = 0;
+				for (; i < mr; ++i)
+				{
+					*buffer++ = panel[i * rsa + p * csa];
+				}
+				for (; i < MR; ++i)
+				{
+					*buffer++ = T(0);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Packs a kc × nc block of B into NR-column panels (NR consecutive
+	 * values per k), the last one being padded with zeros.
+	 */
+	template <typename T>
+	void
+	gemm_pack_b(size_t NR, size_t kc, size_t nc, const T *b, ptrdiff_t rsb,
+	            ptrdiff_t csb, T *buffer)
+	{
+		for (size_t jr = 0; jr < nc; jr += NR)
+		{
+			const size_t nr = std::min<size_t>(NR, nc - jr);
+			const T *panel = b + jr * csb;
+
+			for (size_t p = 0; p < kc; ++p)
+			{
+				size_t j = 0;
+				for (; j < nr; ++j)
+				{
+					*buffer++ = panel[p * rsb + j * csb];
+				}
+				for (; j < NR; ++j)
+				{
+					*buffer++ = T(0);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Computes C = alpha * A * B + beta * C for a MR × NR block where A and B
+	 * are packed panels, ab being a buffer of MR × NR values.
+	 *
+	 * Only the mr × nr upper-left part of C is written, and C is not read
+	 * when beta is zero.
+	 */
+	template <typename T>
+	void
+	gemm_micro_kernel(const gemm_blocking<T> &blocking, size_t kc,
+	                  const T &alpha, const T *a, const T *b, const T &beta,
+	                  T *c, ptrdiff_t rsc, ptrdiff_t csc, size_t mr,
+	                  size_t nr, T *ab)
+	{
+		const size_t NR = blocking.nr;
+
+		blocking.accumulate(kc, a, b, ab);
+
+		for (size_t i = 0; i < mr; ++i)
+		{
+			for (size_t j = 0; j < nr; ++j)
+			{
+				T &cij = c[i * rsc + j * csc];
+
+				if (beta == T(0))
+				{
+					cij = alpha * ab[i * NR + j];
+				}
+				else
+				{
+					cij = alpha * ab[i * NR + j] + beta * cij;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Computes the m × nc block C = alpha * A * B + beta * C where A is m ×
+	 * kc and B is a packed kc × nc panel (see “gemm_pack_b()”).
+	 *
+	 * A is packed by mc × kc blocks in packed_a, ab is a buffer of mr × nr
+	 * values.
+	 */
+	template <typename T>
+	void
+	gemm_macro_kernel(const gemm_blocking<T> &blocking, size_t m, size_t nc,
+	                  size_t kc, const T &alpha,
+	                  const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	                  const T *packed_b, const T &beta,
+	                  T *c, ptrdiff_t rsc, ptrdiff_t csc,
+	                  T *packed_a, T *ab)
+	{
+		const size_t
+			MR = blocking.mr,
+			NR = blocking.nr,
+			MC = blocking.mc;
+
+		for (size_t ic = 0; ic < m; ic += MC)
+		{
+			const size_t mc = std::min(MC, m - ic);
+
+			gemm_pack_a(MR, mc, kc, a + ic * rsa, rsa, csa, packed_a);
+
+			for (size_t jr = 0; jr < nc; jr += NR)
+			{
+				const size_t nr = std::min(NR, nc - jr);
+
+				for (size_t ir = 0; ir < mc; ir += MR)
+				{
+					const size_t mr = std::min(MR, mc - ir);
+
+					gemm_micro_kernel(blocking, kc, alpha, packed_a + ir * kc,
+					                  packed_b + jr * kc, beta,
+					                  c + (ic + ir) * rsc + jr * csc, rsc, csc,
+					                  mr, nr, ab);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Computes C = alpha * A * B + beta * C where A is m × k, B is k × n and C
+	 * is m × n.
+	 *
+	 * Each matrix is described by a pointer to its first element, its row
+	 * stride and its column stride (in elements), so any storage order or
+	 * transposition can be used without copying.
+	 *
+	 * The product is cache-blocked (Goto's algorithm): B is packed by kc × nc
+	 * panels, A by mc × kc blocks and a register-tiled micro-kernel computes
+	 * mr × nr blocks of C (see “gemm_blocking”).
+	 *
+	 * When beta is zero, C is not read (it may be uninitialized).
+	 *
+	 * Requirements:
+	 * - T must be an arithmetic type (see “meta::is_arithmetic”).
+	 */
+	template <typename T>
+	void
+	gemm(size_t m, size_t n, size_t k, const T &alpha,
+	     const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	     const T *b, ptrdiff_t rsb, ptrdiff_t csb,
+	     const T &beta, T *c, ptrdiff_t rsc, ptrdiff_t csc)
+	{
+		if ((m == 0) || (n == 0))
+		{
+			return;
+		}
+
+		// Under this number of multiplications, the packing costs more
+		// than it saves.
+		const size_t threshold = 16 * 16 * 16;
+
+		if ((k == 0) || (alpha == T(0)))
+		{
+			for (size_t i = 0; i < m; ++i)
+			{
+				for (size_t j = 0; j < n; ++j)
+				{
+					T &cij = c[i * rsc + j * csc];
+					cij = (beta == T(0) ? T(0) : beta * cij);
+				}
+			}
+			return;
+		}
+
+		if ((m * n * k) < threshold)
+		{
+			gemm_small(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, rsc,
+			           csc);
+			return;
+		}
+
+		const gemm_blocking<T> &blocking = gemm_blocking<T>::get();
+		const size_t
+			MR = blocking.mr,
+			NR = blocking.nr,
+			MC = blocking.mc,
+			KC = blocking.kc,
+			NC = blocking.nc;
+
+		// The buffers are only as large as the operands need.
+		const size_t kc_max = std::min(KC, k);
+		gemm_buffer<T>
+			packed_a(std::min(MC, (m + MR - 1) / MR * MR) * kc_max),
+			packed_b(std::min(NC, (n + NR - 1) / NR * NR) * kc_max),
+			ab(MR * NR);
+
+		for (size_t jc = 0; jc < n; jc += NC)
+		{
+			const size_t nc = std::min(NC, n - jc);
+
+			for (size_t pc = 0; pc < k; pc += KC)
+			{
+				const size_t kc = std::min(KC, k - pc);
+
+				// C must be scaled by beta only once.
+				const T beta_pc = (pc == 0 ? beta : T(1));
+
+				gemm_pack_b(NR, kc, nc, b + pc * rsb + jc * csb, rsb, csb,
+				            packed_b.get());
+
+				gemm_macro_kernel(blocking, m, nc, kc, alpha,
+				                  a + pc * csa, rsa, csa, packed_b.get(),
+				                  beta_pc, c + jc * csc, rsc, csc,
+				                  packed_a.get(), ab.get());
+			}
+		}
+	}
+
+	/**
+	 * Packs a kc × nc panel of B, one NR-column sliver by index.
+	 */
+	template <typename T>
+	class gemm_pack_task : public parallel_task
+	{
+	public:
+
+		gemm_pack_task(size_t nr, size_t kc, size_t nc, const T *b,
+		               ptrdiff_t rsb, ptrdiff_t csb, T *packed_b)
+			: _nr(nr), _kc(kc), _nc(nc), _b(b), _rsb(rsb), _csb(csb),
+			  _packed_b(packed_b)
+		{}
+
+		size_t
+		slivers() const
+		{
+			return ((_nc + _nr - 1) / _nr);
+		}
+
+		void
+		operator()(size_t s)
+		{
+			const size_t j = s * _nr;
+
+			gemm_pack_b(_nr, _kc, std::min(_nr, _nc - j), _b + j * _csb, _rsb,
+			            _csb, _packed_b + j * _kc);
+		}
+
+	private:
+
+		const size_t _nr, _kc, _nc;
+
+		const T *const _b;
+		const ptrdiff_t _rsb, _csb;
+
+		T *const _packed_b;
+	};
+
+	/**
+	 * Computes one tile of the m × nc block C = alpha * A * B + beta * C
+	 * where B is a packed panel shared by all the tiles, which are numbered
+	 * row after row.
+	 *
+	 * Each tile packs its own blocks of A.
+	 */
+	template <typename T>
+	class gemm_task : public parallel_task
+	{
+	public:
+
+		gemm_task(const gemm_blocking<T> &blocking, size_t m, size_t nc,
+		          size_t kc, size_t tile_rows, size_t tile_columns,
+		          const T &alpha, const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+		          const T *packed_b, const T &beta,
+		          T *c, ptrdiff_t rsc, ptrdiff_t csc)
+			: _blocking(blocking), _m(m), _nc(nc), _kc(kc),
+			  _tile_rows(tile_rows), _tile_columns(tile_columns),
+			  _tiles_by_row((nc + tile_columns - 1) / tile_columns),
+			  _alpha(alpha), _a(a), _rsa(rsa), _csa(csa),
+			  _packed_b(packed_b), _beta(beta), _c(c), _rsc(rsc), _csc(csc)
+		{}
+
+		size_t
+		tiles() const
+		{
+			return (((_m + _tile_rows - 1) / _tile_rows) * _tiles_by_row);
+		}
+
+		void
+		operator()(size_t t)
+		{
+			const size_t
+				i = (t / _tiles_by_row) * _tile_rows,
+				j = (t % _tiles_by_row) * _tile_columns,
+				rows = std::min(_tile_rows, _m - i),
+				MR = _blocking.mr;
+
+			gemm_buffer<T>
+				packed_a(std::min(_blocking.mc, (rows + MR - 1) / MR * MR)
+				         * _kc),
+				ab(MR * _blocking.nr);
+
+			gemm_macro_kernel(_blocking, rows,
+			                  std::min(_tile_columns, _nc - j), _kc, _alpha,
+			                  _a + i * _rsa, _rsa, _csa, _packed_b + j * _kc,
+			                  _beta, _c + i * _rsc + j * _csc, _rsc, _csc,
+			                  packed_a.get(), ab.get());
+		}
+
+	private:
+
+		const gemm_blocking<T> &_blocking;
+
+		const size_t _m, _nc, _kc, _tile_rows, _tile_columns, _tiles_by_row;
+
+		const T _alpha;
+
+		const T *const _a;
+		const ptrdiff_t _rsa, _csa;
+
+		const T *const _packed_b;
+
+		const T _beta;
+
+		T *const _c;
+		const ptrdiff_t _rsc, _csc;
+	};
+
+	/**
+	 * Under this number of multiplications, a product is not worth being
+	 * split between threads.
+	 */
+	const size_t gemm_parallel_threshold = 64 * 64 * 64;
+
+	/**
+	 * Parallel version of “gemm()”.
+	 *
+	 * For each kc × nc panel of B, the panel is packed once by the executor
+	 * and C is split in tiles which are computed independently, all of them
+	 * reading the same packed panel.
+	 *
+	 * Small products are computed in the calling thread.
+	 */
+	template <typename T>
+	void
+	gemm(executor &e, size_t m, size_t n, size_t k, const T &alpha,
+	     const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	     const T *b, ptrdiff_t rsb, ptrdiff_t csb,
+	     const T &beta, T *c, ptrdiff_t rsc, ptrdiff_t csc)
+	{
+		const size_t concurrency = e.concurrency();
+
+		if ((concurrency == 1) || ((m * n * k) < gemm_parallel_threshold)
+		    || (alpha == T(0)))
+		{
+			gemm(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, rsc, csc);
+			return;
+		}
+
+		const gemm_blocking<T> &blocking = gemm_blocking<T>::get();
+		const size_t
+			MR = blocking.mr,
+			NR = blocking.nr,
+			MC = blocking.mc,
+			KC = blocking.kc,
+			NC = blocking.nc,
+			min_tile = 64,
+			target = 4 * concurrency;
+
+		gemm_buffer<T>
+			packed_b(std::min(NC, (n + NR - 1) / NR * NR) * std::min(KC, k));
+
+		for (size_t jc = 0; jc < n; jc += NC)
+		{
+			const size_t nc = std::min(NC, n - jc);
+
+			// Splits the biggest dimension until there are enough tiles to
+			// keep every thread busy even if they do not run at the same
+			// speed.
+			size_t
+				tile_rows = std::min(MC, (m + MR - 1) / MR * MR),
+				tile_columns = (nc + NR - 1) / NR * NR;
+
+			while ((((m + tile_rows - 1) / tile_rows)
+			        * ((nc + tile_columns - 1) / tile_columns)) < target)
+			{
+				if ((tile_rows >= tile_columns) && (tile_rows > min_tile))
+				{
+					tile_rows = (tile_rows / 2 + MR - 1) / MR * MR;
+				}
+				else if (tile_columns > min_tile)
+				{
+					tile_columns = (tile_columns / 2 + NR - 1) / NR * NR;
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			for (size_t pc = 0; pc < k; pc += KC)
+			{
+				const size_t kc = std::min(KC, k - pc);
+
+				// C must be scaled by beta only once.
+				const T beta_pc = (pc == 0 ? beta : T(1));
+
+				gemm_pack_task<T> pack(NR, kc, nc, b + pc * rsb + jc * csb,
+				                       rsb, csb, packed_b.get());
+				e.run(pack, pack.slivers());
+
+				gemm_task<T> task(blocking, m, nc, kc, tile_rows,
+				                  tile_columns, alpha, a + pc * csa, rsa, csa,
+				                  packed_b.get(), beta_pc, c + jc * csc, rsc,
+				                  csc);
+				e.run(task, task.tiles());
+			}
+		}
+	}
+} // namespace matrix_details
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_MATRIX_GEMM
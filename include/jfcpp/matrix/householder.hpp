@@ -0,0 +1,305 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_HOUSEHOLDER
+#define H_JFCPP_MATRIX_HOUSEHOLDER
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../simd.hpp"
+#include "../thread_pool.hpp"
+#include "gemm.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Householder reflectors, shared by the orthogonal decompositions.
+ *
+ * A reflector is “H = I - tau × v × vᵀ” where v(0) = 1.  A block of k
+ * reflectors is stored as a k × m matrix V whose row p is v_p (zeros
+ * included, so that the strides can describe either rows or columns of
+ * another matrix) and the product “H_0 × … × H_{k-1}” is “I - Vᵀ × T × V”
+ * where T is a k × k upper triangular matrix (compact WY form), which allows
+ * to apply the block with matrix products.
+ */
+namespace matrix_details
+{
+	/**
+	 * Sum of x[i] × y[i] for i in [0, n).
+	 */
+	template <typename T>
+	T
+	dot(size_t n, const T *x, const T *y)
+	{
+		T result(0);
+		for (size_t i = 0; i < n; ++i)
+		{
+			result += x[i] * y[i];
+		}
+
+		return result;
+	}
+
+	/**
+	 * y[i] += a × x[i] for i in [0, n).
+	 */
+	template <typename T>
+	void
+	axpy(size_t n, const T &a, const T *x, T *y)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			y[i] += a * x[i];
+		}
+	}
+
+	/**
+	 * (x[i], y[i]) = (c × x[i] - s × y[i], s × x[i] + c × y[i]) for i in [0,
+	 * n).
+	 */
+	template <typename T>
+	void
+	rotate(size_t n, const T &c, const T &s, T *x, T *y)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			const T xi = x[i], yi = y[i];
+
+			x[i] = c * xi - s * yi;
+			y[i] = s * xi + c * yi;
+		}
+	}
+
+	/**
+	 * “float” and “double” use the SIMD kernels.
+	 */
+#	define JFCPP_MATRIX_LEVEL1_SIMD(T) \
+	inline \
+	T \
+	dot(size_t n, const T *x, const T *y) \
+	{ \
+		return simd::kernels<T>::get().dot(n, x, y); \
+	} \
+	inline \
+	void \
+	axpy(size_t n, const T &a, const T *x, T *y) \
+	{ \
+		simd::kernels<T>::get().axpy(n, a, x, y); \
+	} \
+	inline \
+	void \
+	rotate(size_t n, const T &c, const T &s, T *x, T *y) \
+	{ \
+		simd::kernels<T>::get().rotate(n, c, s, x, y); \
+	}
+
+	JFCPP_MATRIX_LEVEL1_SIMD(float)
+	JFCPP_MATRIX_LEVEL1_SIMD(double)
+
+#	undef JFCPP_MATRIX_LEVEL1_SIMD
+
+	/**
+	 * √(a² + b²) without intermediate overflow.
+	 */
+	template <typename T>
+	T
+	hypot(const T &a, const T &b)
+	{
+		const T x = std::abs(a), y = std::abs(b);
+		const T big = std::max(x, y), small = std::min(x, y);
+
+		if (big == T(0))
+		{
+			return T(0);
+		}
+
+		const T r = small / big;
+
+		return big * std::sqrt(T(1) + r * r);
+	}
+
+	/**
+	 * Computes the reflector which maps (alpha, x) to (beta, 0).
+	 *
+	 * alpha is replaced by beta and x (n values spaced by incx) by the
+	 * values of v after the leading 1.  When x is already null, H = I.
+	 *
+	 * @return tau.
+	 */
+	template <typename T>
+	T
+	householder(T &alpha, size_t n, T *x, ptrdiff_t incx)
+	{
+		// Scaled norm to avoid overflows and underflows.
+		T scale(0);
+		for (size_t i = 0; i < n; ++i)
+		{
+			scale = std::max(scale, std::abs(x[i * incx]));
+		}
+		if (scale == T(0))
+		{
+			return T(0);
+		}
+
+		T sum(0);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const T y = x[i * incx] / scale;
+			sum += y * y;
+		}
+
+		const T norm = scale * std::sqrt(sum);
+		const T r = hypot(alpha, norm);
+		const T beta = (alpha < T(0)) ? r : -r;
+		const T tau = (beta - alpha) / beta;
+		const T s = T(1) / (alpha - beta);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i * incx] *= s;
+		}
+		alpha = beta;
+
+		return tau;
+	}
+
+	/**
+	 * Computes the triangular factor T (k × k, row by row with the leading
+	 * dimension ldt, its lower part is zeroed) of a block of reflectors.
+	 */
+	template <typename T>
+	void
+	reflector_factor(size_t k, size_t m, const T *v, ptrdiff_t rsv,
+	                 ptrdiff_t csv, const T *tau, T *t, size_t ldt)
+	{
+		if (k == 0)
+		{
+			return;
+		}
+
+		// G = V × Vᵀ.
+		std::vector<T> g(k * k);
+		gemm(k, k, m, T(1), v, rsv, csv, v, csv, rsv, T(0), &g[0], k, 1);
+
+		for (size_t i = 0; i < k; ++i)
+		{
+			T *column = t + i;
+
+			for (size_t q = i + 1; q < k; ++q)
+			{
+				column[q * ldt] = T(0);
+			}
+			column[i * ldt] = tau[i];
+
+			// T(0:i, i) = -tau_i × T(0:i, 0:i) × V(0:i) × v_i.
+			for (size_t q = 0; q < i; ++q)
+			{
+				T s(0);
+				for (size_t p = q; p < i; ++p)
+				{
+					s += t[q * ldt + p] * g[p * k + i];
+				}
+				column[q * ldt] = -tau[i] * s;
+			}
+		}
+	}
+
+	/**
+	 * Below this number of columns of C, the reflectors are applied column
+	 * by column: packing V for the matrix products would cost more than
+	 * the products themselves.
+	 */
+	enum { narrow_reflected = 4 };
+
+	/**
+	 * C = (I - Vᵀ × T × V) × C, or (I - Vᵀ × Tᵀ × V) × C (the transpose of
+	 * the block) if “transposed” is true.
+	 *
+	 * C is m × n, with the row and column strides rsc and csc.
+	 */
+	template <typename T>
+	void
+	apply_reflectors(executor &e, bool transposed, size_t k, size_t m,
+	                 const T *v, ptrdiff_t rsv, ptrdiff_t csv, const T *t,
+	                 size_t ldt, size_t n, T *c, ptrdiff_t rsc, ptrdiff_t csc)
+	{
+		if ((k == 0) || (m == 0) || (n == 0))
+		{
+			return;
+		}
+
+		if ((n < size_t(narrow_reflected)) && (csv == 1))
+		{
+			std::vector<T> x(m), w(k), tw(k);
+
+			for (size_t j = 0; j < n; ++j)
+			{
+				for (size_t i = 0; i < m; ++i)
+				{
+					x[i] = c[i * rsc + j * csc];
+				}
+
+				for (size_t p = 0; p < k; ++p)
+				{
+					w[p] = dot(m, v + p * rsv, &x[0]);
+				}
+				for (size_t p = 0; p < k; ++p)
+				{
+					T s(0);
+					for (size_t q = 0; q < k; ++q)
+					{
+						s += (transposed ? t[q * ldt + p] : t[p * ldt + q])
+							* w[q];
+					}
+					tw[p] = s;
+				}
+				for (size_t p = 0; p < k; ++p)
+				{
+					axpy(m, -tw[p], v + p * rsv, &x[0]);
+				}
+
+				for (size_t i = 0; i < m; ++i)
+				{
+					c[i * rsc + j * csc] = x[i];
+				}
+			}
+
+			return;
+		}
+
+		std::vector<T> w(k * n), tw(k * n);
+
+		// W = V × C.
+		gemm(e, k, n, m, T(1), v, rsv, csv, c, rsc, csc, T(0), &w[0], n, 1);
+
+		// W = T × W (or Tᵀ × W).
+		gemm(e, k, n, k, T(1), t, transposed ? 1 : ldt,
+		     transposed ? ldt : 1, &w[0], n, 1, T(0), &tw[0], n, 1);
+
+		// C -= Vᵀ × W.
+		gemm(e, m, n, k, T(-1), v, csv, rsv, &tw[0], n, 1, T(1), c, rsc, csc);
+	}
+} // namespace matrix_details
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_MATRIX_HOUSEHOLDER
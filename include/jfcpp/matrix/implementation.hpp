@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <new>
 #include <ostream>
 #include <stdexcept>
 
@@ -27,14 +28,246 @@
 #include "../algorithm.hpp"
 #include "../common.hpp"
 #include "../functional.hpp"
+#include "../meta/enable_if.hpp"
+#include "../meta/is_arithmetic.hpp"
+#include "../meta/is_same.hpp"
+#include "../simd.hpp"
+#include "../thread_pool.hpp"
+#include "gemm.hpp"
 
 JFCPP_NAMESPACE_BEGIN
 
-template <typename T>
-matrix<T>
-matrix<T>::identity(size_t dim, const_reference zero, const_reference one)
+namespace matrix_details
 {
-	matrix<T> id(dim, dim, zero);
+	/**
+	 * Applies an assignment operation (e.g. “+=”) element-wise between two
+	 * ranges.
+	 */
+	template <typename T, typename T2, class Operation>
+	void
+	apply(T *first, T *last, const T2 *other, Operation op)
+	{
+		algorithm::apply(first, last, other, op);
+	}
+
+	/**
+	 * Applies an assignment operation (e.g. “+=”) with a scalar to each
+	 * element of a range.
+	 */
+	template <typename T, typename T2, class Operation>
+	void
+	apply_scalar(T *first, T *last, const T2 &s, Operation op)
+	{
+		algorithm::apply(first, last, std::bind2nd(op, s));
+	}
+
+	/**
+	 * “float” and “double” use the SIMD kernels.
+	 *
+	 * The scalar version is only used if converting the scalar to T first
+	 * does not change the result (same type or integer).
+	 */
+#	define JFCPP_MATRIX_SIMD_OPERATION(T, FUNC_NAME, KERNEL) \
+	inline \
+	void \
+	apply(T *first, T *last, const T *other, \
+	      functional::FUNC_NAME##_assign<T, T>) \
+	{ \
+		simd::kernels<T>::get().KERNEL(last - first, first, other); \
+	} \
+	template <typename T2> \
+	typename meta::enable_if<meta::is_same<T, T2>::value \
+	                         || meta::is_integral<T2>::value>::type \
+	apply_scalar(T *first, T *last, const T2 &s, \
+	             functional::FUNC_NAME##_assign<T, T2>) \
+	{ \
+		simd::kernels<T>::get().KERNEL##_scalar(last - first, first, T(s)); \
+	}
+
+	JFCPP_MATRIX_SIMD_OPERATION(float, plus, add)
+	JFCPP_MATRIX_SIMD_OPERATION(float, minus, subtract)
+	JFCPP_MATRIX_SIMD_OPERATION(float, multiplies, multiply)
+	JFCPP_MATRIX_SIMD_OPERATION(float, divides, divide)
+
+	JFCPP_MATRIX_SIMD_OPERATION(double, plus, add)
+	JFCPP_MATRIX_SIMD_OPERATION(double, minus, subtract)
+	JFCPP_MATRIX_SIMD_OPERATION(double, multiplies, multiply)
+	JFCPP_MATRIX_SIMD_OPERATION(double, divides, divide)
+
+#	undef JFCPP_MATRIX_SIMD_OPERATION
+
+	/**
+	 * Generic matrix product, used when the types are not arithmetic (e.g.
+	 * “rational” or “mpz_class”) or when they differ.
+	 */
+	template <typename T, typename T2,
+	          bool = (meta::is_same<T, T2>::value
+	                  && meta::is_arithmetic<T>::value)>
+	struct mprod_helper
+	{
+		/**
+		 * Computes the rows of the result by blocks.
+		 */
+		template <class M, class M2>
+		class task : public parallel_task
+		{
+		public:
+
+			static const size_t rows_by_block = 16;
+
+			task(const M &a, const M2 &b, M &result)
+				: _a(a), _b(b), _result(result)
+			{}
+
+			size_t
+			blocks() const
+			{
+				return ((_result.rows() + rows_by_block - 1) / rows_by_block);
+			}
+
+			void
+			operator()(size_t block)
+			{
+				const size_t
+					first = block * rows_by_block,
+					last = std::min(first + rows_by_block, _result.rows());
+
+				for (size_t i = first; i < last; ++i)
+				{
+					for (size_t j = 0; j < _result.columns(); ++j)
+					{
+						T tmp(0);
+						for (size_t k = 0; k < _a.columns(); ++k)
+						{
+							tmp += _a(i, k) * _b(k, j);
+						}
+						_result(i, j) = tmp;
+					}
+				}
+			}
+
+		private:
+
+			const M &_a;
+
+			const M2 &_b;
+
+			M &_result;
+		};
+
+		template <class A, class L, class A2, class L2>
+		static
+		void
+		compute(const matrix<T, A, L> &a, const matrix<T2, A2, L2> &b,
+		        matrix<T, A, L> &result, executor &e)
+		{
+			task<matrix<T, A, L>, matrix<T2, A2, L2> > t(a, b, result);
+
+			e.run(t, t.blocks());
+		}
+	};
+
+	/**
+	 * Arithmetic types use the cache-blocked GEMM engine, which accepts any
+	 * strides and therefore any layout of the operands.
+	 */
+	template <typename T>
+	struct mprod_helper<T, T, true>
+	{
+		template <class A, class L, class A2, class L2>
+		static
+		void
+		compute(const matrix<T, A, L> &a, const matrix<T, A2, L2> &b,
+		        matrix<T, A, L> &result, executor &e)
+		{
+			const size_t m = a.rows(), n = b.columns(), k = a.columns();
+
+			gemm(e, m, n, k, T(1),
+			     a.begin(), L::row_stride(m, k), L::column_stride(m, k),
+			     b.begin(), L2::row_stride(k, n), L2::column_stride(k, n),
+			     T(0), result.begin(), L::row_stride(m, n),
+			     L::column_stride(m, n));
+		}
+	};
+
+	/**
+	 * Applies “*result = op(*first)” to n elements separated by stride.
+	 */
+	template <typename T, class UnaryOperator>
+	void
+	transform(size_t n, const T *first, T *result, size_t stride,
+	          UnaryOperator op)
+	{
+		if (stride == 1)
+		{
+			std::transform(first, first + n, result, op);
+			return;
+		}
+
+		for (size_t i = 0; i < n; ++i, first += stride, result += stride)
+		{
+			*result = op(*first);
+		}
+	}
+
+	/**
+	 * Applies “*result = op(*first1, *first2)” to n elements separated by
+	 * stride.
+	 */
+	template <typename T, class BinaryOperator>
+	void
+	transform(size_t n, const T *first1, const T *first2, T *result,
+	          size_t stride, BinaryOperator op)
+	{
+		if (stride == 1)
+		{
+			std::transform(first1, first1 + n, first2, result, op);
+			return;
+		}
+
+		for (size_t i = 0; i < n;
+		     ++i, first1 += stride, first2 += stride, result += stride)
+		{
+			*result = op(*first1, *first2);
+		}
+	}
+
+	/**
+	 * Exchanges n elements separated by stride.
+	 */
+	template <typename T>
+	void
+	swap_ranges(size_t n, T *a, T *b, size_t stride)
+	{
+		if (stride == 1)
+		{
+			std::swap_ranges(a, a + n, b);
+			return;
+		}
+
+		for (size_t i = 0; i < n; ++i, a += stride, b += stride)
+		{
+			std::swap(*a, *b);
+		}
+	}
+
+	/**
+	 * Solves “a × X = B” where B is replaced by X, a is destroyed.
+	 */
+	template <typename T, class A, class L>
+	void
+	eliminate(matrix<T, A, L> &a, matrix<T, A, L> &B, executor &e)
+	{
+		elimination<T>::solve(a, B, e);
+	}
+} // namespace matrix_details
+
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::identity(size_t dim, const_reference zero,
+                               const_reference one, const Allocator &allocator)
+{
+	matrix<T, Allocator, Layout> id(dim, dim, zero, allocator);
 
 	for (size_t i = 0; i < id._rows; ++i)
 	{
@@ -44,64 +277,94 @@ matrix<T>::identity(size_t dim, const_reference zero, const_reference one)
 	return id;
 }
 
-template <typename T>
-matrix<T>::matrix(size_t dim)
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>::matrix(size_t dim)
 	: _rows(dim), _columns(dim), _size(dim * dim), _values(NULL),
-	  _values_by_rows(NULL)
+	  _allocator()
 {
 	this->allocate();
 
 	ensures(this->is_square());
 }
 
-template <typename T>
-matrix<T>::matrix(size_t rows, size_t columns)
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>::matrix(size_t rows, size_t columns,
+                             const Allocator &allocator)
 	: _rows(rows), _columns(columns), _size(rows * columns), _values(NULL),
-	  _values_by_rows(NULL)
+	  _allocator(allocator)
 {
 	this->allocate();
 }
 
-template <typename T>
-matrix<T>::matrix(size_t rows, size_t columns, const_reference value)
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>::matrix(size_t rows, size_t columns, const_reference value,
+                             const Allocator &allocator)
 	: _rows(rows), _columns(columns), _size(rows * columns), _values(NULL),
-	  _values_by_rows(NULL)
+	  _allocator(allocator)
 {
 	this->allocate();
 
 	std::fill(this->begin(), this->end(), value);
 }
 
-template <typename T>
-matrix<T>::matrix(const matrix<T> &m)
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>::matrix(const matrix<T, Allocator, Layout> &m)
 	: _rows(m._rows), _columns(m._columns), _size(m._size), _values(NULL),
-	  _values_by_rows(NULL)
+	  _allocator(m._allocator)
 {
 	this->allocate();
 
 	this->copy_values(m);
 }
 
-template <typename T>
-template <typename T2>
-matrix<T>::matrix(const matrix<T2> &m)
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>::matrix(matrix<T, Allocator, Layout> &&m)
+	: _rows(m._rows), _columns(m._columns), _size(m._size),
+	  _values(m._values), _allocator(m._allocator)
+{
+	m._rows = m._columns = m._size = 0;
+	m._values = NULL;
+}
+#endif
+
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
+matrix<T, Allocator, Layout>::matrix(const matrix<T2, A2, L2> &m)
 	: _rows(m.rows()), _columns(m.columns()), _size(m.size()), _values(NULL),
-	  _values_by_rows(NULL)
+	  _allocator(matrix_details::allocator_from<Allocator, A2>::get(
+		             m.get_allocator()))
 {
 	this->allocate();
 
 	this->copy_values(m);
 }
 
-template <typename T>
-matrix<T>::~matrix()
+template <typename T, class Allocator, class Layout>
+template <class E>
+matrix<T, Allocator, Layout>::matrix(const matrix_details::expression<E> &e)
+	: _rows(e.derived().rows()), _columns(e.derived().columns()),
+	  _size(_rows * _columns), _values(NULL),
+	  _allocator(matrix_details::allocator_from<Allocator,
+	                                            typename E::allocator_type>::get(
+		             e.derived().get_allocator()))
+{
+	this->allocate();
+
+	matrix_details::evaluate(this->_values, e.derived(),
+	                         matrix_details::assign<T, typename E::value_type>(),
+	                         Layout());
+}
+
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>::~matrix()
 {
 	this->deallocate();
 }
 
-template <typename T>
-typename matrix<T>::reference
-matrix<T>::at(size_t i)
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::reference
+matrix<T, Allocator, Layout>::at(size_t i)
 {
 	if (i >= this->_size)
 	{
@@ -111,17 +374,17 @@ matrix<T>::at(size_t i)
 	return (*this)(i);
 }
 
-template <typename T>
-typename matrix<T>::const_reference
-matrix<T>::at(size_t i) const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_reference
+matrix<T, Allocator, Layout>::at(size_t i) const
 {
 	// Reuse the implementation of at(size_t).
-	return const_cast<matrix<T> *>(this)->at(i);
+	return const_cast<matrix<T, Allocator, Layout> *>(this)->at(i);
 }
 
-template <typename T>
-typename matrix<T>::reference
-matrix<T>::at(size_t i, size_t j)
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::reference
+matrix<T, Allocator, Layout>::at(size_t i, size_t j)
 {
 	if (!this->is_valid_subscript(i, j))
 	{
@@ -131,59 +394,65 @@ matrix<T>::at(size_t i, size_t j)
 	return (*this)(i, j);
 }
 
-template <typename T>
-typename matrix<T>::const_reference
-matrix<T>::at(size_t i, size_t j) const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_reference
+matrix<T, Allocator, Layout>::at(size_t i, size_t j) const
 {
 	// Reuse the implementation of at(size_t, size_t).
-	return const_cast<matrix<T> *>(this)->at(i, j);
+	return const_cast<matrix<T, Allocator, Layout> *>(this)->at(i, j);
 }
 
-template <typename T>
-typename matrix<T>::iterator
-matrix<T>::begin()
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::iterator
+matrix<T, Allocator, Layout>::begin()
 {
 	return this->_values;
 }
 
-template <typename T>
-typename matrix<T>::const_iterator
-matrix<T>::begin() const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_iterator
+matrix<T, Allocator, Layout>::begin() const
 {
-	return const_cast<matrix<T> *>(this)->begin();
+	return const_cast<matrix<T, Allocator, Layout> *>(this)->begin();
 }
 
-template <typename T>
-typename matrix<T>::column_iterator
-matrix<T>::cbegin()
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::column_iterator
+matrix<T, Allocator, Layout>::cbegin()
 {
-	return column_iterator(*this, 0, 0);
+	return column_iterator(this->_values, this->_rows,
+	                       Layout::row_stride(this->_rows, this->_columns),
+	                       Layout::column_stride(this->_rows, this->_columns),
+	                       0, 0);
 }
 
-template <typename T>
-typename matrix<T>::const_column_iterator
-matrix<T>::cbegin() const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_column_iterator
+matrix<T, Allocator, Layout>::cbegin() const
 {
-	return const_column_iterator(*this, 0, 0);
+	return const_cast<matrix<T, Allocator, Layout> *>(this)->cbegin();
 }
 
-template <typename T>
-typename matrix<T>::column_iterator
-matrix<T>::cend()
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::column_iterator
+matrix<T, Allocator, Layout>::cend()
 {
-	return column_iterator(*this, 0, this->_columns);
+	return column_iterator(this->_values, this->_rows,
+	                       Layout::row_stride(this->_rows, this->_columns),
+	                       Layout::column_stride(this->_rows, this->_columns),
+	                       0, this->_columns);
 }
 
-template <typename T>
-typename matrix<T>::const_column_iterator
-matrix<T>::cend() const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_column_iterator
+matrix<T, Allocator, Layout>::cend() const
 {
-	return const_column_iterator(*this, 0, this->_columns);
+	return const_cast<matrix<T, Allocator, Layout> *>(this)->cend();
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::clear()
+matrix<T, Allocator, Layout>::clear()
 {
 	this->deallocate();
 
@@ -192,22 +461,25 @@ matrix<T>::clear()
 	this->_size = 0;
 
 	this->_values = NULL;
-	this->_values_by_rows = NULL;
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 size_t
-matrix<T>::columns() const
+matrix<T, Allocator, Layout>::columns() const
 {
 	return this->_columns;
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 T
-matrix<T>::det() const
+matrix<T, Allocator, Layout>::det() const
 {
 	requires (this->is_square());
 
+	// The storage of a column-major matrix is the one of its transpose,
+	// which has the same determinant: the expanded formulas below do not
+	// depend on the layout.
+
 	if (this->_rows == 1)
 	{
 		return this->_values[0];
@@ -220,7 +492,10 @@ matrix<T>::det() const
 		        this->_values[1] * this->_values[2]);
 	}
 
-	assert(this->_rows == 3);
+	if (this->_rows != 3)
+	{
+		return matrix_details::elimination<T>::det(*this);
+	}
 
 	return (this->_values[0] * this->_values[4] * this->_values[8]
 	        +
@@ -235,195 +510,294 @@ matrix<T>::det() const
 	        this->_values[0] * this->_values[5] * this->_values[7]);
 }
 
-template <typename T>
-typename matrix<T>::iterator
-matrix<T>::end()
+template <typename T, class Allocator, class Layout>
+T
+matrix<T, Allocator, Layout>::log_det(int &sign) const
+{
+	requires(this->is_square());
+
+	return lu<T, Allocator, Layout>(*this).log_det(sign);
+}
+
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::iterator
+matrix<T, Allocator, Layout>::end()
 {
 	return this->_values + this->_size;
 }
 
-template <typename T>
-typename matrix<T>::const_iterator
-matrix<T>::end() const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_iterator
+matrix<T, Allocator, Layout>::end() const
 {
-	return const_cast<matrix<T> *>(this)->end();
+	return const_cast<matrix<T, Allocator, Layout> *>(this)->end();
 }
 
-template <typename T>
-template <typename T2>
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::allocator_type
+matrix<T, Allocator, Layout>::get_allocator() const
+{
+	return this->_allocator;
+}
+
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
 bool
-matrix<T>::has_same_dimensions(const matrix<T2> &m) const
+matrix<T, Allocator, Layout>::has_same_dimensions(const matrix<T2, A2, L2> &m) const
 {
 	return ((this->_rows == m.rows()) && (this->_columns == m.columns()));
 }
 
-template <typename T>
-matrix<T>
-matrix<T>::inverse() const
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::inverse() const
+{
+	return matrix<T, Allocator, Layout>(*this).inverse_perf();
+}
+
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::inverse(executor &e) const
+{
+	return matrix<T, Allocator, Layout>(*this).inverse_perf(e);
+}
+
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::inverse_perf()
 {
-	return matrix<T>(*this).inverse_perf();
+	sequential_executor e;
+
+	return this->inverse_perf(e);
 }
 
-template <typename T>
-matrix<T>
-matrix<T>::inverse_perf()
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::inverse_perf(executor &e)
 {
 	requires(this->is_square());
 
-	matrix<T> inverse = matrix<T>::identity(this->_rows);
+	matrix<T, Allocator, Layout> result = identity(this->_rows, T(0), T(1),
+	                                       this->_allocator);
 
-	this->solve_perf(inverse);
+	matrix_details::eliminate(*this, result, e);
 
-	return inverse;
+	return result;
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 bool
-matrix<T>::is_valid_column(size_t j) const
+matrix<T, Allocator, Layout>::is_valid_column(size_t j) const
 {
 	return (j < this->_columns);
 }
 
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 bool
-matrix<T>::is_valid_row(size_t i) const
+matrix<T, Allocator, Layout>::is_valid_row(size_t i) const
 {
 	return (i < this->_rows);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 bool
-matrix<T>::is_valid_subscript(size_t i, size_t j) const
+matrix<T, Allocator, Layout>::is_valid_subscript(size_t i, size_t j) const
 {
 	return (this->is_valid_row(i) && this->is_valid_column(j));
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 bool
-matrix<T>::is_square() const
+matrix<T, Allocator, Layout>::is_square() const
 {
 	return (this->_rows == this->_columns);
 }
 
-template <typename T>
-template <typename T2>
-matrix<T>
-matrix<T>::mprod(const matrix<T2> &m) const
+template <typename T, class Allocator, class Layout>
+bool
+matrix<T, Allocator, Layout>::is_symmetric() const
 {
-	requires(this->_columns == m.rows());
+	if (!this->is_square())
+	{
+		return false;
+	}
 
-	matrix<T> result(this->_rows, m.columns());
-	for (size_t i = 0; i < result._rows; ++i)
+	for (size_t i = 0; i < this->_rows; ++i)
 	{
-		for (size_t j = 0; j < result._columns; ++j)
+		for (size_t j = 0; j < i; ++j)
 		{
-			T tmp(0);
-			for (size_t k = 0; k < this->_columns; ++k)
+			if (!((*this)(i, j) == (*this)(j, i)))
 			{
-				tmp += (*this)(i, k) * m(k, j);
+				return false;
 			}
-			result(i, j) = tmp;
 		}
 	}
+
+	return true;
+}
+
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::mprod(const matrix<T2, A2, L2> &m) const
+{
+	requires(this->_columns == m.rows());
+
+	sequential_executor e;
+
+	return this->mprod(m, e);
+}
+
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::mprod(const matrix<T2, A2, L2> &m, executor &e) const
+{
+	requires(this->_columns == m.rows());
+
+	matrix<T, Allocator, Layout> result(this->_rows, m.columns(),
+	                                   this->_allocator);
+
+	matrix_details::mprod_helper<T, T2>::compute(*this, m, result, e);
+
 	return result;
 }
 
-template<typename T>
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::mprod(const matrix<T2, A2, L2> &m, size_t threads) const
+{
+	// Starting threads costs more than a small product.
+	if ((threads == 1) || ((this->_rows * this->_columns * m.columns())
+	                       < matrix_details::gemm_parallel_threshold))
+	{
+		return this->mprod(m);
+	}
+
+	thread_pool &shared = thread_pool::instance();
+
+	if ((threads == 0) || (threads == shared.concurrency()))
+	{
+		return this->mprod(m, shared);
+	}
+
+	thread_pool pool(threads);
+
+	return this->mprod(m, pool);
+}
+
+template <typename T, class Allocator, class Layout>
 template<class UnaryOperator>
 void
-matrix<T>::op_column(size_t i, size_t j, UnaryOperator op)
+matrix<T, Allocator, Layout>::op_column(size_t i, size_t j, UnaryOperator op)
 {
 	requires(i < this->_columns);
 	requires(j < this->_columns);
 
-	for (size_t k = 0; k < this->_rows; ++k)
-	{
-		(*this)(k, j) = op((*this)(k, i));
-	}
+	const size_t r = this->_rows, c = this->_columns;
+
+	matrix_details::transform(r, this->_values + Layout::index(0, i, r, c),
+	                          this->_values + Layout::index(0, j, r, c),
+	                          Layout::row_stride(r, c), op);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 template<class BinaryOperator>
 void
-matrix<T>::op_column(size_t i, size_t j, size_t k, BinaryOperator op)
+matrix<T, Allocator, Layout>::op_column(size_t i, size_t j, size_t k, BinaryOperator op)
 {
 	requires(i < this->_columns);
 	requires(j < this->_columns);
 	requires(k < this->_columns);
 
-	for (size_t l = 0; l < this->_rows; ++l)
-	{
-		(*this)(l, k) = op((*this)(l, i), (*this)(l, j));
-	}
+	const size_t r = this->_rows, c = this->_columns;
+
+	matrix_details::transform(r, this->_values + Layout::index(0, i, r, c),
+	                          this->_values + Layout::index(0, j, r, c),
+	                          this->_values + Layout::index(0, k, r, c),
+	                          Layout::row_stride(r, c), op);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 template<class UnaryOperator>
 void
-matrix<T>::op_row(size_t i, size_t j, UnaryOperator op)
+matrix<T, Allocator, Layout>::op_row(size_t i, size_t j, UnaryOperator op)
 {
 	requires(i < this->_rows);
 	requires(j < this->_rows);
 
-	iterator it = this->_values + this->_columns * i;
+	const size_t r = this->_rows, c = this->_columns;
 
-	std::transform(it, it + this->_columns, this->_values + this->_columns * j,
-	               op);
+	matrix_details::transform(c, this->_values + Layout::index(i, 0, r, c),
+	                          this->_values + Layout::index(j, 0, r, c),
+	                          Layout::column_stride(r, c), op);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 template<class BinaryOperator>
 void
-matrix<T>::op_row(size_t i, size_t j, size_t k, BinaryOperator op)
+matrix<T, Allocator, Layout>::op_row(size_t i, size_t j, size_t k, BinaryOperator op)
 {
 	requires(i < this->_rows);
 	requires(j < this->_rows);
 	requires(k < this->_rows);
 
-	iterator it = this->_values + this->_columns * i;
+	const size_t r = this->_rows, c = this->_columns;
 
-	std::transform(it, it + this->_columns, this->_values + this->_columns * j,
-	               this->_values + this->_columns * k, op);
+	matrix_details::transform(c, this->_values + Layout::index(i, 0, r, c),
+	                          this->_values + Layout::index(j, 0, r, c),
+	                          this->_values + Layout::index(k, 0, r, c),
+	                          Layout::column_stride(r, c), op);
 }
 
-template <typename T>
-typename matrix<T>::reverse_iterator
-matrix<T>::rbegin()
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::reverse_iterator
+matrix<T, Allocator, Layout>::rbegin()
 {
 	return reverse_iterator(this->end());
 }
 
-template <typename T>
-typename matrix<T>::const_reverse_iterator
-matrix<T>::rbegin() const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_reverse_iterator
+matrix<T, Allocator, Layout>::rbegin() const
 {
 	return reverse_iterator(this->end());
 }
 
-template <typename T>
-typename matrix<T>::reverse_iterator
-matrix<T>::rend()
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::reverse_iterator
+matrix<T, Allocator, Layout>::rend()
 {
 	return reverse_iterator(this->begin());
 }
 
-template <typename T>
-typename matrix<T>::const_reverse_iterator
-matrix<T>::rend() const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_reverse_iterator
+matrix<T, Allocator, Layout>::rend() const
 {
 	return reverse_iterator(this->begin());
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::resize(size_t rows, size_t columns)
+matrix<T, Allocator, Layout>::resize(size_t rows, size_t columns)
 {
 	if ((rows == this->_rows) && (columns == this->_columns))
 	{
 		return;
 	}
 
+	// Same number of values: the storage is reused.
+	if ((rows * columns) == this->_size)
+	{
+		this->_rows = rows;
+		this->_columns = columns;
+
+		return;
+	}
+
 	this->deallocate();
 
 	this->_rows = rows;
@@ -436,112 +810,105 @@ matrix<T>::resize(size_t rows, size_t columns)
 	validate(*this);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 size_t
-matrix<T>::rows() const
+matrix<T, Allocator, Layout>::rows() const
 {
 	return this->_rows;
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 size_t
-matrix<T>::size() const
+matrix<T, Allocator, Layout>::size() const
 {
 	return this->_size;
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::solve(matrix<T> &B) const
+matrix<T, Allocator, Layout>::solve(matrix<T, Allocator, Layout> &B) const
 {
-	matrix<T>(*this).solve_perf(B);
+	matrix<T, Allocator, Layout>(*this).solve_perf(B);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::solve_perf(matrix<T> &B)
+matrix<T, Allocator, Layout>::solve(matrix<T, Allocator, Layout> &B, executor &e) const
 {
-	requires(this->is_square());
-	requires(this->_columns == B._rows);
+	matrix<T, Allocator, Layout>(*this).solve_perf(B, e);
+}
 
-	// Row echelon form.
-	for (size_t i = 0; i < this->_rows; ++i)
-	{
-		const T pivot = (*this)(i, i);
+template <typename T, class Allocator, class Layout>
+void
+matrix<T, Allocator, Layout>::solve_perf(matrix<T, Allocator, Layout> &B)
+{
+	sequential_executor e;
 
-		for (size_t j = i + 1; j < this->_rows; ++j)
-		{
-			my_op op((*this)(j, i) / pivot);
+	this->solve_perf(B, e);
+}
 
-			this->op_row(j, i, j, op);
-			B.op_row(j, i, j, op);
-		}
-	}
+template <typename T, class Allocator, class Layout>
+void
+matrix<T, Allocator, Layout>::solve_perf(matrix<T, Allocator, Layout> &B, executor &e)
+{
+	requires(this->is_square());
+	requires(this->_columns == B._rows);
 
-	// Gauss-Jordan elimination.
-	for (size_t i = this->_rows; i > 0;)
-	{
-		--i;
-		for (size_t j = this->_columns - 1; j > i; --j)
-		{
-			if ((*this)(i, j) != 0)
-			{
-				B.op_row(i, j, i, my_op((*this)(i, j)));
-			}
-		}
-		B.op_row(i, i, std::bind2nd(std::divides<T>(), (*this)(i, i)));
-	}
+	matrix_details::eliminate(*this, B, e);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::swap(matrix<T> &m)
+matrix<T, Allocator, Layout>::swap(matrix<T, Allocator, Layout> &m)
 {
 	std::swap(this->_rows, m._rows);
 	std::swap(this->_columns, m._columns);
 	std::swap(this->_size, m._size);
 	std::swap(this->_values, m._values);
-	std::swap(this->_values_by_rows, m._values_by_rows);
+	std::swap(this->_allocator, m._allocator);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::swap_columns(size_t i, size_t j)
+matrix<T, Allocator, Layout>::swap_columns(size_t i, size_t j)
 {
 	requires(i != j);
 	requires(i < this->_columns);
 	requires(j < this->_columns);
 
-	for (size_t k = 0; k < this->_rows; ++k)
-	{
-		std::swap((*this)(k, i), (*this)(k, j));
-	}
+	const size_t r = this->_rows, c = this->_columns;
+
+	matrix_details::swap_ranges(r, this->_values + Layout::index(0, i, r, c),
+	                            this->_values + Layout::index(0, j, r, c),
+	                            Layout::row_stride(r, c));
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::swap_rows(size_t i, size_t j)
+matrix<T, Allocator, Layout>::swap_rows(size_t i, size_t j)
 {
 	requires(i != j);
 	requires(i < this->_rows);
 	requires(j < this->_rows);
 
-	std::swap_ranges(this->_values_by_rows[i],
-	                 this->_values_by_rows[i] + this->_columns,
-	                 this->_values_by_rows[j]);
+	const size_t r = this->_rows, c = this->_columns;
+
+	matrix_details::swap_ranges(c, this->_values + Layout::index(i, 0, r, c),
+	                            this->_values + Layout::index(j, 0, r, c),
+	                            Layout::column_stride(r, c));
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 T
-matrix<T>::trace() const
+matrix<T, Allocator, Layout>::trace() const
 {
 	return this->trace<T>();
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 template <typename R>
 R
-matrix<T>::trace() const
+matrix<T, Allocator, Layout>::trace() const
 {
 	requires(this->is_square());
 
@@ -555,42 +922,83 @@ matrix<T>::trace() const
 	return result;
 }
 
-template <typename T>
-matrix<T>
-matrix<T>::transpose() const
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>
+matrix<T, Allocator, Layout>::transpose() const
 {
-	matrix<T> result(this->_columns, this->_rows);
+	return matrix(this->transposed());
+}
 
-	for (size_t i = 0; i < this->_rows; ++i)
+template <typename T, class Allocator, class Layout>
+matrix_details::transposition<matrix<T, Allocator, Layout> >
+matrix<T, Allocator, Layout>::transposed() const
+{
+	return matrix_details::transposition<matrix<T, Allocator, Layout> >(*this);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+matrix<T, Allocator, Layout>::transpose_in_place()
+{
+	if (this->is_square())
 	{
-		for (size_t j = 0; j < this->_columns; ++j)
-		{
-			result(j, i) = (*this)(i, j);
-		}
+		matrix_details::transpose_square(this->_rows, this->_values,
+		                                 this->_columns);
+		return;
 	}
 
-	return result;
+	// The storage is transposed as an outer × inner row-major array.
+	matrix_details::transpose_cycles(Layout::outer(this->_rows, this->_columns),
+	                                 Layout::inner(this->_rows, this->_columns),
+	                                 this->_values);
+	std::swap(this->_rows, this->_columns);
 }
 
-template <typename T>
-template <typename T2>
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
 bool
-matrix<T>::operator==(const matrix<T2> &m) const
+matrix<T, Allocator, Layout>::operator==(const matrix<T2, A2, L2> &m) const
 {
 	return (this->has_same_dimensions(m) && this->has_same_values(m));
 }
 
-template <typename T>
-matrix<T> &
-matrix<T>::operator=(const matrix<T> &m)
+template <typename T, class Allocator, class Layout>
+template <class E>
+bool
+matrix<T, Allocator, Layout>::operator==(const matrix_details::expression<E> &e) const
+{
+	const E &x = e.derived();
+
+	if ((this->_rows != x.rows()) || (this->_columns != x.columns()))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		for (size_t j = 0; j < this->_columns; ++j)
+		{
+			if (!((*this)(i, j) == x(i, j)))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout> &
+matrix<T, Allocator, Layout>::operator=(const matrix<T, Allocator, Layout> &m)
 {
 	return this->operator= <T>(m);
 }
 
-template <typename T>
-template <typename T2>
-matrix<T> &
-matrix<T>::operator=(const matrix<T2> &m)
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
+matrix<T, Allocator, Layout> &
+matrix<T, Allocator, Layout>::operator=(const matrix<T2, A2, L2> &m)
 {
 	this->resize(m.rows(), m.columns());
 
@@ -599,13 +1007,60 @@ matrix<T>::operator=(const matrix<T2> &m)
 	return *this;
 }
 
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout> &
+matrix<T, Allocator, Layout>::operator=(matrix<T, Allocator, Layout> &&m)
+{
+	if (&m != this)
+	{
+		this->clear();
+		this->swap(m);
+	}
+
+	return *this;
+}
+#endif
+
+template <typename T, class Allocator, class Layout>
+template <class E>
+matrix<T, Allocator, Layout> &
+matrix<T, Allocator, Layout>::operator=(const matrix_details::expression<E> &e)
+{
+	const typename matrix_details::operand<E>::type x(e.derived());
+
+	// Resizing would destroy the values before they are read.
+	if (x.aliases(*this)
+	    || ((x.rows() != this->_rows || x.columns() != this->_columns)
+	        && x.references(*this)))
+	{
+		matrix<T, Allocator, Layout> tmp(x.rows(), x.columns(),
+		                                 this->_allocator);
+
+		matrix_details::evaluate(tmp._values, e.derived(),
+		                         matrix_details::assign<T, typename E::value_type>(),
+		                         Layout());
+		this->swap(tmp);
+
+		return *this;
+	}
+
+	this->resize(x.rows(), x.columns());
+
+	matrix_details::evaluate(this->_values, e.derived(),
+	                         matrix_details::assign<T, typename E::value_type>(),
+	                         Layout());
+
+	return *this;
+}
+
 // Unary operations (but increment).
 #define JFCPP_MATRIX_OPERATION(OP) \
-template <typename T> \
-matrix<T> \
-matrix<T>::operator OP() const \
+template <typename T, class Allocator, class Layout> \
+matrix<T, Allocator, Layout> \
+matrix<T, Allocator, Layout>::operator OP() const \
 { \
-	matrix result(this->rows(), this->columns()); \
+	matrix result(this->rows(), this->columns(), this->_allocator); \
  \
 	for (size_t i = 0; i < this->size(); ++i) \
 	{ \
@@ -623,9 +1078,9 @@ JFCPP_MATRIX_OPERATION(~)
 
 // Pre-incrementation.
 #define JFCPP_MATRIX_OPERATION(OP) \
-template <typename T> \
-matrix<T> & \
-matrix<T>::operator OP() \
+template <typename T, class Allocator, class Layout> \
+matrix<T, Allocator, Layout> & \
+matrix<T, Allocator, Layout>::operator OP() \
 { \
 	for (size_t i = 0; i < this->size(); ++i) \
 	{ \
@@ -641,11 +1096,11 @@ JFCPP_MATRIX_OPERATION(--)
 
 // Post-incrementation.
 #define JFCPP_MATRIX_OPERATION(OP) \
-template <typename T> \
-matrix<T> \
-matrix<T>::operator OP(int) \
+template <typename T, class Allocator, class Layout> \
+matrix<T, Allocator, Layout> \
+matrix<T, Allocator, Layout>::operator OP(int) \
 { \
-	matrix result(this->rows(), this->columns()); \
+	matrix result(this->rows(), this->columns(), this->_allocator); \
  \
 	for (size_t i = 0; i < this->size(); ++i) \
 	{ \
@@ -661,25 +1116,50 @@ JFCPP_MATRIX_OPERATION(--)
 
 // Binary operations.
 #define JFCPP_MATRIX_OPERATION(OP, FUNC_NAME) \
-template <typename T> \
-template <typename T2> \
-matrix<T> & \
-matrix<T>::operator OP##=(const matrix<T2> &m) \
+template <typename T, class Allocator, class Layout> \
+template <typename T2, class A2, class L2> \
+matrix<T, Allocator, Layout> & \
+matrix<T, Allocator, Layout>::operator OP##=(const matrix<T2, A2, L2> &m) \
 { \
 	requires(this->has_same_dimensions(m)); \
  \
-	algorithm::apply(this->begin(), this->end(), m.begin(), \
-	                 functional::FUNC_NAME##_assign<value_type, T2>()); \
+	if (!meta::is_same<Layout, L2>::value) \
+	{ \
+		return (*this OP##= static_cast<const matrix_details::expression<matrix<T2, A2, L2> > &>(m)); \
+	} \
+ \
+	matrix_details::apply(this->begin(), this->end(), m.begin(), \
+	                      functional::FUNC_NAME##_assign<value_type, T2>()); \
+ \
+	return *this; \
+} \
+template <typename T, class Allocator, class Layout> \
+template <class E> \
+matrix<T, Allocator, Layout> & \
+matrix<T, Allocator, Layout>::operator OP##=(const matrix_details::expression<E> &e) \
+{ \
+	const typename matrix_details::operand<E>::type x(e.derived()); \
+ \
+	requires((x.rows() == this->_rows) && (x.columns() == this->_columns)); \
+ \
+	if (x.aliases(*this)) \
+	{ \
+		return (*this OP##= matrix<typename E::value_type>(e.derived())); \
+	} \
+ \
+	matrix_details::evaluate(this->_values, x, \
+	                         functional::FUNC_NAME##_assign<value_type, typename E::value_type>(), \
+	                         Layout()); \
  \
 	return *this; \
 } \
-template <typename T> \
+template <typename T, class Allocator, class Layout> \
 template <typename T2> \
-matrix<T> & \
-matrix<T>::operator OP##=(const T2 &s) \
+typename matrix_details::if_scalar<T2, matrix<T, Allocator, Layout> &>::type \
+matrix<T, Allocator, Layout>::operator OP##=(const T2 &s) \
 { \
-	algorithm::apply(this->begin(), this->end(), \
-	                 std::bind2nd(functional::FUNC_NAME##_assign<value_type, T2>(), s)); \
+	matrix_details::apply_scalar(this->begin(), this->end(), s, \
+	                             functional::FUNC_NAME##_assign<value_type, T2>()); \
  \
 	return *this; \
 }
@@ -698,127 +1178,164 @@ JFCPP_MATRIX_OPERATION(^, bit_xor)
 
 #undef JFCPP_MATRIX_OPERATION
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 template <typename T2>
-matrix<T> &
-matrix<T>::operator=(const T2 &s)
+typename matrix_details::if_scalar<T2, matrix<T, Allocator, Layout> &>::type
+matrix<T, Allocator, Layout>::operator=(const T2 &s)
 {
 	std::fill(this->begin(), this->end(), s);
 
 	return *this;
-
 }
 
-template <typename T>
-typename matrix<T>::reference
-matrix<T>::operator()(size_t i)
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::reference
+matrix<T, Allocator, Layout>::operator()(size_t i)
 {
 	requires(i < this->_size);
 
 	return this->_values[i];
 }
 
-template <typename T>
-typename matrix<T>::const_reference
-matrix<T>::operator()(size_t i) const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_reference
+matrix<T, Allocator, Layout>::operator()(size_t i) const
 {
 	// Reuse the implementation of operator()(size_t).
-	return (*const_cast<matrix<T> *>(this))(i);
+	return (*const_cast<matrix<T, Allocator, Layout> *>(this))(i);
 }
 
-template <typename T>
-typename matrix<T>::reference
-matrix<T>::operator()(size_t i, size_t j)
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::reference
+matrix<T, Allocator, Layout>::operator()(size_t i, size_t j)
 {
 	requires(this->is_valid_subscript(i, j));
 
-	return this->_values_by_rows[i][j];
+	return this->_values[Layout::index(i, j, this->_rows, this->_columns)];
 }
 
-template <typename T>
-typename matrix<T>::const_reference
-matrix<T>::operator()(size_t i, size_t j) const
+template <typename T, class Allocator, class Layout>
+typename matrix<T, Allocator, Layout>::const_reference
+matrix<T, Allocator, Layout>::operator()(size_t i, size_t j) const
 {
 	// Reuse the implementation of operator()(size_t, size_t).
-	return (*const_cast<matrix<T> *>(this))(i, j);
+	return (*const_cast<matrix<T, Allocator, Layout> *>(this))(i, j);
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::allocate()
+matrix<T, Allocator, Layout>::allocate()
 {
 	requires(this->_values == NULL);
 
 	assert(this->_size == (this->_rows * this->_columns));
-	assert(this->_values_by_rows == NULL);
 
-	this->_values = new T[this->_size];
-	this->_values_by_rows = new T*[this->_rows];
+	if (this->_size == 0)
+	{
+		return;
+	}
+
+	T *values = this->_allocator.allocate(this->_size);
 
-	T *p = this->_values;
-	for (size_t i = 0; i < this->_rows; ++i, p += this->_columns)
+	// Like “new T[n]”: if a constructor throws, the previous values are
+	// destroyed and the memory released.
+	size_t i = 0;
+	try
+	{
+		for (; i < this->_size; ++i)
+		{
+			new (static_cast<void *>(values + i)) T;
+		}
+	}
+	catch (...)
 	{
-		this->_values_by_rows[i] = p;
+		while (i != 0)
+		{
+			values[--i].~T();
+		}
+		this->_allocator.deallocate(values, this->_size);
+
+		throw;
 	}
 
+	this->_values = values;
+
 	validate(*this);
 }
 
-template <typename T>
-template <typename T2>
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
 void
-matrix<T>::copy_values(const matrix<T2> &m)
+matrix<T, Allocator, Layout>::copy_values(const matrix<T2, A2, L2> &m)
 {
 	requires(this->has_same_dimensions(m));
 
-	std::copy(m.begin(), m.end(), this->begin());
+	if (meta::is_same<Layout, L2>::value)
+	{
+		std::copy(m.begin(), m.end(), this->begin());
+	}
+	else
+	{
+		matrix_details::evaluate(this->_values, m,
+		                         matrix_details::assign<T, T2>(), Layout());
+	}
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::copy_values(const matrix<T> &m)
+matrix<T, Allocator, Layout>::copy_values(const matrix<T, Allocator, Layout> &m)
 {
-	this->copy_values<T>(m);
+	this->copy_values<T, Allocator, Layout>(m);
 
 	ensures(this->has_same_values(m));
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 void
-matrix<T>::deallocate()
+matrix<T, Allocator, Layout>::deallocate()
 {
-	delete[] this->_values_by_rows;
-	this->_values_by_rows = NULL;
+	if (this->_values == NULL)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < this->_size; ++i)
+	{
+		this->_values[i].~T();
+	}
+	this->_allocator.deallocate(this->_values, this->_size);
 
-	delete[] this->_values;
 	this->_values = NULL;
 }
 
-template <typename T>
-template <typename T2>
+template <typename T, class Allocator, class Layout>
+template <typename T2, class A2, class L2>
 bool
-matrix<T>::has_same_values(const matrix<T2> &m) const
+matrix<T, Allocator, Layout>::has_same_values(const matrix<T2, A2, L2> &m) const
 {
 	requires(this->has_same_dimensions(m));
 
+	if (!meta::is_same<Layout, L2>::value)
+	{
+		return (*this == static_cast<const matrix_details::expression<matrix<T2, A2, L2> > &>(m));
+	}
+
 	return std::equal(this->begin(), this->end(), m.begin());
 }
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 bool
-matrix<T>::isValid() const
+matrix<T, Allocator, Layout>::isValid() const
 {
 	return ((this->_size == (this->_rows * this->_columns))
-	        && ((this->_values != NULL) || (this->_size == 0))
-	        && (((this->_values == NULL) && (this->_values_by_rows == NULL))
-	            || ((this->_values_by_rows != NULL))));
+	        && ((this->_values != NULL) == (this->_size != 0)));
 }
 
 JFCPP_NAMESPACE_END
 
-template <typename T>
+template <typename T, class Allocator, class Layout>
 std::ostream &
-operator<<(std::ostream &os, const JFCPP_NS()matrix<T> &m)
+operator<<(std::ostream &os, const JFCPP_NS()matrix<T, Allocator, Layout> &m)
 {
 	if ((m.rows() == 0) || (m.columns() == 0))
 	{
@@ -837,3 +1354,10 @@ operator<<(std::ostream &os, const JFCPP_NS()matrix<T> &m)
 
 	return os;
 }
+
+template <class E>
+std::ostream &
+operator<<(std::ostream &os, const JFCPP_NS()matrix_details::expression<E> &e)
+{
+	return (os << JFCPP_NS()matrix<typename E::value_type>(e.derived()));
+}
@@ -0,0 +1,146 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_LAYOUT
+#define H_JFCPP_MATRIX_LAYOUT
+
+#include <cstddef>
+
+#include "../common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Orders in which the elements of an expression can be accessed with a
+	 * single index (see “linear” in “matrix/expression.hpp”).
+	 */
+	enum linear_order
+	{
+		linear_none = 0,
+		linear_rows = 1,
+		linear_columns = 2
+	};
+}
+
+/**
+ * Storage orders of “matrix” (its third template parameter).
+ *
+ * The values of a matrix are stored in “outer()” contiguous runs of
+ * “inner()” values: rows for “row_major”, columns for “column_major”.
+ *
+ * The storage of a column-major matrix is the one of its transpose in
+ * row-major order, converting from one layout to the other is therefore a
+ * transposition (see “matrix/transpose.hpp”).
+ */
+
+/**
+ * The element (i, j) is at “i × columns + j”.
+ *
+ * This is the default layout.
+ */
+struct row_major
+{
+	enum { order = matrix_details::linear_rows };
+
+	static
+	size_t
+	index(size_t i, size_t j, size_t, size_t columns)
+	{
+		return (i * columns + j);
+	}
+
+	static
+	size_t
+	row_stride(size_t, size_t columns)
+	{
+		return columns;
+	}
+
+	static
+	size_t
+	column_stride(size_t, size_t)
+	{
+		return 1;
+	}
+
+	static
+	size_t
+	outer(size_t rows, size_t)
+	{
+		return rows;
+	}
+
+	static
+	size_t
+	inner(size_t, size_t columns)
+	{
+		return columns;
+	}
+};
+
+/**
+ * The element (i, j) is at “j × rows + i”, like in Fortran and LAPACK.
+ *
+ * Columns are contiguous, which suits the algorithms working column by
+ * column (e.g. “matrix::op_column()”).
+ */
+struct column_major
+{
+	enum { order = matrix_details::linear_columns };
+
+	static
+	size_t
+	index(size_t i, size_t j, size_t rows, size_t)
+	{
+		return (j * rows + i);
+	}
+
+	static
+	size_t
+	row_stride(size_t, size_t)
+	{
+		return 1;
+	}
+
+	static
+	size_t
+	column_stride(size_t rows, size_t)
+	{
+		return rows;
+	}
+
+	static
+	size_t
+	outer(size_t, size_t columns)
+	{
+		return columns;
+	}
+
+	static
+	size_t
+	inner(size_t rows, size_t)
+	{
+		return rows;
+	}
+};
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_MATRIX_LAYOUT
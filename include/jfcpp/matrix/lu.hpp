@@ -0,0 +1,232 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_LU
+#define H_JFCPP_MATRIX_LU
+
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * LU decomposition with partial pivoting of a square matrix: P × A = L × U
+ * where P is a permutation, L is lower triangular with a unit diagonal and
+ * U is upper triangular.
+ *
+ * Once computed (O(n³)), it can be used to solve any number of systems
+ * A × X = B in O(n² × B.columns()) each, and to compute the determinant or
+ * the inverse of A.
+ *
+ * Pivoting: for floating point types, the greatest value (in absolute value)
+ * of the column is used, for other types (integers, rationals, GMP, …) the
+ * first non-zero one.
+ *
+ * For arithmetic types, the decomposition and the substitutions are blocked:
+ * most of the work is done by matrix products on the cache-blocked GEMM
+ * engine, which can be parallelized by giving an executor.
+ *
+ * The decomposition is done in the layout of the matrix, through its
+ * strides: a column-major matrix is not converted (only its panels are
+ * copied row by row while they are factorized) and the right-hand sides of
+ * “solve()” may have any layout.
+ *
+ * Requirements:
+ * - the ones of “matrix<T>”;
+ * - T must be constructible from 0 and 1 and comparable with “==”;
+ * - “T &T::operator-=(const T &)”, “T operator*(const T &, const T &)” and
+ *   “T operator/(const T &, const T &)” must be defined.
+ */
+template <typename T, class Allocator, class Layout>
+class lu
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef matrix<T, Allocator, Layout> matrix_type;
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Constructs an empty decomposition, see “factorize()”.
+	 */
+	lu();
+
+	/**
+	 * Computes the decomposition of a matrix.
+	 *
+	 * @param a The matrix (must be square).
+	 */
+	explicit lu(const matrix_type &a);
+
+	/**
+	 * Computes the decomposition of a matrix using an executor.
+	 *
+	 * @param a The matrix (must be square).
+	 * @param e
+	 */
+	lu(const matrix_type &a, executor &e);
+
+	/**
+	 * Computes the decomposition of a matrix, replacing the current one.
+	 *
+	 * The storage of the current decomposition is reused when possible.
+	 *
+	 * @param a The matrix (must be square).
+	 */
+	void factorize(const matrix_type &a);
+
+	/**
+	 * Same as “factorize(const matrix_type &)” but using an executor.
+	 */
+	void factorize(const matrix_type &a, executor &e);
+
+	/**
+	 * Computes the decomposition of a matrix.
+	 *
+	 * Contrary to the method “factorize(const matrix_type &)”, “a” is not
+	 * copied: its storage is taken and it is left empty.
+	 *
+	 * @param a The matrix (must be square).
+	 */
+	void factorize_perf(matrix_type &a);
+
+	/**
+	 * Same as “factorize_perf(matrix_type &)” but using an executor.
+	 */
+	void factorize_perf(matrix_type &a, executor &e);
+
+	/**
+	 * Computes the determinant of the decomposed matrix.
+	 *
+	 * Calculus complexity: O(n).
+	 */
+	T det() const;
+
+	/**
+	 * Computes the logarithm of the absolute value of the determinant of the
+	 * decomposed matrix, which does not overflow even when the determinant
+	 * does.
+	 *
+	 * Calculus complexity: O(n).
+	 *
+	 * Requirement:
+	 * - T must be a floating point type.
+	 *
+	 * @param sign Receives the sign of the determinant: -1, 0 or 1.
+	 *
+	 * @return The logarithm (-∞ if the determinant is null).
+	 */
+	T log_det(int &sign) const;
+
+	/**
+	 * Gets the dimension of the decomposed matrix.
+	 */
+	size_t dimension() const;
+
+	/**
+	 * Gets L and U packed in a single matrix: U is the upper triangle
+	 * (diagonal included) and L the strict lower one.
+	 */
+	const matrix_type &factors() const;
+
+	/**
+	 * Computes the inverse of the decomposed matrix.
+	 *
+	 * Calculus complexity: O(n³).
+	 *
+	 * @throw std::runtime_error If the matrix is singular.
+	 */
+	matrix_type inverse() const;
+
+	/**
+	 * Same as “inverse()” but using an executor.
+	 */
+	matrix_type inverse(executor &e) const;
+
+	/**
+	 * Tests whether the decomposed matrix is singular (i.e. not invertible).
+	 */
+	bool is_singular() const;
+
+	/**
+	 * Gets the permutation P as a sequence of swaps: the row i has been
+	 * swapped with the row “pivots()[i]” (≥ i), in this order.
+	 */
+	const std::vector<size_t> &pivots() const;
+
+	/**
+	 * Solves A × X = B, the solution replaces B.
+	 *
+	 * Calculus complexity: O(n² × B.columns()).
+	 *
+	 * @param B A matrix with as many rows as A.
+	 *
+	 * @throw std::runtime_error If the matrix is singular.
+	 */
+	template <class A2, class L2>
+	void solve(matrix<T, A2, L2> &B) const;
+
+	/**
+	 * Same as “solve(matrix<T, A2, L2> &)” but using an executor.
+	 */
+	template <class A2, class L2>
+	void solve(matrix<T, A2, L2> &B, executor &e) const;
+
+private:
+
+	/**
+	 * L and U packed.
+	 */
+	matrix_type _lu;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _pivots;
+
+	/**
+	 * Whether the permutation is odd.
+	 */
+	bool _odd;
+
+	/**
+	 *
+	 */
+	bool _singular;
+
+	/**
+	 * Decomposes “_lu” in place.
+	 */
+	void decompose(executor &e);
+};
+
+JFCPP_NAMESPACE_END
+
+#include "lu/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_LU
@@ -0,0 +1,508 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+#include "../../meta/is_arithmetic.hpp"
+#include "../../thread_pool.hpp"
+#include "../gemm.hpp"
+#include "../transpose.hpp"
+#include "../triangular.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Exact types: the first non-zero value is a good pivot.
+	 */
+	template <typename T, bool = meta::is_floating_point<T>::value>
+	struct pivoting
+	{
+		static
+		bool
+		is_better(const T &candidate, const T &pivot)
+		{
+			return ((pivot == T(0)) && !(candidate == T(0)));
+		}
+	};
+
+	/**
+	 * Floating point types: the greatest value limits the rounding errors.
+	 */
+	template <typename T>
+	struct pivoting<T, true>
+	{
+		static
+		bool
+		is_better(const T &candidate, const T &pivot)
+		{
+			return (std::abs(candidate) > std::abs(pivot));
+		}
+	};
+
+	/**
+	 * “x[0, n) -= a × y[0, n)”.
+	 */
+	template <typename T>
+	void
+	subtract_scaled(size_t n, T *x, const T &a, const T *y)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] -= a * y[i];
+		}
+	}
+
+	/**
+	 * Number of columns by block of the decomposition, 0 means the
+	 * decomposition is not blocked.
+	 *
+	 * Blocking only pays when the products are done by the GEMM engine, i.e.
+	 * for arithmetic types.
+	 */
+	template <typename T, bool = meta::is_arithmetic<T>::value>
+	struct lu_blocking
+	{
+		enum { size = 0 };
+	};
+
+	template <typename T>
+	struct lu_blocking<T, true>
+	{
+		enum { size = 128 };
+	};
+
+	/**
+	 * “C -= A × B” where A is m × k, B is k × n and C is m × n, each of them
+	 * with its row and column strides.
+	 */
+	template <typename T, bool = meta::is_arithmetic<T>::value>
+	struct lu_product
+	{
+		static
+		void
+		subtract(executor &, size_t m, size_t n, size_t k,
+		         const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+		         const T *b, ptrdiff_t rsb, ptrdiff_t csb,
+		         T *c, ptrdiff_t rsc, ptrdiff_t csc)
+		{
+			for (size_t i = 0; i < m; ++i)
+			{
+				for (size_t p = 0; p < k; ++p)
+				{
+					const T &x = a[i * rsa + p * csa];
+
+					if (x == T(0))
+					{
+						continue;
+					}
+
+					for (size_t j = 0; j < n; ++j)
+					{
+						c[i * rsc + j * csc] -= x * b[p * rsb + j * csb];
+					}
+				}
+			}
+		}
+	};
+
+	template <typename T>
+	struct lu_product<T, true>
+	{
+		static
+		void
+		subtract(executor &e, size_t m, size_t n, size_t k,
+		         const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+		         const T *b, ptrdiff_t rsb, ptrdiff_t csb,
+		         T *c, ptrdiff_t rsc, ptrdiff_t csc)
+		{
+			gemm(e, m, n, k, T(-1), a, rsa, csa, b, rsb, csb, T(1), c, rsc,
+			     csc);
+		}
+	};
+
+	/**
+	 * Factorizes the m × k panel a (stored row by row with the leading
+	 * dimension lda) with partial pivoting (unblocked algorithm).
+	 *
+	 * Only the rows of the panel are swapped: the row p has been swapped
+	 * with the row “pivots[p]” (≥ p), in this order, and “odd” is flipped
+	 * for each swap.
+	 *
+	 * @return Whether a column of the panel has no pivot (the matrix is
+	 *         singular).
+	 */
+	template <typename T>
+	bool
+	lu_panel(size_t m, size_t k, T *a, size_t lda, size_t *pivots, bool &odd)
+	{
+		bool singular = false;
+
+		for (size_t p = 0; p < k; ++p)
+		{
+			// Selects the pivot.
+			size_t q = p;
+			for (size_t i = p + 1; i < m; ++i)
+			{
+				if (pivoting<T>::is_better(a[i * lda + p], a[q * lda + p]))
+				{
+					q = i;
+				}
+			}
+
+			pivots[p] = q;
+			if (q != p)
+			{
+				std::swap_ranges(a + p * lda, a + p * lda + k, a + q * lda);
+				odd = !odd;
+			}
+
+			const T *row_p = a + p * lda;
+			const T pivot = row_p[p];
+
+			// The whole column is null: nothing to eliminate.
+			if (pivot == T(0))
+			{
+				singular = true;
+				continue;
+			}
+
+			// Updates the rest of the panel.
+			for (size_t i = p + 1; i < m; ++i)
+			{
+				T *row_i = a + i * lda;
+
+				if (row_i[p] == T(0))
+				{
+					continue;
+				}
+
+				row_i[p] = row_i[p] / pivot;
+				subtract_scaled(k - p - 1, row_i + p + 1, row_i[p],
+				                row_p + p + 1);
+			}
+		}
+
+		return singular;
+	}
+
+	/**
+	 * Exchanges the values of the rows i and j of a in the columns [first,
+	 * last).
+	 */
+	template <typename T>
+	void
+	lu_swap(T *a, ptrdiff_t rs, ptrdiff_t cs, size_t i, size_t j,
+	        size_t first, size_t last)
+	{
+		for (size_t c = first; c < last; ++c)
+		{
+			std::swap(a[i * rs + c * cs], a[j * rs + c * cs]);
+		}
+	}
+} // namespace matrix_details
+
+template <typename T, class Allocator, class Layout>
+lu<T, Allocator, Layout>::lu()
+	: _lu(0), _odd(false), _singular(false)
+{}
+
+template <typename T, class Allocator, class Layout>
+lu<T, Allocator, Layout>::lu(const matrix_type &a)
+	: _lu(a), _odd(false), _singular(false)
+{
+	requires(a.is_square());
+
+	sequential_executor e;
+
+	this->decompose(e);
+}
+
+template <typename T, class Allocator, class Layout>
+lu<T, Allocator, Layout>::lu(const matrix_type &a, executor &e)
+	: _lu(a), _odd(false), _singular(false)
+{
+	requires(a.is_square());
+
+	this->decompose(e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+lu<T, Allocator, Layout>::factorize(const matrix_type &a)
+{
+	sequential_executor e;
+
+	this->factorize(a, e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+lu<T, Allocator, Layout>::factorize(const matrix_type &a, executor &e)
+{
+	requires(a.is_square());
+
+	this->_lu = a;
+
+	this->decompose(e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+lu<T, Allocator, Layout>::factorize_perf(matrix_type &a)
+{
+	sequential_executor e;
+
+	this->factorize_perf(a, e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+lu<T, Allocator, Layout>::factorize_perf(matrix_type &a, executor &e)
+{
+	requires(a.is_square());
+
+	this->_lu.swap(a);
+	a.clear();
+
+	this->decompose(e);
+}
+
+template <typename T, class Allocator, class Layout>
+T
+lu<T, Allocator, Layout>::det() const
+{
+	T result(1);
+
+	for (size_t i = 0, n = this->dimension(); i < n; ++i)
+	{
+		result = result * this->_lu(i, i);
+	}
+
+	return (this->_odd ? T(0) - result : result);
+}
+
+template <typename T, class Allocator, class Layout>
+T
+lu<T, Allocator, Layout>::log_det(int &sign) const
+{
+	T result(0);
+
+	sign = (this->_odd ? -1 : 1);
+
+	for (size_t i = 0, n = this->dimension(); i < n; ++i)
+	{
+		const T &u = this->_lu(i, i);
+
+		if (u == T(0))
+		{
+			sign = 0;
+			return -std::numeric_limits<T>::infinity();
+		}
+
+		if (u < T(0))
+		{
+			sign = -sign;
+		}
+
+		result += std::log(std::abs(u));
+	}
+
+	return result;
+}
+
+template <typename T, class Allocator, class Layout>
+size_t
+lu<T, Allocator, Layout>::dimension() const
+{
+	return this->_lu.rows();
+}
+
+template <typename T, class Allocator, class Layout>
+const typename lu<T, Allocator, Layout>::matrix_type &
+lu<T, Allocator, Layout>::factors() const
+{
+	return this->_lu;
+}
+
+template <typename T, class Allocator, class Layout>
+typename lu<T, Allocator, Layout>::matrix_type
+lu<T, Allocator, Layout>::inverse() const
+{
+	sequential_executor e;
+
+	return this->inverse(e);
+}
+
+template <typename T, class Allocator, class Layout>
+typename lu<T, Allocator, Layout>::matrix_type
+lu<T, Allocator, Layout>::inverse(executor &e) const
+{
+	matrix_type result = matrix_type::identity(this->dimension(), T(0), T(1),
+	                                           this->_lu.get_allocator());
+
+	this->solve(result, e);
+
+	return result;
+}
+
+template <typename T, class Allocator, class Layout>
+bool
+lu<T, Allocator, Layout>::is_singular() const
+{
+	return this->_singular;
+}
+
+template <typename T, class Allocator, class Layout>
+const std::vector<size_t> &
+lu<T, Allocator, Layout>::pivots() const
+{
+	return this->_pivots;
+}
+
+template <typename T, class Allocator, class Layout>
+template <class A2, class L2>
+void
+lu<T, Allocator, Layout>::solve(matrix<T, A2, L2> &B) const
+{
+	sequential_executor e;
+
+	this->solve(B, e);
+}
+
+template <typename T, class Allocator, class Layout>
+template <class A2, class L2>
+void
+lu<T, Allocator, Layout>::solve(matrix<T, A2, L2> &B, executor &e) const
+{
+	requires(B.rows() == this->dimension());
+
+	if (this->_singular)
+	{
+		throw std::runtime_error("singular matrix");
+	}
+
+	const size_t n = this->dimension(), m = B.columns();
+	const size_t
+		rsa = Layout::row_stride(n, n),
+		csa = Layout::column_stride(n, n),
+		rsb = L2::row_stride(n, m),
+		csb = L2::column_stride(n, m);
+
+	// P × B.
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (this->_pivots[i] != i)
+		{
+			B.swap_rows(i, this->_pivots[i]);
+		}
+	}
+
+	const T *a = this->_lu.begin();
+	T *b = B.begin();
+
+	// L × Y = P × B (forward substitution, L has a unit diagonal).
+	matrix_details::trsm(e, false, true, n, m, T(1), a, rsa, csa, b, rsb,
+	                     csb);
+
+	// U × X = Y (backward substitution).
+	matrix_details::trsm(e, true, false, n, m, T(1), a, rsa, csa, b, rsb,
+	                     csb);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+lu<T, Allocator, Layout>::decompose(executor &e)
+{
+	typedef matrix_details::lu_blocking<T> blocking;
+	typedef matrix_details::lu_product<T> product;
+
+	const size_t
+		n = this->_lu.rows(),
+		nb = (blocking::size == 0 ? n : size_t(blocking::size)),
+		rs = Layout::row_stride(n, n),
+		cs = Layout::column_stride(n, n);
+
+	this->_pivots.resize(n);
+	this->_odd = false;
+	this->_singular = false;
+
+	T *a = this->_lu.begin();
+
+	// The panels are factorized row by row: when the rows are not
+	// contiguous, they are transposed in this buffer.
+	std::vector<T> buffer;
+
+	// Right-looking blocked algorithm: each panel of nb columns is factorized
+	// then used to update the trailing sub-matrix with a matrix product.
+	for (size_t k0 = 0; k0 < n; k0 += nb)
+	{
+		const size_t kb = std::min(nb, n - k0), k1 = k0 + kb, m = n - k0;
+		T *panel = a + k0 * (rs + cs);
+
+		if (cs == 1)
+		{
+			this->_singular |= matrix_details::lu_panel(
+				m, kb, panel, rs, &this->_pivots[k0], this->_odd);
+		}
+		else
+		{
+			buffer.resize(m * kb);
+			matrix_details::transpose(kb, m, panel, cs, &buffer[0], kb);
+			this->_singular |= matrix_details::lu_panel(
+				m, kb, &buffer[0], kb, &this->_pivots[k0], this->_odd);
+			matrix_details::transpose(m, kb, &buffer[0], kb, panel, cs);
+		}
+
+		// The swaps of the panel apply to the whole rows.
+		for (size_t k = k0; k < k1; ++k)
+		{
+			const size_t p = (this->_pivots[k] += k0);
+
+			if (p != k)
+			{
+				matrix_details::lu_swap(a, rs, cs, k, p, 0, k0);
+				matrix_details::lu_swap(a, rs, cs, k, p, k1, n);
+			}
+		}
+
+		if (k1 == n)
+		{
+			break;
+		}
+
+		// U12 = L11⁻¹ × A12.
+		matrix_details::trsm(e, false, true, kb, n - k1, T(1),
+		                     panel, rs, cs, a + k0 * rs + k1 * cs, rs, cs);
+
+		// A22 -= L21 × U12.
+		product::subtract(e, n - k1, n - k1, kb,
+		                  a + k1 * rs + k0 * cs, rs, cs,
+		                  a + k0 * rs + k1 * cs, rs, cs,
+		                  a + k1 * (rs + cs), rs, cs);
+	}
+}
+
+JFCPP_NAMESPACE_END
@@ -0,0 +1,62 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_MODULAR
+#define H_JFCPP_MATRIX_MODULAR
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Computes the determinant of an integer matrix with the multi-modular
+ * method.
+ *
+ * The determinant is computed modulo enough primes (of half the size of an
+ * “unsigned long”) to exceed twice the Hadamard bound, each of them with a
+ * Gaussian elimination on machine integers, then it is reconstructed with the
+ * chinese remainder theorem.
+ *
+ * Contrary to the fraction-free elimination, the intermediate values never
+ * grow, which makes it much faster for large matrices.
+ *
+ * Requirements:
+ * - T must be an integer type which can represent 4 × ∏ᵢ (∑ⱼ aᵢⱼ²), e.g.
+ *   “mpz_class” (“math/gmp.hpp” must then be included);
+ * - “math::mod<T>()” must be defined for T;
+ * - T must be constructible from an “unsigned long”.
+ *
+ * @param a A square matrix.
+ */
+template <typename T, class Allocator>
+T det_modular(const matrix<T, Allocator> &a);
+
+/**
+ * Same as “det_modular(const matrix<T, Allocator> &)” but the primes are
+ * processed in parallel by the given executor.
+ */
+template <typename T, class Allocator>
+T det_modular(const matrix<T, Allocator> &a, executor &e);
+
+JFCPP_NAMESPACE_END
+
+#include "modular/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_MODULAR
@@ -0,0 +1,229 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+#include "../../math.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Finds the greatest prime lower than n (n > 3).
+	 */
+	inline
+	unsigned long
+	previous_prime(unsigned long n)
+	{
+		for (unsigned long p = (n - 2) | 1;; p -= 2)
+		{
+			bool prime = true;
+
+			for (unsigned long d = 3; prime && (d <= p / d); d += 2)
+			{
+				prime = ((p % d) != 0);
+			}
+
+			if (prime)
+			{
+				return p;
+			}
+		}
+	}
+
+	/**
+	 * Computes the determinant of a matrix modulo each prime.
+	 *
+	 * The primes are lower than the square root of the greatest “unsigned
+	 * long” so that the product of two residues does not overflow.
+	 */
+	template <class M>
+	class modular_det_task : public parallel_task
+	{
+	public:
+
+		modular_det_task(const M &a, const std::vector<unsigned long> &primes,
+		                 std::vector<unsigned long> &results)
+			: _a(a), _primes(primes), _results(results)
+		{}
+
+		void
+		operator()(size_t i)
+		{
+			const unsigned long p = this->_primes[i];
+			const size_t n = this->_a.rows();
+
+			std::vector<unsigned long> m(n * n);
+			for (size_t k = 0; k < m.size(); ++k)
+			{
+				m[k] = JFCPP_MATH_NS()mod(this->_a(k), p);
+			}
+
+			unsigned long det = 1;
+			for (size_t k = 0; (k < n) && (det != 0); ++k)
+			{
+				size_t r = k;
+				while ((r < n) && (m[r * n + k] == 0))
+				{
+					++r;
+				}
+
+				if (r == n)
+				{
+					det = 0;
+					break;
+				}
+
+				if (r != k)
+				{
+					std::swap_ranges(m.begin() + r * n, m.begin() + (r + 1) * n,
+					                 m.begin() + k * n);
+					det = p - det;
+				}
+
+				const unsigned long pivot = m[k * n + k];
+				det = det * pivot % p;
+
+				const unsigned long inverse =
+					JFCPP_MATH_NS()exp_mod<unsigned long>(pivot, p - 2, p);
+
+				for (size_t i = k + 1; i < n; ++i)
+				{
+					const unsigned long f = m[i * n + k] * inverse % p;
+
+					if (f == 0)
+					{
+						continue;
+					}
+
+					// Subtracting f is adding p - f.
+					const unsigned long g = p - f;
+					for (size_t j = k + 1; j < n; ++j)
+					{
+						m[i * n + j] = (m[i * n + j] + g * m[k * n + j]) % p;
+					}
+				}
+			}
+
+			this->_results[i] = det;
+		}
+
+	private:
+
+		const M &_a;
+
+		const std::vector<unsigned long> &_primes;
+
+		std::vector<unsigned long> &_results;
+	};
+} // namespace matrix_details
+
+template <typename T, class Allocator>
+T
+det_modular(const matrix<T, Allocator> &a)
+{
+	sequential_executor e;
+
+	return det_modular(a, e);
+}
+
+template <typename T, class Allocator>
+T
+det_modular(const matrix<T, Allocator> &a, executor &e)
+{
+	requires(a.is_square());
+
+	const size_t n = a.rows();
+
+	// Hadamard's inequality: det² ≤ ∏ᵢ (∑ⱼ aᵢⱼ²).
+	T bound(4);
+	for (size_t i = 0; i < n; ++i)
+	{
+		T norm(0);
+		for (size_t j = 0; j < n; ++j)
+		{
+			norm += a(i, j) * a(i, j);
+		}
+
+		if (norm == T(0))
+		{
+			return T(0);
+		}
+
+		bound *= norm;
+	}
+
+	// The product of the primes must exceed 2 × |det|.
+	std::vector<unsigned long> primes;
+	T product(1);
+	for (unsigned long p = 1ul << (std::numeric_limits<unsigned long>::digits
+	                               / 2 - 1);
+	     product <= bound / product;
+	     product *= T(p))
+	{
+		p = matrix_details::previous_prime(p);
+		primes.push_back(p);
+	}
+
+	const size_t k = primes.size();
+
+	std::vector<unsigned long> residues(k);
+	matrix_details::modular_det_task<matrix<T, Allocator> >
+		task(a, primes, residues);
+	e.run(task, k);
+
+	// Garner's algorithm: det = c₀ + c₁ p₀ + c₂ p₀ p₁ + … (mod ∏ pᵢ).
+	std::vector<unsigned long> c(k);
+	for (size_t i = 0; i < k; ++i)
+	{
+		const unsigned long p = primes[i];
+
+		unsigned long value = 0, radix = 1;
+		for (size_t j = 0; j < i; ++j)
+		{
+			value = (value + c[j] % p * radix) % p;
+			radix = radix * (primes[j] % p) % p;
+		}
+
+		c[i] = (residues[i] + p - value) % p
+			* JFCPP_MATH_NS()exp_mod<unsigned long>(radix, p - 2, p) % p;
+	}
+
+	T result(c[k - 1]);
+	for (size_t i = k - 1; i-- > 0;)
+	{
+		result = result * T(primes[i]) + T(c[i]);
+	}
+
+	// Symmetric representation.
+	if (product < T(2) * result)
+	{
+		result -= product;
+	}
+
+	return result;
+}
+
+JFCPP_NAMESPACE_END
@@ -0,0 +1,227 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_QR
+#define H_JFCPP_MATRIX_QR
+
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * QR decomposition of a m × n matrix: A = Q × R (or A × P = Q × R with
+ * column pivoting) where Q is orthogonal and R upper triangular (upper
+ * trapezoidal when m < n).
+ *
+ * Q is the product of k = min(m, n) Householder reflectors which are
+ * stored below the diagonal of R, it is never formed unless requested by
+ * “Q()”.  The reflectors are computed by panels of columns and applied to
+ * the rest of the matrix by blocks (compact WY form, see
+ * “matrix/householder.hpp”): most of the work is done by matrix products
+ * on the GEMM engine, which can be parallelized by giving an executor.
+ *
+ * Its main use is “least_squares()”: unlike the normal equations (Aᵀ × A ×
+ * X = Aᵀ × B), it does not square the condition number of A.
+ *
+ * With column pivoting, the columns are chosen by decreasing norms
+ * (Businger-Golub) so that the magnitudes of the diagonal of R decrease,
+ * which reveals the numerical rank of A.  The pivoting is done on the R of
+ * the unpivoted decomposition (k × n): it selects the same columns since
+ * the norms only depend on Aᵀ × A = Rᵀ × R, while the work on the m rows of
+ * A stays blocked.
+ *
+ * The decomposition is done in the layout of A, through its strides, so
+ * that a column-major matrix (whose columns, worked on by the reflectors,
+ * are contiguous) is not converted.  Q and R have the layout of A.
+ *
+ * Requirement:
+ * - T must be a floating point type.
+ */
+template <typename T, class Allocator, class Layout>
+class qr
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef matrix<T, Allocator, Layout> matrix_type;
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Constructs an empty decomposition, see “factorize()”.
+	 */
+	qr();
+
+	/**
+	 * Computes the decomposition of a matrix.
+	 *
+	 * @param a        The matrix (any dimensions).
+	 * @param pivoting Whether the columns are pivoted.
+	 */
+	explicit qr(const matrix_type &a, bool pivoting = false);
+
+	/**
+	 * Same as “qr(const matrix_type &, bool)” but using an executor.
+	 */
+	qr(const matrix_type &a, bool pivoting, executor &e);
+
+	/**
+	 * Computes the decomposition of a matrix, replacing the current one.
+	 */
+	void factorize(const matrix_type &a, bool pivoting = false);
+
+	/**
+	 * Same as “factorize(const matrix_type &, bool)” but using an executor.
+	 */
+	void factorize(const matrix_type &a, bool pivoting, executor &e);
+
+	/**
+	 *
+	 */
+	size_t columns() const;
+
+	/**
+	 * Whether the columns have been pivoted.
+	 */
+	bool is_pivoted() const;
+
+	/**
+	 * Gets the column permutation P: the column j of A × P is the column
+	 * “permutation()[j]” of A (the identity without pivoting).
+	 */
+	const std::vector<size_t> &permutation() const;
+
+	/**
+	 * Computes the economy-size Q: its k = min(m, n) orthonormal columns
+	 * (m × k).
+	 *
+	 * Calculus complexity: O(m × k²).
+	 */
+	matrix_type Q() const;
+
+	/**
+	 * Same as “Q()” but using an executor.
+	 */
+	matrix_type Q(executor &e) const;
+
+	/**
+	 * Gets R (k × n).
+	 */
+	matrix_type R() const;
+
+	/**
+	 * Gets the numerical rank of A: the number of diagonal values of R
+	 * greater than “max(m, n) × ε × |R(0, 0)|” (in magnitude).
+	 *
+	 * It is only reliable with column pivoting.
+	 */
+	size_t rank() const;
+
+	/**
+	 *
+	 */
+	size_t rows() const;
+
+	/**
+	 * Computes X (n × B.columns()) which minimizes ‖A × X - B‖ (each column
+	 * of X for the same column of B).
+	 *
+	 * Calculus complexity: O((m × k + k²) × B.columns()).
+	 *
+	 * When A does not have a full rank (or m < n), there are many
+	 * solutions: with pivoting, the basic solution (at most “rank()”
+	 * values are not zero, the others matching the smallest values of the
+	 * diagonal of R) is returned.
+	 *
+	 * @param B A matrix with as many rows as A.
+	 *
+	 * @throw std::runtime_error If, without pivoting, a value of the
+	 *                           diagonal of R is zero.
+	 */
+	template <class A2, class L2>
+	matrix<T, A2, L2> least_squares(const matrix<T, A2, L2> &B) const;
+
+	/**
+	 * Same as “least_squares(const matrix<T, A2, L2> &)” but using an
+	 * executor.
+	 */
+	template <class A2, class L2>
+	matrix<T, A2, L2> least_squares(const matrix<T, A2, L2> &B,
+	                                executor &e) const;
+
+private:
+
+	/**
+	 * R (upper triangle) and the reflectors of the unpivoted decomposition
+	 * (below the diagonal, the reflector j in the column j).
+	 */
+	matrix_type _factors;
+
+	/**
+	 *
+	 */
+	std::vector<T> _tau;
+
+	/**
+	 * The triangular factors of the blocks of reflectors (compact WY
+	 * form), kept so that applying Q only costs matrix products.
+	 */
+	std::vector<T> _blocks;
+
+	/**
+	 * With pivoting: the pivoted decomposition of the R of “_factors”,
+	 * stored the same way (k × n).
+	 */
+	matrix_type _pivoted;
+
+	/**
+	 *
+	 */
+	std::vector<T> _pivoted_tau;
+
+	/**
+	 *
+	 */
+	std::vector<T> _pivoted_blocks;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _permutation;
+
+	/**
+	 * The matrix which holds R.
+	 */
+	const matrix_type &triangle() const;
+};
+
+JFCPP_NAMESPACE_END
+
+#include "qr/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_QR
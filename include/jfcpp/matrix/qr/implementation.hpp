@@ -0,0 +1,603 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+#include "../../thread_pool.hpp"
+#include "../gemm.hpp"
+#include "../householder.hpp"
+#include "../triangular.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Number of columns by panel of the decomposition, which is also the
+	 * number of reflectors applied at once.
+	 */
+	enum { qr_block = 32 };
+
+	/**
+	 * Copies the reflectors [first, first + count) of a decomposition (m
+	 * rows with the strides rs and cs, the reflector j below the diagonal of
+	 * the column j) to v (count × (m - first), with the leading 1s and the
+	 * zeros).
+	 */
+	template <typename T>
+	void
+	qr_reflectors(size_t m, const T *a, ptrdiff_t rs, ptrdiff_t cs,
+	              size_t first, size_t count, T *v)
+	{
+		const size_t ld = m - first;
+
+		std::fill(v, v + count * ld, T(0));
+		for (size_t i = 0; i < ld; ++i)
+		{
+			const T *row = a + (first + i) * rs + first * cs;
+
+			for (size_t p = 0; (p < count) && (p < i); ++p)
+			{
+				v[p * ld + i] = row[p * cs];
+			}
+			if (i < count)
+			{
+				v[i * ld + i] = T(1);
+			}
+		}
+	}
+
+	/**
+	 * Number of blocks of reflectors of a m × n decomposition.
+	 */
+	inline
+	size_t
+	qr_blocks(size_t m, size_t n)
+	{
+		return ((std::min(m, n) + qr_block - 1) / qr_block);
+	}
+
+	/**
+	 * Computes the triangular factors of the blocks of reflectors of a
+	 * decomposition (m × n, with the strides rs and cs), each one is qr_block
+	 * × qr_block.
+	 */
+	template <typename T>
+	void
+	qr_block_factors(size_t m, size_t n, const T *a, ptrdiff_t rs,
+	                 ptrdiff_t cs, const T *tau, T *t)
+	{
+		const size_t k = std::min(m, n), nb = qr_block;
+
+		std::vector<T> v;
+
+		for (size_t j0 = 0; j0 < k; j0 += nb, t += nb * nb)
+		{
+			const size_t kb = std::min(nb, k - j0), ld = m - j0;
+
+			v.resize(kb * ld);
+			qr_reflectors(m, a, rs, cs, j0, kb, &v[0]);
+			reflector_factor(kb, ld, &v[0], ld, 1, tau + j0, t, nb);
+		}
+	}
+
+	/**
+	 * Householder QR decomposition in place of a (m × n, with the strides rs
+	 * and cs), the triangular factors of the blocks of reflectors go to t.
+	 *
+	 * Each panel is copied with its columns as rows, where the reflectors
+	 * are applied column by column with the SIMD kernels, then the block of
+	 * its reflectors is applied to the rest of the matrix.
+	 */
+	template <typename T>
+	void
+	qr_factorize(executor &e, size_t m, size_t n, T *a, ptrdiff_t rs,
+	             ptrdiff_t cs, T *tau, T *t)
+	{
+		const size_t k = std::min(m, n), nb = qr_block;
+
+		std::vector<T> panel;
+
+		for (size_t j0 = 0; j0 < k; j0 += nb, t += nb * nb)
+		{
+			const size_t kb = std::min(nb, k - j0), ld = m - j0;
+
+			panel.resize(kb * ld);
+			for (size_t i = 0; i < ld; ++i)
+			{
+				const T *row = a + (j0 + i) * rs + j0 * cs;
+
+				for (size_t p = 0; p < kb; ++p)
+				{
+					panel[p * ld + i] = row[p * cs];
+				}
+			}
+
+			for (size_t p = 0; p < kb; ++p)
+			{
+				T *v = &panel[p * ld + p];
+
+				tau[j0 + p] = householder(v[0], ld - p - 1, v + 1, 1);
+
+				const T beta = v[0];
+				v[0] = T(1);
+				for (size_t q = p + 1; q < kb; ++q)
+				{
+					T *c = &panel[q * ld + p];
+
+					axpy(ld - p, -tau[j0 + p] * dot(ld - p, v, c), v, c);
+				}
+				v[0] = beta;
+			}
+
+			for (size_t i = 0; i < ld; ++i)
+			{
+				T *row = a + (j0 + i) * rs + j0 * cs;
+
+				for (size_t p = 0; p < kb; ++p)
+				{
+					row[p * cs] = panel[p * ld + i];
+				}
+			}
+
+			// The panel becomes the block of reflectors.
+			for (size_t p = 0; p < kb; ++p)
+			{
+				T *v = &panel[p * ld];
+
+				std::fill(v, v + p, T(0));
+				v[p] = T(1);
+			}
+
+			reflector_factor(kb, ld, &panel[0], ld, 1, tau + j0, t, nb);
+			apply_reflectors(e, true, kb, ld, &panel[0], ld, 1, t, nb,
+			                 n - j0 - kb, a + j0 * rs + (j0 + kb) * cs, rs,
+			                 cs);
+		}
+	}
+
+	/**
+	 * C = Q × C, or Qᵀ × C if “transposed” is true, where Q is given by the
+	 * reflectors of a decomposition (m × n, with the strides rsa and csa)
+	 * and their triangular factors, and C is m × nc (with the strides rsc
+	 * and csc).
+	 */
+	template <typename T>
+	void
+	qr_apply(executor &e, bool transposed, size_t m, size_t n, const T *a,
+	         ptrdiff_t rsa, ptrdiff_t csa, const T *t, size_t nc, T *c,
+	         ptrdiff_t rsc, ptrdiff_t csc)
+	{
+		const size_t
+			k = std::min(m, n),
+			nb = qr_block,
+			blocks = qr_blocks(m, n);
+
+		std::vector<T> v;
+
+		// Q = H_0 × … × H_{k-1}: Qᵀ × C applies the first block first.
+		for (size_t b = 0; b < blocks; ++b)
+		{
+			const size_t
+				j0 = (transposed ? b : blocks - 1 - b) * nb,
+				kb = std::min(nb, k - j0),
+				ld = m - j0;
+
+			v.resize(kb * ld);
+			qr_reflectors(m, a, rsa, csa, j0, kb, &v[0]);
+			apply_reflectors(e, transposed, kb, ld, &v[0], ld, 1,
+			                 t + (j0 / nb) * nb * nb, nb, nc, c + j0 * rsc,
+			                 rsc, csc);
+		}
+	}
+
+	/**
+	 * Householder QR decomposition with column pivoting in place of r (k ×
+	 * n, with the strides rs and cs), the columns being chosen by decreasing
+	 * remaining norms.
+	 *
+	 * The columns are worked on as rows of a copy.  The remaining norms
+	 * are downdated and recomputed when the cancellation is too large (as in
+	 * LAPACK's “dlaqp2”).
+	 *
+	 * @param permutation Receives the column of r which is now the column
+	 *                    j (n values).
+	 */
+	template <typename T>
+	void
+	qr_pivot(size_t k, size_t n, T *r, ptrdiff_t rs, ptrdiff_t cs, T *tau,
+	         size_t *permutation)
+	{
+		const T threshold = std::sqrt(std::numeric_limits<T>::epsilon());
+
+		std::vector<T> w(n * k), norms(n), reference(n);
+
+		for (size_t j = 0; j < n; ++j)
+		{
+			permutation[j] = j;
+			for (size_t i = 0; i < k; ++i)
+			{
+				w[j * k + i] = r[i * rs + j * cs];
+			}
+			norms[j] = reference[j] = std::sqrt(dot(k, &w[j * k], &w[j * k]));
+		}
+
+		for (size_t i = 0; i < k; ++i)
+		{
+			const size_t pivot = std::max_element(norms.begin() + i,
+			                                      norms.end())
+				- norms.begin();
+
+			if (pivot != i)
+			{
+				std::swap_ranges(&w[i * k], &w[i * k] + k, &w[pivot * k]);
+				std::swap(permutation[i], permutation[pivot]);
+				std::swap(norms[i], norms[pivot]);
+				std::swap(reference[i], reference[pivot]);
+			}
+
+			T *v = &w[i * k + i];
+			tau[i] = householder(v[0], k - i - 1, v + 1, 1);
+
+			const T beta = v[0];
+			v[0] = T(1);
+			for (size_t j = i + 1; j < n; ++j)
+			{
+				T *c = &w[j * k + i];
+
+				axpy(k - i, -tau[i] * dot(k - i, v, c), v, c);
+
+				if (norms[j] == T(0))
+				{
+					continue;
+				}
+
+				const T ratio = std::abs(c[0]) / norms[j];
+				const T rest = std::max(T(0), T(1) - ratio * ratio);
+				const T scaled = norms[j] / reference[j];
+
+				if (rest * scaled * scaled <= threshold)
+				{
+					norms[j] = reference[j] = std::sqrt(
+						dot(k - i - 1, c + 1, c + 1));
+				}
+				else
+				{
+					norms[j] *= std::sqrt(rest);
+				}
+			}
+			v[0] = beta;
+		}
+
+		for (size_t j = 0; j < n; ++j)
+		{
+			for (size_t i = 0; i < k; ++i)
+			{
+				r[i * rs + j * cs] = w[j * k + i];
+			}
+		}
+	}
+} // namespace matrix_details
+
+template <typename T, class Allocator, class Layout>
+qr<T, Allocator, Layout>::qr()
+	: _factors(0)
+{}
+
+template <typename T, class Allocator, class Layout>
+qr<T, Allocator, Layout>::qr(const matrix_type &a, bool pivoting)
+	: _factors(0)
+{
+	this->factorize(a, pivoting);
+}
+
+template <typename T, class Allocator, class Layout>
+qr<T, Allocator, Layout>::qr(const matrix_type &a, bool pivoting, executor &e)
+	: _factors(0)
+{
+	this->factorize(a, pivoting, e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+qr<T, Allocator, Layout>::factorize(const matrix_type &a, bool pivoting)
+{
+	sequential_executor e;
+
+	this->factorize(a, pivoting, e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+qr<T, Allocator, Layout>::factorize(const matrix_type &a, bool pivoting,
+                            executor &e)
+{
+	const size_t m = a.rows(), n = a.columns(), k = std::min(m, n);
+
+	this->_factors = a;
+	this->_tau.assign(k, T(0));
+	this->_blocks.assign(matrix_details::qr_blocks(m, n)
+	                     * matrix_details::qr_block
+	                     * matrix_details::qr_block, T(0));
+	this->_pivoted.resize(0, 0);
+	this->_pivoted_tau.clear();
+	this->_pivoted_blocks.clear();
+	this->_permutation.resize(n);
+
+	if (k == 0)
+	{
+		for (size_t j = 0; j < n; ++j)
+		{
+			this->_permutation[j] = j;
+		}
+		return;
+	}
+
+	matrix_details::qr_factorize(e, m, n, this->_factors.begin(),
+	                             Layout::row_stride(m, n),
+	                             Layout::column_stride(m, n),
+	                             &this->_tau[0], &this->_blocks[0]);
+
+	if (!pivoting)
+	{
+		for (size_t j = 0; j < n; ++j)
+		{
+			this->_permutation[j] = j;
+		}
+		return;
+	}
+
+	this->_pivoted = this->R();
+	this->_pivoted_tau.resize(k);
+	matrix_details::qr_pivot(k, n, this->_pivoted.begin(),
+	                         Layout::row_stride(k, n),
+	                         Layout::column_stride(k, n),
+	                         &this->_pivoted_tau[0], &this->_permutation[0]);
+
+	this->_pivoted_blocks.resize(this->_blocks.size());
+	matrix_details::qr_block_factors(k, n, this->_pivoted.begin(),
+	                                 Layout::row_stride(k, n),
+	                                 Layout::column_stride(k, n),
+	                                 &this->_pivoted_tau[0],
+	                                 &this->_pivoted_blocks[0]);
+}
+
+template <typename T, class Allocator, class Layout>
+size_t
+qr<T, Allocator, Layout>::columns() const
+{
+	return this->_factors.columns();
+}
+
+template <typename T, class Allocator, class Layout>
+bool
+qr<T, Allocator, Layout>::is_pivoted() const
+{
+	return !this->_pivoted_tau.empty();
+}
+
+template <typename T, class Allocator, class Layout>
+const std::vector<size_t> &
+qr<T, Allocator, Layout>::permutation() const
+{
+	return this->_permutation;
+}
+
+template <typename T, class Allocator, class Layout>
+typename qr<T, Allocator, Layout>::matrix_type
+qr<T, Allocator, Layout>::Q() const
+{
+	sequential_executor e;
+
+	return this->Q(e);
+}
+
+template <typename T, class Allocator, class Layout>
+typename qr<T, Allocator, Layout>::matrix_type
+qr<T, Allocator, Layout>::Q(executor &e) const
+{
+	const size_t m = this->rows(), n = this->columns(), k = std::min(m, n);
+
+	matrix_type q(m, k, T(0));
+	if (k == 0)
+	{
+		return q;
+	}
+
+	for (size_t i = 0; i < k; ++i)
+	{
+		q(i, i) = T(1);
+	}
+
+	const size_t
+		rsq = Layout::row_stride(m, k),
+		csq = Layout::column_stride(m, k);
+
+	// With pivoting, Q = Q_A × Q_R where Q_R only mixes the first k rows.
+	if (this->is_pivoted())
+	{
+		matrix_details::qr_apply(e, false, k, n, this->_pivoted.begin(),
+		                         Layout::row_stride(k, n),
+		                         Layout::column_stride(k, n),
+		                         &this->_pivoted_blocks[0], k, q.begin(),
+		                         rsq, csq);
+	}
+	matrix_details::qr_apply(e, false, m, n, this->_factors.begin(),
+	                         Layout::row_stride(m, n),
+	                         Layout::column_stride(m, n),
+	                         &this->_blocks[0], k, q.begin(), rsq, csq);
+
+	return q;
+}
+
+template <typename T, class Allocator, class Layout>
+typename qr<T, Allocator, Layout>::matrix_type
+qr<T, Allocator, Layout>::R() const
+{
+	const matrix_type &a = this->triangle();
+	const size_t n = a.columns(), k = std::min(a.rows(), n);
+
+	matrix_type r(k, n, T(0));
+	for (size_t i = 0; i < k; ++i)
+	{
+		for (size_t j = i; j < n; ++j)
+		{
+			r(i, j) = a(i, j);
+		}
+	}
+
+	return r;
+}
+
+template <typename T, class Allocator, class Layout>
+size_t
+qr<T, Allocator, Layout>::rank() const
+{
+	const matrix_type &a = this->triangle();
+	const size_t
+		m = this->rows(),
+		n = a.columns(),
+		k = std::min(a.rows(), n);
+
+	if (k == 0)
+	{
+		return 0;
+	}
+
+	const T threshold = T(std::max(m, n)) * std::numeric_limits<T>::epsilon()
+		* std::abs(a(0, 0));
+
+	size_t result = 0;
+	for (size_t i = 0; i < k; ++i)
+	{
+		if (std::abs(a(i, i)) > threshold)
+		{
+			++result;
+		}
+	}
+
+	return result;
+}
+
+template <typename T, class Allocator, class Layout>
+size_t
+qr<T, Allocator, Layout>::rows() const
+{
+	return this->_factors.rows();
+}
+
+template <typename T, class Allocator, class Layout>
+template <class A2, class L2>
+matrix<T, A2, L2>
+qr<T, Allocator, Layout>::least_squares(const matrix<T, A2, L2> &B) const
+{
+	sequential_executor e;
+
+	return this->least_squares(B, e);
+}
+
+template <typename T, class Allocator, class Layout>
+template <class A2, class L2>
+matrix<T, A2, L2>
+qr<T, Allocator, Layout>::least_squares(const matrix<T, A2, L2> &B,
+                                        executor &e) const
+{
+	requires(B.rows() == this->rows());
+
+	const size_t
+		m = this->rows(),
+		n = this->columns(),
+		k = std::min(m, n),
+		nc = B.columns(),
+		rsc = L2::row_stride(m, nc),
+		csc = L2::column_stride(m, nc);
+
+	matrix<T, A2, L2> X(n, nc, T(0));
+	if ((k == 0) || (nc == 0))
+	{
+		return X;
+	}
+
+	// Qᵀ × B, whose first k rows are the ones which can be matched.
+	matrix<T, A2, L2> c(B);
+	matrix_details::qr_apply(e, true, m, n, this->_factors.begin(),
+	                         Layout::row_stride(m, n),
+	                         Layout::column_stride(m, n),
+	                         &this->_blocks[0], nc, c.begin(), rsc, csc);
+	if (this->is_pivoted())
+	{
+		matrix_details::qr_apply(e, true, k, n, this->_pivoted.begin(),
+		                         Layout::row_stride(k, n),
+		                         Layout::column_stride(k, n),
+		                         &this->_pivoted_blocks[0], nc, c.begin(),
+		                         rsc, csc);
+	}
+
+	const matrix_type &a = this->triangle();
+	size_t r = k;
+
+	if (this->is_pivoted())
+	{
+		r = this->rank();
+	}
+	else
+	{
+		for (size_t i = 0; i < k; ++i)
+		{
+			if (a(i, i) == T(0))
+			{
+				throw std::runtime_error("rank-deficient matrix");
+			}
+		}
+	}
+
+	if (r != 0)
+	{
+		matrix_details::trsm(e, true, false, r, nc, T(1), a.begin(),
+		                     Layout::row_stride(a.rows(), n),
+		                     Layout::column_stride(a.rows(), n),
+		                     c.begin(), rsc, csc);
+	}
+
+	// The other values of the basic solution are zero.
+	for (size_t i = 0; i < r; ++i)
+	{
+		for (size_t j = 0; j < nc; ++j)
+		{
+			X(this->_permutation[i], j) = c(i, j);
+		}
+	}
+
+	return X;
+}
+
+template <typename T, class Allocator, class Layout>
+const typename qr<T, Allocator, Layout>::matrix_type &
+qr<T, Allocator, Layout>::triangle() const
+{
+	return (this->is_pivoted() ? this->_pivoted : this->_factors);
+}
+
+JFCPP_NAMESPACE_END
@@ -0,0 +1,186 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_SVD
+#define H_JFCPP_MATRIX_SVD
+
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Singular value decomposition of a m × n matrix: A = U × Σ × Vᵀ where Σ is
+ * diagonal with non-negative values and U and V have orthonormal columns.
+ *
+ * Only the thin decomposition (or its k largest values) is computed: with
+ * k = min(m, n), U is m × k, Σ is k × k and V is n × k.
+ *
+ * Two algorithms are provided:
+ * - “compute()”: one-sided Jacobi (Hestenes), accurate to the small
+ *   singular values, for small and medium matrices.  The matrix is first
+ *   reduced to a square triangle by a QR decomposition when it is not
+ *   square.  Each round of rotations works on disjoint pairs of columns,
+ *   which are split between the threads of the executor;
+ * - “compute_randomized()”: the range finder of Halko, Martinsson and
+ *   Tropp for the k largest singular values of a large matrix.  A is only
+ *   used by matrix products (O(m × n × k) operations in total), on the
+ *   GEMM engine.
+ *
+ * The singular values are sorted in decreasing order, the singular vector j
+ * is the column j of “U()” or “V()”.
+ *
+ * It works on row-major matrices: a matrix of another layout is converted
+ * when it is given (the computation works on a copy anyway).
+ *
+ * Requirement:
+ * - T must be a floating point type.
+ */
+template <typename T, class Allocator>
+class svd
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef matrix<T, Allocator> matrix_type;
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Constructs an empty decomposition, see “compute()”.
+	 */
+	svd();
+
+	/**
+	 * Computes the decomposition of a matrix with the Jacobi algorithm.
+	 *
+	 * @param a       The matrix (any dimensions).
+	 * @param vectors Whether U and V are computed.
+	 *
+	 * @throw std::runtime_error If the Jacobi algorithm does not converge.
+	 */
+	explicit svd(const matrix_type &a, bool vectors = true);
+
+	/**
+	 * Same as “svd(const matrix_type &, bool)” but using an executor.
+	 */
+	svd(const matrix_type &a, bool vectors, executor &e);
+
+	/**
+	 * Computes the decomposition of a matrix with the Jacobi algorithm,
+	 * replacing the current one.
+	 *
+	 * @throw std::runtime_error If the Jacobi algorithm does not converge.
+	 */
+	void compute(const matrix_type &a, bool vectors = true);
+
+	/**
+	 * Same as “compute(const matrix_type &, bool)” but using an executor.
+	 */
+	void compute(const matrix_type &a, bool vectors, executor &e);
+
+	/**
+	 * Computes approximately the k largest singular values and their
+	 * vectors.
+	 *
+	 * A is multiplied by a random n × (k + oversampling) matrix, then
+	 * “iterations” times by Aᵀ and A (which improves the accuracy when the
+	 * singular values decrease slowly), with orthonormalizations in
+	 * between.  The decomposition of the projection of A on the resulting
+	 * basis gives the result.
+	 *
+	 * The random matrix is generated from “seed”, the result is the same
+	 * for the same seed.
+	 *
+	 * @throw std::runtime_error If the Jacobi algorithm does not converge.
+	 */
+	void compute_randomized(const matrix_type &a, size_t k,
+	                        size_t oversampling = 10, size_t iterations = 2,
+	                        unsigned long seed = 1);
+
+	/**
+	 * Same as “compute_randomized(const matrix_type &, size_t, size_t,
+	 * size_t, unsigned long)” but using an executor.
+	 */
+	void compute_randomized(const matrix_type &a, size_t k,
+	                        size_t oversampling, size_t iterations,
+	                        unsigned long seed, executor &e);
+
+	/**
+	 * Gets the number of singular values greater than “max(m, n) × ε ×
+	 * σ_0”.
+	 */
+	size_t rank() const;
+
+	/**
+	 * Gets the left singular vectors (m × k), empty if they were not
+	 * requested.
+	 *
+	 * The columns of the null singular values complete the others into an
+	 * orthonormal basis.
+	 */
+	const matrix_type &U() const;
+
+	/**
+	 * Gets the right singular vectors (n × k), empty if they were not
+	 * requested.
+	 */
+	const matrix_type &V() const;
+
+	/**
+	 * Gets the singular values, in decreasing order.
+	 */
+	const std::vector<T> &values() const;
+
+private:
+
+	/**
+	 * max(m, n) of the decomposed matrix.
+	 */
+	size_t _dimension;
+
+	/**
+	 *
+	 */
+	std::vector<T> _values;
+
+	/**
+	 *
+	 */
+	matrix_type _u;
+
+	/**
+	 *
+	 */
+	matrix_type _v;
+};
+
+JFCPP_NAMESPACE_END
+
+#include "svd/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_SVD
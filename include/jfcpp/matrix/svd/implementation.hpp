@@ -0,0 +1,574 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+#include "../../thread_pool.hpp"
+#include "../gemm.hpp"
+#include "../householder.hpp"
+#include "../qr.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Maximum number of sweeps of the Jacobi algorithm.
+	 */
+	enum { svd_sweeps = 30 };
+
+	/**
+	 * Applies the rotations of one round of the Jacobi algorithm: each pair
+	 * (p, q) of columns is orthogonalized, the pairs of a round are
+	 * disjoint and split in slices of consecutive pairs.
+	 *
+	 * The columns are the rows of w (n × m), their squared norms are in
+	 * norms and the rows of v (n × n) receive the same rotations (if v is
+	 * not null).
+	 */
+	template <typename T>
+	class jacobi_round_task : public parallel_task
+	{
+	public:
+
+		jacobi_round_task(size_t m, size_t n, T *w, T *v, T *norms,
+		                  const size_t *pairs, size_t count, size_t slices,
+		                  const T &tolerance)
+			: _m(m), _n(n), _w(w), _v(v), _norms(norms), _pairs(pairs),
+			  _count(count), _slices(slices), _tolerance(tolerance),
+			  _rotated(slices, 0)
+		{}
+
+		void
+		operator()(size_t slice)
+		{
+			const size_t
+				begin = slice * this->_count / this->_slices,
+				end = (slice + 1) * this->_count / this->_slices;
+			const size_t m = this->_m, n = this->_n;
+
+			for (size_t i = begin; i < end; ++i)
+			{
+				const size_t p = this->_pairs[2 * i], q = this->_pairs[2 * i + 1];
+				T *wp = this->_w + p * m, *wq = this->_w + q * m;
+				const T alpha = this->_norms[p], beta = this->_norms[q];
+
+				if ((alpha == T(0)) || (beta == T(0)))
+				{
+					continue;
+				}
+
+				const T gamma = dot(m, wp, wq);
+				if (std::abs(gamma) <= this->_tolerance
+				    * std::sqrt(alpha) * std::sqrt(beta))
+				{
+					continue;
+				}
+
+				// The rotation which cancels wp · wq, with |t| ≤ 1.
+				const T zeta = (beta - alpha) / (T(2) * gamma);
+				const T t = ((zeta < T(0)) ? T(-1) : T(1))
+					/ (std::abs(zeta) + hypot(T(1), zeta));
+				const T c = T(1) / std::sqrt(T(1) + t * t), s = c * t;
+
+				rotate(m, c, s, wp, wq);
+				if (this->_v)
+				{
+					rotate(n, c, s, this->_v + p * n, this->_v + q * n);
+				}
+				this->_norms[p] = alpha - t * gamma;
+				this->_norms[q] = beta + t * gamma;
+				this->_rotated[slice] = 1;
+			}
+		}
+
+		/**
+		 * Whether at least one pair has been rotated.
+		 */
+		bool
+		rotated() const
+		{
+			return (std::find(this->_rotated.begin(), this->_rotated.end(),
+			                  1) != this->_rotated.end());
+		}
+
+	private:
+
+		const size_t _m, _n;
+
+		T *const _w, *const _v, *const _norms;
+
+		const size_t *const _pairs;
+
+		const size_t _count, _slices;
+
+		const T _tolerance;
+
+		/**
+		 * One flag by slice (not “std::vector<bool>” whose elements share
+		 * bytes), so the threads do not write to the same memory.
+		 */
+		std::vector<char> _rotated;
+	};
+
+	/**
+	 * One-sided Jacobi algorithm on n columns of m elements (m ≥ n), stored
+	 * as the rows of w.
+	 *
+	 * When it returns, the rows of w are orthogonal: their norms are the
+	 * singular values and, if v is not null, the rows of v (initialized to
+	 * the identity) are the right singular vectors.
+	 *
+	 * The pairs are ordered by a round-robin tournament: each of the n - 1
+	 * rounds (n if n is odd) of a sweep covers n / 2 disjoint pairs.
+	 *
+	 * @throw std::runtime_error If it does not converge.
+	 */
+	template <typename T>
+	void
+	jacobi_svd(executor &e, size_t m, size_t n, T *w, T *v)
+	{
+		if (n == 0)
+		{
+			return;
+		}
+
+		if (v)
+		{
+			std::fill(v, v + n * n, T(0));
+			for (size_t i = 0; i < n; ++i)
+			{
+				v[i * n + i] = T(1);
+			}
+		}
+		if (n == 1)
+		{
+			return;
+		}
+
+		// An odd number of columns uses a dummy one (n) which is never
+		// rotated.
+		const size_t players = n + (n % 2), count = players / 2;
+		const size_t slices = std::max<size_t>(
+			1, std::min<size_t>(e.concurrency(), count));
+		const T tolerance = T(m) * std::numeric_limits<T>::epsilon();
+
+		std::vector<size_t> order(players), pairs(2 * count);
+		std::vector<T> norms(n);
+		for (size_t i = 0; i < players; ++i)
+		{
+			order[i] = i;
+		}
+
+		for (size_t sweep = 0; sweep < svd_sweeps; ++sweep)
+		{
+			// The norms updated by the rotations drift slowly.
+			for (size_t j = 0; j < n; ++j)
+			{
+				norms[j] = dot(m, w + j * m, w + j * m);
+			}
+
+			bool rotated = false;
+			for (size_t round = 0; round < players - 1; ++round)
+			{
+				size_t real = 0;
+				for (size_t i = 0; i < count; ++i)
+				{
+					const size_t
+						p = order[i],
+						q = order[players - 1 - i];
+
+					if ((p < n) && (q < n))
+					{
+						pairs[2 * real] = std::min(p, q);
+						pairs[2 * real + 1] = std::max(p, q);
+						++real;
+					}
+				}
+
+				jacobi_round_task<T> task(m, n, w, v, &norms[0], &pairs[0],
+				                          real, std::min(slices, real),
+				                          tolerance);
+				e.run(task, std::min(slices, real));
+				rotated = rotated || task.rotated();
+
+				// The first player stays, the others rotate.
+				std::rotate(order.begin() + 1, order.end() - 1, order.end());
+			}
+
+			if (!rotated)
+			{
+				return;
+			}
+		}
+
+		throw std::runtime_error("svd: no convergence");
+	}
+}
+
+template <typename T, class Allocator>
+svd<T, Allocator>::svd()
+	: _dimension(0)
+{}
+
+template <typename T, class Allocator>
+svd<T, Allocator>::svd(const matrix_type &a, bool vectors)
+	: _dimension(0)
+{
+	this->compute(a, vectors);
+}
+
+template <typename T, class Allocator>
+svd<T, Allocator>::svd(const matrix_type &a, bool vectors, executor &e)
+	: _dimension(0)
+{
+	this->compute(a, vectors, e);
+}
+
+template <typename T, class Allocator>
+void
+svd<T, Allocator>::compute(const matrix_type &a, bool vectors)
+{
+	sequential_executor e;
+
+	this->compute(a, vectors, e);
+}
+
+template <typename T, class Allocator>
+void
+svd<T, Allocator>::compute(const matrix_type &a, bool vectors, executor &e)
+{
+	const size_t m = a.rows(), n = a.columns();
+	const bool transposed = (m < n);
+
+	// The algorithm works on the columns of a matrix with at least as many
+	// rows as columns: Aᵀ = V × Σ × Uᵀ is decomposed instead of a wide A.
+	const size_t rows = std::max(m, n), k = std::min(m, n);
+	const ptrdiff_t
+		rs = transposed ? 1 : ptrdiff_t(n),
+		cs = transposed ? ptrdiff_t(n) : 1;
+
+	this->_dimension = rows;
+	this->_values.assign(k, T(0));
+	this->_u = matrix_type();
+	this->_v = matrix_type();
+	if (k == 0)
+	{
+		if (vectors)
+		{
+			this->_u = matrix_type(m, 0);
+			this->_v = matrix_type(n, 0);
+		}
+		return;
+	}
+
+	// A tall matrix is reduced to its k × k triangle R (A = Q × R): the
+	// rotations work on k elements instead of rows and the columns of R are
+	// closer to orthogonal, which saves sweeps.
+	matrix_type q;
+	std::vector<T> w(k * k), v(vectors ? k * k : 0);
+	if (rows > k)
+	{
+		matrix_type b(rows, k);
+		for (size_t i = 0; i < rows; ++i)
+		{
+			for (size_t j = 0; j < k; ++j)
+			{
+				b(i, j) = a.begin()[i * rs + j * cs];
+			}
+		}
+
+		const qr<T, Allocator> f(b, false, e);
+		const matrix_type r = f.R();
+		if (vectors)
+		{
+			q = f.Q(e);
+		}
+		for (size_t j = 0; j < k; ++j)
+		{
+			for (size_t i = 0; i < k; ++i)
+			{
+				w[j * k + i] = r(i, j);
+			}
+		}
+	}
+	else
+	{
+		for (size_t j = 0; j < k; ++j)
+		{
+			for (size_t i = 0; i < k; ++i)
+			{
+				w[j * k + i] = a.begin()[i * rs + j * cs];
+			}
+		}
+	}
+
+	matrix_details::jacobi_svd(e, k, k, &w[0], vectors ? &v[0] : 0);
+
+	// Sorts the columns by decreasing norm.
+	std::vector<std::pair<T, size_t> > sorted(k);
+	for (size_t j = 0; j < k; ++j)
+	{
+		sorted[j].first = std::sqrt(matrix_details::dot(k, &w[j * k],
+		                                                &w[j * k]));
+		sorted[j].second = j;
+	}
+	std::sort(sorted.begin(), sorted.end(),
+	          std::greater<std::pair<T, size_t> >());
+	for (size_t j = 0; j < k; ++j)
+	{
+		this->_values[j] = sorted[j].first;
+	}
+	if (!vectors)
+	{
+		return;
+	}
+
+	// The left vectors of the k × k problem are its normalized columns.
+	matrix_type left(k, k, T(0)), right(k, k);
+	for (size_t j = 0; j < k; ++j)
+	{
+		const T sigma = sorted[j].first;
+		const T *wj = &w[sorted[j].second * k], *vj = &v[sorted[j].second * k];
+
+		for (size_t i = 0; i < k; ++i)
+		{
+			if (sigma != T(0))
+			{
+				left(i, j) = wj[i] / sigma;
+			}
+			right(i, j) = vj[i];
+		}
+	}
+
+	// A × V has no direction for the null singular values (the last ones),
+	// their columns complete the others into an orthonormal basis: the unit
+	// vector the least covered by the previous columns is orthogonalized
+	// against them (twice, which is enough in floating point).
+	for (size_t j = 0; j < k; ++j)
+	{
+		if (sorted[j].first != T(0))
+		{
+			continue;
+		}
+
+		size_t best = 0;
+		T smallest = std::numeric_limits<T>::max();
+		for (size_t i = 0; i < k; ++i)
+		{
+			T covered(0);
+			for (size_t c = 0; c < j; ++c)
+			{
+				covered += left(i, c) * left(i, c);
+			}
+			if (covered < smallest)
+			{
+				smallest = covered;
+				best = i;
+			}
+		}
+		left(best, j) = T(1);
+
+		for (size_t pass = 0; pass < 2; ++pass)
+		{
+			for (size_t c = 0; c < j; ++c)
+			{
+				T projection(0);
+				for (size_t i = 0; i < k; ++i)
+				{
+					projection += left(i, c) * left(i, j);
+				}
+				for (size_t i = 0; i < k; ++i)
+				{
+					left(i, j) -= projection * left(i, c);
+				}
+			}
+		}
+
+		T norm(0);
+		for (size_t i = 0; i < k; ++i)
+		{
+			norm += left(i, j) * left(i, j);
+		}
+		norm = std::sqrt(norm);
+		for (size_t i = 0; i < k; ++i)
+		{
+			left(i, j) /= norm;
+		}
+	}
+
+	if (rows > k)
+	{
+		matrix_type u(rows, k);
+		matrix_details::gemm(e, rows, k, k, T(1), q.begin(), ptrdiff_t(k),
+		                     ptrdiff_t(1), left.begin(), ptrdiff_t(k),
+		                     ptrdiff_t(1), T(0), u.begin(), ptrdiff_t(k),
+		                     ptrdiff_t(1));
+		left = u;
+	}
+
+	if (transposed)
+	{
+		this->_u = right;
+		this->_v = left;
+	}
+	else
+	{
+		this->_u = left;
+		this->_v = right;
+	}
+}
+
+template <typename T, class Allocator>
+void
+svd<T, Allocator>::compute_randomized(const matrix_type &a, size_t k,
+                                      size_t oversampling, size_t iterations,
+                                      unsigned long seed)
+{
+	sequential_executor e;
+
+	this->compute_randomized(a, k, oversampling, iterations, seed, e);
+}
+
+template <typename T, class Allocator>
+void
+svd<T, Allocator>::compute_randomized(const matrix_type &a, size_t k,
+                                      size_t oversampling, size_t iterations,
+                                      unsigned long seed, executor &e)
+{
+	const size_t m = a.rows(), n = a.columns();
+
+	requires(k <= std::min(m, n));
+
+	const size_t l = std::min(k + oversampling, std::min(m, n));
+	const ptrdiff_t one = 1;
+
+	if (k == 0)
+	{
+		this->_dimension = std::max(m, n);
+		this->_values.clear();
+		this->_u = matrix_type(m, 0);
+		this->_v = matrix_type(n, 0);
+		return;
+	}
+
+	// Ω, pseudo-random in [-1, 1].
+	matrix_type omega(n, l);
+	for (size_t i = 0; i < n * l; ++i)
+	{
+		seed = (seed * 1103515245ul + 12345ul) & 0x7FFFFFFFul;
+		omega.begin()[i] = T(seed) / T(0x3FFFFFFF) - T(1);
+	}
+
+	// Q: an orthonormal basis of the range of (A × Aᵀ)^iterations × A × Ω.
+	matrix_type y(m, l), z(n, l);
+	matrix_details::gemm(e, m, l, n, T(1), a.begin(), ptrdiff_t(n), one,
+	                     omega.begin(), ptrdiff_t(l), one, T(0), y.begin(),
+	                     ptrdiff_t(l), one);
+	matrix_type q = qr<T, Allocator>(y, false, e).Q(e);
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		matrix_details::gemm(e, n, l, m, T(1), a.begin(), one, ptrdiff_t(n),
+		                     q.begin(), ptrdiff_t(l), one, T(0), z.begin(),
+		                     ptrdiff_t(l), one);
+		z = qr<T, Allocator>(z, false, e).Q(e);
+		matrix_details::gemm(e, m, l, n, T(1), a.begin(), ptrdiff_t(n), one,
+		                     z.begin(), ptrdiff_t(l), one, T(0), y.begin(),
+		                     ptrdiff_t(l), one);
+		q = qr<T, Allocator>(y, false, e).Q(e);
+	}
+
+	// B = Qᵀ × A (l × n) has the k largest singular values of A, A ≈ Q ×
+	// B.
+	matrix_type b(l, n);
+	matrix_details::gemm(e, l, n, m, T(1), q.begin(), one, ptrdiff_t(l),
+	                     a.begin(), ptrdiff_t(n), one, T(0), b.begin(),
+	                     ptrdiff_t(n), one);
+	this->compute(b, true, e);
+
+	matrix_type u(m, k), v(n, k);
+	matrix_details::gemm(e, m, k, l, T(1), q.begin(), ptrdiff_t(l), one,
+	                     this->_u.begin(), ptrdiff_t(l), one, T(0), u.begin(),
+	                     ptrdiff_t(k), one);
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < k; ++j)
+		{
+			v(i, j) = this->_v(i, j);
+		}
+	}
+
+	this->_dimension = std::max(m, n);
+	this->_values.resize(k);
+	this->_u = u;
+	this->_v = v;
+}
+
+template <typename T, class Allocator>
+size_t
+svd<T, Allocator>::rank() const
+{
+	if (this->_values.empty())
+	{
+		return 0;
+	}
+
+	const T threshold = T(this->_dimension)
+		* std::numeric_limits<T>::epsilon() * this->_values[0];
+
+	size_t r = 0;
+	while ((r < this->_values.size()) && (this->_values[r] > threshold))
+	{
+		++r;
+	}
+
+	return r;
+}
+
+template <typename T, class Allocator>
+const typename svd<T, Allocator>::matrix_type &
+svd<T, Allocator>::U() const
+{
+	return this->_u;
+}
+
+template <typename T, class Allocator>
+const typename svd<T, Allocator>::matrix_type &
+svd<T, Allocator>::V() const
+{
+	return this->_v;
+}
+
+template <typename T, class Allocator>
+const std::vector<T> &
+svd<T, Allocator>::values() const
+{
+	return this->_values;
+}
+
+JFCPP_NAMESPACE_END
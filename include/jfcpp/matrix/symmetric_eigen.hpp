@@ -0,0 +1,165 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_SYMMETRIC_EIGEN
+#define H_JFCPP_MATRIX_SYMMETRIC_EIGEN
+
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Eigen-decomposition of a real symmetric matrix: A = V × Λ × Vᵀ where Λ is
+ * diagonal and V orthogonal.
+ *
+ * The computation has three steps:
+ * - A is reduced to a tridiagonal matrix T = Qᵀ × A × Q by Householder
+ *   reflectors, by panels whose update of the rest of the matrix is a matrix
+ *   product (4/3 n³ operations, half of them on the GEMM engine);
+ * - the eigenvalues of T are computed by the implicit QL algorithm with
+ *   Wilkinson shifts (O(n²));
+ * - the wanted eigenvectors of T are computed by inverse iteration (O(n)
+ *   each, vectors of close eigenvalues are reorthogonalized) and then
+ *   multiplied by Q by blocks of reflectors (2 n² k operations on the GEMM
+ *   engine for k vectors).
+ *
+ * Only the upper triangle of A is read.
+ *
+ * The eigenvalues are sorted in decreasing order, the eigenvector j is the
+ * column j of “vectors()”.
+ *
+ * It works on row-major matrices: a matrix of another layout is converted
+ * when it is given (the computation works on a copy anyway).
+ *
+ * Requirement:
+ * - T must be a floating point type.
+ */
+template <typename T, class Allocator>
+class symmetric_eigen
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef matrix<T, Allocator> matrix_type;
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Constructs an empty decomposition, see “compute()”.
+	 */
+	symmetric_eigen();
+
+	/**
+	 * Computes all the eigenvalues and, if requested, the eigenvectors.
+	 *
+	 * @param a       The matrix (must be square).
+	 * @param vectors Whether the eigenvectors are computed.
+	 *
+	 * @throw std::runtime_error If the QL algorithm does not converge.
+	 */
+	explicit symmetric_eigen(const matrix_type &a, bool vectors = true);
+
+	/**
+	 * Same as “symmetric_eigen(const matrix_type &, bool)” but using an
+	 * executor.
+	 */
+	symmetric_eigen(const matrix_type &a, bool vectors, executor &e);
+
+	/**
+	 * Computes all the eigenvalues and, if requested, the eigenvectors,
+	 * replacing the current ones.
+	 *
+	 * @throw std::runtime_error If the QL algorithm does not converge.
+	 */
+	void compute(const matrix_type &a, bool vectors = true);
+
+	/**
+	 * Same as “compute(const matrix_type &, bool)” but using an executor.
+	 */
+	void compute(const matrix_type &a, bool vectors, executor &e);
+
+	/**
+	 * Computes only the k largest eigenvalues and, if requested, their
+	 * eigenvectors.
+	 *
+	 * The reduction to the tridiagonal form is still needed but the
+	 * eigenvectors cost in proportion to k.
+	 *
+	 * @throw std::runtime_error If the QL algorithm does not converge.
+	 */
+	void compute_largest(const matrix_type &a, size_t k, bool vectors = true);
+
+	/**
+	 * Same as “compute_largest(const matrix_type &, size_t, bool)” but
+	 * using an executor.
+	 */
+	void compute_largest(const matrix_type &a, size_t k, bool vectors,
+	                     executor &e);
+
+	/**
+	 * Gets the dimension of the decomposed matrix.
+	 */
+	size_t dimension() const;
+
+	/**
+	 * Gets the computed eigenvalues, in decreasing order.
+	 */
+	const std::vector<T> &values() const;
+
+	/**
+	 * Gets the computed eigenvectors (n × k, one per column), empty if they
+	 * were not requested.
+	 *
+	 * Each one has a norm of 1 and its component of greatest magnitude is
+	 * positive.
+	 */
+	const matrix_type &vectors() const;
+
+private:
+
+	/**
+	 *
+	 */
+	size_t _dimension;
+
+	/**
+	 *
+	 */
+	std::vector<T> _values;
+
+	/**
+	 *
+	 */
+	matrix_type _vectors;
+};
+
+JFCPP_NAMESPACE_END
+
+#include "symmetric_eigen/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_SYMMETRIC_EIGEN
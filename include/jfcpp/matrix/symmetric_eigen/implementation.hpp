@@ -0,0 +1,722 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+#include "../../thread_pool.hpp"
+#include "../gemm.hpp"
+#include "../householder.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Number of rows reduced by panel in the tridiagonal reduction and of
+	 * reflectors by block in the back-transformation.
+	 */
+	enum
+	{
+		tridiagonal_block = 32,
+		back_transformation_block = 64
+	};
+
+	/**
+	 * y = A × v where A is the trailing (n - first) × (n - first) block of
+	 * the n × n matrix a whose upper triangle is used: each of its values is
+	 * read once and used twice.
+	 *
+	 * The rows are split in slices of equal areas, each slice accumulates in
+	 * its own n values of y (the first slice in y itself), which are summed
+	 * by “reduce()”.
+	 */
+	template <typename T>
+	class symmetric_product_task : public parallel_task
+	{
+	public:
+
+		symmetric_product_task(size_t n, size_t first, const T *a,
+		                       const T *v, T *y, T *buffers, size_t slices)
+			: _n(n), _first(first), _a(a), _v(v), _y(y), _buffers(buffers),
+			  _slices(slices)
+		{}
+
+		void
+		operator()(size_t slice)
+		{
+			const size_t
+				begin = this->boundary(slice),
+				end = this->boundary(slice + 1);
+			const size_t n = this->_n;
+			T *y = (slice == 0) ? this->_y : this->_buffers + (slice - 1) * n;
+
+			std::fill(y + this->_first, y + n, T(0));
+			for (size_t r = begin; r < end; ++r)
+			{
+				const T *ar = this->_a + r * n, *v = this->_v;
+
+				y[r] += ar[r] * v[r] + dot(n - r - 1, ar + r + 1, v + r + 1);
+				axpy(n - r - 1, v[r], ar + r + 1, y + r + 1);
+			}
+		}
+
+		void
+		reduce() const
+		{
+			const size_t m = this->_n - this->_first;
+
+			for (size_t slice = 1; slice < this->_slices; ++slice)
+			{
+				axpy(m, T(1), this->_buffers + (slice - 1) * this->_n
+				     + this->_first, this->_y + this->_first);
+			}
+		}
+
+	private:
+
+		/**
+		 * The rows after the boundary s form a triangle whose area is (1 -
+		 * s / slices) times the whole one.
+		 */
+		size_t
+		boundary(size_t slice) const
+		{
+			if (slice == this->_slices)
+			{
+				return this->_n;
+			}
+
+			const double m = double(this->_n - this->_first);
+			const size_t rest = size_t(m * std::sqrt(
+				1.0 - double(slice) / double(this->_slices)));
+
+			return (this->_n - std::min(rest, this->_n - this->_first));
+		}
+
+		size_t _n;
+		size_t _first;
+		const T *_a;
+		const T *_v;
+		T *_y;
+		T *_buffers;
+		size_t _slices;
+	};
+
+	/**
+	 * Reduces the symmetric matrix a (n × n, its upper triangle is used) to
+	 * the tridiagonal form T = Qᵀ × A × Q where Q = H_0 × … × H_{n-2}.
+	 *
+	 * The diagonal of T goes to d, its off-diagonal to e (n - 1 values).  The
+	 * vector of the reflector H_i is stored in the row i of a, from the
+	 * column i + 1 (whose value is 1).
+	 *
+	 * The rows are reduced by panels: the reflectors of a panel are applied
+	 * lazily to its own rows while they are reduced, then to the rest of the
+	 * matrix with two matrix products (A -= Vᵀ × W + Wᵀ × V).
+	 */
+	template <typename T>
+	void
+	tridiagonalize(executor &ex, size_t n, T *a, T *d, T *e, T *tau)
+	{
+		const size_t nb = tridiagonal_block;
+
+		// The rows of W, which complement the reflectors of the panel.
+		std::vector<T> w(nb * n);
+		std::vector<T> y(n);
+
+		// The product by A is the only part which is not done by matrix
+		// products, it is split between the threads.
+		const size_t slices = std::max<size_t>(1, ex.concurrency());
+		std::vector<T> buffers((slices - 1) * n);
+
+		for (size_t j0 = 0; (j0 + 1) < n; j0 += nb)
+		{
+			const size_t kb = std::min(nb, n - 1 - j0), t0 = j0 + kb;
+
+			for (size_t p = 0; p < kb; ++p)
+			{
+				const size_t i = j0 + p;
+				T *row = a + i * n;
+
+				// Applies the previous reflectors of the panel to the row.
+				for (size_t q = 0; q < p; ++q)
+				{
+					const T *vq = a + (j0 + q) * n, *wq = &w[q * n];
+					axpy(n - i, -vq[i], wq + i, row + i);
+					axpy(n - i, -wq[i], vq + i, row + i);
+				}
+
+				d[i] = row[i];
+				tau[i] = householder(row[i + 1], n - i - 2, row + i + 2, 1);
+				e[i] = row[i + 1];
+				row[i + 1] = T(1);
+
+				// y = A × v where A is the trailing matrix, not yet updated
+				// by this panel.
+				symmetric_product_task<T> product(n, i + 1, a, row, &y[0],
+				                                  buffers.empty()
+				                                  ? NULL : &buffers[0],
+				                                  slices);
+				ex.run(product, slices);
+				product.reduce();
+
+				// y -= Vᵀ × (W × v) + Wᵀ × (V × v) for the previous
+				// reflectors of the panel.
+				for (size_t q = 0; q < p; ++q)
+				{
+					const T *vq = a + (j0 + q) * n, *wq = &w[q * n];
+
+					const T
+						sv = dot(n - i - 1, vq + i + 1, row + i + 1),
+						sw = dot(n - i - 1, wq + i + 1, row + i + 1);
+
+					axpy(n - i - 1, -sw, vq + i + 1, &y[i + 1]);
+					axpy(n - i - 1, -sv, wq + i + 1, &y[i + 1]);
+				}
+
+				// w = tau × y - (tau² / 2 × yᵀ × v) × v.
+				T *wp = &w[p * n];
+
+				for (size_t j = i + 1; j < n; ++j)
+				{
+					wp[j] = tau[i] * y[j];
+				}
+
+				const T alpha = -T(0.5) * tau[i]
+					* dot(n - i - 1, wp + i + 1, row + i + 1);
+				axpy(n - i - 1, alpha, row + i + 1, wp + i + 1);
+			}
+
+			// Upper triangle of the trailing matrix, by blocks of rows (the
+			// lower part of the diagonal blocks is updated but never read).
+			const T *v = a + j0 * n;
+			for (size_t r0 = t0; r0 < n; r0 += 8 * nb)
+			{
+				const size_t h = std::min<size_t>(8 * nb, n - r0);
+				T *c = a + r0 * n + r0;
+
+				gemm(ex, h, n - r0, kb, T(-1), v + r0, 1, n, &w[r0], n, 1,
+				     T(1), c, n, 1);
+				gemm(ex, h, n - r0, kb, T(-1), &w[r0], 1, n, v + r0, n, 1,
+				     T(1), c, n, 1);
+			}
+		}
+
+		d[n - 1] = a[n * n - 1];
+	}
+
+	/**
+	 * Computes the eigenvalues of the n × n symmetric tridiagonal matrix
+	 * (d, e) with the implicit QL algorithm and Wilkinson shifts, they
+	 * replace d (in no particular order).
+	 *
+	 * e must have n values (the last one is used as workspace), it is
+	 * destroyed.
+	 *
+	 * An off-diagonal value is negligible relatively to its neighbours or
+	 * to the norm of the matrix, otherwise it would never be near a zero
+	 * eigenvalue.
+	 *
+	 * @throw std::runtime_error If an eigenvalue needs more than 30
+	 *                           iterations.
+	 */
+	template <typename T>
+	void
+	tridiagonal_values(size_t n, T *d, T *e)
+	{
+		const T eps = std::numeric_limits<T>::epsilon();
+
+		e[n - 1] = T(0);
+
+		// Max row sum.
+		T norm(0);
+		for (size_t i = 0; i < n; ++i)
+		{
+			T sum = std::abs(d[i]) + std::abs(e[i]);
+			if (i != 0)
+			{
+				sum += std::abs(e[i - 1]);
+			}
+			norm = std::max(norm, sum);
+		}
+
+		for (size_t l = 0; l < n; ++l)
+		{
+			for (size_t iterations = 0;; ++iterations)
+			{
+				// Looks for a negligible off-diagonal value.
+				size_t m = l;
+				for (; (m + 1) < n; ++m)
+				{
+					if (std::abs(e[m])
+					    <= eps * std::max(std::abs(d[m]) + std::abs(d[m + 1]),
+					                      norm))
+					{
+						break;
+					}
+				}
+				if (m == l)
+				{
+					break;
+				}
+
+				if (iterations == 30)
+				{
+					throw std::runtime_error("symmetric_eigen: no convergence");
+				}
+
+				// Wilkinson shift.
+				T g = (d[l + 1] - d[l]) / (T(2) * e[l]);
+				T r = hypot(g, T(1));
+				g = d[m] - d[l] + e[l] / (g + ((g < T(0)) ? -r : r));
+
+				// Chases the bulge with Givens rotations from the bottom.
+				T s(1), c(1), p(0);
+				bool split = false;
+				for (size_t i = m; i-- > l;)
+				{
+					const T f = s * e[i], b = c * e[i];
+
+					r = hypot(f, g);
+					e[i + 1] = r;
+					if (r == T(0))
+					{
+						// Underflow: the matrix splits.
+						d[i + 1] -= p;
+						e[m] = T(0);
+						split = true;
+						break;
+					}
+
+					s = f / r;
+					c = g / r;
+					g = d[i + 1] - p;
+					r = (d[i] - g) * s + T(2) * c * b;
+					p = s * r;
+					d[i + 1] = g + p;
+					g = c * r - b;
+				}
+				if (split)
+				{
+					continue;
+				}
+
+				d[l] -= p;
+				e[l] = g;
+				e[m] = T(0);
+			}
+		}
+	}
+
+	/**
+	 * Computes the eigenvectors of the n × n symmetric tridiagonal matrix
+	 * (d, e) for the k eigenvalues w (in increasing order) by inverse
+	 * iteration, the vector j goes to the row j of z (k × n).
+	 *
+	 * Close eigenvalues are slightly separated and the vectors of a group
+	 * of close eigenvalues are reorthogonalized (as in LAPACK's “dstein”).
+	 */
+	template <typename T>
+	void
+	tridiagonal_vectors(size_t n, const T *d, const T *e, size_t k,
+	                    const T *w, T *z)
+	{
+		const T eps = std::numeric_limits<T>::epsilon();
+		const size_t max_iterations = 5, extra = 2;
+
+		if (n == 1)
+		{
+			if (k != 0)
+			{
+				z[0] = T(1);
+			}
+			return;
+		}
+
+		T norm(0);
+		for (size_t i = 0; i < n; ++i)
+		{
+			norm = std::max(norm, std::abs(d[i])
+			                + ((i == 0) ? T(0) : std::abs(e[i - 1]))
+			                + ((i + 1 == n) ? T(0) : std::abs(e[i])));
+		}
+
+		const T
+			orthogonality = T(1e-3) * norm,
+			threshold = std::sqrt(T(0.1) / T(n)),
+			tiny = std::max(eps * norm, std::numeric_limits<T>::min());
+
+		// LU factorization with partial pivoting of T - λ × I: u (diagonal),
+		// u1 and u2 (the two upper diagonals) and l (the multipliers).
+		std::vector<T> u(n), u1(n), u2(n), l(n), x(n);
+		std::vector<char> swapped(n);
+
+		unsigned long seed = 1;
+		T previous(0);
+		size_t group = 0;
+
+		for (size_t j = 0; j < k; ++j)
+		{
+			T lambda = w[j];
+			if (j != 0)
+			{
+				const T separation = T(10) * std::abs(eps * lambda);
+				if (lambda - previous < separation)
+				{
+					lambda = previous + separation;
+				}
+				if (lambda - previous > orthogonality)
+				{
+					group = j;
+				}
+			}
+			previous = lambda;
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				u[i] = d[i] - lambda;
+				u1[i] = ((i + 1) < n) ? e[i] : T(0);
+
+				// Pseudo-random start in [-1, 1].
+				seed = (seed * 1103515245ul + 12345ul) & 0x7FFFFFFFul;
+				x[i] = T(seed) / T(0x3FFFFFFF) - T(1);
+			}
+			for (size_t i = 0; (i + 1) < n; ++i)
+			{
+				const T c = e[i];
+
+				if (std::abs(u[i]) >= std::abs(c))
+				{
+					swapped[i] = false;
+					u2[i] = T(0);
+					l[i] = (u[i] == T(0)) ? T(0) : c / u[i];
+					u[i + 1] -= l[i] * u1[i];
+				}
+				else
+				{
+					const T f = u[i] / c, t = u1[i];
+
+					swapped[i] = true;
+					u[i] = c;
+					l[i] = f;
+					u1[i] = u[i + 1];
+					u[i + 1] = t - f * u[i + 1];
+					if ((i + 2) < n)
+					{
+						u2[i] = u1[i + 1];
+						u1[i + 1] = -f * u1[i + 1];
+					}
+					else
+					{
+						u2[i] = T(0);
+					}
+				}
+			}
+			// Tiny pivots are perturbed.
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (std::abs(u[i]) < tiny)
+				{
+					u[i] = (u[i] < T(0)) ? -tiny : tiny;
+				}
+			}
+
+			T *zj = z + j * n;
+
+			for (size_t iteration = 0, passed = 0;
+			     (iteration < max_iterations) && (passed <= extra);
+			     ++iteration)
+			{
+				// Scales x to avoid overflows in the solve.
+				T sum(0);
+				for (size_t i = 0; i < n; ++i)
+				{
+					sum += std::abs(x[i]);
+				}
+				const T scale = T(n) * norm
+					* std::max(eps, std::abs(u[n - 1])) / sum;
+				for (size_t i = 0; i < n; ++i)
+				{
+					x[i] *= scale;
+				}
+
+				// x = (T - λ × I)⁻¹ × x.
+				for (size_t i = 0; (i + 1) < n; ++i)
+				{
+					if (swapped[i])
+					{
+						const T t = x[i];
+						x[i] = x[i + 1];
+						x[i + 1] = t - l[i] * x[i];
+					}
+					else
+					{
+						x[i + 1] -= l[i] * x[i];
+					}
+				}
+				x[n - 1] /= u[n - 1];
+				x[n - 2] = (x[n - 2] - u1[n - 2] * x[n - 1]) / u[n - 2];
+				for (size_t i = n - 2; i-- > 0;)
+				{
+					x[i] = (x[i] - u1[i] * x[i + 1] - u2[i] * x[i + 2]) / u[i];
+				}
+
+				// Orthogonalizes against the vectors of the group.
+				for (size_t q = group; q < j; ++q)
+				{
+					const T *zq = z + q * n;
+
+					axpy(n, -dot(n, &x[0], zq), zq, &x[0]);
+				}
+
+				T greatest(0);
+				for (size_t i = 0; i < n; ++i)
+				{
+					greatest = std::max(greatest, std::abs(x[i]));
+				}
+				if (greatest >= threshold)
+				{
+					++passed;
+				}
+			}
+
+			// Normalizes, the greatest component is positive.
+			size_t greatest = 0;
+			T sum(0);
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (std::abs(x[i]) > std::abs(x[greatest]))
+				{
+					greatest = i;
+				}
+			}
+			const T s = x[greatest];
+			for (size_t i = 0; i < n; ++i)
+			{
+				x[i] /= s;
+				sum += x[i] * x[i];
+			}
+			const T norm_x = std::sqrt(sum);
+			for (size_t i = 0; i < n; ++i)
+			{
+				zj[i] = x[i] / norm_x;
+			}
+		}
+	}
+
+	/**
+	 * y = Q × y where Q is the product of the reflectors stored by
+	 * “tridiagonalize()” and y is n × k (row by row).
+	 */
+	template <typename T>
+	void
+	back_transform(executor &ex, size_t n, const T *a, const T *tau,
+	               size_t k, T *y)
+	{
+		const size_t nb = back_transformation_block;
+
+		if (n < 2)
+		{
+			return;
+		}
+
+		const size_t reflectors = n - 1;
+		std::vector<T> v, t(nb * nb);
+
+		// Q × y = H_0 × (H_1 × (… × y)): the last block comes first.
+		for (size_t b1 = reflectors; b1 > 0;)
+		{
+			const size_t kb = std::min(nb, b1), b0 = b1 - kb, m = n - b0 - 1;
+
+			// The vectors, with their zeros.
+			v.assign(kb * m, T(0));
+			for (size_t p = 0; p < kb; ++p)
+			{
+				const T *row = a + (b0 + p) * n + b0 + p + 1;
+
+				std::copy(row, row + (m - p), &v[p * m + p]);
+			}
+
+			reflector_factor(kb, m, &v[0], m, 1, tau + b0, &t[0], nb);
+			apply_reflectors(ex, false, kb, m, &v[0], m, 1, &t[0], nb, k,
+			                 y + (b0 + 1) * k, k, 1);
+
+			b1 = b0;
+		}
+	}
+} // namespace matrix_details
+
+template <typename T, class Allocator>
+symmetric_eigen<T, Allocator>::symmetric_eigen()
+	: _dimension(0)
+{}
+
+template <typename T, class Allocator>
+symmetric_eigen<T, Allocator>::symmetric_eigen(const matrix_type &a,
+                                               bool vectors)
+	: _dimension(0)
+{
+	this->compute(a, vectors);
+}
+
+template <typename T, class Allocator>
+symmetric_eigen<T, Allocator>::symmetric_eigen(const matrix_type &a,
+                                               bool vectors, executor &e)
+	: _dimension(0)
+{
+	this->compute(a, vectors, e);
+}
+
+template <typename T, class Allocator>
+void
+symmetric_eigen<T, Allocator>::compute(const matrix_type &a, bool vectors)
+{
+	sequential_executor e;
+
+	this->compute_largest(a, a.rows(), vectors, e);
+}
+
+template <typename T, class Allocator>
+void
+symmetric_eigen<T, Allocator>::compute(const matrix_type &a, bool vectors,
+                                       executor &e)
+{
+	this->compute_largest(a, a.rows(), vectors, e);
+}
+
+template <typename T, class Allocator>
+void
+symmetric_eigen<T, Allocator>::compute_largest(const matrix_type &a,
+                                               size_t k, bool vectors)
+{
+	sequential_executor e;
+
+	this->compute_largest(a, k, vectors, e);
+}
+
+template <typename T, class Allocator>
+void
+symmetric_eigen<T, Allocator>::compute_largest(const matrix_type &a,
+                                               size_t k, bool vectors,
+                                               executor &e)
+{
+	requires(a.is_square());
+	requires(k <= a.rows());
+
+	const size_t n = a.rows();
+
+	this->_dimension = n;
+	this->_values.clear();
+	this->_vectors.resize(0, 0);
+
+	if (n == 0)
+	{
+		return;
+	}
+
+	matrix_type reduced(a);
+	std::vector<T> d(n), off(n), tau(n);
+
+	matrix_details::tridiagonalize(e, n, reduced.begin(), &d[0], &off[0],
+	                               &tau[0]);
+
+	std::vector<T> values(d), work(off);
+	matrix_details::tridiagonal_values(n, &values[0], &work[0]);
+	std::sort(values.begin(), values.end());
+
+	// The k largest, in increasing order.
+	const T *wanted = &values[0] + (n - k);
+
+	this->_values.assign(std::reverse_iterator<const T *>(wanted + k),
+	                     std::reverse_iterator<const T *>(wanted));
+
+	if (!vectors || (k == 0))
+	{
+		return;
+	}
+
+	std::vector<T> z(k * n);
+	matrix_details::tridiagonal_vectors(n, &d[0], &off[0], k, wanted, &z[0]);
+
+	// The columns are in decreasing order of the eigenvalues.
+	this->_vectors.resize(n, k);
+	for (size_t j = 0; j < k; ++j)
+	{
+		const T *zj = &z[(k - 1 - j) * n];
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			this->_vectors(i, j) = zj[i];
+		}
+	}
+
+	matrix_details::back_transform(e, n, reduced.begin(), &tau[0], k,
+	                               this->_vectors.begin());
+
+	// The greatest component of each eigenvector is positive.
+	for (size_t j = 0; j < k; ++j)
+	{
+		size_t greatest = 0;
+		for (size_t i = 1; i < n; ++i)
+		{
+			if (std::abs(this->_vectors(i, j))
+			    > std::abs(this->_vectors(greatest, j)))
+			{
+				greatest = i;
+			}
+		}
+		if (this->_vectors(greatest, j) < T(0))
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				this->_vectors(i, j) = -this->_vectors(i, j);
+			}
+		}
+	}
+}
+
+template <typename T, class Allocator>
+size_t
+symmetric_eigen<T, Allocator>::dimension() const
+{
+	return this->_dimension;
+}
+
+template <typename T, class Allocator>
+const std::vector<T> &
+symmetric_eigen<T, Allocator>::values() const
+{
+	return this->_values;
+}
+
+template <typename T, class Allocator>
+const typename symmetric_eigen<T, Allocator>::matrix_type &
+symmetric_eigen<T, Allocator>::vectors() const
+{
+	return this->_vectors;
+}
+
+JFCPP_NAMESPACE_END
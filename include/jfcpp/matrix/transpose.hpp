@@ -0,0 +1,282 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_TRANSPOSE
+#define H_JFCPP_MATRIX_TRANSPOSE
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../simd.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	/**
+	 * Blocking parameters of the transposition.
+	 *
+	 * - TB × TB is the block transposed in registers by the SIMD kernel (1
+	 *   for the types without kernel);
+	 * - TILE × TILE is the size under which the recursion stops, a tile of
+	 *   the source and one of the destination fit in L1.
+	 */
+	template <typename T, size_t TB_ = 1>
+	struct transpose_blocking
+	{
+		enum
+		{
+			TB = TB_,
+			TILE = 32
+		};
+	};
+
+	template <>
+	struct transpose_blocking<float>
+		: public transpose_blocking<float, simd::kernels<float>::TB>
+	{};
+	template <>
+	struct transpose_blocking<double>
+		: public transpose_blocking<double, simd::kernels<double>::TB>
+	{};
+
+	/**
+	 * Rounds the half of n to a multiple of TB, n must be greater than TILE.
+	 */
+	template <typename T>
+	size_t
+	transpose_split(size_t n)
+	{
+		const size_t TB = transpose_blocking<T>::TB;
+
+		return ((n / 2 + TB - 1) / TB * TB);
+	}
+
+	/**
+	 * Transposes a rows × columns tile of a into b.
+	 *
+	 * lda and ldb are the distances between two rows of a and b.
+	 */
+	template <typename T>
+	void
+	transpose_tile(size_t rows, size_t columns, const T *a, size_t lda, T *b,
+	               size_t ldb)
+	{
+		for (size_t i = 0; i < rows; ++i)
+		{
+			for (size_t j = 0; j < columns; ++j)
+			{
+				b[j * ldb + i] = a[i * lda + j];
+			}
+		}
+	}
+
+	/**
+	 * “float” and “double” use the SIMD kernels for the full TB × TB blocks.
+	 */
+#	define JFCPP_MATRIX_TRANSPOSE_TILE(T) \
+	template <> \
+	inline \
+	void \
+	transpose_tile<T>(size_t rows, size_t columns, const T *a, size_t lda, \
+	                  T *b, size_t ldb) \
+	{ \
+		const size_t TB = transpose_blocking<T>::TB; \
+		const simd::kernels<T> &k = simd::kernels<T>::get(); \
+	 \
+		const size_t \
+			full_rows = rows / TB * TB, \
+			full_columns = columns / TB * TB; \
+	 \
+		for (size_t i = 0; i < full_rows; i += TB) \
+		{ \
+			for (size_t j = 0; j < full_columns; j += TB) \
+			{ \
+				k.transpose(a + i * lda + j, lda, b + j * ldb + i, ldb); \
+			} \
+			for (size_t i2 = i; i2 < i + TB; ++i2) \
+			{ \
+				for (size_t j = full_columns; j < columns; ++j) \
+				{ \
+					b[j * ldb + i2] = a[i2 * lda + j]; \
+				} \
+			} \
+		} \
+		for (size_t i = full_rows; i < rows; ++i) \
+		{ \
+			for (size_t j = 0; j < columns; ++j) \
+			{ \
+				b[j * ldb + i] = a[i * lda + j]; \
+			} \
+		} \
+	}
+
+	JFCPP_MATRIX_TRANSPOSE_TILE(float)
+	JFCPP_MATRIX_TRANSPOSE_TILE(double)
+
+#	undef JFCPP_MATRIX_TRANSPOSE_TILE
+
+	/**
+	 * Transposes the rows × columns matrix a into b.
+	 *
+	 * The algorithm is cache-oblivious: the greatest dimension is split in
+	 * two until the tiles fit in the cache, so the source and the
+	 * destination are both accessed by blocks whatever the size of the
+	 * caches and of the TLB.
+	 */
+	template <typename T>
+	void
+	transpose(size_t rows, size_t columns, const T *a, size_t lda, T *b,
+	          size_t ldb)
+	{
+		const size_t TILE = transpose_blocking<T>::TILE;
+
+		if ((rows <= TILE) && (columns <= TILE))
+		{
+			transpose_tile(rows, columns, a, lda, b, ldb);
+		}
+		else if (rows >= columns)
+		{
+			const size_t half = transpose_split<T>(rows);
+
+			transpose(half, columns, a, lda, b, ldb);
+			transpose(rows - half, columns, a + half * lda, lda, b + half, ldb);
+		}
+		else
+		{
+			const size_t half = transpose_split<T>(columns);
+
+			transpose(rows, half, a, lda, b, ldb);
+			transpose(rows, columns - half, a + half, lda, b + half * ldb, ldb);
+		}
+	}
+
+	/**
+	 * Exchanges the rows × columns block x with the transpose of the
+	 * columns × rows block y (ld is the distance between two rows of both).
+	 */
+	template <typename T>
+	void
+	transpose_swap(size_t rows, size_t columns, T *x, T *y, size_t ld)
+	{
+		const size_t TILE = transpose_blocking<T>::TILE;
+
+		if ((rows <= TILE) && (columns <= TILE))
+		{
+			for (size_t i = 0; i < rows; ++i)
+			{
+				for (size_t j = 0; j < columns; ++j)
+				{
+					std::swap(x[i * ld + j], y[j * ld + i]);
+				}
+			}
+		}
+		else if (rows >= columns)
+		{
+			const size_t half = transpose_split<T>(rows);
+
+			transpose_swap(half, columns, x, y, ld);
+			transpose_swap(rows - half, columns, x + half * ld, y + half, ld);
+		}
+		else
+		{
+			const size_t half = transpose_split<T>(columns);
+
+			transpose_swap(rows, half, x, y, ld);
+			transpose_swap(rows, columns - half, x + half, y + half * ld, ld);
+		}
+	}
+
+	/**
+	 * Transposes in place the n × n matrix a (ld is the distance between two
+	 * rows): both diagonal blocks are transposed in place and the other two
+	 * are exchanged, recursively.
+	 */
+	template <typename T>
+	void
+	transpose_square(size_t n, T *a, size_t ld)
+	{
+		if (n <= size_t(transpose_blocking<T>::TILE))
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				for (size_t j = i + 1; j < n; ++j)
+				{
+					std::swap(a[i * ld + j], a[j * ld + i]);
+				}
+			}
+			return;
+		}
+
+		const size_t half = transpose_split<T>(n);
+
+		transpose_square(half, a, ld);
+		transpose_square(n - half, a + half * ld + half, ld);
+		transpose_swap(half, n - half, a + half, a + half * ld, ld);
+	}
+
+	/**
+	 * Transposes in place the rows × columns matrix a (stored contiguously,
+	 * row by row) by following the cycles of the permutation.
+	 *
+	 * The element (i, j) goes from the position i × columns + j to the
+	 * position j × rows + i, a bit by element records which ones have
+	 * already been moved.
+	 */
+	template <typename T>
+	void
+	transpose_cycles(size_t rows, size_t columns, T *a)
+	{
+		const size_t size = rows * columns;
+
+		if (size < 3)
+		{
+			return;
+		}
+
+		std::vector<bool> moved(size, false);
+
+		// The first and the last elements do not move.
+		for (size_t start = 1; start < size - 1; ++start)
+		{
+			if (moved[start])
+			{
+				continue;
+			}
+
+			T value = a[start];
+			size_t k = start;
+
+			do
+			{
+				const size_t next = (k % columns) * rows + k / columns;
+
+				std::swap(value, a[next]);
+				moved[next] = true;
+				k = next;
+			}
+			while (k != start);
+		}
+	}
+} // namespace matrix_details
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_MATRIX_TRANSPOSE
@@ -0,0 +1,454 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_TRIANGULAR
+#define H_JFCPP_MATRIX_TRIANGULAR
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "../common.hpp"
+#include "../meta/is_arithmetic.hpp"
+#include "../thread_pool.hpp"
+#include "gemm.hpp"
+#include "householder.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Options of the triangular kernels (see “matrix_view::trsm()” and
+ * “matrix_view::trmm()”).
+ */
+enum triangular_side
+{
+	left_side,  // A × X.
+	right_side  // X × A.
+};
+
+enum triangular_part
+{
+	lower_part,
+	upper_part
+};
+
+enum triangular_diagonal
+{
+	non_unit_diagonal,
+	unit_diagonal // Only ones, the diagonal of A is not read.
+};
+
+/**
+ * Triangular solve (TRSM) and multiply (TRMM) kernels, which are also used by
+ * the substitutions of the decompositions.
+ *
+ * The triangular matrix A is on the left of B, any other case is obtained
+ * with the strides: “X × A = B” is “Aᵀ × Xᵀ = Bᵀ” and the transpose of a
+ * lower triangle is an upper one.
+ *
+ * The rows of B are processed by blocks: the diagonal blocks of A are
+ * applied by tiles of columns of B, in parallel, and the rest of A by the
+ * GEMM engine, so that nearly all the operations are matrix products.
+ */
+namespace matrix_details
+{
+	/**
+	 * Number of rows of B by block, 0 means the kernels are not blocked.
+	 *
+	 * Blocking only pays when the products are done by the GEMM engine, i.e.
+	 * for arithmetic types.
+	 */
+	template <typename T, bool = meta::is_arithmetic<T>::value>
+	struct triangular_blocking
+	{
+		enum { size = 0 };
+	};
+
+	template <typename T>
+	struct triangular_blocking<T, true>
+	{
+		enum { size = 64 };
+	};
+
+	/**
+	 * “C += alpha × A × B” where A is m × k, B is k × n and C is m × n.
+	 */
+	template <typename T, bool = meta::is_arithmetic<T>::value>
+	struct triangular_product
+	{
+		static
+		void
+		add(executor &, size_t m, size_t n, size_t k, const T &alpha,
+		    const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+		    const T *b, ptrdiff_t rsb, ptrdiff_t csb,
+		    T *c, ptrdiff_t rsc, ptrdiff_t csc)
+		{
+			for (size_t i = 0; i < m; ++i)
+			{
+				for (size_t p = 0; p < k; ++p)
+				{
+					const T &x = a[i * rsa + p * csa];
+
+					if (!(x == T(0)))
+					{
+						const T y = alpha * x;
+
+						for (size_t j = 0; j < n; ++j)
+						{
+							c[i * rsc + j * csc] += y * b[p * rsb + j * csb];
+						}
+					}
+				}
+			}
+		}
+	};
+
+	template <typename T>
+	struct triangular_product<T, true>
+	{
+		static
+		void
+		add(executor &e, size_t m, size_t n, size_t k, const T &alpha,
+		    const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+		    const T *b, ptrdiff_t rsb, ptrdiff_t csb,
+		    T *c, ptrdiff_t rsc, ptrdiff_t csc)
+		{
+			gemm(e, m, n, k, alpha, a, rsa, csa, b, rsb, csb, T(1), c, rsc,
+			     csc);
+		}
+	};
+
+	/**
+	 * Solves “A × X = B” or computes “B = A × B” in place where A is a k ×
+	 * k triangle (a diagonal block) and B has n columns.
+	 *
+	 * The columns of B are independent and are processed by tiles, which
+	 * are copied to a contiguous buffer if the columns of B are not.
+	 */
+	template <typename T>
+	class triangular_task : public parallel_task
+	{
+	public:
+
+		enum { columns_by_tile = 256 };
+
+		triangular_task(bool solve, bool upper, bool unit, size_t k,
+		                const T *a, ptrdiff_t rsa, ptrdiff_t csa, size_t n,
+		                T *b, ptrdiff_t rsb, ptrdiff_t csb)
+			: _solve(solve), _upper(upper), _unit(unit), _k(k), _a(a),
+			  _rsa(rsa), _csa(csa), _n(n), _b(b), _rsb(rsb), _csb(csb)
+		{}
+
+		size_t
+		tiles() const
+		{
+			return ((this->_n + columns_by_tile - 1) / columns_by_tile);
+		}
+
+		void
+		operator()(size_t tile)
+		{
+			const size_t
+				first = tile * columns_by_tile,
+				width = std::min<size_t>(columns_by_tile, this->_n - first);
+			const size_t k = this->_k;
+			T *b = this->_b + first * this->_csb;
+
+			if (this->_csb == 1)
+			{
+				this->apply(width, b, this->_rsb);
+				return;
+			}
+
+			std::vector<T> buffer(k * width);
+			for (size_t i = 0; i < k; ++i)
+			{
+				for (size_t j = 0; j < width; ++j)
+				{
+					buffer[i * width + j] = b[i * this->_rsb + j * this->_csb];
+				}
+			}
+
+			this->apply(width, &buffer[0], width);
+
+			for (size_t i = 0; i < k; ++i)
+			{
+				for (size_t j = 0; j < width; ++j)
+				{
+					b[i * this->_rsb + j * this->_csb] = buffer[i * width + j];
+				}
+			}
+		}
+
+	private:
+
+		/**
+		 * Works on the k rows (of width elements) of a tile.
+		 */
+		void
+		apply(size_t width, T *b, ptrdiff_t ldb) const
+		{
+			const size_t k = this->_k;
+
+			// The solve goes away from the diagonal element which does not
+			// depend on the others, the product towards it so that it reads
+			// rows which are not yet modified.
+			const bool forward = (this->_solve != this->_upper);
+
+			for (size_t step = 0; step < k; ++step)
+			{
+				const size_t i = forward ? step : k - 1 - step;
+				const size_t
+					begin = this->_upper ? i + 1 : 0,
+					end = this->_upper ? k : i;
+				T *row = b + i * ldb;
+
+				if (!this->_solve)
+				{
+					this->scale(width, row, i);
+				}
+				for (size_t p = begin; p < end; ++p)
+				{
+					const T &x = this->_a[i * this->_rsa + p * this->_csa];
+
+					if (!(x == T(0)))
+					{
+						axpy(width, this->_solve ? T(0) - x : x, b + p * ldb,
+						     row);
+					}
+				}
+				if (this->_solve)
+				{
+					this->scale(width, row, i);
+				}
+			}
+		}
+
+		/**
+		 * Multiplies (or divides for a solve) a row by the diagonal element
+		 * i.
+		 */
+		void
+		scale(size_t width, T *row, size_t i) const
+		{
+			if (this->_unit)
+			{
+				return;
+			}
+
+			const T &d = this->_a[i * (this->_rsa + this->_csa)];
+			for (size_t j = 0; j < width; ++j)
+			{
+				row[j] = this->_solve ? row[j] / d : row[j] * d;
+			}
+		}
+
+		const bool _solve, _upper, _unit;
+
+		const size_t _k;
+
+		const T *const _a;
+
+		const ptrdiff_t _rsa, _csa;
+
+		const size_t _n;
+
+		T *const _b;
+
+		const ptrdiff_t _rsb, _csb;
+	};
+
+	/**
+	 * B = alpha × B.
+	 */
+	template <typename T>
+	void
+	triangular_scale(size_t m, size_t n, const T &alpha, T *b, ptrdiff_t rsb,
+	                 ptrdiff_t csb)
+	{
+		if (alpha == T(1))
+		{
+			return;
+		}
+
+		for (size_t i = 0; i < m; ++i)
+		{
+			for (size_t j = 0; j < n; ++j)
+			{
+				T &x = b[i * rsb + j * csb];
+
+				x = alpha * x;
+			}
+		}
+	}
+
+	/**
+	 * Solves “A × X = alpha × B” in place where A is the m × m lower (or
+	 * upper) triangle of a (with a unit diagonal if “unit” is true) and B is
+	 * m × n.
+	 *
+	 * Requirement:
+	 * - the diagonal of A must not contain zeros.
+	 */
+	template <typename T>
+	void
+	trsm(executor &e, bool upper, bool unit, size_t m, size_t n,
+	     const T &alpha, const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	     T *b, ptrdiff_t rsb, ptrdiff_t csb)
+	{
+		typedef triangular_blocking<T> blocking;
+		typedef triangular_product<T> product;
+		typedef triangular_task<T> task;
+
+		if ((m == 0) || (n == 0))
+		{
+			return;
+		}
+
+		const size_t nb = (blocking::size == 0 ? m : size_t(blocking::size));
+
+		triangular_scale(m, n, alpha, b, rsb, csb);
+
+		if (upper)
+		{
+			for (size_t k1 = m; k1 > 0;)
+			{
+				const size_t kb = std::min(nb, k1), k0 = k1 - kb;
+
+				task t(true, true, unit, kb, a + k0 * (rsa + csa), rsa, csa,
+				       n, b + k0 * rsb, rsb, csb);
+				e.run(t, t.tiles());
+
+				// B[0, k0) -= A[0, k0) × X[k0, k1).
+				product::add(e, k0, n, kb, T(-1), a + k0 * csa, rsa, csa,
+				             b + k0 * rsb, rsb, csb, b, rsb, csb);
+
+				k1 = k0;
+			}
+		}
+		else
+		{
+			for (size_t k0 = 0; k0 < m; k0 += nb)
+			{
+				const size_t kb = std::min(nb, m - k0), k1 = k0 + kb;
+
+				task t(true, false, unit, kb, a + k0 * (rsa + csa), rsa, csa,
+				       n, b + k0 * rsb, rsb, csb);
+				e.run(t, t.tiles());
+
+				// B[k1, m) -= A[k1, m) × X[k0, k1).
+				product::add(e, m - k1, n, kb, T(-1),
+				             a + k1 * rsa + k0 * csa, rsa, csa,
+				             b + k0 * rsb, rsb, csb, b + k1 * rsb, rsb, csb);
+			}
+		}
+	}
+
+	/**
+	 * Sequential version of “trsm()”.
+	 */
+	template <typename T>
+	void
+	trsm(bool upper, bool unit, size_t m, size_t n, const T &alpha,
+	     const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	     T *b, ptrdiff_t rsb, ptrdiff_t csb)
+	{
+		sequential_executor e;
+
+		trsm(e, upper, unit, m, n, alpha, a, rsa, csa, b, rsb, csb);
+	}
+
+	/**
+	 * Computes “B = alpha × A × B” in place where A is the m × m lower (or
+	 * upper) triangle of a (with a unit diagonal if “unit” is true) and B is
+	 * m × n.
+	 */
+	template <typename T>
+	void
+	trmm(executor &e, bool upper, bool unit, size_t m, size_t n,
+	     const T &alpha, const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	     T *b, ptrdiff_t rsb, ptrdiff_t csb)
+	{
+		typedef triangular_blocking<T> blocking;
+		typedef triangular_product<T> product;
+		typedef triangular_task<T> task;
+
+		if ((m == 0) || (n == 0))
+		{
+			return;
+		}
+
+		const size_t nb = (blocking::size == 0 ? m : size_t(blocking::size));
+
+		triangular_scale(m, n, alpha, b, rsb, csb);
+
+		// Each block of rows only reads the other blocks before they are
+		// modified.
+		if (upper)
+		{
+			for (size_t k0 = 0; k0 < m; k0 += nb)
+			{
+				const size_t kb = std::min(nb, m - k0), k1 = k0 + kb;
+
+				task t(false, true, unit, kb, a + k0 * (rsa + csa), rsa, csa,
+				       n, b + k0 * rsb, rsb, csb);
+				e.run(t, t.tiles());
+
+				// B[k0, k1) += A[k0, k1) × B[k1, m).
+				product::add(e, kb, n, m - k1, T(1),
+				             a + k0 * rsa + k1 * csa, rsa, csa,
+				             b + k1 * rsb, rsb, csb, b + k0 * rsb, rsb, csb);
+			}
+		}
+		else
+		{
+			for (size_t k1 = m; k1 > 0;)
+			{
+				const size_t kb = std::min(nb, k1), k0 = k1 - kb;
+
+				task t(false, false, unit, kb, a + k0 * (rsa + csa), rsa, csa,
+				       n, b + k0 * rsb, rsb, csb);
+				e.run(t, t.tiles());
+
+				// B[k0, k1) += A[k0, k1) × B[0, k0).
+				product::add(e, kb, n, k0, T(1), a + k0 * rsa, rsa, csa,
+				             b, rsb, csb, b + k0 * rsb, rsb, csb);
+
+				k1 = k0;
+			}
+		}
+	}
+
+	/**
+	 * Sequential version of “trmm()”.
+	 */
+	template <typename T>
+	void
+	trmm(bool upper, bool unit, size_t m, size_t n, const T &alpha,
+	     const T *a, ptrdiff_t rsa, ptrdiff_t csa,
+	     T *b, ptrdiff_t rsb, ptrdiff_t csb)
+	{
+		sequential_executor e;
+
+		trmm(e, upper, unit, m, n, alpha, a, rsa, csa, b, rsb, csb);
+	}
+} // namespace matrix_details
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_MATRIX_TRIANGULAR
@@ -0,0 +1,440 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_VIEW
+#define H_JFCPP_MATRIX_VIEW
+
+#include <cstddef>
+
+#include <contracts.h>
+
+#include "../common.hpp"
+#include "../matrix.hpp"
+#include "../meta/enable_if.hpp"
+#include "../thread_pool.hpp"
+#include "expression.hpp"
+#include "triangular.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+template <typename T>
+class matrix_view;
+
+/**
+ * A read-only view on a part of a matrix (or of any memory) which does not
+ * own nor copy the values.
+ *
+ * The element (i, j) is at “data() + i × row_stride() + j ×
+ * column_stride()”: a block of a matrix has the row stride of the matrix (its
+ * leading dimension), a column has a single column and taking one row out of
+ * two doubles the row stride.
+ *
+ * A view is an expression (see “matrix/expression.hpp”): it can be an
+ * operand of the element-wise operators, be assigned to a matrix or used to
+ * construct one.
+ *
+ * The viewed memory must outlive the view, resizing the matrix invalidates
+ * it.
+ *
+ * @template T The type of the elements.
+ */
+template <typename T>
+class const_matrix_view
+	: public matrix_details::expression<const_matrix_view<T> >
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 *
+	 */
+	typedef const T &const_reference;
+
+	/**
+	 * A view does not own its values.
+	 */
+	typedef matrix_details::no_allocator allocator_type;
+
+	/**
+	 * The elements are not contiguous in general.
+	 */
+	enum { linear = matrix_details::linear_none };
+
+	/**
+	 * Constructs an empty view.
+	 */
+	const_matrix_view();
+
+	/**
+	 * Constructs a view on raw memory.
+	 */
+	const_matrix_view(const T *data, size_t rows, size_t columns,
+	                  size_t row_stride, size_t column_stride = 1);
+
+	/**
+	 * Constructs a view on a whole matrix.
+	 */
+	template <class Allocator, class Layout>
+	const_matrix_view(const matrix<T, Allocator, Layout> &m);
+
+	/**
+	 * Gets the view on the rows × columns block whose first element is (i,
+	 * j).
+	 */
+	const_matrix_view block(size_t i, size_t j, size_t rows,
+	                        size_t columns) const;
+
+	/**
+	 * Gets the view on the column j (a rows() × 1 view).
+	 */
+	const_matrix_view column(size_t j) const;
+
+	/**
+	 *
+	 */
+	size_t columns() const;
+
+	/**
+	 *
+	 */
+	size_t column_stride() const;
+
+	/**
+	 * Gets the address of the element (0, 0).
+	 */
+	const T *data() const;
+
+	/**
+	 * Whether the elements are stored row by row without gaps.
+	 */
+	bool is_contiguous() const;
+
+	/**
+	 * Matrix product.
+	 *
+	 * Arithmetic types use the packed GEMM of “matrix/gemm.hpp” directly on
+	 * the strided memory, nothing is copied.
+	 */
+	matrix<T> mprod(const const_matrix_view &m) const;
+
+	/**
+	 * Same as “mprod(const const_matrix_view &)” but the work is split by
+	 * the given executor.
+	 */
+	matrix<T> mprod(const const_matrix_view &m, executor &e) const;
+
+	/**
+	 * Gets the view on the row i (a 1 × columns() view).
+	 */
+	const_matrix_view row(size_t i) const;
+
+	/**
+	 *
+	 */
+	size_t rows() const;
+
+	/**
+	 *
+	 */
+	size_t row_stride() const;
+
+	/**
+	 * Solves “this × X = B” where B is replaced by X (see
+	 * “matrix::solve()”).
+	 *
+	 * The decomposition works on a copy of this view and of B.
+	 *
+	 * @throw std::runtime_error If there is no solutions.
+	 */
+	void solve(matrix_view<T> B) const;
+
+	/**
+	 * Gets the view on one row out of “row_step” and one column out of
+	 * “column_step”.
+	 */
+	const_matrix_view strided(size_t row_step, size_t column_step) const;
+
+	/**
+	 * Gets the view on the transpose (the strides are exchanged).
+	 */
+	const_matrix_view transposed_view() const;
+
+	/**
+	 *
+	 */
+	const_reference operator()(size_t i, size_t j) const;
+
+	/**
+	 * For the expressions: a matrix built from a view uses a default
+	 * allocator.
+	 */
+	allocator_type get_allocator() const;
+
+	/**
+	 * Whether the values of m are read (see “matrix/expression.hpp”).
+	 */
+	template <class M>
+	bool references(const M &m) const;
+
+	/**
+	 * Whether m is another view on these values.
+	 */
+	template <class M>
+	bool aliases(const M &m) const;
+
+protected:
+
+	/**
+	 *
+	 */
+	const T *_data;
+
+	/**
+	 *
+	 */
+	size_t _rows;
+
+	/**
+	 *
+	 */
+	size_t _columns;
+
+	/**
+	 *
+	 */
+	size_t _row_stride;
+
+	/**
+	 *
+	 */
+	size_t _column_stride;
+};
+
+/**
+ * A mutable view, see “const_matrix_view”.
+ *
+ * Like “array_view”, assigning to a view copies the values into the viewed
+ * memory, it does not change what is viewed.
+ *
+ * @template T The type of the elements.
+ */
+template <typename T>
+class matrix_view : public const_matrix_view<T>
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef T &reference;
+
+	/**
+	 * Constructs an empty view.
+	 */
+	matrix_view();
+
+	/**
+	 * Constructs a view on raw memory.
+	 */
+	matrix_view(T *data, size_t rows, size_t columns, size_t row_stride,
+	            size_t column_stride = 1);
+
+	/**
+	 * Constructs a view on a whole matrix.
+	 */
+	template <class Allocator, class Layout>
+	matrix_view(matrix<T, Allocator, Layout> &m);
+
+	/**
+	 * @see const_matrix_view::block()
+	 */
+	matrix_view block(size_t i, size_t j, size_t rows, size_t columns);
+
+	/**
+	 * @see const_matrix_view::column()
+	 */
+	matrix_view column(size_t j);
+
+	/**
+	 *
+	 */
+	T *data();
+
+	/**
+	 * Computes “this = alpha × a × b + beta × this” (this is the BLAS
+	 * operation of the same name).
+	 *
+	 * When beta is zero, the previous values are not read.
+	 *
+	 * Requirement:
+	 * - the views must not overlap this one.
+	 */
+	void gemm(const T &alpha, const const_matrix_view<T> &a,
+	          const const_matrix_view<T> &b, const T &beta);
+
+	/**
+	 * Same as “gemm()” but the work is split by the given executor.
+	 */
+	void gemm(const T &alpha, const const_matrix_view<T> &a,
+	          const const_matrix_view<T> &b, const T &beta, executor &e);
+
+	/**
+	 * @see const_matrix_view::row()
+	 */
+	matrix_view row(size_t i);
+
+	/**
+	 * @see const_matrix_view::strided()
+	 */
+	matrix_view strided(size_t row_step, size_t column_step);
+
+	/**
+	 * @see const_matrix_view::transposed_view()
+	 */
+	matrix_view transposed_view();
+
+	/**
+	 * Computes “this = alpha × A × this” (left side) or “this = alpha ×
+	 * this × A” (right side) where A is triangular (this is the BLAS
+	 * operation of the same name).
+	 *
+	 * Only the given part of A is read, and not its diagonal if it is a
+	 * unit one; Aᵀ is obtained with “transposed_view()”.
+	 *
+	 * Arithmetic types do nearly all the operations with the GEMM engine
+	 * (see “matrix/triangular.hpp”).
+	 *
+	 * Requirements:
+	 * - A must be square, with as many rows as this view (left side) or
+	 *   as many columns (right side);
+	 * - A must not overlap this view.
+	 */
+	void trmm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a);
+
+	/**
+	 * Same as “trmm()” but the work is split by the given executor.
+	 */
+	void trmm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a, executor &e);
+
+	/**
+	 * Solves “A × X = alpha × this” (left side) or “X × A = alpha × this”
+	 * (right side) where A is triangular, this view is replaced by X (this
+	 * is the BLAS operation of the same name).
+	 *
+	 * Same conventions as “trmm()”.
+	 *
+	 * Requirements:
+	 * - same as “trmm()”;
+	 * - the diagonal of A must not contain zeros.
+	 */
+	void trsm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a);
+
+	/**
+	 * Same as “trsm()” but the work is split by the given executor.
+	 */
+	void trsm(triangular_side side, triangular_part part,
+	          triangular_diagonal diagonal, const T &alpha,
+	          const const_matrix_view<T> &a, executor &e);
+
+	/**
+	 *
+	 */
+	reference operator()(size_t i, size_t j);
+
+	using const_matrix_view<T>::block;
+	using const_matrix_view<T>::column;
+	using const_matrix_view<T>::data;
+	using const_matrix_view<T>::row;
+	using const_matrix_view<T>::strided;
+	using const_matrix_view<T>::transposed_view;
+	using const_matrix_view<T>::operator();
+
+	/**
+	 * Copies the values of another view (with the same dimensions).
+	 */
+	matrix_view &operator=(const matrix_view &v);
+
+	/**
+	 * Evaluates an expression (with the same dimensions) in the viewed
+	 * memory, through a temporary matrix if it reads these values at other
+	 * positions.
+	 */
+	template <class E>
+	matrix_view &operator=(const matrix_details::expression<E> &e);
+
+	/**
+	 * Sets every element to a value.
+	 */
+	template <typename T2>
+	typename matrix_details::if_scalar<T2, matrix_view &>::type
+	operator=(const T2 &value);
+
+	/**
+	 * Element-wise operations with an expression or a scalar.
+	 */
+	template <class E>
+	matrix_view &operator+=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix_view &operator-=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix_view &operator*=(const matrix_details::expression<E> &e);
+	template <class E>
+	matrix_view &operator/=(const matrix_details::expression<E> &e);
+
+	template <typename T2>
+	typename matrix_details::if_scalar<T2, matrix_view &>::type
+	operator+=(const T2 &s);
+	template <typename T2>
+	typename matrix_details::if_scalar<T2, matrix_view &>::type
+	operator-=(const T2 &s);
+	template <typename T2>
+	typename matrix_details::if_scalar<T2, matrix_view &>::type
+	operator*=(const T2 &s);
+	template <typename T2>
+	typename matrix_details::if_scalar<T2, matrix_view &>::type
+	operator/=(const T2 &s);
+
+private:
+
+	/**
+	 * Applies “op(this(i, j), x(i, j))” to each element.
+	 */
+	template <class X, class Operation>
+	void evaluate(const X &x, Operation op);
+
+	/**
+	 *
+	 */
+	explicit matrix_view(const const_matrix_view<T> &v);
+};
+
+JFCPP_NAMESPACE_END
+
+#include "view/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_VIEW
@@ -0,0 +1,628 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <cstddef>
+
+#include <contracts.h>
+
+#include "../../common.hpp"
+#include "../../functional.hpp"
+#include "../../meta/is_arithmetic.hpp"
+#include "../gemm.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_details
+{
+	template <typename T>
+	memory_layout<T>
+	layout_of(const const_matrix_view<T> &v)
+	{
+		const memory_layout<T> layout =
+			{v.data(), v.rows(), v.columns(), v.row_stride(), v.column_stride()};
+
+		return layout;
+	}
+
+	/**
+	 * “C = alpha × A × B + beta × C” on views.
+	 */
+	template <typename T, bool = meta::is_arithmetic<T>::value>
+	struct view_product
+	{
+		static
+		void
+		compute(executor &, const T &alpha, const const_matrix_view<T> &a,
+		        const const_matrix_view<T> &b, const T &beta,
+		        matrix_view<T> &c)
+		{
+			for (size_t i = 0; i < c.rows(); ++i)
+			{
+				for (size_t j = 0; j < c.columns(); ++j)
+				{
+					T tmp(0);
+					for (size_t k = 0; k < a.columns(); ++k)
+					{
+						tmp += a(i, k) * b(k, j);
+					}
+
+					T &cij = c(i, j);
+					cij = (beta == T(0) ? alpha * tmp : alpha * tmp + beta * cij);
+				}
+			}
+		}
+	};
+
+	template <typename T>
+	struct view_product<T, true>
+	{
+		static
+		void
+		compute(executor &e, const T &alpha, const const_matrix_view<T> &a,
+		        const const_matrix_view<T> &b, const T &beta,
+		        matrix_view<T> &c)
+		{
+			gemm(e, c.rows(), c.columns(), a.columns(), alpha,
+			     a.data(), a.row_stride(), a.column_stride(),
+			     b.data(), b.row_stride(), b.column_stride(),
+			     beta, c.data(), c.row_stride(), c.column_stride());
+		}
+	};
+} // namespace matrix_details
+
+////////////////////////////////////////
+// const_matrix_view
+
+template <typename T>
+const_matrix_view<T>::const_matrix_view()
+	: _data(NULL), _rows(0), _columns(0), _row_stride(0), _column_stride(1)
+{}
+
+template <typename T>
+const_matrix_view<T>::const_matrix_view(const T *data, size_t rows,
+                                        size_t columns, size_t row_stride,
+                                        size_t column_stride)
+	: _data(data), _rows(rows), _columns(columns), _row_stride(row_stride),
+	  _column_stride(column_stride)
+{}
+
+template <typename T>
+template <class Allocator, class Layout>
+const_matrix_view<T>::const_matrix_view(const matrix<T, Allocator, Layout> &m)
+	: _data(m.begin()), _rows(m.rows()), _columns(m.columns()),
+	  _row_stride(Layout::row_stride(m.rows(), m.columns())),
+	  _column_stride(Layout::column_stride(m.rows(), m.columns()))
+{}
+
+template <typename T>
+const_matrix_view<T>
+const_matrix_view<T>::block(size_t i, size_t j, size_t rows,
+                            size_t columns) const
+{
+	requires(i + rows <= this->_rows);
+	requires(j + columns <= this->_columns);
+
+	return const_matrix_view(this->_data + i * this->_row_stride
+	                         + j * this->_column_stride,
+	                         rows, columns, this->_row_stride,
+	                         this->_column_stride);
+}
+
+template <typename T>
+const_matrix_view<T>
+const_matrix_view<T>::column(size_t j) const
+{
+	return this->block(0, j, this->_rows, 1);
+}
+
+template <typename T>
+size_t
+const_matrix_view<T>::columns() const
+{
+	return this->_columns;
+}
+
+template <typename T>
+size_t
+const_matrix_view<T>::column_stride() const
+{
+	return this->_column_stride;
+}
+
+template <typename T>
+const T *
+const_matrix_view<T>::data() const
+{
+	return this->_data;
+}
+
+template <typename T>
+bool
+const_matrix_view<T>::is_contiguous() const
+{
+	return (((this->_columns < 2) || (this->_column_stride == 1))
+	        && ((this->_rows < 2) || (this->_row_stride == this->_columns)));
+}
+
+template <typename T>
+matrix<T>
+const_matrix_view<T>::mprod(const const_matrix_view &m) const
+{
+	sequential_executor e;
+
+	return this->mprod(m, e);
+}
+
+template <typename T>
+matrix<T>
+const_matrix_view<T>::mprod(const const_matrix_view &m, executor &e) const
+{
+	requires(this->_columns == m.rows());
+
+	matrix<T> result(this->_rows, m.columns());
+	matrix_view<T> r(result);
+
+	r.gemm(T(1), *this, m, T(0), e);
+
+	return result;
+}
+
+template <typename T>
+const_matrix_view<T>
+const_matrix_view<T>::row(size_t i) const
+{
+	return this->block(i, 0, 1, this->_columns);
+}
+
+template <typename T>
+size_t
+const_matrix_view<T>::rows() const
+{
+	return this->_rows;
+}
+
+template <typename T>
+size_t
+const_matrix_view<T>::row_stride() const
+{
+	return this->_row_stride;
+}
+
+template <typename T>
+void
+const_matrix_view<T>::solve(matrix_view<T> B) const
+{
+	requires(this->_rows == this->_columns);
+	requires(B.rows() == this->_rows);
+
+	matrix<T> a(*this), x(B);
+
+	a.solve_perf(x);
+
+	B = x;
+}
+
+template <typename T>
+const_matrix_view<T>
+const_matrix_view<T>::strided(size_t row_step, size_t column_step) const
+{
+	requires(row_step > 0);
+	requires(column_step > 0);
+
+	return const_matrix_view(this->_data,
+	                         (this->_rows + row_step - 1) / row_step,
+	                         (this->_columns + column_step - 1) / column_step,
+	                         this->_row_stride * row_step,
+	                         this->_column_stride * column_step);
+}
+
+template <typename T>
+const_matrix_view<T>
+const_matrix_view<T>::transposed_view() const
+{
+	return const_matrix_view(this->_data, this->_columns, this->_rows,
+	                         this->_column_stride, this->_row_stride);
+}
+
+template <typename T>
+typename const_matrix_view<T>::const_reference
+const_matrix_view<T>::operator()(size_t i, size_t j) const
+{
+	requires(i < this->_rows);
+	requires(j < this->_columns);
+
+	return this->_data[i * this->_row_stride + j * this->_column_stride];
+}
+
+template <typename T>
+typename const_matrix_view<T>::allocator_type
+const_matrix_view<T>::get_allocator() const
+{
+	return allocator_type();
+}
+
+template <typename T>
+template <class M>
+bool
+const_matrix_view<T>::references(const M &m) const
+{
+	return matrix_details::overlaps(matrix_details::layout_of(*this),
+	                                matrix_details::layout_of(m));
+}
+
+template <typename T>
+template <class M>
+bool
+const_matrix_view<T>::aliases(const M &m) const
+{
+	return (this->references(m)
+	        && !matrix_details::same_layout(matrix_details::layout_of(*this),
+	                                        matrix_details::layout_of(m)));
+}
+
+////////////////////////////////////////
+// matrix_view
+
+template <typename T>
+matrix_view<T>::matrix_view()
+{}
+
+template <typename T>
+matrix_view<T>::matrix_view(T *data, size_t rows, size_t columns,
+                            size_t row_stride, size_t column_stride)
+	: const_matrix_view<T>(data, rows, columns, row_stride, column_stride)
+{}
+
+template <typename T>
+template <class Allocator, class Layout>
+matrix_view<T>::matrix_view(matrix<T, Allocator, Layout> &m)
+	: const_matrix_view<T>(m)
+{}
+
+template <typename T>
+matrix_view<T>::matrix_view(const const_matrix_view<T> &v)
+	: const_matrix_view<T>(v)
+{}
+
+template <typename T>
+matrix_view<T>
+matrix_view<T>::block(size_t i, size_t j, size_t rows, size_t columns)
+{
+	return matrix_view(const_matrix_view<T>::block(i, j, rows, columns));
+}
+
+template <typename T>
+matrix_view<T>
+matrix_view<T>::column(size_t j)
+{
+	return matrix_view(const_matrix_view<T>::column(j));
+}
+
+template <typename T>
+T *
+matrix_view<T>::data()
+{
+	// The memory has been given as mutable.
+	return const_cast<T *>(this->_data);
+}
+
+template <typename T>
+void
+matrix_view<T>::gemm(const T &alpha, const const_matrix_view<T> &a,
+                     const const_matrix_view<T> &b, const T &beta)
+{
+	sequential_executor e;
+
+	this->gemm(alpha, a, b, beta, e);
+}
+
+template <typename T>
+void
+matrix_view<T>::gemm(const T &alpha, const const_matrix_view<T> &a,
+                     const const_matrix_view<T> &b, const T &beta, executor &e)
+{
+	requires(a.columns() == b.rows());
+	requires(a.rows() == this->_rows);
+	requires(b.columns() == this->_columns);
+	requires(!a.references(*this));
+	requires(!b.references(*this));
+
+	matrix_details::view_product<T>::compute(e, alpha, a, b, beta, *this);
+}
+
+template <typename T>
+matrix_view<T>
+matrix_view<T>::row(size_t i)
+{
+	return matrix_view(const_matrix_view<T>::row(i));
+}
+
+template <typename T>
+matrix_view<T>
+matrix_view<T>::strided(size_t row_step, size_t column_step)
+{
+	return matrix_view(const_matrix_view<T>::strided(row_step, column_step));
+}
+
+template <typename T>
+matrix_view<T>
+matrix_view<T>::transposed_view()
+{
+	return matrix_view(const_matrix_view<T>::transposed_view());
+}
+
+template <typename T>
+void
+matrix_view<T>::trmm(triangular_side side, triangular_part part,
+                     triangular_diagonal diagonal, const T &alpha,
+                     const const_matrix_view<T> &a)
+{
+	sequential_executor e;
+
+	this->trmm(side, part, diagonal, alpha, a, e);
+}
+
+template <typename T>
+void
+matrix_view<T>::trmm(triangular_side side, triangular_part part,
+                     triangular_diagonal diagonal, const T &alpha,
+                     const const_matrix_view<T> &a, executor &e)
+{
+	requires(a.rows() == a.columns());
+	requires(a.rows() == (side == left_side ? this->_rows : this->_columns));
+	requires(!a.references(*this));
+
+	// B × A is (Aᵀ × Bᵀ)ᵀ, and the upper part of A is the lower one of Aᵀ.
+	const bool left = (side == left_side);
+	const size_t
+		m = left ? this->_rows : this->_columns,
+		n = left ? this->_columns : this->_rows;
+	const ptrdiff_t
+		rsa = left ? a.row_stride() : a.column_stride(),
+		csa = left ? a.column_stride() : a.row_stride(),
+		rsb = left ? this->_row_stride : this->_column_stride,
+		csb = left ? this->_column_stride : this->_row_stride;
+
+	matrix_details::trmm(e, (part == upper_part) == left,
+	                     diagonal == unit_diagonal, m, n, alpha, a.data(), rsa,
+	                     csa, this->data(), rsb, csb);
+}
+
+template <typename T>
+void
+matrix_view<T>::trsm(triangular_side side, triangular_part part,
+                     triangular_diagonal diagonal, const T &alpha,
+                     const const_matrix_view<T> &a)
+{
+	sequential_executor e;
+
+	this->trsm(side, part, diagonal, alpha, a, e);
+}
+
+template <typename T>
+void
+matrix_view<T>::trsm(triangular_side side, triangular_part part,
+                     triangular_diagonal diagonal, const T &alpha,
+                     const const_matrix_view<T> &a, executor &e)
+{
+	requires(a.rows() == a.columns());
+	requires(a.rows() == (side == left_side ? this->_rows : this->_columns));
+	requires(!a.references(*this));
+
+	// X × A = B is Aᵀ × Xᵀ = Bᵀ.
+	const bool left = (side == left_side);
+	const size_t
+		m = left ? this->_rows : this->_columns,
+		n = left ? this->_columns : this->_rows;
+	const ptrdiff_t
+		rsa = left ? a.row_stride() : a.column_stride(),
+		csa = left ? a.column_stride() : a.row_stride(),
+		rsb = left ? this->_row_stride : this->_column_stride,
+		csb = left ? this->_column_stride : this->_row_stride;
+
+	matrix_details::trsm(e, (part == upper_part) == left,
+	                     diagonal == unit_diagonal, m, n, alpha, a.data(), rsa,
+	                     csa, this->data(), rsb, csb);
+}
+
+template <typename T>
+typename matrix_view<T>::reference
+matrix_view<T>::operator()(size_t i, size_t j)
+{
+	requires(i < this->_rows);
+	requires(j < this->_columns);
+
+	return this->data()[i * this->_row_stride + j * this->_column_stride];
+}
+
+template <typename T>
+matrix_view<T> &
+matrix_view<T>::operator=(const matrix_view &v)
+{
+	return (*this = static_cast<const matrix_details::expression<const_matrix_view<T> > &>(v));
+}
+
+template <typename T>
+template <class E>
+matrix_view<T> &
+matrix_view<T>::operator=(const matrix_details::expression<E> &e)
+{
+	const typename matrix_details::operand<E>::type x(e.derived());
+
+	requires((x.rows() == this->_rows) && (x.columns() == this->_columns));
+
+	if (x.aliases(*this))
+	{
+		const matrix<typename E::value_type> tmp(e.derived());
+
+		return (*this = tmp);
+	}
+
+	this->evaluate(x, matrix_details::assign<T, typename E::value_type>());
+
+	return *this;
+}
+
+template <typename T>
+template <typename T2>
+typename matrix_details::if_scalar<T2, matrix_view<T> &>::type
+matrix_view<T>::operator=(const T2 &value)
+{
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		for (size_t j = 0; j < this->_columns; ++j)
+		{
+			(*this)(i, j) = value;
+		}
+	}
+
+	return *this;
+}
+
+#define JFCPP_MATRIX_VIEW_OPERATION(OP, FUNC_NAME) \
+template <typename T> \
+template <class E> \
+matrix_view<T> & \
+matrix_view<T>::operator OP##=(const matrix_details::expression<E> &e) \
+{ \
+	const typename matrix_details::operand<E>::type x(e.derived()); \
+ \
+	requires((x.rows() == this->_rows) && (x.columns() == this->_columns)); \
+ \
+	if (x.aliases(*this)) \
+	{ \
+		return (*this OP##= matrix<typename E::value_type>(e.derived())); \
+	} \
+ \
+	this->evaluate(x, functional::FUNC_NAME##_assign<T, typename E::value_type>()); \
+ \
+	return *this; \
+} \
+template <typename T> \
+template <typename T2> \
+typename matrix_details::if_scalar<T2, matrix_view<T> &>::type \
+matrix_view<T>::operator OP##=(const T2 &s) \
+{ \
+	for (size_t i = 0; i < this->_rows; ++i) \
+	{ \
+		for (size_t j = 0; j < this->_columns; ++j) \
+		{ \
+			(*this)(i, j) OP##= s; \
+		} \
+	} \
+ \
+	return *this; \
+}
+
+JFCPP_MATRIX_VIEW_OPERATION(+, plus)
+JFCPP_MATRIX_VIEW_OPERATION(-, minus)
+JFCPP_MATRIX_VIEW_OPERATION(*, multiplies)
+JFCPP_MATRIX_VIEW_OPERATION(/, divides)
+
+#undef JFCPP_MATRIX_VIEW_OPERATION
+
+template <typename T>
+template <class X, class Operation>
+void
+matrix_view<T>::evaluate(const X &x, Operation op)
+{
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		T *row = this->data() + i * this->_row_stride;
+
+		for (size_t j = 0; j < this->_columns; ++j)
+		{
+			op(row[j * this->_column_stride], x(i, j));
+		}
+	}
+}
+
+////////////////////////////////////////
+// matrix
+
+template <typename T, class Allocator, class Layout>
+matrix_view<T>
+matrix<T, Allocator, Layout>::block(size_t i, size_t j, size_t rows,
+                                    size_t columns)
+{
+	return this->view().block(i, j, rows, columns);
+}
+
+template <typename T, class Allocator, class Layout>
+const_matrix_view<T>
+matrix<T, Allocator, Layout>::block(size_t i, size_t j, size_t rows,
+                                    size_t columns) const
+{
+	return this->view().block(i, j, rows, columns);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+matrix<T, Allocator, Layout>::trmm(triangular_side side, triangular_part part,
+                                   triangular_diagonal diagonal,
+                                   const T &alpha,
+                                   const const_matrix_view<T> &a)
+{
+	this->view().trmm(side, part, diagonal, alpha, a);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+matrix<T, Allocator, Layout>::trmm(triangular_side side, triangular_part part,
+                                   triangular_diagonal diagonal,
+                                   const T &alpha,
+                                   const const_matrix_view<T> &a, executor &e)
+{
+	this->view().trmm(side, part, diagonal, alpha, a, e);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+matrix<T, Allocator, Layout>::trsm(triangular_side side, triangular_part part,
+                                   triangular_diagonal diagonal,
+                                   const T &alpha,
+                                   const const_matrix_view<T> &a)
+{
+	this->view().trsm(side, part, diagonal, alpha, a);
+}
+
+template <typename T, class Allocator, class Layout>
+void
+matrix<T, Allocator, Layout>::trsm(triangular_side side, triangular_part part,
+                                   triangular_diagonal diagonal,
+                                   const T &alpha,
+                                   const const_matrix_view<T> &a, executor &e)
+{
+	this->view().trsm(side, part, diagonal, alpha, a, e);
+}
+
+template <typename T, class Allocator, class Layout>
+matrix_view<T>
+matrix<T, Allocator, Layout>::view()
+{
+	return matrix_view<T>(*this);
+}
+
+template <typename T, class Allocator, class Layout>
+const_matrix_view<T>
+matrix<T, Allocator, Layout>::view() const
+{
+	return const_matrix_view<T>(*this);
+}
+
+JFCPP_NAMESPACE_END
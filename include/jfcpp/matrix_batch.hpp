@@ -0,0 +1,232 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_MATRIX_BATCH
+#define H_JFCPP_MATRIX_BATCH
+
+#include <cstddef>
+#include <vector>
+
+#include "aligned_allocator.hpp"
+#include "common.hpp"
+#include "fixed_matrix.hpp"
+#include "thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * A batch of matrices with the same small dimensions (e.g. thousands of 3 × 3
+ * rotations or 4 × 4 transforms), which are multiplied, inverted or solved
+ * all at once.
+ *
+ * The matrices are interleaved (a structure of arrays by block): the batch
+ * is split in blocks of “simd::kernels<T>::BL” matrices and a block stores
+ * the element (0, 0) of all its matrices, then the element (0, 1), etc.  Each
+ * lane of a SIMD register is thus a different matrix and an operation costs
+ * the instructions of a single matrix for a whole register, without any heap
+ * allocation by matrix.  The last block is padded.
+ *
+ * The determinant and the inverse use the explicit formulas of
+ * “fixed_matrix”, without pivoting.
+ *
+ * Requirements:
+ * - T must be “float” or “double”;
+ * - R and C must be in [1, 4].
+ *
+ * @template T         The type of the elements.
+ * @template R         The number of rows of each matrix.
+ * @template C         The number of columns of each matrix.
+ * @template Allocator A standard allocator of T.
+ */
+template <typename T, size_t R, size_t C = R,
+          class Allocator = aligned_allocator<T> >
+class matrix_batch
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 *
+	 */
+	typedef T &reference;
+
+	/**
+	 *
+	 */
+	typedef const T &const_reference;
+
+	/**
+	 * The type of a single matrix.
+	 */
+	typedef fixed_matrix<T, R, C> matrix_type;
+
+	/**
+	 * Constructs an empty batch.
+	 */
+	matrix_batch();
+
+	/**
+	 * Constructs a batch of n matrices filled with a value.
+	 */
+	explicit matrix_batch(size_t n, const T &value = T(0));
+
+	/**
+	 * Gets the number of matrices.
+	 */
+	size_t size() const;
+
+	/**
+	 *
+	 */
+	static size_t columns();
+
+	/**
+	 *
+	 */
+	static size_t rows();
+
+	/**
+	 * Gets the interleaved values (see the description of the class).
+	 */
+	T *data();
+	const T *data() const;
+
+	/**
+	 * Computes the determinant of every matrix.
+	 *
+	 * Requirement:
+	 * - The matrices must be square (checked at compile time).
+	 */
+	std::vector<T> det() const;
+
+	/**
+	 * Same as “det()” but the work is split by the given executor.
+	 */
+	std::vector<T> det(executor &e) const;
+
+	/**
+	 * Gets a copy of the matrix b.
+	 */
+	matrix_type get(size_t b) const;
+
+	/**
+	 * Computes the inverse of every matrix.
+	 *
+	 * Requirement:
+	 * - The matrices must be square (checked at compile time).
+	 *
+	 * @throw std::runtime_error If one of the matrices is not invertible.
+	 */
+	matrix_batch inverse() const;
+
+	/**
+	 * Same as “inverse()” but the work is split by the given executor.
+	 */
+	matrix_batch inverse(executor &e) const;
+
+	/**
+	 * Computes the inverse of every matrix.
+	 *
+	 * Contrary to the method “inverse() const”, the inverses are computed
+	 * in place (without allocating and touching new memory) and this batch
+	 * is left empty.
+	 *
+	 * Requirement:
+	 * - The matrices must be square (checked at compile time).
+	 *
+	 * @throw std::runtime_error If one of the matrices is not invertible.
+	 */
+	matrix_batch inverse_perf();
+
+	/**
+	 * Same as “inverse_perf()” but the work is split by the given executor.
+	 */
+	matrix_batch inverse_perf(executor &e);
+
+	/**
+	 * Computes the product of each matrix by the matrix with the same index
+	 * in m.
+	 *
+	 * Requirement:
+	 * - m must have the same size.
+	 */
+	template <size_t C2, class A2>
+	matrix_batch<T, R, C2, Allocator>
+	mprod(const matrix_batch<T, C, C2, A2> &m) const;
+
+	/**
+	 * Same as “mprod()” but the work is split by the given executor.
+	 */
+	template <size_t C2, class A2>
+	matrix_batch<T, R, C2, Allocator>
+	mprod(const matrix_batch<T, C, C2, A2> &m, executor &e) const;
+
+	/**
+	 * Sets the matrix b.
+	 */
+	void set(size_t b, const matrix_type &m);
+
+	/**
+	 * Solves each “this[b] × X = B[b]” where B is replaced by X.
+	 *
+	 * X is computed with the inverse, block by block.
+	 *
+	 * Requirements:
+	 * - The matrices must be square (checked at compile time);
+	 * - B must have the same size.
+	 *
+	 * @throw std::runtime_error If one of the matrices is not invertible (B
+	 *                           is then partially solved).
+	 */
+	template <size_t C2, class A2>
+	void solve(matrix_batch<T, R, C2, A2> &B) const;
+
+	/**
+	 * Same as “solve()” but the work is split by the given executor.
+	 */
+	template <size_t C2, class A2>
+	void solve(matrix_batch<T, R, C2, A2> &B, executor &e) const;
+
+	/**
+	 * Gets the value at the row i and the column j of the matrix b.
+	 */
+	reference operator()(size_t b, size_t i, size_t j);
+	const_reference operator()(size_t b, size_t i, size_t j) const;
+
+private:
+
+	/**
+	 *
+	 */
+	size_t _size;
+
+	/**
+	 * The blocks of interleaved matrices.
+	 */
+	std::vector<T, Allocator> _values;
+};
+
+JFCPP_NAMESPACE_END
+
+#include "matrix_batch/implementation.hpp"
+
+#endif // H_JFCPP_MATRIX_BATCH
@@ -0,0 +1,460 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../common.hpp"
+#include "../simd.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace matrix_batch_details
+{
+	/**
+	 * Only defined for the square dimensions supported by the kernels.
+	 */
+	template <size_t R, size_t C>
+	struct square;
+
+	template <>
+	struct square<1, 1>
+	{
+		enum { dimension = 1 };
+	};
+
+	template <>
+	struct square<2, 2>
+	{
+		enum { dimension = 2 };
+	};
+
+	template <>
+	struct square<3, 3>
+	{
+		enum { dimension = 3 };
+	};
+
+	template <>
+	struct square<4, 4>
+	{
+		enum { dimension = 4 };
+	};
+
+	/**
+	 * Minimum number of blocks by slice of work, which is also the number
+	 * of blocks solved at once by “solve()”.
+	 */
+	enum { grain = 64 };
+
+	/**
+	 * Number of blocks needed for n matrices.
+	 */
+	template <typename T>
+	size_t
+	blocks(size_t n)
+	{
+		return ((n + simd::kernels<T>::BL - 1) / simd::kernels<T>::BL);
+	}
+
+	/**
+	 * Applies a batch kernel to slices of consecutive blocks.
+	 *
+	 * a is r × k, b is k × c and out receives the r × c (or r × r for the
+	 * inverse) results, d one determinant by matrix.  For “solve”, a is r
+	 * × r and out contains B (r × c) on input.
+	 */
+	template <typename T>
+	class batch_task : public parallel_task
+	{
+	public:
+
+		enum operation { det, inverse, mprod, solve };
+
+		batch_task(operation op, size_t size, size_t slices, size_t r,
+		           size_t k, size_t c, const T *a, const T *b, T *out,
+		           T *d)
+			: _op(op), _size(size), _blocks(blocks<T>(size)),
+			  _slices(slices), _r(r), _k(k), _c(c), _a(a), _b(b),
+			  _out(out), _d(d)
+		{}
+
+		void
+		operator()(size_t slice)
+		{
+			const simd::kernels<T> &kernels = simd::kernels<T>::get();
+			const size_t
+				BL = simd::kernels<T>::BL,
+				begin = slice * this->_blocks / this->_slices,
+				end = (slice + 1) * this->_blocks / this->_slices;
+			const size_t r = this->_r, k = this->_k, c = this->_c;
+			const T *a = this->_a + begin * r * k * BL;
+
+			switch (this->_op)
+			{
+			case det:
+				kernels.batch_det(end - begin, r, a, this->_d + begin * BL);
+				break;
+
+			case inverse:
+				kernels.batch_inverse(end - begin, r, a,
+				                      this->_out + begin * r * r * BL,
+				                      this->_d + begin * BL);
+				this->check(begin, end, this->_d + begin * BL);
+				break;
+
+			case mprod:
+				kernels.batch_mprod(end - begin, r, k, c, a,
+				                    this->_b + begin * k * c * BL,
+				                    this->_out + begin * r * c * BL);
+				break;
+
+			case solve:
+				{
+					// By chunks of blocks which stay in the cache.
+					std::vector<T>
+						inverses(grain * r * r * BL),
+						dets(grain * BL),
+						x(grain * r * c * BL);
+
+					for (size_t first = begin; first < end; first += grain)
+					{
+						const size_t count = std::min<size_t>(grain,
+						                                      end - first);
+						T *b = this->_out + first * r * c * BL;
+
+						kernels.batch_inverse(count, r,
+						                      this->_a + first * r * r * BL,
+						                      &inverses[0], &dets[0]);
+						this->check(first, first + count, &dets[0]);
+						kernels.batch_mprod(count, r, r, c, &inverses[0], b,
+						                    &x[0]);
+						std::copy(x.begin(), x.begin() + count * r * c * BL,
+						          b);
+					}
+				}
+				break;
+			}
+		}
+
+	private:
+
+		/**
+		 * Checks the determinants of the blocks [begin, end) (d being the
+		 * one of the first matrix), the padding is ignored.
+		 *
+		 * @throw std::runtime_error If one of them is zero.
+		 */
+		void
+		check(size_t begin, size_t end, const T *d) const
+		{
+			const size_t
+				first = begin * simd::kernels<T>::BL,
+				last = std::min(end * simd::kernels<T>::BL, this->_size);
+
+			for (size_t i = first; i < last; ++i)
+			{
+				if (d[i - first] == T(0))
+				{
+					throw std::runtime_error("singular matrix");
+				}
+			}
+		}
+
+		const operation _op;
+
+		const size_t _size, _blocks, _slices, _r, _k, _c;
+
+		const T *const _a, *const _b;
+
+		T *const _out, *const _d;
+	};
+
+	/**
+	 * Runs an operation on a batch of n matrices.
+	 */
+	template <typename T>
+	void
+	run(executor &e, typename batch_task<T>::operation op, size_t n,
+	    size_t r, size_t k, size_t c, const T *a, const T *b, T *out, T *d)
+	{
+		const size_t slices = std::max<size_t>(
+			1, std::min<size_t>(e.concurrency(), blocks<T>(n) / grain));
+
+		if (n == 0)
+		{
+			return;
+		}
+
+		batch_task<T> task(op, n, slices, r, k, c, a, b, out, d);
+		e.run(task, slices);
+	}
+} // namespace matrix_batch_details
+
+template <typename T, size_t R, size_t C, class Allocator>
+matrix_batch<T, R, C, Allocator>::matrix_batch()
+	: _size(0)
+{}
+
+template <typename T, size_t R, size_t C, class Allocator>
+matrix_batch<T, R, C, Allocator>::matrix_batch(size_t n, const T &value)
+	: _size(n),
+	  _values(matrix_batch_details::blocks<T>(n) * R * C
+	          * simd::kernels<T>::BL, value)
+{}
+
+template <typename T, size_t R, size_t C, class Allocator>
+size_t
+matrix_batch<T, R, C, Allocator>::size() const
+{
+	return this->_size;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+size_t
+matrix_batch<T, R, C, Allocator>::columns()
+{
+	return C;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+size_t
+matrix_batch<T, R, C, Allocator>::rows()
+{
+	return R;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+T *
+matrix_batch<T, R, C, Allocator>::data()
+{
+	return (this->_values.empty() ? 0 : &this->_values[0]);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+const T *
+matrix_batch<T, R, C, Allocator>::data() const
+{
+	return (this->_values.empty() ? 0 : &this->_values[0]);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+std::vector<T>
+matrix_batch<T, R, C, Allocator>::det() const
+{
+	sequential_executor e;
+
+	return this->det(e);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+std::vector<T>
+matrix_batch<T, R, C, Allocator>::det(executor &e) const
+{
+	// Only compiles for square matrices.
+	const size_t n = matrix_batch_details::square<R, C>::dimension;
+
+	std::vector<T> result(matrix_batch_details::blocks<T>(this->_size)
+	                      * simd::kernels<T>::BL);
+
+	matrix_batch_details::run<T>(e, matrix_batch_details::batch_task<T>::det,
+	                             this->_size, n, n, n, this->data(), 0, 0,
+	                             result.empty() ? 0 : &result[0]);
+	result.resize(this->_size);
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+typename matrix_batch<T, R, C, Allocator>::matrix_type
+matrix_batch<T, R, C, Allocator>::get(size_t b) const
+{
+	matrix_type m;
+
+	for (size_t i = 0; i < R; ++i)
+	{
+		for (size_t j = 0; j < C; ++j)
+		{
+			m(i, j) = (*this)(b, i, j);
+		}
+	}
+
+	return m;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+matrix_batch<T, R, C, Allocator>
+matrix_batch<T, R, C, Allocator>::inverse() const
+{
+	sequential_executor e;
+
+	return this->inverse(e);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+matrix_batch<T, R, C, Allocator>
+matrix_batch<T, R, C, Allocator>::inverse(executor &e) const
+{
+	// Only compiles for square matrices.
+	const size_t n = matrix_batch_details::square<R, C>::dimension;
+
+	matrix_batch result(this->_size);
+	std::vector<T> dets(matrix_batch_details::blocks<T>(this->_size)
+	                    * simd::kernels<T>::BL);
+
+	matrix_batch_details::run<T>(e,
+	                             matrix_batch_details::batch_task<T>::inverse,
+	                             this->_size, n, n, n, this->data(), 0,
+	                             result.data(), dets.empty() ? 0 : &dets[0]);
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+matrix_batch<T, R, C, Allocator>
+matrix_batch<T, R, C, Allocator>::inverse_perf()
+{
+	sequential_executor e;
+
+	return this->inverse_perf(e);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+matrix_batch<T, R, C, Allocator>
+matrix_batch<T, R, C, Allocator>::inverse_perf(executor &e)
+{
+	// Only compiles for square matrices.
+	const size_t n = matrix_batch_details::square<R, C>::dimension;
+
+	matrix_batch result;
+	result._size = this->_size;
+	result._values.swap(this->_values);
+	this->_size = 0;
+
+	std::vector<T> dets(matrix_batch_details::blocks<T>(result._size)
+	                    * simd::kernels<T>::BL);
+
+	// The kernel reads each matrix before writing its inverse.
+	matrix_batch_details::run<T>(e,
+	                             matrix_batch_details::batch_task<T>::inverse,
+	                             result._size, n, n, n, result.data(), 0,
+	                             result.data(), dets.empty() ? 0 : &dets[0]);
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+template <size_t C2, class A2>
+matrix_batch<T, R, C2, Allocator>
+matrix_batch<T, R, C, Allocator>::mprod(const matrix_batch<T, C, C2, A2> &m)
+	const
+{
+	sequential_executor e;
+
+	return this->mprod(m, e);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+template <size_t C2, class A2>
+matrix_batch<T, R, C2, Allocator>
+matrix_batch<T, R, C, Allocator>::mprod(const matrix_batch<T, C, C2, A2> &m,
+                                        executor &e) const
+{
+	requires(m.size() == this->_size);
+
+	matrix_batch<T, R, C2, Allocator> result(this->_size);
+
+	matrix_batch_details::run<T>(e, matrix_batch_details::batch_task<T>::mprod,
+	                             this->_size, R, C, C2, this->data(),
+	                             m.data(), result.data(), 0);
+
+	return result;
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+void
+matrix_batch<T, R, C, Allocator>::set(size_t b, const matrix_type &m)
+{
+	for (size_t i = 0; i < R; ++i)
+	{
+		for (size_t j = 0; j < C; ++j)
+		{
+			(*this)(b, i, j) = m(i, j);
+		}
+	}
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+template <size_t C2, class A2>
+void
+matrix_batch<T, R, C, Allocator>::solve(matrix_batch<T, R, C2, A2> &B) const
+{
+	sequential_executor e;
+
+	this->solve(B, e);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+template <size_t C2, class A2>
+void
+matrix_batch<T, R, C, Allocator>::solve(matrix_batch<T, R, C2, A2> &B,
+                                        executor &e) const
+{
+	requires(B.size() == this->_size);
+
+	// Only compiles for square matrices.
+	const size_t n = matrix_batch_details::square<R, C>::dimension;
+
+	matrix_batch_details::run<T>(e, matrix_batch_details::batch_task<T>::solve,
+	                             this->_size, n, n, C2, this->data(), 0,
+	                             B.data(), 0);
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+typename matrix_batch<T, R, C, Allocator>::reference
+matrix_batch<T, R, C, Allocator>::operator()(size_t b, size_t i, size_t j)
+{
+	requires(b < this->_size);
+	requires(i < R);
+	requires(j < C);
+
+	const size_t BL = simd::kernels<T>::BL;
+
+	return this->_values[(b / BL) * R * C * BL + (i * C + j) * BL + b % BL];
+}
+
+template <typename T, size_t R, size_t C, class Allocator>
+typename matrix_batch<T, R, C, Allocator>::const_reference
+matrix_batch<T, R, C, Allocator>::operator()(size_t b, size_t i, size_t j)
+	const
+{
+	requires(b < this->_size);
+	requires(i < R);
+	requires(j < C);
+
+	const size_t BL = simd::kernels<T>::BL;
+
+	return this->_values[(b / BL) * R * C * BL + (i * C + j) * BL + b % BL];
+}
+
+JFCPP_NAMESPACE_END
@@ -0,0 +1,69 @@
+#ifndef H_JFCPP_META_IS_ARITHMETIC
+#define H_JFCPP_META_IS_ARITHMETIC
+
+#include "../common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace meta
+{
+	/**
+	 * Whether T is a built-in floating point type.
+	 */
+	template <typename T>
+	struct is_floating_point
+	{
+		static const bool value = false;
+	};
+
+	/**
+	 * Whether T is a built-in integer type (“bool” excluded).
+	 */
+	template <typename T>
+	struct is_integral
+	{
+		static const bool value = false;
+	};
+
+#	define SPECIALIZATION(TRAIT, TYPE) \
+	template <> \
+	struct TRAIT<TYPE> \
+	{ \
+		static const bool value = true; \
+	}
+
+	SPECIALIZATION(is_floating_point, float);
+	SPECIALIZATION(is_floating_point, double);
+	SPECIALIZATION(is_floating_point, long double);
+
+	SPECIALIZATION(is_integral, char);
+	SPECIALIZATION(is_integral, signed char);
+	SPECIALIZATION(is_integral, unsigned char);
+	SPECIALIZATION(is_integral, short int);
+	SPECIALIZATION(is_integral, unsigned short int);
+	SPECIALIZATION(is_integral, int);
+	SPECIALIZATION(is_integral, unsigned int);
+	SPECIALIZATION(is_integral, long int);
+	SPECIALIZATION(is_integral, unsigned long int);
+
+#	undef SPECIALIZATION
+
+	/**
+	 * Whether T is a built-in arithmetic type, i.e. a type for which the
+	 * usual operators are cheap and have no side effects.
+	 */
+	template <typename T>
+	struct is_arithmetic
+	{
+		static const bool value = (is_floating_point<T>::value
+		                           || is_integral<T>::value);
+	};
+
+	template <typename T>
+	struct is_arithmetic<const T> : public is_arithmetic<T>
+	{};
+} // namespace meta
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_META_IS_ARITHMETIC
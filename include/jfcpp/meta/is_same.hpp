@@ -0,0 +1,28 @@
+#ifndef H_JFCPP_META_IS_SAME
+#define H_JFCPP_META_IS_SAME
+
+#include "../common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace meta
+{
+	/**
+	 * Whether T1 and T2 are exactly the same type.
+	 */
+	template <typename T1, typename T2>
+	struct is_same
+	{
+		static const bool value = false;
+	};
+
+	template <typename T>
+	struct is_same<T, T>
+	{
+		static const bool value = true;
+	};
+} // namespace meta
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_META_IS_SAME
@@ -27,15 +27,30 @@ JFCPP_NAMESPACE_BEGIN
 
 namespace operators
 {
+	/**
+	 * Classes deriving from this one are never taken as the scalar operand of
+	 * the operators below, they must provide their own (e.g. matrix
+	 * expressions, see “matrix/expression.hpp”).
+	 */
+	struct non_scalar
+	{};
+
+	/**
+	 * The left operand is taken by value and returned as is (not through the
+	 * reference returned by “OP=”), so that in C++11 a temporary operand is
+	 * moved instead of copied, e.g. “a + b + c” only allocates once if T1 is
+	 * movable.
+	 */
 #	define JFCPP_BINARY_OPERATOR(NAME, OP) \
 	template <typename T1> \
 	struct NAME \
 	{ \
 		template <typename T2> friend \
-		T1 \
+		typename meta::enable_if<!meta::is_a<non_scalar, T2>::value, T1>::type \
 		operator OP(T1 lhs, const T2 &rhs) \
 		{ \
-			return (lhs OP##= rhs); \
+			lhs OP##= rhs; \
+			return lhs; \
 		} \
 	}
 
@@ -44,16 +59,19 @@ namespace operators
 	struct NAME \
 	{ \
 		template <typename T2> friend \
-		T1 \
+		typename meta::enable_if<!meta::is_a<non_scalar, T2>::value, T1>::type \
 		operator OP(T1 lhs, const T2 &rhs) \
 		{ \
-			return (lhs OP##= rhs); \
+			lhs OP##= rhs; \
+			return lhs; \
 		} \
 		template <typename T2> friend \
-		typename meta::enable_if<!meta::is_a<NAME<T2>, T2>::value, T1>::type \
+		typename meta::enable_if<!meta::is_a<NAME<T2>, T2>::value \
+		                         && !meta::is_a<non_scalar, T2>::value, T1>::type \
 		operator OP(const T2 &lhs, T1 rhs) \
 		{ \
-			return (rhs OP##= lhs); \
+			rhs OP##= lhs; \
+			return rhs; \
 		} \
 	}
 
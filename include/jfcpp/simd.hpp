@@ -0,0 +1,910 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_SIMD
+#define H_JFCPP_SIMD
+
+#include <cstddef>
+
+#include "common.hpp"
+
+// The kernels are compiled for every instruction set thanks to the “target”
+// attribute of GCC (and Clang), the best one is chosen at run time.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+	&& !defined(JFCPP_NO_SIMD)
+#	define JFCPP_SIMD_X86
+#	include <immintrin.h>
+#	define JFCPP_SIMD_TARGET(TARGET) __attribute__((target(TARGET)))
+#endif
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Hand-vectorized kernels for arrays of “float” and “double”.
+ *
+ * Each kernel is available for several instruction sets and the best one
+ * supported by the processor is selected at run time, so that the same binary
+ * runs well on different machines.
+ *
+ * Define “JFCPP_NO_SIMD” to use only the generic (C++) kernels.
+ */
+namespace simd
+{
+	/**
+	 * Supported instruction sets, from the least to the most powerful.
+	 */
+	enum instruction_set
+	{
+		generic,
+		sse2,
+		avx2,   // With FMA.
+		avx512  // Foundation only.
+	};
+
+	/**
+	 * Gets the best instruction set supported by this processor.
+	 */
+	inline
+	instruction_set
+	detect()
+	{
+#	ifdef JFCPP_SIMD_X86
+		static const instruction_set result =
+			(__builtin_cpu_supports("avx512f") ? avx512 :
+			 (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? avx2 :
+			 __builtin_cpu_supports("sse2") ? sse2 :
+			 generic);
+
+		return result;
+#	else
+		return generic;
+#	endif
+	}
+
+	/**
+	 * The kernels for a given type, each one is a pointer to the
+	 * implementation for a given instruction set.
+	 *
+	 * Only “float” and “double” are supported.
+	 */
+	template <typename T>
+	struct kernels;
+
+	namespace details
+	{
+		/**
+		 * The shape of the block of C computed by the GEMM micro-kernel of
+		 * each instruction set.
+		 *
+		 * A row is NR / W vectors and the MR × NR / W accumulators are
+		 * enough to hide the latency of the multiplications while leaving
+		 * registers for the vectors of B and the broadcast value of A.
+		 */
+		template <typename T, instruction_set ISA>
+		struct gemm_shape
+		{
+			enum
+			{
+				MR = 4,
+				NR = 4
+			};
+		};
+
+		/**
+		 * 8 accumulators out of 16 registers.
+		 */
+		template <typename T>
+		struct gemm_shape<T, sse2>
+		{
+			enum
+			{
+				MR = 4,
+				NR = 2 * (16 / sizeof(T))
+			};
+		};
+
+		/**
+		 * 12 accumulators out of 16 registers.
+		 */
+		template <typename T>
+		struct gemm_shape<T, avx2>
+		{
+			enum
+			{
+				MR = 6,
+				NR = 2 * (32 / sizeof(T))
+			};
+		};
+
+		/**
+		 * 24 accumulators out of 32 registers.
+		 */
+		template <typename T>
+		struct gemm_shape<T, avx512>
+		{
+			enum
+			{
+				MR = 8,
+				NR = 3 * (64 / sizeof(T))
+			};
+		};
+
+		/**
+		 * The size of the square block transposed by the transpose kernel:
+		 * 4 × 4 for “double” and 8 × 8 for “float” (one AVX register per
+		 * row).
+		 */
+		template <typename T>
+		struct transpose_shape
+		{
+			enum
+			{
+				TB = 32 / sizeof(T)
+			};
+		};
+
+		/**
+		 * The number of matrices interleaved in a block of a batch (see
+		 * “matrix_batch”): a whole number of vectors for every instruction
+		 * set.
+		 */
+		template <typename T>
+		struct batch_shape
+		{
+			enum
+			{
+				BL = 16
+			};
+		};
+
+		/**
+		 * Defines the kernels on batches of small matrices, V being the
+		 * vector type and W its number of elements: each lane of a vector
+		 * is a different matrix.
+		 *
+		 * The determinant and the adjugate use the same explicit formulas
+		 * as “fixed_matrix”.
+		 */
+#		define JFCPP_SIMD_BATCH_KERNELS(ATTRIBUTES, T, V, W, LOAD, STORE, SET1, ADD, SUB, MUL, DIV, FMADD) \
+		ATTRIBUTES \
+		V batch_minor(V a, V b, V c, V d) \
+		{ return SUB(MUL(a, b), MUL(c, d)); } \
+		\
+		ATTRIBUTES \
+		V batch_adjugate(size_t n, const V *a, V *b) \
+		{ \
+			if (n == 1) \
+			{ \
+				if (b) b[0] = SET1(T(1)); \
+				return a[0]; \
+			} \
+			if (n == 2) \
+			{ \
+				if (b) \
+				{ \
+					b[0] = a[3]; \
+					b[1] = SUB(SET1(T(0)), a[1]); \
+					b[2] = SUB(SET1(T(0)), a[2]); \
+					b[3] = a[0]; \
+				} \
+				return batch_minor(a[0], a[3], a[1], a[2]); \
+			} \
+			if (n == 3) \
+			{ \
+				const V \
+					b0 = batch_minor(a[4], a[8], a[5], a[7]), \
+					b3 = batch_minor(a[5], a[6], a[3], a[8]), \
+					b6 = batch_minor(a[3], a[7], a[4], a[6]); \
+				if (b) \
+				{ \
+					b[0] = b0; \
+					b[1] = batch_minor(a[2], a[7], a[1], a[8]); \
+					b[2] = batch_minor(a[1], a[5], a[2], a[4]); \
+					b[3] = b3; \
+					b[4] = batch_minor(a[0], a[8], a[2], a[6]); \
+					b[5] = batch_minor(a[2], a[3], a[0], a[5]); \
+					b[6] = b6; \
+					b[7] = batch_minor(a[1], a[6], a[0], a[7]); \
+					b[8] = batch_minor(a[0], a[4], a[1], a[3]); \
+				} \
+				return FMADD(a[0], b0, FMADD(a[1], b3, MUL(a[2], b6))); \
+			} \
+			/* The 2 × 2 minors of the two first rows (s) and of the two */ \
+			/* last ones (c). */ \
+			const V s[6] = \
+			{ \
+				batch_minor(a[0], a[5], a[4], a[1]), \
+				batch_minor(a[0], a[6], a[4], a[2]), \
+				batch_minor(a[0], a[7], a[4], a[3]), \
+				batch_minor(a[1], a[6], a[5], a[2]), \
+				batch_minor(a[1], a[7], a[5], a[3]), \
+				batch_minor(a[2], a[7], a[6], a[3]) \
+			}; \
+			const V c[6] = \
+			{ \
+				batch_minor(a[8], a[13], a[12], a[9]), \
+				batch_minor(a[8], a[14], a[12], a[10]), \
+				batch_minor(a[8], a[15], a[12], a[11]), \
+				batch_minor(a[9], a[14], a[13], a[10]), \
+				batch_minor(a[9], a[15], a[13], a[11]), \
+				batch_minor(a[10], a[15], a[14], a[11]) \
+			}; \
+			if (b) \
+			{ \
+				b[0] = FMADD(a[7], c[3], batch_minor(a[5], c[5], a[6], c[4])); \
+				b[1] = SUB(batch_minor(a[2], c[4], a[1], c[5]), MUL(a[3], c[3])); \
+				b[2] = FMADD(a[15], s[3], batch_minor(a[13], s[5], a[14], s[4])); \
+				b[3] = SUB(batch_minor(a[10], s[4], a[9], s[5]), MUL(a[11], s[3])); \
+				b[4] = SUB(batch_minor(a[6], c[2], a[4], c[5]), MUL(a[7], c[1])); \
+				b[5] = FMADD(a[3], c[1], batch_minor(a[0], c[5], a[2], c[2])); \
+				b[6] = SUB(batch_minor(a[14], s[2], a[12], s[5]), MUL(a[15], s[1])); \
+				b[7] = FMADD(a[11], s[1], batch_minor(a[8], s[5], a[10], s[2])); \
+				b[8] = FMADD(a[7], c[0], batch_minor(a[4], c[4], a[5], c[2])); \
+				b[9] = SUB(batch_minor(a[1], c[2], a[0], c[4]), MUL(a[3], c[0])); \
+				b[10] = FMADD(a[15], s[0], batch_minor(a[12], s[4], a[13], s[2])); \
+				b[11] = SUB(batch_minor(a[9], s[2], a[8], s[4]), MUL(a[11], s[0])); \
+				b[12] = SUB(batch_minor(a[5], c[1], a[4], c[3]), MUL(a[6], c[0])); \
+				b[13] = FMADD(a[2], c[0], batch_minor(a[0], c[3], a[1], c[1])); \
+				b[14] = SUB(batch_minor(a[13], s[1], a[12], s[3]), MUL(a[14], s[0])); \
+				b[15] = FMADD(a[10], s[0], batch_minor(a[8], s[3], a[9], s[1])); \
+			} \
+			return ADD(ADD(batch_minor(s[0], c[5], s[1], c[4]), \
+			               batch_minor(s[2], c[3], s[4], c[1])), \
+			           FMADD(s[3], c[2], MUL(s[5], c[0]))); \
+		} \
+		\
+		ATTRIBUTES \
+		void batch_mprod(size_t blocks, size_t r, size_t k, size_t c, \
+		                 const T *a, const T *b, T *ab) \
+		{ \
+			enum { BL = batch_shape<T>::BL }; \
+			for (size_t block = 0; block < blocks; ++block) \
+			{ \
+				for (size_t l = 0; l < BL; l += W) \
+					for (size_t i = 0; i < r; ++i) \
+						for (size_t j = 0; j < c; ++j) \
+						{ \
+							V acc = MUL(LOAD(a + i * k * BL + l), LOAD(b + j * BL + l)); \
+							for (size_t p = 1; p < k; ++p) \
+								acc = FMADD(LOAD(a + (i * k + p) * BL + l), \
+								            LOAD(b + (p * c + j) * BL + l), acc); \
+							STORE(ab + (i * c + j) * BL + l, acc); \
+						} \
+				a += r * k * BL; \
+				b += k * c * BL; \
+				ab += r * c * BL; \
+			} \
+		} \
+		\
+		ATTRIBUTES \
+		void batch_det(size_t blocks, size_t n, const T *a, T *d) \
+		{ \
+			enum { BL = batch_shape<T>::BL }; \
+			for (size_t block = 0; block < blocks; ++block, a += n * n * BL, d += BL) \
+				for (size_t l = 0; l < BL; l += W) \
+				{ \
+					V m[16]; \
+					for (size_t e = 0; e < n * n; ++e) \
+						m[e] = LOAD(a + e * BL + l); \
+					STORE(d + l, batch_adjugate(n, m, 0)); \
+				} \
+		} \
+		\
+		ATTRIBUTES \
+		void batch_inverse(size_t blocks, size_t n, const T *a, T *b, T *d) \
+		{ \
+			enum { BL = batch_shape<T>::BL }; \
+			for (size_t block = 0; block < blocks; ++block, a += n * n * BL, b += n * n * BL, d += BL) \
+				for (size_t l = 0; l < BL; l += W) \
+				{ \
+					V m[16], adjugate[16]; \
+					for (size_t e = 0; e < n * n; ++e) \
+						m[e] = LOAD(a + e * BL + l); \
+					const V det = batch_adjugate(n, m, adjugate); \
+					const V inverse = DIV(SET1(T(1)), det); \
+					for (size_t e = 0; e < n * n; ++e) \
+						STORE(b + e * BL + l, MUL(adjugate[e], inverse)); \
+					STORE(d + l, det); \
+				} \
+		}
+
+#		define JFCPP_SIMD_GENERIC_KERNELS(T) \
+		inline void add(size_t n, T *x, const T *y) \
+		{ for (size_t i = 0; i < n; ++i) x[i] += y[i]; } \
+		inline void subtract(size_t n, T *x, const T *y) \
+		{ for (size_t i = 0; i < n; ++i) x[i] -= y[i]; } \
+		inline void multiply(size_t n, T *x, const T *y) \
+		{ for (size_t i = 0; i < n; ++i) x[i] *= y[i]; } \
+		inline void divide(size_t n, T *x, const T *y) \
+		{ for (size_t i = 0; i < n; ++i) x[i] /= y[i]; } \
+		inline void add_scalar(size_t n, T *x, T s) \
+		{ for (size_t i = 0; i < n; ++i) x[i] += s; } \
+		inline void subtract_scalar(size_t n, T *x, T s) \
+		{ for (size_t i = 0; i < n; ++i) x[i] -= s; } \
+		inline void multiply_scalar(size_t n, T *x, T s) \
+		{ for (size_t i = 0; i < n; ++i) x[i] *= s; } \
+		inline void divide_scalar(size_t n, T *x, T s) \
+		{ for (size_t i = 0; i < n; ++i) x[i] /= s; } \
+		inline T dot(size_t n, const T *x, const T *y) \
+		{ \
+			T result(0); \
+			for (size_t i = 0; i < n; ++i) result += x[i] * y[i]; \
+			return result; \
+		} \
+		inline void axpy(size_t n, T a, const T *x, T *y) \
+		{ for (size_t i = 0; i < n; ++i) y[i] += a * x[i]; } \
+		inline void rotate(size_t n, T c, T s, T *x, T *y) \
+		{ \
+			for (size_t i = 0; i < n; ++i) \
+			{ \
+				const T xi = x[i], yi = y[i]; \
+				x[i] = c * xi - s * yi; \
+				y[i] = s * xi + c * yi; \
+			} \
+		} \
+		inline void gemm(size_t kc, const T *a, const T *b, T *ab) \
+		{ \
+			enum \
+			{ \
+				MR = gemm_shape<T, simd::generic>::MR, \
+				NR = gemm_shape<T, simd::generic>::NR \
+			}; \
+			for (size_t i = 0; i < MR * NR; ++i) ab[i] = T(0); \
+			for (size_t p = 0; p < kc; ++p, a += MR, b += NR) \
+				for (size_t i = 0; i < MR; ++i) \
+					for (size_t j = 0; j < NR; ++j) \
+						ab[i * NR + j] += a[i] * b[j]; \
+		} \
+		inline void transpose(const T *a, size_t lda, T *b, size_t ldb) \
+		{ \
+			enum { TB = transpose_shape<T>::TB }; \
+			for (size_t i = 0; i < TB; ++i) \
+				for (size_t j = 0; j < TB; ++j) \
+					b[j * ldb + i] = a[i * lda + j]; \
+		}
+
+		// One matrix by “vector”.
+#		define JFCPP_SIMD_GENERIC_LOAD(P) (*(P))
+#		define JFCPP_SIMD_GENERIC_STORE(P, X) (*(P) = (X))
+#		define JFCPP_SIMD_GENERIC_SET1(X) (X)
+#		define JFCPP_SIMD_GENERIC_ADD(A, B) ((A) + (B))
+#		define JFCPP_SIMD_GENERIC_SUB(A, B) ((A) - (B))
+#		define JFCPP_SIMD_GENERIC_MUL(A, B) ((A) * (B))
+#		define JFCPP_SIMD_GENERIC_DIV(A, B) ((A) / (B))
+#		define JFCPP_SIMD_GENERIC_FMADD(A, B, C) ((A) * (B) + (C))
+#		define JFCPP_SIMD_GENERIC_BATCH_KERNELS(T) \
+		JFCPP_SIMD_BATCH_KERNELS(inline, T, T, 1, JFCPP_SIMD_GENERIC_LOAD, \
+		                         JFCPP_SIMD_GENERIC_STORE, \
+		                         JFCPP_SIMD_GENERIC_SET1, \
+		                         JFCPP_SIMD_GENERIC_ADD, \
+		                         JFCPP_SIMD_GENERIC_SUB, \
+		                         JFCPP_SIMD_GENERIC_MUL, \
+		                         JFCPP_SIMD_GENERIC_DIV, \
+		                         JFCPP_SIMD_GENERIC_FMADD)
+
+		namespace generic
+		{
+			JFCPP_SIMD_GENERIC_KERNELS(float)
+			JFCPP_SIMD_GENERIC_KERNELS(double)
+			JFCPP_SIMD_GENERIC_BATCH_KERNELS(float)
+			JFCPP_SIMD_GENERIC_BATCH_KERNELS(double)
+		}
+
+#		undef JFCPP_SIMD_GENERIC_BATCH_KERNELS
+#		undef JFCPP_SIMD_GENERIC_FMADD
+#		undef JFCPP_SIMD_GENERIC_DIV
+#		undef JFCPP_SIMD_GENERIC_MUL
+#		undef JFCPP_SIMD_GENERIC_SUB
+#		undef JFCPP_SIMD_GENERIC_ADD
+#		undef JFCPP_SIMD_GENERIC_SET1
+#		undef JFCPP_SIMD_GENERIC_STORE
+#		undef JFCPP_SIMD_GENERIC_LOAD
+#		undef JFCPP_SIMD_GENERIC_KERNELS
+
+#	ifdef JFCPP_SIMD_X86
+
+		/**
+		 * Defines all the kernels for a given instruction set and a given
+		 * type, V being the vector type and W its number of elements.
+		 *
+		 * ISA is the “instruction_set” and TARGET the corresponding
+		 * attribute.
+		 */
+#		define JFCPP_SIMD_KERNELS(ISA, TARGET, T, V, W, LOAD, STORE, SET1, ZERO, ADD, SUB, MUL, DIV, FMADD) \
+		JFCPP_SIMD_TARGET(TARGET) inline \
+		V fmadd(V a, V b, V c) { return FMADD(a, b, c); } \
+		\
+		JFCPP_SIMD_BATCH_KERNELS(JFCPP_SIMD_TARGET(TARGET) inline, T, V, W, \
+		                         LOAD, STORE, SET1, ADD, SUB, MUL, DIV, \
+		                         fmadd) \
+		\
+		JFCPP_SIMD_KERNELS_BINARY(TARGET, T, V, W, LOAD, STORE, SET1, add, ADD, +) \
+		JFCPP_SIMD_KERNELS_BINARY(TARGET, T, V, W, LOAD, STORE, SET1, subtract, SUB, -) \
+		JFCPP_SIMD_KERNELS_BINARY(TARGET, T, V, W, LOAD, STORE, SET1, multiply, MUL, *) \
+		JFCPP_SIMD_KERNELS_BINARY(TARGET, T, V, W, LOAD, STORE, SET1, divide, DIV, /) \
+		\
+		JFCPP_SIMD_TARGET(TARGET) inline \
+		T dot(size_t n, const T *x, const T *y) \
+		{ \
+			V acc0 = ZERO(), acc1 = ZERO(); \
+			size_t i = 0; \
+			for (; (i + 2 * W) <= n; i += 2 * W) \
+			{ \
+				acc0 = fmadd(LOAD(x + i), LOAD(y + i), acc0); \
+				acc1 = fmadd(LOAD(x + i + W), LOAD(y + i + W), acc1); \
+			} \
+			for (; (i + W) <= n; i += W) \
+			{ \
+				acc0 = fmadd(LOAD(x + i), LOAD(y + i), acc0); \
+			} \
+			T tmp[W]; \
+			STORE(tmp, ADD(acc0, acc1)); \
+			T result(0); \
+			for (size_t j = 0; j < W; ++j) result += tmp[j]; \
+			for (; i < n; ++i) result += x[i] * y[i]; \
+			return result; \
+		} \
+		\
+		JFCPP_SIMD_TARGET(TARGET) inline \
+		void axpy(size_t n, T a, const T *x, T *y) \
+		{ \
+			const V av = SET1(a); \
+			size_t i = 0; \
+			for (; (i + 2 * W) <= n; i += 2 * W) \
+			{ \
+				STORE(y + i, fmadd(av, LOAD(x + i), LOAD(y + i))); \
+				STORE(y + i + W, fmadd(av, LOAD(x + i + W), LOAD(y + i + W))); \
+			} \
+			for (; (i + W) <= n; i += W) \
+				STORE(y + i, fmadd(av, LOAD(x + i), LOAD(y + i))); \
+			for (; i < n; ++i) \
+				y[i] += a * x[i]; \
+		} \
+		\
+		JFCPP_SIMD_TARGET(TARGET) inline \
+		void rotate(size_t n, T c, T s, T *x, T *y) \
+		{ \
+			const V cv = SET1(c), sv = SET1(s); \
+			size_t i = 0; \
+			for (; (i + W) <= n; i += W) \
+			{ \
+				const V xv = LOAD(x + i), yv = LOAD(y + i); \
+				STORE(x + i, SUB(MUL(cv, xv), MUL(sv, yv))); \
+				STORE(y + i, fmadd(sv, xv, MUL(cv, yv))); \
+			} \
+			for (; i < n; ++i) \
+			{ \
+				const T xi = x[i], yi = y[i]; \
+				x[i] = c * xi - s * yi; \
+				y[i] = s * xi + c * yi; \
+			} \
+		} \
+		\
+		JFCPP_SIMD_TARGET(TARGET) inline \
+		void gemm(size_t kc, const T *a, const T *b, T *ab) \
+		{ \
+			enum \
+			{ \
+				MR = gemm_shape<T, ISA>::MR, \
+				NR = gemm_shape<T, ISA>::NR, \
+				NV = NR / W \
+			}; \
+			JFCPP_SIMD_GEMM_ROWS(JFCPP_SIMD_GEMM_ZERO, V, ZERO) \
+			for (size_t p = 0; p < kc; ++p, a += MR, b += NR) \
+			{ \
+				const V \
+					b0 = LOAD(b), \
+					b1 = (NV > 1 ? LOAD(b + W) : b0), \
+					b2 = (NV > 2 ? LOAD(b + 2 * W) : b0); \
+				JFCPP_SIMD_GEMM_ROWS(JFCPP_SIMD_GEMM_UPDATE, V, SET1) \
+			} \
+			JFCPP_SIMD_GEMM_ROWS(JFCPP_SIMD_GEMM_STORE, W, STORE) \
+		}
+
+		/**
+		 * The GEMM micro-kernel uses named accumulators (cI_V for the
+		 * vector V of the row I) rather than an array so that they are
+		 * kept in registers: up to 8 rows of 3 vectors, the conditions on
+		 * the shape are constant and the unused accumulators are removed by
+		 * the compiler.
+		 */
+#		define JFCPP_SIMD_GEMM_ROWS(ROW, X, Y) \
+		ROW(0, X, Y) ROW(1, X, Y) ROW(2, X, Y) ROW(3, X, Y) \
+		ROW(4, X, Y) ROW(5, X, Y) ROW(6, X, Y) ROW(7, X, Y)
+#		define JFCPP_SIMD_GEMM_ZERO(I, V, ZERO) \
+		V c##I##_0 = ZERO(), c##I##_1 = ZERO(), c##I##_2 = ZERO();
+#		define JFCPP_SIMD_GEMM_UPDATE(I, V, SET1) \
+		if (MR > I) \
+		{ \
+			const V ai = SET1(a[I]); \
+			c##I##_0 = fmadd(ai, b0, c##I##_0); \
+			if (NV > 1) c##I##_1 = fmadd(ai, b1, c##I##_1); \
+			if (NV > 2) c##I##_2 = fmadd(ai, b2, c##I##_2); \
+		}
+#		define JFCPP_SIMD_GEMM_STORE(I, W, STORE) \
+		if (MR > I) \
+		{ \
+			STORE(ab + I * NR, c##I##_0); \
+			if (NV > 1) STORE(ab + I * NR + W, c##I##_1); \
+			if (NV > 2) STORE(ab + I * NR + 2 * W, c##I##_2); \
+		}
+
+		/**
+		 * Defines “x OP= y” and “x OP= s” for a given operation, VOP being
+		 * its vector version.
+		 */
+#		define JFCPP_SIMD_KERNELS_BINARY(TARGET, T, V, W, LOAD, STORE, SET1, NAME, VOP, OP) \
+		JFCPP_SIMD_TARGET(TARGET) inline \
+		void NAME(size_t n, T *x, const T *y) \
+		{ \
+			size_t i = 0; \
+			for (; (i + W) <= n; i += W) \
+				STORE(x + i, VOP(LOAD(x + i), LOAD(y + i))); \
+			for (; i < n; ++i) \
+				x[i] OP##= y[i]; \
+		} \
+		JFCPP_SIMD_TARGET(TARGET) inline \
+		void NAME##_scalar(size_t n, T *x, T s) \
+		{ \
+			const V sv = SET1(s); \
+			size_t i = 0; \
+			for (; (i + W) <= n; i += W) \
+				STORE(x + i, VOP(LOAD(x + i), sv)); \
+			for (; i < n; ++i) \
+				x[i] OP##= s; \
+		}
+
+#		define JFCPP_SIMD_SSE2_FMADD_PD(A, B, C) _mm_add_pd(_mm_mul_pd(A, B), C)
+#		define JFCPP_SIMD_SSE2_FMADD_PS(A, B, C) _mm_add_ps(_mm_mul_ps(A, B), C)
+
+		namespace sse2
+		{
+			JFCPP_SIMD_KERNELS(simd::sse2, "sse2", double, __m128d, 2,
+			                   _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+			                   _mm_setzero_pd, _mm_add_pd, _mm_sub_pd,
+			                   _mm_mul_pd, _mm_div_pd, JFCPP_SIMD_SSE2_FMADD_PD)
+			JFCPP_SIMD_KERNELS(simd::sse2, "sse2", float, __m128, 4,
+			                   _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps,
+			                   _mm_setzero_ps, _mm_add_ps, _mm_sub_ps,
+			                   _mm_mul_ps, _mm_div_ps, JFCPP_SIMD_SSE2_FMADD_PS)
+
+			/**
+			 * 4 × 4 made of 2 × 2 blocks.
+			 */
+			JFCPP_SIMD_TARGET("sse2") inline
+			void
+			transpose(const double *a, size_t lda, double *b, size_t ldb)
+			{
+				for (size_t i = 0; i < 4; i += 2)
+				{
+					for (size_t j = 0; j < 4; j += 2)
+					{
+						const __m128d
+							r0 = _mm_loadu_pd(a + i * lda + j),
+							r1 = _mm_loadu_pd(a + (i + 1) * lda + j);
+
+						_mm_storeu_pd(b + j * ldb + i, _mm_unpacklo_pd(r0, r1));
+						_mm_storeu_pd(b + (j + 1) * ldb + i,
+						              _mm_unpackhi_pd(r0, r1));
+					}
+				}
+			}
+
+			/**
+			 * 8 × 8 made of 4 × 4 blocks.
+			 */
+			JFCPP_SIMD_TARGET("sse2") inline
+			void
+			transpose(const float *a, size_t lda, float *b, size_t ldb)
+			{
+				for (size_t i = 0; i < 8; i += 4)
+				{
+					for (size_t j = 0; j < 8; j += 4)
+					{
+						__m128
+							r0 = _mm_loadu_ps(a + i * lda + j),
+							r1 = _mm_loadu_ps(a + (i + 1) * lda + j),
+							r2 = _mm_loadu_ps(a + (i + 2) * lda + j),
+							r3 = _mm_loadu_ps(a + (i + 3) * lda + j);
+
+						_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+						_mm_storeu_ps(b + j * ldb + i, r0);
+						_mm_storeu_ps(b + (j + 1) * ldb + i, r1);
+						_mm_storeu_ps(b + (j + 2) * ldb + i, r2);
+						_mm_storeu_ps(b + (j + 3) * ldb + i, r3);
+					}
+				}
+			}
+		}
+
+		namespace avx2
+		{
+			JFCPP_SIMD_KERNELS(simd::avx2, "avx2,fma", double, __m256d, 4,
+			                   _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+			                   _mm256_setzero_pd, _mm256_add_pd, _mm256_sub_pd,
+			                   _mm256_mul_pd, _mm256_div_pd, _mm256_fmadd_pd)
+			JFCPP_SIMD_KERNELS(simd::avx2, "avx2,fma", float, __m256, 8,
+			                   _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps,
+			                   _mm256_setzero_ps, _mm256_add_ps, _mm256_sub_ps,
+			                   _mm256_mul_ps, _mm256_div_ps, _mm256_fmadd_ps)
+
+			JFCPP_SIMD_TARGET("avx2,fma") inline
+			void
+			transpose(const double *a, size_t lda, double *b, size_t ldb)
+			{
+				const __m256d
+					r0 = _mm256_loadu_pd(a),
+					r1 = _mm256_loadu_pd(a + lda),
+					r2 = _mm256_loadu_pd(a + 2 * lda),
+					r3 = _mm256_loadu_pd(a + 3 * lda),
+
+					// (a00 a10 a02 a12), (a01 a11 a03 a13), …
+					t0 = _mm256_unpacklo_pd(r0, r1),
+					t1 = _mm256_unpackhi_pd(r0, r1),
+					t2 = _mm256_unpacklo_pd(r2, r3),
+					t3 = _mm256_unpackhi_pd(r2, r3);
+
+				_mm256_storeu_pd(b, _mm256_permute2f128_pd(t0, t2, 0x20));
+				_mm256_storeu_pd(b + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+				_mm256_storeu_pd(b + 2 * ldb,
+				                 _mm256_permute2f128_pd(t0, t2, 0x31));
+				_mm256_storeu_pd(b + 3 * ldb,
+				                 _mm256_permute2f128_pd(t1, t3, 0x31));
+			}
+
+			JFCPP_SIMD_TARGET("avx2,fma") inline
+			void
+			transpose(const float *a, size_t lda, float *b, size_t ldb)
+			{
+				__m256 r[8], t[8];
+
+				for (size_t i = 0; i < 8; ++i)
+				{
+					r[i] = _mm256_loadu_ps(a + i * lda);
+				}
+
+				for (size_t i = 0; i < 8; i += 2)
+				{
+					t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+					t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+				}
+
+				for (size_t i = 0; i < 8; i += 4)
+				{
+					r[i] = _mm256_shuffle_ps(t[i], t[i + 2], 0x44);
+					r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], 0xEE);
+					r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+					r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+				}
+
+				for (size_t i = 0; i < 4; ++i)
+				{
+					_mm256_storeu_ps(b + i * ldb,
+					                 _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+					_mm256_storeu_ps(b + (i + 4) * ldb,
+					                 _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+				}
+			}
+		}
+
+		namespace avx512
+		{
+			JFCPP_SIMD_KERNELS(simd::avx512, "avx512f", double, __m512d, 8,
+			                   _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd,
+			                   _mm512_setzero_pd, _mm512_add_pd, _mm512_sub_pd,
+			                   _mm512_mul_pd, _mm512_div_pd, _mm512_fmadd_pd)
+			JFCPP_SIMD_KERNELS(simd::avx512, "avx512f", float, __m512, 16,
+			                   _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps,
+			                   _mm512_setzero_ps, _mm512_add_ps, _mm512_sub_ps,
+			                   _mm512_mul_ps, _mm512_div_ps, _mm512_fmadd_ps)
+
+			// The blocks are as wide as an AVX register.
+			using avx2::transpose;
+		}
+
+#		undef JFCPP_SIMD_SSE2_FMADD_PS
+#		undef JFCPP_SIMD_SSE2_FMADD_PD
+#		undef JFCPP_SIMD_GEMM_STORE
+#		undef JFCPP_SIMD_GEMM_UPDATE
+#		undef JFCPP_SIMD_GEMM_ZERO
+#		undef JFCPP_SIMD_GEMM_ROWS
+#		undef JFCPP_SIMD_KERNELS_BINARY
+#		undef JFCPP_SIMD_KERNELS
+
+#	endif // JFCPP_SIMD_X86
+
+#		undef JFCPP_SIMD_BATCH_KERNELS
+	} // namespace details
+
+#	ifdef JFCPP_SIMD_X86
+#		define JFCPP_SIMD_SELECT(T, ISA) \
+		case ISA: \
+			add = details::ISA::add; \
+			subtract = details::ISA::subtract; \
+			multiply = details::ISA::multiply; \
+			divide = details::ISA::divide; \
+			add_scalar = details::ISA::add_scalar; \
+			subtract_scalar = details::ISA::subtract_scalar; \
+			multiply_scalar = details::ISA::multiply_scalar; \
+			divide_scalar = details::ISA::divide_scalar; \
+			dot = details::ISA::dot; \
+			axpy = details::ISA::axpy; \
+			rotate = details::ISA::rotate; \
+			mr = details::gemm_shape<T, ISA>::MR; \
+			nr = details::gemm_shape<T, ISA>::NR; \
+			gemm = details::ISA::gemm; \
+			transpose = details::ISA::transpose; \
+			batch_mprod = details::ISA::batch_mprod; \
+			batch_det = details::ISA::batch_det; \
+			batch_inverse = details::ISA::batch_inverse; \
+			break;
+#	else
+#		define JFCPP_SIMD_SELECT(T, ISA)
+#	endif
+
+#	define JFCPP_SIMD_KERNELS_SPECIALIZATION(T) \
+	template <> \
+	struct kernels<T> \
+	{ \
+		enum \
+		{ \
+			TB = details::transpose_shape<T>::TB, \
+			BL = details::batch_shape<T>::BL \
+		}; \
+	 \
+		/** \
+		 * Gets the kernels for the best instruction set of this \
+		 * processor. \
+		 */ \
+		static \
+		const kernels & \
+		get() \
+		{ \
+			static const kernels result(detect()); \
+	 \
+			return result; \
+		} \
+	 \
+		/** \
+		 * Gets the kernels for a given instruction set, which must be \
+		 * supported by this processor. \
+		 */ \
+		explicit \
+		kernels(instruction_set isa) : isa(generic), \
+			add(details::generic::add), \
+			subtract(details::generic::subtract), \
+			multiply(details::generic::multiply), \
+			divide(details::generic::divide), \
+			add_scalar(details::generic::add_scalar), \
+			subtract_scalar(details::generic::subtract_scalar), \
+			multiply_scalar(details::generic::multiply_scalar), \
+			divide_scalar(details::generic::divide_scalar), \
+			dot(details::generic::dot), \
+			axpy(details::generic::axpy), \
+			rotate(details::generic::rotate), \
+			mr(details::gemm_shape<T, generic>::MR), \
+			nr(details::gemm_shape<T, generic>::NR), \
+			gemm(details::generic::gemm), \
+			transpose(details::generic::transpose), \
+			batch_mprod(details::generic::batch_mprod), \
+			batch_det(details::generic::batch_det), \
+			batch_inverse(details::generic::batch_inverse) \
+		{ \
+			if (isa > detect()) \
+			{ \
+				return; \
+			} \
+			this->isa = isa; \
+			switch (isa) \
+			{ \
+				JFCPP_SIMD_SELECT(T, sse2) \
+				JFCPP_SIMD_SELECT(T, avx2) \
+				JFCPP_SIMD_SELECT(T, avx512) \
+			default: \
+				this->isa = generic; \
+			} \
+		} \
+	 \
+		/** \
+		 * The instruction set actually used. \
+		 */ \
+		instruction_set isa; \
+	 \
+		/** \
+		 * x[i] OP= y[i] for i in [0, n). \
+		 */ \
+		void (*add)(size_t n, T *x, const T *y); \
+		void (*subtract)(size_t n, T *x, const T *y); \
+		void (*multiply)(size_t n, T *x, const T *y); \
+		void (*divide)(size_t n, T *x, const T *y); \
+	 \
+		/** \
+		 * x[i] OP= s for i in [0, n). \
+		 */ \
+		void (*add_scalar)(size_t n, T *x, T s); \
+		void (*subtract_scalar)(size_t n, T *x, T s); \
+		void (*multiply_scalar)(size_t n, T *x, T s); \
+		void (*divide_scalar)(size_t n, T *x, T s); \
+	 \
+		/** \
+		 * Sum of x[i] * y[i] for i in [0, n). \
+		 */ \
+		T (*dot)(size_t n, const T *x, const T *y); \
+	 \
+		/** \
+		 * y[i] += a * x[i] for i in [0, n). \
+		 */ \
+		void (*axpy)(size_t n, T a, const T *x, T *y); \
+	 \
+		/** \
+		 * Plane rotation: (x[i], y[i]) = (c * x[i] - s * y[i], \
+		 * s * x[i] + c * y[i]) for i in [0, n). \
+		 */ \
+		void (*rotate)(size_t n, T c, T s, T *x, T *y); \
+	 \
+		/** \
+		 * The shape of the block computed by “gemm”, it depends on \
+		 * the instruction set. \
+		 */ \
+		size_t mr, nr; \
+	 \
+		/** \
+		 * GEMM micro-kernel: computes the mr × nr block ab (stored row \
+		 * by row) from kc columns of packed A (mr values per column) \
+		 * and kc rows of packed B (nr values per row). \
+		 */ \
+		void (*gemm)(size_t kc, const T *a, const T *b, T *ab); \
+	 \
+		/** \
+		 * Transposes the TB × TB block a into b (lda and ldb are the \
+		 * distances between two rows). \
+		 */ \
+		void (*transpose)(const T *a, size_t lda, T *b, size_t ldb); \
+	 \
+		/** \
+		 * The batch kernels work on whole blocks of BL interleaved \
+		 * matrices: the element e (row by row) of the matrix l of a \
+		 * block is at “block + e * BL + l”.  d receives one value by \
+		 * matrix. \
+		 * \
+		 * batch_mprod: ab = a × b where a is r × k and b is k × c (ab \
+		 * must not overlap them). \
+		 * \
+		 * batch_det: d = det(a) where a is n × n (n in [1, 4]). \
+		 * \
+		 * batch_inverse: b = adjugate(a) / det(a) and d = det(a), a \
+		 * singular matrix gives non-finite values (b can be a). \
+		 */ \
+		void (*batch_mprod)(size_t blocks, size_t r, size_t k, size_t c, \
+		                    const T *a, const T *b, T *ab); \
+		void (*batch_det)(size_t blocks, size_t n, const T *a, T *d); \
+		void (*batch_inverse)(size_t blocks, size_t n, const T *a, T *b, \
+		                      T *d); \
+	}
+
+	JFCPP_SIMD_KERNELS_SPECIALIZATION(float);
+	JFCPP_SIMD_KERNELS_SPECIALIZATION(double);
+
+#	undef JFCPP_SIMD_KERNELS_SPECIALIZATION
+#	undef JFCPP_SIMD_SELECT
+} // namespace simd
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_SIMD
@@ -0,0 +1,334 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_SPARSE_MATRIX
+#define H_JFCPP_SPARSE_MATRIX
+
+#include <cstddef>
+#include <vector>
+
+#include <contracts.h>
+
+#include "common.hpp"
+#include "matrix.hpp"
+#include "operators.hpp"
+#include "thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Collects the non-zero values of a sparse matrix as (row, column, value)
+ * triplets (the coordinate format), in any order.
+ *
+ * Values added several times at the same position are summed, which is
+ * convenient for assembling finite elements.
+ */
+template <typename T>
+class sparse_builder
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 *
+	 */
+	sparse_builder(size_t rows, size_t columns);
+
+	/**
+	 * Adds “value” to the element (i, j).
+	 */
+	void add(size_t i, size_t j, const T &value);
+
+	/**
+	 * Removes every triplet.
+	 */
+	void clear();
+
+	/**
+	 *
+	 */
+	size_t columns() const;
+
+	/**
+	 * Reserves the memory for n triplets.
+	 */
+	void reserve(size_t n);
+
+	/**
+	 *
+	 */
+	size_t rows() const;
+
+	/**
+	 * Number of triplets (duplicates included).
+	 */
+	size_t size() const;
+
+private:
+
+	template <typename T2>
+	friend class sparse_matrix;
+
+	/**
+	 *
+	 */
+	size_t _rows;
+
+	/**
+	 *
+	 */
+	size_t _columns;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _row_indices;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _column_indices;
+
+	/**
+	 *
+	 */
+	std::vector<T> _values;
+};
+
+/**
+ * A sparse matrix in the compressed sparse row (CSR) format.
+ *
+ * Only the non-zero values are stored, row by row, with their column
+ * indices in increasing order; “row_offsets()[i]” is the position of the
+ * first value of the row i and “row_offsets()[rows()]” is the number of
+ * values.
+ *
+ * The column view, i.e. the compressed sparse column (CSC) format, is an
+ * index over the same values (“column_offsets()”, “row_indices()” and
+ * “column_positions()”), built by the constructors.
+ *
+ * The products are split by rows between the threads of an executor, each
+ * thread receiving about the same number of values.
+ *
+ * General requirements:
+ * - T must have a default constructor;
+ * - the method “T &T::operator=(const T &)” must be defined;
+ * - T(0) must be the zero.
+ *
+ * @template T The type of contained elements.
+ */
+template <typename T>
+class sparse_matrix : public operators::equality_comparable<sparse_matrix<T> >
+{
+public:
+
+	/**
+	 *
+	 */
+	typedef T value_type;
+
+	/**
+	 * Constructs an empty 0 × 0 matrix.
+	 */
+	sparse_matrix();
+
+	/**
+	 * Constructs a rows × columns matrix without non-zero values.
+	 */
+	sparse_matrix(size_t rows, size_t columns);
+
+	/**
+	 * Constructs a matrix from its triplets, the zeros are not stored.
+	 *
+	 * Complexity: O(rows + columns + size × log(size / rows)).
+	 */
+	explicit sparse_matrix(const sparse_builder<T> &builder);
+
+	/**
+	 * Constructs a matrix from a dense one, the zeros are not stored.
+	 */
+	template <class Allocator, class Layout>
+	explicit sparse_matrix(const matrix<T, Allocator, Layout> &m);
+
+	/**
+	 *
+	 */
+	size_t columns() const;
+
+	/**
+	 * The column index of each value.
+	 */
+	const std::vector<size_t> &column_indices() const;
+
+	/**
+	 * Column view: position in “row_indices()” of the first value of each
+	 * column, plus the number of values.
+	 */
+	const std::vector<size_t> &column_offsets() const;
+
+	/**
+	 * Column view: position in “values()” of each value, column by column.
+	 *
+	 * The values of the column j are therefore
+	 * “values()[column_positions()[k]]” for k in
+	 * [column_offsets()[j], column_offsets()[j + 1]).
+	 */
+	const std::vector<size_t> &column_positions() const;
+
+	/**
+	 * Product with a dense matrix (a n × 1 matrix being a vector).
+	 *
+	 * Requirement:
+	 * - m.rows() == columns().
+	 */
+	template <class Allocator>
+	matrix<T, Allocator> mprod(const matrix<T, Allocator> &m) const;
+
+	/**
+	 * Same as “mprod(const matrix<T, Allocator> &)” but the rows are split
+	 * between the threads of the given executor.
+	 */
+	template <class Allocator>
+	matrix<T, Allocator> mprod(const matrix<T, Allocator> &m,
+	                           executor &e) const;
+
+	/**
+	 * Sparse matrix-vector product: y = this × x.
+	 *
+	 * x must have “columns()” values and y “rows()” values, they must not
+	 * overlap.
+	 */
+	void mprod(const T *x, T *y) const;
+
+	/**
+	 * Same as “mprod(const T *, T *)” but the rows are split between the
+	 * threads of the given executor.
+	 */
+	void mprod(const T *x, T *y, executor &e) const;
+
+	/**
+	 * Number of stored values.
+	 */
+	size_t non_zeros() const;
+
+	/**
+	 * Position of the first value of each row, plus the number of values.
+	 */
+	const std::vector<size_t> &row_offsets() const;
+
+	/**
+	 * Column view: the row index of each value, column by column, in
+	 * increasing order within each column.
+	 */
+	const std::vector<size_t> &row_indices() const;
+
+	/**
+	 *
+	 */
+	size_t rows() const;
+
+	/**
+	 * Computes the transpose, the column view of this matrix being the row
+	 * view of its transpose and vice versa.
+	 *
+	 * Complexity: O(rows + columns + non_zeros).
+	 */
+	sparse_matrix transpose() const;
+
+	/**
+	 * The stored values, row by row.
+	 */
+	const std::vector<T> &values() const;
+
+	/**
+	 *
+	 */
+	bool operator==(const sparse_matrix &m) const;
+
+	/**
+	 * Gets the element (i, j), zero if it is not stored.
+	 *
+	 * Complexity: O(log(values in the row i)).
+	 */
+	T operator()(size_t i, size_t j) const;
+
+private:
+
+	/**
+	 *
+	 */
+	size_t _rows;
+
+	/**
+	 *
+	 */
+	size_t _columns;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _row_offsets;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _column_indices;
+
+	/**
+	 *
+	 */
+	std::vector<T> _values;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _column_offsets;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _row_indices;
+
+	/**
+	 *
+	 */
+	std::vector<size_t> _column_positions;
+
+	/**
+	 * Builds the column view from the rows.
+	 *
+	 * Complexity: O(rows + columns + non_zeros).
+	 */
+	void index_columns();
+
+	/**
+	 * y (rows × n, ldy) = this × x (columns × n, ldx).
+	 */
+	void multiply(const T *x, size_t ldx, size_t n, T *y, size_t ldy,
+	              executor &e) const;
+};
+
+JFCPP_NAMESPACE_END
+
+#include "sparse_matrix/implementation.hpp"
+
+#endif // H_JFCPP_SPARSE_MATRIX
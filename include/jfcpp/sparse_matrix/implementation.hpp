@@ -0,0 +1,582 @@
+/**
+ * This class is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This class is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this class.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <contracts.h>
+
+#include "../common.hpp"
+#include "../thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace sparse_details
+{
+	/**
+	 * Under this weight (values + rows), a part is not worth a thread.
+	 */
+	const size_t min_part_weight = 4096;
+
+	/**
+	 * Orders the triplets by column, then by insertion order so that the
+	 * duplicates are always summed in the same order.
+	 */
+	class column_order
+	{
+	public:
+
+		explicit
+		column_order(const std::vector<size_t> &columns)
+			: _columns(columns)
+		{}
+
+		bool
+		operator()(size_t a, size_t b) const
+		{
+			return ((_columns[a] < _columns[b])
+			        || ((_columns[a] == _columns[b]) && (a < b)));
+		}
+
+	private:
+
+		const std::vector<size_t> &_columns;
+	};
+
+	/**
+	 * Splits the rows in parts which have about the same weight (number of
+	 * values plus number of rows, so that empty rows still count).
+	 *
+	 * The part p contains the rows [bounds[p], bounds[p + 1]).
+	 */
+	inline
+	void
+	split(const std::vector<size_t> &offsets, size_t parts,
+	      std::vector<size_t> &bounds)
+	{
+		const size_t
+			rows = offsets.size() - 1,
+			weight = offsets[rows] + rows;
+
+		bounds.resize(parts + 1);
+		bounds[0] = 0;
+		bounds[parts] = rows;
+
+		for (size_t p = 1; p < parts; ++p)
+		{
+			const size_t target = weight / parts * p + weight % parts * p / parts;
+
+			// First row r such as “offsets[r] + r >= target”.
+			size_t first = bounds[p - 1], last = rows;
+			while (first < last)
+			{
+				const size_t middle = first + (last - first) / 2;
+
+				if (offsets[middle] + middle < target)
+				{
+					first = middle + 1;
+				}
+				else
+				{
+					last = middle;
+				}
+			}
+
+			bounds[p] = first;
+		}
+	}
+
+	/**
+	 * Computes the rows of y (ldy) = a × x (ldx, n columns) for a part.
+	 */
+	template <typename T>
+	class product_task : public parallel_task
+	{
+	public:
+
+		product_task(const size_t *bounds, const size_t *offsets,
+		             const size_t *columns, const T *values, const T *x,
+		             size_t ldx, size_t n, T *y, size_t ldy)
+			: _bounds(bounds), _offsets(offsets), _columns(columns),
+			  _values(values), _x(x), _ldx(ldx), _n(n), _y(y), _ldy(ldy)
+		{}
+
+		void
+		operator()(size_t part)
+		{
+			for (size_t i = _bounds[part]; i < _bounds[part + 1]; ++i)
+			{
+				const size_t first = _offsets[i], last = _offsets[i + 1];
+
+				if (_n == 1)
+				{
+					T sum(0);
+					for (size_t k = first; k < last; ++k)
+					{
+						sum += _values[k] * _x[_columns[k] * _ldx];
+					}
+					_y[i * _ldy] = sum;
+
+					continue;
+				}
+
+				T *row = _y + i * _ldy;
+
+				std::fill(row, row + _n, T(0));
+				for (size_t k = first; k < last; ++k)
+				{
+					const T &a = _values[k];
+					const T *x = _x + _columns[k] * _ldx;
+
+					for (size_t j = 0; j < _n; ++j)
+					{
+						row[j] += a * x[j];
+					}
+				}
+			}
+		}
+
+	private:
+
+		const size_t *_bounds;
+		const size_t *_offsets;
+		const size_t *_columns;
+		const T *_values;
+		const T *_x;
+		size_t _ldx;
+		size_t _n;
+		T *_y;
+		size_t _ldy;
+	};
+} // namespace sparse_details
+
+////////////////////////////////////////
+// sparse_builder
+
+template <typename T>
+sparse_builder<T>::sparse_builder(size_t rows, size_t columns)
+	: _rows(rows), _columns(columns)
+{}
+
+template <typename T>
+void
+sparse_builder<T>::add(size_t i, size_t j, const T &value)
+{
+	requires(i < this->_rows);
+	requires(j < this->_columns);
+
+	this->_row_indices.push_back(i);
+	this->_column_indices.push_back(j);
+	this->_values.push_back(value);
+}
+
+template <typename T>
+void
+sparse_builder<T>::clear()
+{
+	this->_row_indices.clear();
+	this->_column_indices.clear();
+	this->_values.clear();
+}
+
+template <typename T>
+size_t
+sparse_builder<T>::columns() const
+{
+	return this->_columns;
+}
+
+template <typename T>
+void
+sparse_builder<T>::reserve(size_t n)
+{
+	this->_row_indices.reserve(n);
+	this->_column_indices.reserve(n);
+	this->_values.reserve(n);
+}
+
+template <typename T>
+size_t
+sparse_builder<T>::rows() const
+{
+	return this->_rows;
+}
+
+template <typename T>
+size_t
+sparse_builder<T>::size() const
+{
+	return this->_values.size();
+}
+
+////////////////////////////////////////
+// sparse_matrix
+
+template <typename T>
+sparse_matrix<T>::sparse_matrix()
+	: _rows(0), _columns(0), _row_offsets(1, 0), _column_offsets(1, 0)
+{}
+
+template <typename T>
+sparse_matrix<T>::sparse_matrix(size_t rows, size_t columns)
+	: _rows(rows), _columns(columns), _row_offsets(rows + 1, 0),
+	  _column_offsets(columns + 1, 0)
+{}
+
+template <typename T>
+sparse_matrix<T>::sparse_matrix(const sparse_builder<T> &builder)
+	: _rows(builder._rows), _columns(builder._columns),
+	  _row_offsets(builder._rows + 1, 0)
+{
+	const size_t n = builder.size();
+
+	// Counting sort of the triplets by row.
+	std::vector<size_t> starts(this->_rows + 1, 0);
+	for (size_t k = 0; k < n; ++k)
+	{
+		++starts[builder._row_indices[k] + 1];
+	}
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		starts[i + 1] += starts[i];
+	}
+
+	std::vector<size_t> order(n), next(starts.begin(), starts.end() - 1);
+	for (size_t k = 0; k < n; ++k)
+	{
+		order[next[builder._row_indices[k]]++] = k;
+	}
+
+	this->_column_indices.reserve(n);
+	this->_values.reserve(n);
+
+	const sparse_details::column_order by_column(builder._column_indices);
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		std::sort(order.begin() + starts[i], order.begin() + starts[i + 1],
+		          by_column);
+
+		// Sums the duplicates and drops the zeros.
+		for (size_t k = starts[i]; k < starts[i + 1];)
+		{
+			const size_t j = builder._column_indices[order[k]];
+
+			T sum(builder._values[order[k]]);
+			for (++k; (k < starts[i + 1])
+				     && (builder._column_indices[order[k]] == j); ++k)
+			{
+				sum += builder._values[order[k]];
+			}
+
+			if (!(sum == T(0)))
+			{
+				this->_column_indices.push_back(j);
+				this->_values.push_back(sum);
+			}
+		}
+
+		this->_row_offsets[i + 1] = this->_values.size();
+	}
+
+	this->index_columns();
+}
+
+template <typename T>
+template <class Allocator, class Layout>
+sparse_matrix<T>::sparse_matrix(const matrix<T, Allocator, Layout> &m)
+	: _rows(m.rows()), _columns(m.columns()), _row_offsets(m.rows() + 1, 0)
+{
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		for (size_t j = 0; j < this->_columns; ++j)
+		{
+			const T &value = m(i, j);
+
+			if (!(value == T(0)))
+			{
+				this->_column_indices.push_back(j);
+				this->_values.push_back(value);
+			}
+		}
+
+		this->_row_offsets[i + 1] = this->_values.size();
+	}
+
+	this->index_columns();
+}
+
+template <typename T>
+size_t
+sparse_matrix<T>::columns() const
+{
+	return this->_columns;
+}
+
+template <typename T>
+const std::vector<size_t> &
+sparse_matrix<T>::column_indices() const
+{
+	return this->_column_indices;
+}
+
+template <typename T>
+const std::vector<size_t> &
+sparse_matrix<T>::column_offsets() const
+{
+	return this->_column_offsets;
+}
+
+template <typename T>
+const std::vector<size_t> &
+sparse_matrix<T>::column_positions() const
+{
+	return this->_column_positions;
+}
+
+template <typename T>
+template <class Allocator>
+matrix<T, Allocator>
+sparse_matrix<T>::mprod(const matrix<T, Allocator> &m) const
+{
+	sequential_executor e;
+
+	return this->mprod(m, e);
+}
+
+template <typename T>
+template <class Allocator>
+matrix<T, Allocator>
+sparse_matrix<T>::mprod(const matrix<T, Allocator> &m, executor &e) const
+{
+	requires(m.rows() == this->_columns);
+
+	matrix<T, Allocator> result(this->_rows, m.columns());
+
+	if (m.columns() != 0)
+	{
+		this->multiply(m.begin(), m.columns(), m.columns(), result.begin(),
+		               result.columns(), e);
+	}
+
+	return result;
+}
+
+template <typename T>
+void
+sparse_matrix<T>::mprod(const T *x, T *y) const
+{
+	sequential_executor e;
+
+	this->mprod(x, y, e);
+}
+
+template <typename T>
+void
+sparse_matrix<T>::mprod(const T *x, T *y, executor &e) const
+{
+	this->multiply(x, 1, 1, y, 1, e);
+}
+
+template <typename T>
+size_t
+sparse_matrix<T>::non_zeros() const
+{
+	return this->_values.size();
+}
+
+template <typename T>
+const std::vector<size_t> &
+sparse_matrix<T>::row_offsets() const
+{
+	return this->_row_offsets;
+}
+
+template <typename T>
+const std::vector<size_t> &
+sparse_matrix<T>::row_indices() const
+{
+	return this->_row_indices;
+}
+
+template <typename T>
+size_t
+sparse_matrix<T>::rows() const
+{
+	return this->_rows;
+}
+
+template <typename T>
+sparse_matrix<T>
+sparse_matrix<T>::transpose() const
+{
+	sparse_matrix result;
+
+	result._rows = this->_columns;
+	result._columns = this->_rows;
+	result._row_offsets = this->_column_offsets;
+	result._column_indices = this->_row_indices;
+	result._column_offsets = this->_row_offsets;
+	result._row_indices = this->_column_indices;
+
+	const size_t n = this->non_zeros();
+
+	// The value k of the result is the value “_column_positions[k]” of
+	// this matrix, whose position in the result is therefore k.
+	result._values.resize(n);
+	result._column_positions.resize(n);
+	for (size_t k = 0; k < n; ++k)
+	{
+		const size_t position = this->_column_positions[k];
+
+		result._values[k] = this->_values[position];
+		result._column_positions[position] = k;
+	}
+
+	return result;
+}
+
+template <typename T>
+const std::vector<T> &
+sparse_matrix<T>::values() const
+{
+	return this->_values;
+}
+
+template <typename T>
+bool
+sparse_matrix<T>::operator==(const sparse_matrix &m) const
+{
+	return ((this->_rows == m._rows)
+	        && (this->_columns == m._columns)
+	        && (this->_row_offsets == m._row_offsets)
+	        && (this->_column_indices == m._column_indices)
+	        && (this->_values == m._values));
+}
+
+template <typename T>
+T
+sparse_matrix<T>::operator()(size_t i, size_t j) const
+{
+	requires(i < this->_rows);
+	requires(j < this->_columns);
+
+	const std::vector<size_t>::const_iterator
+		first = this->_column_indices.begin() + this->_row_offsets[i],
+		last = this->_column_indices.begin() + this->_row_offsets[i + 1],
+		it = std::lower_bound(first, last, j);
+
+	if ((it == last) || (*it != j))
+	{
+		return T(0);
+	}
+
+	return this->_values[it - this->_column_indices.begin()];
+}
+
+template <typename T>
+void
+sparse_matrix<T>::index_columns()
+{
+	const size_t n = this->non_zeros();
+
+	// Counting sort by column, the rows are visited in order so the
+	// indices of each column are sorted.
+	std::vector<size_t> &offsets = this->_column_offsets;
+	offsets.assign(this->_columns + 1, 0);
+	for (size_t k = 0; k < n; ++k)
+	{
+		++offsets[this->_column_indices[k] + 1];
+	}
+	for (size_t j = 0; j < this->_columns; ++j)
+	{
+		offsets[j + 1] += offsets[j];
+	}
+
+	this->_row_indices.resize(n);
+	this->_column_positions.resize(n);
+
+	std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		for (size_t k = this->_row_offsets[i]; k < this->_row_offsets[i + 1];
+		     ++k)
+		{
+			const size_t position = next[this->_column_indices[k]]++;
+
+			this->_row_indices[position] = i;
+			this->_column_positions[position] = k;
+		}
+	}
+}
+
+template <typename T>
+void
+sparse_matrix<T>::multiply(const T *x, size_t ldx, size_t n, T *y, size_t ldy,
+                           executor &e) const
+{
+	if (this->_rows == 0)
+	{
+		return;
+	}
+
+	const size_t weight = (this->non_zeros() + this->_rows) * n;
+
+	size_t parts = (e.concurrency() == 1 ? 1 : 4 * e.concurrency());
+	parts = std::min(parts, weight / sparse_details::min_part_weight);
+	parts = std::max(size_t(1), std::min(parts, this->_rows));
+
+	std::vector<size_t> bounds;
+	sparse_details::split(this->_row_offsets, parts, bounds);
+
+	const size_t *const columns =
+		(this->_column_indices.empty() ? NULL : &this->_column_indices[0]);
+	const T *const values = (this->_values.empty() ? NULL : &this->_values[0]);
+
+	sparse_details::product_task<T> task(&bounds[0], &this->_row_offsets[0],
+	                                     columns, values, x, ldx, n, y, ldy);
+
+	e.run(task, parts);
+}
+
+////////////////////////////////////////
+// matrix
+
+template <typename T, class Allocator, class Layout>
+matrix<T, Allocator, Layout>::matrix(const sparse_matrix<T> &m)
+	: _rows(m.rows()), _columns(m.columns()), _size(m.rows() * m.columns()),
+	  _values(NULL), _allocator()
+{
+	this->allocate();
+
+	std::fill(this->begin(), this->end(), T(0));
+
+	const std::vector<size_t>
+		&offsets = m.row_offsets(),
+		&columns = m.column_indices();
+	const std::vector<T> &values = m.values();
+
+	for (size_t i = 0; i < this->_rows; ++i)
+	{
+		for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+		{
+			(*this)(i, columns[k]) = values[k];
+		}
+	}
+}
+
+JFCPP_NAMESPACE_END
@@ -0,0 +1,187 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_TEXT
+#define H_JFCPP_TEXT
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <contracts.h>
+
+#include "array.hpp"
+#include "array_view.hpp"
+#include "common.hpp"
+#include "matrix.hpp"
+#include "matrix/view.hpp"
+#include "thread_pool.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * Fast conversions between numbers and text, for large files of
+ * whitespace-separated values.
+ *
+ * Unlike the streams, the conversions do not depend on the locale (the
+ * decimal separator is always ‘.’) and do not allocate: the values are
+ * parsed from and formatted to a range of characters, e.g. a buffer or a
+ * mapped file.
+ *
+ * Floating point numbers with at most 19 significant digits and a small
+ * exponent (the vast majority of the values found in practice) are
+ * converted with a single multiplication or division, in a wider type if
+ * needed, and correctly rounded; the others fall back to “strtod()” (and its
+ * siblings).
+ *
+ * A matrix is written one row per line, the values being separated by
+ * spaces, blank lines are ignored when it is read.
+ *
+ * The bulk functions which take an executor split the text in chunks, at
+ * whitespace (or line) boundaries, which are parsed in parallel: a first
+ * pass counts the values of each chunk (with SIMD instructions when
+ * available) to know where to store them.
+ *
+ * Requirement:
+ * - T must be a built-in arithmetic type.
+ */
+namespace text
+{
+	namespace details
+	{
+		/**
+		 * Enough characters for any value of T.
+		 */
+		template <typename T>
+		struct max_length
+		{
+			enum
+			{
+				value = 48
+			};
+		};
+	} // namespace details
+
+	/**
+	 * Parses a value at the beginning of [first, last) (no whitespace is
+	 * skipped).
+	 *
+	 * The syntax is the one of “strtod()” (or “strtol()” for integers, in
+	 * base 10) but a leading ‘+’ is accepted.
+	 *
+	 * @return The end of the value or first if there is no valid value of T
+	 *         (value is then unchanged).
+	 */
+	template <typename T>
+	const char *parse(const char *first, const char *last, T &value);
+
+	/**
+	 * Formats a value at first, which is not null-terminated.
+	 *
+	 * Floating point numbers are written with the shortest of 15 and 17
+	 * significant digits (6 and 9 for “float”) which gives back the same
+	 * value once parsed.
+	 *
+	 * Requirement:
+	 * - [first, last) must be at least “details::max_length<T>::value” long.
+	 *
+	 * @return The end of the value.
+	 */
+	template <typename T>
+	char *format(char *first, char *last, T value);
+
+	/**
+	 * Parses a.size() values separated by whitespace into a.
+	 *
+	 * @return The end of the last value.
+	 *
+	 * @throw std::runtime_error If a value is invalid or missing.
+	 */
+	template <typename T>
+	const char *parse(const char *first, const char *last, array_view<T> a);
+
+	/**
+	 * Parses all the values of [first, last), separated by whitespace.
+	 *
+	 * @throw std::runtime_error If a value is invalid or if there are none.
+	 */
+	template <typename T>
+	array<T> parse_array(const char *first, const char *last);
+
+	template <typename T>
+	array<T> parse_array(const char *first, const char *last, executor &e);
+
+	/**
+	 * Parses the matrix in [first, last), one row per line.
+	 *
+	 * @throw std::runtime_error If a value is invalid or if the rows do not
+	 *                           have the same number of values.
+	 */
+	template <typename T>
+	matrix<T> parse_matrix(const char *first, const char *last);
+
+	template <typename T>
+	matrix<T> parse_matrix(const char *first, const char *last, executor &e);
+
+	/**
+	 * Same as “parse_array()” on a mapped file.
+	 *
+	 * @throw std::runtime_error If the file cannot be mapped.
+	 */
+	template <typename T>
+	array<T> load_array(const std::string &path);
+
+	template <typename T>
+	array<T> load_array(const std::string &path, executor &e);
+
+	/**
+	 * Same as “parse_matrix()” on a mapped file.
+	 *
+	 * @throw std::runtime_error If the file cannot be mapped.
+	 */
+	template <typename T>
+	matrix<T> load_matrix(const std::string &path);
+
+	template <typename T>
+	matrix<T> load_matrix(const std::string &path, executor &e);
+
+	/**
+	 * Appends the values on a line.
+	 */
+	template <typename T>
+	void format(std::vector<char> &buffer, const array_view<T> &a);
+
+	template <typename T, size_t S>
+	void format(std::vector<char> &buffer, const array<T, S> &a);
+
+	/**
+	 * Appends the rows, one per line.
+	 */
+	template <typename T>
+	void format(std::vector<char> &buffer, const const_matrix_view<T> &m);
+
+	template <typename T, class Allocator, class Layout>
+	void format(std::vector<char> &buffer,
+	            const matrix<T, Allocator, Layout> &m);
+} // namespace text
+
+JFCPP_NAMESPACE_END
+
+#include "text/implementation.hpp"
+
+#endif // H_JFCPP_TEXT
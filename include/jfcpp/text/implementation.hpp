@@ -0,0 +1,1166 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <contracts.h>
+
+#include "../common.hpp"
+#include "../simd.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+namespace text
+{
+	namespace details
+	{
+		/**
+		 * Whether c is one of “ \t\n\v\f\r”.
+		 */
+		inline
+		bool
+		is_space(char c)
+		{
+			return ((c == ' ')
+			        || (static_cast<unsigned char>(c - '\t') <= '\r' - '\t'));
+		}
+
+		inline
+		bool
+		is_digit(char c)
+		{
+			return (static_cast<unsigned char>(c - '0') < 10);
+		}
+
+		inline
+		const char *
+		skip_spaces(const char *first, const char *last)
+		{
+			while ((first != last) && is_space(*first))
+			{
+				++first;
+			}
+
+			return first;
+		}
+
+		namespace generic
+		{
+			/**
+			 * Counts the beginnings of values (characters which are not
+			 * whitespace and follow whitespace or the beginning).
+			 *
+			 * @param space Whether the character before first is
+			 *              whitespace.
+			 */
+			inline
+			size_t
+			count_values(const char *first, const char *last, bool space)
+			{
+				size_t n = 0;
+
+				for (; first != last; ++first)
+				{
+					const bool s = is_space(*first);
+
+					n += (space && !s);
+					space = s;
+				}
+
+				return n;
+			}
+		}
+
+#		ifdef JFCPP_SIMD_X86
+		namespace sse2
+		{
+			/**
+			 * Same as “generic::count_values()” 16 characters at a time:
+			 * the whitespace mask is shifted by one to find the
+			 * beginnings.
+			 */
+			JFCPP_SIMD_TARGET("sse2")
+			inline
+			size_t
+			count_values(const char *first, const char *last)
+			{
+				const __m128i
+					blank = _mm_set1_epi8(' '),
+					tab = _mm_set1_epi8('\t'),
+					range = _mm_set1_epi8('\r' - '\t');
+
+				size_t n = 0;
+				unsigned previous = 1; // The beginning counts as whitespace.
+
+				for (; (last - first) >= 16; first += 16)
+				{
+					const __m128i
+						x = _mm_loadu_si128(
+							reinterpret_cast<const __m128i *>(first)),
+						t = _mm_sub_epi8(x, tab),
+						s = _mm_or_si128(
+							_mm_cmpeq_epi8(x, blank),
+							_mm_cmpeq_epi8(_mm_min_epu8(t, range), t));
+
+					const unsigned spaces = _mm_movemask_epi8(s);
+
+					n += __builtin_popcount(~spaces & ((spaces << 1) | previous)
+					                        & 0xFFFF);
+					previous = spaces >> 15;
+				}
+
+				return n + generic::count_values(first, last, previous != 0);
+			}
+		}
+#		endif
+
+		/**
+		 * Counts the values separated by whitespace in [first, last).
+		 */
+		inline
+		size_t
+		count_values(const char *first, const char *last)
+		{
+#		ifdef JFCPP_SIMD_X86
+			if (simd::detect() >= simd::sse2)
+			{
+				return sse2::count_values(first, last);
+			}
+#		endif
+
+			return generic::count_values(first, last, true);
+		}
+
+		/**
+		 * Throws the error at “where” with its line number.
+		 */
+		inline
+		void
+		fail(const char *first, const char *where, const char *what)
+		{
+			char line[24];
+			std::sprintf(line, "%lu", static_cast<unsigned long>(
+				             std::count(first, where, '\n') + 1));
+
+			throw std::runtime_error(std::string("text: ") + what
+			                         + " at line " + line);
+		}
+
+		/**
+		 * “numeric_limits<T>::is_signed” dispatch which does not compare
+		 * unsigned values to zero.
+		 */
+		template <typename T, bool = std::numeric_limits<T>::is_signed>
+		struct sign
+		{
+			static
+			bool
+			is_negative(T value)
+			{
+				return (value < T(0));
+			}
+		};
+
+		template <typename T>
+		struct sign<T, false>
+		{
+			static
+			bool
+			is_negative(T)
+			{
+				return false;
+			}
+		};
+
+		template <typename T>
+		const char *
+		parse_integer(const char *first, const char *last, T &value)
+		{
+			const char *p = first;
+
+			bool negative = false;
+			if ((p != last) && ((*p == '-') || (*p == '+')))
+			{
+				negative = (*p == '-');
+				++p;
+			}
+			if (negative && !std::numeric_limits<T>::is_signed)
+			{
+				return first;
+			}
+
+			const uint64_t max = std::numeric_limits<uint64_t>::max();
+			const char *const digits = p;
+
+			uint64_t u = 0;
+			for (; (p != last) && is_digit(*p); ++p)
+			{
+				const unsigned d = *p - '0';
+				if (u > (max - d) / 10)
+				{
+					return first;
+				}
+				u = u * 10 + d;
+			}
+
+			if ((p == digits)
+			    || (u > static_cast<uint64_t>(std::numeric_limits<T>::max())
+			        + negative))
+			{
+				return first;
+			}
+
+			// The conversion is modular.
+			value = static_cast<T>(negative ? (0 - u) : u);
+
+			return p;
+		}
+
+		inline float strto(const char *s, char **end, float)
+		{
+			return ::strtof(s, end);
+		}
+
+		inline double strto(const char *s, char **end, double)
+		{
+			return std::strtod(s, end);
+		}
+
+		inline long double strto(const char *s, char **end, long double)
+		{
+			return ::strtold(s, end);
+		}
+
+		/**
+		 * Parses a floating point number with the C library, at most
+		 * “n” characters are read.
+		 *
+		 * The value is copied to be null-terminated and to use the
+		 * decimal separator of the current locale.
+		 */
+		template <typename T>
+		const char *
+		parse_slowly(const char *first, size_t n, T &value)
+		{
+			char small[64];
+			std::string large;
+
+			char *s = small;
+			if (n < sizeof(small))
+			{
+				std::memcpy(small, first, n);
+				small[n] = '\0';
+			}
+			else
+			{
+				large.assign(first, n);
+				s = &large[0];
+			}
+
+			const char point = *std::localeconv()->decimal_point;
+			if (point != '.')
+			{
+				std::replace(s, s + n, '.', point);
+			}
+
+			char *end;
+			errno = 0;
+			const T result = strto(s, &end, T());
+
+			if ((end == s)
+			    || ((errno == ERANGE)
+			        && ((result == std::numeric_limits<T>::infinity())
+			            || (result == -std::numeric_limits<T>::infinity()))))
+			{
+				return first;
+			}
+
+			value = result;
+
+			return first + (end - s);
+		}
+
+		/**
+		 * 10^i is exact in T for i ≤ “exact_powers<T>()”, i.e. when 5^i
+		 * fits in the significand of T.
+		 */
+		template <typename T>
+		int
+		exact_powers()
+		{
+			const int n = static_cast<int>(std::numeric_limits<T>::digits
+			                               * 0.43067655807339306); // log₅ 2
+			return std::min(n, 27);
+		}
+
+		/**
+		 * Computes “significand × 10^exponent” if both operands are exact
+		 * in T: the result is then correctly rounded.
+		 *
+		 * @return Whether the result has been computed.
+		 */
+		template <typename T>
+		bool
+		scale(uint64_t significand, int exponent, T &result)
+		{
+			static const long double powers[] = {
+				1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L,
+				1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L,
+				1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+			};
+
+			const int max_power = exact_powers<T>();
+
+			if ((exponent < -max_power) || (exponent > max_power)
+			    || ((std::numeric_limits<T>::digits < 64)
+			        && (significand >> (std::numeric_limits<T>::digits % 64)
+			            != 0)))
+			{
+				return false;
+			}
+
+			result = static_cast<T>(significand);
+			if (exponent < 0)
+			{
+				result /= static_cast<T>(powers[-exponent]);
+			}
+			else
+			{
+				result *= static_cast<T>(powers[exponent]);
+			}
+
+			return true;
+		}
+
+		/**
+		 * A type with a larger significand, if any.
+		 */
+		template <typename T>
+		struct wider
+		{
+			typedef T type;
+		};
+
+		template <>
+		struct wider<float>
+		{
+			typedef double type;
+		};
+
+		template <>
+		struct wider<double>
+		{
+			typedef long double type;
+		};
+
+		/**
+		 * Same as “scale()” but computed in a wider type, which covers
+		 * the 17 significant digits of a “double” (or the 9 of a
+		 * “float”).
+		 *
+		 * Rounding twice gives the correctly rounded result unless the
+		 * wide result is exactly halfway between two values of T, in
+		 * which case nothing is computed.
+		 */
+		template <typename T>
+		bool
+		scale_wider(uint64_t significand, int exponent, T &result)
+		{
+			typedef typename wider<T>::type W;
+
+			W r;
+			if ((std::numeric_limits<W>::digits <= std::numeric_limits<T>::digits)
+			    || !scale(significand, exponent, r))
+			{
+				return false;
+			}
+
+			// Halfway, “r + rest” would be the next value of T (and it
+			// cannot be one otherwise).
+			const T t = static_cast<T>(r);
+			const W rest = r - static_cast<W>(t);
+			if ((rest != 0)
+			    && (static_cast<W>(static_cast<T>(r + rest)) == r + rest))
+			{
+				return false;
+			}
+
+			result = t;
+
+			return true;
+		}
+
+		template <typename T>
+		const char *
+		parse_float(const char *first, const char *last, T &value)
+		{
+			const char *p = first;
+
+			bool negative = false;
+			if ((p != last) && ((*p == '-') || (*p == '+')))
+			{
+				negative = (*p == '-');
+				++p;
+			}
+
+			// At most 19 significant digits, which fit in 64 bits, are
+			// kept.
+			uint64_t significand = 0;
+			int digits = 0, exponent = 0;
+			bool exact = true;
+			size_t n = 0;
+
+			for (bool fraction = false;; fraction = true)
+			{
+				const char *const start = p;
+
+				for (; (p != last) && is_digit(*p); ++p)
+				{
+					const unsigned d = *p - '0';
+
+					if ((significand == 0) && (d == 0))
+					{
+						// Leading zero.
+					}
+					else if (digits < 19)
+					{
+						significand = significand * 10 + d;
+						++digits;
+					}
+					else
+					{
+						exact = exact && (d == 0);
+						exponent += !fraction;
+						continue;
+					}
+					exponent -= fraction;
+				}
+				n += p - start;
+
+				if (fraction || (p == last) || (*p != '.'))
+				{
+					break;
+				}
+				++p;
+			}
+
+			if (n == 0)
+			{
+				// Infinity, NaN or invalid.
+				return parse_slowly(first, std::min<size_t>(last - first, 63),
+				                    value);
+			}
+
+			if ((p != last) && ((*p == 'e') || (*p == 'E')))
+			{
+				const char *q = p + 1;
+
+				bool negative_exponent = false;
+				if ((q != last) && ((*q == '-') || (*q == '+')))
+				{
+					negative_exponent = (*q == '-');
+					++q;
+				}
+
+				if ((q != last) && is_digit(*q))
+				{
+					int e = 0;
+					for (; (q != last) && is_digit(*q); ++q)
+					{
+						if (e < 100000)
+						{
+							e = e * 10 + (*q - '0');
+						}
+					}
+					exponent += negative_exponent ? -e : e;
+					p = q;
+				}
+			}
+
+			if (significand == 0)
+			{
+				value = negative ? -T(0) : T(0);
+				return p;
+			}
+
+			T result;
+			if (!exact || !(scale(significand, exponent, result)
+			                || scale_wider(significand, exponent, result)))
+			{
+				return parse_slowly(first, p - first, value);
+			}
+
+			value = negative ? -result : result;
+
+			return p;
+		}
+
+		template <typename T, bool = std::numeric_limits<T>::is_integer>
+		struct converter
+		{
+			static
+			const char *
+			parse(const char *first, const char *last, T &value)
+			{
+				return parse_integer(first, last, value);
+			}
+
+			static
+			char *
+			format(char *first, T value)
+			{
+				char buffer[24];
+				char *p = buffer + sizeof(buffer);
+
+				const bool negative = sign<T>::is_negative(value);
+				uint64_t u = static_cast<uint64_t>(value);
+				if (negative)
+				{
+					u = 0 - u;
+				}
+
+				do
+				{
+					*--p = static_cast<char>('0' + u % 10);
+					u /= 10;
+				}
+				while (u != 0);
+
+				if (negative)
+				{
+					*first++ = '-';
+				}
+
+				return std::copy(p, buffer + sizeof(buffer), first);
+			}
+		};
+
+		inline int print(char *s, int precision, double value)
+		{
+			return std::sprintf(s, "%.*g", precision, value);
+		}
+
+		inline int print(char *s, int precision, float value)
+		{
+			return print(s, precision, static_cast<double>(value));
+		}
+
+		inline int print(char *s, int precision, long double value)
+		{
+			return std::sprintf(s, "%.*Lg", precision, value);
+		}
+
+		template <typename T>
+		struct converter<T, false>
+		{
+			static
+			const char *
+			parse(const char *first, const char *last, T &value)
+			{
+				return parse_float(first, last, value);
+			}
+
+			static
+			char *
+			format(char *first, T value)
+			{
+				// Printing “digits10” digits gives back the same decimal
+				// number, “digits10 + 2” the same binary one.
+				const int
+					low = std::numeric_limits<T>::digits10,
+					high = static_cast<int>(std::numeric_limits<T>::digits
+					                        * 0.30102999566398120) + 2;
+
+				// The decimal separator of the current locale is replaced
+				// before checking, “parse()” only accepts a point.
+				const char point = *std::localeconv()->decimal_point;
+
+				int n = print(first, low, value);
+				if (point != '.')
+				{
+					std::replace(first, first + n, point, '.');
+				}
+
+				T check;
+				if ((parse(first, first + n, check) != first + n)
+				    || !(check == value))
+				{
+					n = print(first, high, value);
+					if (point != '.')
+					{
+						std::replace(first, first + n, point, '.');
+					}
+				}
+
+				return first + n;
+			}
+		};
+
+		/**
+		 * Parses the values of [first, last) to “values”.
+		 *
+		 * If columns is not zero, each non-blank line must contain this
+		 * number of values.
+		 *
+		 * @return The description of the error or NULL.
+		 */
+		template <typename T>
+		const char *
+		parse_values(const char *&first, const char *last, T *values,
+		             size_t columns)
+		{
+			size_t in_line = 0;
+
+			while (first != last)
+			{
+				const char c = *first;
+
+				if ((c == '\n') && (columns != 0))
+				{
+					if ((in_line != 0) && (in_line != columns))
+					{
+						return "wrong number of values";
+					}
+					in_line = 0;
+					++first;
+					continue;
+				}
+				if (is_space(c))
+				{
+					++first;
+					continue;
+				}
+
+				if ((columns != 0) && (in_line == columns))
+				{
+					return "wrong number of values";
+				}
+
+				const char *end = converter<T>::parse(first, last, *values);
+				if ((end == first) || ((end != last) && !is_space(*end)))
+				{
+					return "invalid value";
+				}
+
+				first = end;
+				++values;
+				++in_line;
+			}
+
+			if ((columns != 0) && (in_line != 0) && (in_line != columns))
+			{
+				return "wrong number of values";
+			}
+
+			return NULL;
+		}
+
+		/**
+		 * Splits [first, last) in n chunks which end at whitespace (or at
+		 * the end of a line if “lines” is true).
+		 */
+		inline
+		std::vector<const char *>
+		split(const char *first, const char *last, size_t n, bool lines)
+		{
+			const size_t size = last - first;
+
+			std::vector<const char *> bounds(n + 1, last);
+			bounds[0] = first;
+
+			for (size_t k = 1; k < n; ++k)
+			{
+				const char *p =
+					std::max(bounds[k - 1], first + size / n * k);
+
+				if (lines)
+				{
+					p = std::find(p, last, '\n');
+					p += (p != last);
+				}
+				else
+				{
+					while ((p != last) && !is_space(*p))
+					{
+						++p;
+					}
+				}
+
+				bounds[k] = p;
+			}
+
+			return bounds;
+		}
+
+		/**
+		 * A few chunks per thread, but not smaller than 64 KiB.
+		 */
+		inline
+		size_t
+		chunks(size_t size, const executor &e)
+		{
+			return std::min(4 * e.concurrency(), size / 65536 + 1);
+		}
+
+		/**
+		 * Counts the values of each chunk.
+		 */
+		class count_task : public parallel_task
+		{
+		public:
+
+			count_task(const std::vector<const char *> &bounds,
+			           std::vector<size_t> &counts)
+				: _bounds(bounds), _counts(counts)
+			{}
+
+			void
+			operator()(size_t i)
+			{
+				_counts[i] = count_values(_bounds[i], _bounds[i + 1]);
+			}
+
+		private:
+
+			const std::vector<const char *> &_bounds;
+
+			std::vector<size_t> &_counts;
+		};
+
+		/**
+		 * Parses each chunk at its offset.
+		 */
+		template <typename T>
+		class parse_task : public parallel_task
+		{
+		public:
+
+			parse_task(const std::vector<const char *> &bounds,
+			           const std::vector<size_t> &offsets, T *values,
+			           size_t columns, std::vector<const char *> &errors,
+			           std::vector<const char *> &positions)
+				: _bounds(bounds), _offsets(offsets), _values(values),
+				  _columns(columns), _errors(errors), _positions(positions)
+			{}
+
+			void
+			operator()(size_t i)
+			{
+				const char *p = _bounds[i];
+
+				_errors[i] = parse_values(p, _bounds[i + 1],
+				                          _values + _offsets[i], _columns);
+				_positions[i] = p;
+			}
+
+		private:
+
+			const std::vector<const char *> &_bounds;
+
+			const std::vector<size_t> &_offsets;
+
+			T *_values;
+
+			size_t _columns;
+
+			std::vector<const char *> &_errors, &_positions;
+		};
+
+		/**
+		 * Counts the values of each chunk and computes where they start.
+		 *
+		 * @return The total number of values.
+		 */
+		inline
+		size_t
+		count(const std::vector<const char *> &bounds,
+		      std::vector<size_t> &offsets, executor &e)
+		{
+			const size_t n = bounds.size() - 1;
+
+			offsets.resize(n + 1);
+
+			count_task task(bounds, offsets);
+			e.run(task, n);
+
+			size_t total = 0;
+			for (size_t i = 0; i <= n; ++i)
+			{
+				const size_t c = (i < n) ? offsets[i] : 0;
+				offsets[i] = total;
+				total += c;
+			}
+
+			return total;
+		}
+
+		/**
+		 * Parses the chunks and throws the first error.
+		 */
+		template <typename T>
+		void
+		parse(const char *first, const std::vector<const char *> &bounds,
+		      const std::vector<size_t> &offsets, T *values, size_t columns,
+		      executor &e)
+		{
+			const size_t n = bounds.size() - 1;
+
+			std::vector<const char *> errors(n), positions(n);
+
+			parse_task<T> task(bounds, offsets, values, columns, errors,
+			                   positions);
+			e.run(task, n);
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (errors[i] != NULL)
+				{
+					fail(first, positions[i], errors[i]);
+				}
+			}
+		}
+
+		/**
+		 * A file mapped in read-only mode.
+		 */
+		class mapped_file
+		{
+		public:
+
+			/**
+			 * @throw std::runtime_error If the file cannot be mapped.
+			 */
+			explicit
+			mapped_file(const std::string &path)
+				: _data(NULL), _length(0)
+			{
+				const int fd = ::open(path.c_str(), O_RDONLY);
+				if (fd == -1)
+				{
+					fail(path, "cannot open");
+				}
+
+				struct stat status;
+				if (::fstat(fd, &status) != 0)
+				{
+					::close(fd);
+					fail(path, "cannot stat");
+				}
+
+				this->_length = status.st_size;
+				if (this->_length != 0)
+				{
+					this->_data = ::mmap(NULL, this->_length, PROT_READ,
+					                     MAP_PRIVATE, fd, 0);
+				}
+
+				::close(fd);
+
+				if (this->_data == MAP_FAILED)
+				{
+					fail(path, "cannot map");
+				}
+
+				if (this->_data != NULL)
+				{
+					::madvise(this->_data, this->_length, MADV_SEQUENTIAL);
+				}
+			}
+
+			~mapped_file()
+			{
+				if (this->_data != NULL)
+				{
+					::munmap(this->_data, this->_length);
+				}
+			}
+
+			const char *
+			begin() const
+			{
+				return static_cast<const char *>(this->_data);
+			}
+
+			const char *
+			end() const
+			{
+				return this->begin() + this->_length;
+			}
+
+		private:
+
+			/**
+			 *
+			 */
+			void *_data;
+
+			/**
+			 *
+			 */
+			size_t _length;
+
+			/**
+			 * Throws the error described by errno.
+			 */
+			static
+			void
+			fail(const std::string &path, const char *what)
+			{
+				throw std::runtime_error(path + ": " + what + ": "
+				                         + std::strerror(errno));
+			}
+
+			/**
+			 * Non copyable.
+			 */
+			mapped_file(const mapped_file &);
+			mapped_file &operator=(const mapped_file &);
+		};
+
+		/**
+		 * Appends the values of the row i of m followed by a new line.
+		 */
+		template <typename T>
+		void
+		format_row(std::vector<char> &buffer, const const_matrix_view<T> &m,
+		           size_t i)
+		{
+			const size_t n = m.columns();
+			const size_t size = buffer.size();
+
+			buffer.resize(size + n * (max_length<T>::value + 1) + 1);
+
+			char *const first = &buffer[0] + size;
+			char *p = first;
+
+			for (size_t j = 0; j < n; ++j)
+			{
+				if (j != 0)
+				{
+					*p++ = ' ';
+				}
+				p = converter<T>::format(p, m(i, j));
+			}
+			*p++ = '\n';
+
+			buffer.resize(size + (p - first));
+		}
+	} // namespace details
+
+	template <typename T>
+	const char *
+	parse(const char *first, const char *last, T &value)
+	{
+		requires(first <= last);
+
+		return details::converter<T>::parse(first, last, value);
+	}
+
+	template <typename T>
+	char *
+	format(char *first, char *last, T value)
+	{
+		requires(last - first >= details::max_length<T>::value);
+
+		return details::converter<T>::format(first, value);
+	}
+
+	template <typename T>
+	const char *
+	parse(const char *first, const char *last, array_view<T> a)
+	{
+		requires(first <= last);
+
+		const char *p = first;
+
+		for (size_t i = 0, n = a.size(); i < n; ++i)
+		{
+			p = details::skip_spaces(p, last);
+			if (p == last)
+			{
+				details::fail(first, p, "missing value");
+			}
+
+			const char *end = details::converter<T>::parse(p, last, a[i]);
+			if ((end == p) || ((end != last) && !details::is_space(*end)))
+			{
+				details::fail(first, p, "invalid value");
+			}
+			p = end;
+		}
+
+		return p;
+	}
+
+	template <typename T>
+	array<T>
+	parse_array(const char *first, const char *last)
+	{
+		sequential_executor e;
+
+		return parse_array<T>(first, last, e);
+	}
+
+	template <typename T>
+	array<T>
+	parse_array(const char *first, const char *last, executor &e)
+	{
+		requires(first <= last);
+
+		const std::vector<const char *> bounds = details::split(
+			first, last, details::chunks(last - first, e), false);
+
+		std::vector<size_t> offsets;
+		const size_t n = details::count(bounds, offsets, e);
+		if (n == 0)
+		{
+			throw std::runtime_error("text: no values");
+		}
+
+		array<T> a(n);
+		details::parse(first, bounds, offsets, a.begin(), 0, e);
+
+		return a;
+	}
+
+	template <typename T>
+	matrix<T>
+	parse_matrix(const char *first, const char *last)
+	{
+		sequential_executor e;
+
+		return parse_matrix<T>(first, last, e);
+	}
+
+	template <typename T>
+	matrix<T>
+	parse_matrix(const char *first, const char *last, executor &e)
+	{
+		requires(first <= last);
+
+		// The first non-blank line gives the number of columns.
+		const char *p = details::skip_spaces(first, last);
+		const size_t columns =
+			details::count_values(p, std::find(p, last, '\n'));
+		if (columns == 0)
+		{
+			return matrix<T>();
+		}
+
+		const std::vector<const char *> bounds = details::split(
+			first, last, details::chunks(last - first, e), true);
+
+		std::vector<size_t> offsets;
+		const size_t n = details::count(bounds, offsets, e);
+
+		// Rounded up: a partial row is detected by the parsing.
+		matrix<T> m((n + columns - 1) / columns, columns);
+		details::parse(first, bounds, offsets, m.begin(), columns, e);
+
+		return m;
+	}
+
+	template <typename T>
+	array<T>
+	load_array(const std::string &path)
+	{
+		sequential_executor e;
+
+		return load_array<T>(path, e);
+	}
+
+	template <typename T>
+	array<T>
+	load_array(const std::string &path, executor &e)
+	{
+		const details::mapped_file file(path);
+
+		return parse_array<T>(file.begin(), file.end(), e);
+	}
+
+	template <typename T>
+	matrix<T>
+	load_matrix(const std::string &path)
+	{
+		sequential_executor e;
+
+		return load_matrix<T>(path, e);
+	}
+
+	template <typename T>
+	matrix<T>
+	load_matrix(const std::string &path, executor &e)
+	{
+		const details::mapped_file file(path);
+
+		return parse_matrix<T>(file.begin(), file.end(), e);
+	}
+
+	template <typename T>
+	void
+	format(std::vector<char> &buffer, const array_view<T> &a)
+	{
+		typedef typename array_view<T>::value_type value_type;
+
+		details::format_row(buffer, const_matrix_view<value_type>(
+			                    a.raw(), 1, a.size(), a.size()), 0);
+	}
+
+	template <typename T, size_t S>
+	void
+	format(std::vector<char> &buffer, const array<T, S> &a)
+	{
+		details::format_row(buffer, const_matrix_view<T>(
+			                    a.begin(), 1, a.size(), a.size()), 0);
+	}
+
+	template <typename T>
+	void
+	format(std::vector<char> &buffer, const const_matrix_view<T> &m)
+	{
+		for (size_t i = 0, n = m.rows(); i < n; ++i)
+		{
+			details::format_row(buffer, m, i);
+		}
+	}
+
+	template <typename T, class Allocator, class Layout>
+	void
+	format(std::vector<char> &buffer, const matrix<T, Allocator, Layout> &m)
+	{
+		format(buffer, const_matrix_view<T>(m));
+	}
+} // namespace text
+
+JFCPP_NAMESPACE_END
@@ -0,0 +1,478 @@
+/**
+ * This file is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author:
+ *   Julien Fontanet <julien.fontanet@isonoe.net>
+ */
+
+#ifndef H_JFCPP_THREAD_POOL
+#define H_JFCPP_THREAD_POOL
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#ifndef JFCPP_NO_THREADS
+#	include <pthread.h>
+#	include <unistd.h>
+#endif
+
+#include "common.hpp"
+
+JFCPP_NAMESPACE_BEGIN
+
+/**
+ * A task which can be executed in parallel: it is called once for each index
+ * in [0, n), in no particular order and possibly concurrently.
+ */
+class parallel_task
+{
+public:
+
+	virtual ~parallel_task()
+	{}
+
+	virtual void operator()(size_t i) = 0;
+};
+
+/**
+ * Something which is able to execute parallel tasks.
+ */
+class executor
+{
+public:
+
+	virtual ~executor()
+	{}
+
+	/**
+	 * Gets the maximum number of indexes which can be processed at the same
+	 * time.
+	 */
+	virtual size_t concurrency() const = 0;
+
+	/**
+	 * Calls “task(i)” for each i in [0, n) and returns when all of them are
+	 * finished.
+	 *
+	 * @throw std::runtime_error If one of the calls threw an exception (the
+	 *                            “sequential_executor” lets it propagate
+	 *                            unchanged).
+	 */
+	virtual void run(parallel_task &task, size_t n) = 0;
+};
+
+/**
+ * Executes everything in the calling thread.
+ */
+class sequential_executor : public executor
+{
+public:
+
+	size_t
+	concurrency() const
+	{
+		return 1;
+	}
+
+	void
+	run(parallel_task &task, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			task(i);
+		}
+	}
+};
+
+/**
+ * A pool of threads executing parallel tasks with work-stealing.
+ *
+ * The indexes are initially split in one contiguous range per thread (the
+ * calling thread included), each thread consumes its range from the
+ * beginning and, once it is empty, steals the second half of the range of
+ * another thread.
+ *
+ * If “run()” is called while the pool is already busy (e.g. from a task),
+ * the task is executed in the calling thread.
+ *
+ * When “JFCPP_NO_THREADS” is defined, no threads are created and
+ * everything is executed in the calling thread.
+ */
+class thread_pool : public executor
+{
+public:
+
+	/**
+	 * Gets the number of processors available on this machine.
+	 */
+	static
+	size_t
+	hardware_concurrency()
+	{
+#	ifndef JFCPP_NO_THREADS
+		const long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+		if (n > 0)
+		{
+			return static_cast<size_t>(n);
+		}
+#	endif
+
+		return 1;
+	}
+
+	/**
+	 * Gets a pool shared by the whole program which uses all the available
+	 * processors.
+	 */
+	static
+	thread_pool &
+	instance()
+	{
+		static thread_pool pool;
+
+		return pool;
+	}
+
+	/**
+	 * Creates a new thread pool.
+	 *
+	 * @param threads The number of threads which will execute the tasks,
+	 *                including the one calling “run()” (0 means
+	 *                “hardware_concurrency()”).
+	 */
+	explicit
+	thread_pool(size_t threads = 0)
+		: _concurrency(threads == 0 ? hardware_concurrency() : threads)
+#	ifndef JFCPP_NO_THREADS
+		, _ranges(_concurrency), _task(NULL), _generation(0), _active(0),
+		  _busy(false), _failed(false), _stopping(false)
+#	endif
+	{
+#	ifndef JFCPP_NO_THREADS
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_wake_up, NULL);
+		pthread_cond_init(&_done, NULL);
+
+		for (size_t i = 0; i < _concurrency; ++i)
+		{
+			pthread_mutex_init(&_ranges[i].mutex, NULL);
+		}
+
+		// The calling thread is the participant 0.
+		_threads.reserve(_concurrency - 1);
+		for (size_t i = 1; i < _concurrency; ++i)
+		{
+			_workers.push_back(worker(this, i));
+		}
+		for (size_t i = 1; i < _concurrency; ++i)
+		{
+			pthread_t thread;
+
+			if (pthread_create(&thread, NULL, &thread_pool::_main,
+			                   &_workers[i - 1]) != 0)
+			{
+				// Works with the threads we have.
+				_concurrency = i;
+				break;
+			}
+			_threads.push_back(thread);
+		}
+#	endif
+	}
+
+	~thread_pool()
+	{
+#	ifndef JFCPP_NO_THREADS
+		pthread_mutex_lock(&_mutex);
+		_stopping = true;
+		pthread_cond_broadcast(&_wake_up);
+		pthread_mutex_unlock(&_mutex);
+
+		for (size_t i = 0; i < _threads.size(); ++i)
+		{
+			pthread_join(_threads[i], NULL);
+		}
+
+		for (size_t i = 0; i < _ranges.size(); ++i)
+		{
+			pthread_mutex_destroy(&_ranges[i].mutex);
+		}
+		pthread_cond_destroy(&_done);
+		pthread_cond_destroy(&_wake_up);
+		pthread_mutex_destroy(&_mutex);
+#	endif
+	}
+
+	size_t
+	concurrency() const
+	{
+		return _concurrency;
+	}
+
+	void
+	run(parallel_task &task, size_t n)
+	{
+#	ifndef JFCPP_NO_THREADS
+		pthread_mutex_lock(&_mutex);
+		if (_busy || (_concurrency == 1) || (n <= 1))
+		{
+			pthread_mutex_unlock(&_mutex);
+			_run_sequentially(task, n);
+			return;
+		}
+		_busy = true;
+		_failed = false;
+
+		for (size_t i = 0; i < _concurrency; ++i)
+		{
+			_ranges[i].begin = n * i / _concurrency;
+			_ranges[i].end = n * (i + 1) / _concurrency;
+		}
+
+		_task = &task;
+		++_generation;
+		pthread_cond_broadcast(&_wake_up);
+		pthread_mutex_unlock(&_mutex);
+
+		_work(0);
+
+		pthread_mutex_lock(&_mutex);
+		while (_active != 0)
+		{
+			pthread_cond_wait(&_done, &_mutex);
+		}
+		_task = NULL;
+		_busy = false;
+
+		const bool failed = _failed;
+		pthread_mutex_unlock(&_mutex);
+
+		if (failed)
+		{
+			throw std::runtime_error("a parallel task failed");
+		}
+#	else
+		_run_sequentially(task, n);
+#	endif
+	}
+
+private:
+
+	// Non-copyable.
+	thread_pool(const thread_pool &);
+	thread_pool &operator=(const thread_pool &);
+
+	size_t _concurrency;
+
+	/**
+	 * Same error reporting as the parallel execution.
+	 */
+	static
+	void
+	_run_sequentially(parallel_task &task, size_t n)
+	{
+		try
+		{
+			sequential_executor().run(task, n);
+		}
+		catch (...)
+		{
+			throw std::runtime_error("a parallel task failed");
+		}
+	}
+
+#	ifndef JFCPP_NO_THREADS
+	/**
+	 * The indexes which remain to be processed by a participant.
+	 */
+	struct range
+	{
+		pthread_mutex_t mutex;
+
+		size_t begin;
+
+		size_t end;
+	};
+
+	struct worker
+	{
+		worker(thread_pool *pool, size_t id) : pool(pool), id(id)
+		{}
+
+		thread_pool *pool;
+
+		size_t id;
+	};
+
+	std::vector<range> _ranges;
+
+	std::vector<worker> _workers;
+
+	std::vector<pthread_t> _threads;
+
+	/**
+	 * Protects all the following members.
+	 */
+	pthread_mutex_t _mutex;
+
+	pthread_cond_t _wake_up;
+
+	pthread_cond_t _done;
+
+	parallel_task *_task;
+
+	unsigned long _generation;
+
+	size_t _active;
+
+	bool _busy;
+
+	bool _failed;
+
+	bool _stopping;
+
+	static
+	void *
+	_main(void *data)
+	{
+		const worker &self = *static_cast<worker *>(data);
+		thread_pool &pool = *self.pool;
+
+		unsigned long generation = 0;
+
+		pthread_mutex_lock(&pool._mutex);
+		while (true)
+		{
+			while (!pool._stopping
+			       && ((pool._task == NULL) || (pool._generation == generation)))
+			{
+				pthread_cond_wait(&pool._wake_up, &pool._mutex);
+			}
+			if (pool._stopping)
+			{
+				break;
+			}
+
+			generation = pool._generation;
+			++pool._active;
+			pthread_mutex_unlock(&pool._mutex);
+
+			pool._work(self.id);
+
+			pthread_mutex_lock(&pool._mutex);
+			if (--pool._active == 0)
+			{
+				pthread_cond_signal(&pool._done);
+			}
+		}
+		pthread_mutex_unlock(&pool._mutex);
+
+		return NULL;
+	}
+
+	/**
+	 * Takes the next index of the range of a participant.
+	 */
+	bool
+	_pop(size_t id, size_t &i)
+	{
+		range &r = _ranges[id];
+		bool found = false;
+
+		pthread_mutex_lock(&r.mutex);
+		if (r.begin < r.end)
+		{
+			i = r.begin++;
+			found = true;
+		}
+		pthread_mutex_unlock(&r.mutex);
+
+		return found;
+	}
+
+	/**
+	 * Moves the second half of the range of another participant to the one
+	 * of “id”.
+	 */
+	bool
+	_steal(size_t id)
+	{
+		for (size_t k = 1; k < _concurrency; ++k)
+		{
+			range &victim = _ranges[(id + k) % _concurrency];
+			size_t begin, end;
+
+			pthread_mutex_lock(&victim.mutex);
+			end = victim.end;
+			begin = victim.begin + (end - victim.begin) / 2;
+			if (victim.begin < end)
+			{
+				victim.end = begin;
+			}
+			pthread_mutex_unlock(&victim.mutex);
+
+			if (begin < end)
+			{
+				range &r = _ranges[id];
+
+				pthread_mutex_lock(&r.mutex);
+				r.begin = begin;
+				r.end = end;
+				pthread_mutex_unlock(&r.mutex);
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void
+	_work(size_t id)
+	{
+		parallel_task &task = *_task;
+		bool failed = false;
+
+		do
+		{
+			size_t i;
+			while (_pop(id, i))
+			{
+				try
+				{
+					task(i);
+				}
+				catch (...)
+				{
+					failed = true;
+				}
+			}
+		}
+		while (_steal(id));
+
+		if (failed)
+		{
+			pthread_mutex_lock(&_mutex);
+			_failed = true;
+			pthread_mutex_unlock(&_mutex);
+		}
+	}
+#	endif // JFCPP_NO_THREADS
+};
+
+JFCPP_NAMESPACE_END
+
+#endif // H_JFCPP_THREAD_POOL
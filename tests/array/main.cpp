@@ -2,6 +2,7 @@
 #include <jfcpp/array.hpp>
 
 #include <cstdlib>
+#include <utility>
 
 #include <contracts.h>
 
@@ -115,5 +116,32 @@ int main()
 		assert(d[i] == -b[i]);
 	}
 
+	// Chained operations.
+	{
+		array<int> e(b + d + b);
+		for (size_t i = 0; i < e.size(); ++i)
+		{
+			assert(e[i] == b[i]);
+		}
+	}
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+	// Move semantics: the storage of a temporary left operand is reused.
+	{
+		array<int> e(b);
+		const int *p = &e[0];
+
+		array<int> f(std::move(e) + d + b);
+		assert(&f[0] == p);
+		for (size_t i = 0; i < f.size(); ++i)
+		{
+			assert(f[i] == b[i]);
+		}
+
+		e = std::move(f);
+		assert(&e[0] == p);
+	}
+#endif
+
 	return EXIT_SUCCESS;
 }
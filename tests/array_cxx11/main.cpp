@@ -0,0 +1,3 @@
+// The tests of “array” built in C++11 (see “../GNUmakefile”), where the move
+// constructor and assignment are compiled.
+#include "../array/main.cpp"
@@ -0,0 +1,126 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/bareiss.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <contracts.h>
+
+#include <jfcpp/math/rational.hpp>
+#include <jfcpp/matrix/modular.hpp>
+
+#include "../matrix_checks.hpp"
+
+using jfcpp::bareiss;
+using jfcpp::det_modular;
+using jfcpp::matrix;
+using jfcpp::thread_pool;
+using jfcpp::math::rational;
+
+int main()
+{
+	// Integers.
+	{
+		matrix<long> a(4, 4);
+		const long values[] = {
+			0, 2, -1, 3,
+			1, 0, 4, -2,
+			3, 1, 0, 1,
+			-2, 5, 1, 0
+		};
+		std::copy(values, values + 16, a.begin());
+
+		const bareiss<long> f(a);
+
+		assert(!f.is_singular());
+		assert(f.det() == -138);
+		assert(a.det() == -138);
+		assert(det_modular(a) == -138);
+
+		// d × X has integer values.
+		matrix<long> x(4, 2), b;
+		for (size_t i = 0; i < x.size(); ++i)
+		{
+			x(i) = long(rand() % 21) - 10;
+		}
+		b = a.mprod(x);
+		f.solve(b);
+		for (size_t i = 0; i < x.size(); ++i)
+		{
+			assert(b(i) == -138 * x(i));
+		}
+
+		// Integer solution.
+		b = a.mprod(x);
+		a.solve(b);
+		assert(b == x);
+	}
+
+	// Larger integer matrix: no overflow as long as the minors fit.
+	{
+		const size_t n = 12;
+
+		matrix<long> a(n, n, 0l);
+		for (size_t i = 0; i < n; ++i)
+		{
+			a(i, i) = 2;
+			if (i != 0)
+			{
+				a(i, i - 1) = -1;
+				a(i - 1, i) = -1;
+			}
+		}
+		a.swap_rows(0, n - 1);
+
+		// The determinant of this tridiagonal matrix is n + 1.
+		assert(a.det() == -long(n + 1));
+
+		thread_pool pool(4);
+		assert(det_modular(a, pool) == -long(n + 1));
+	}
+
+	// Singular matrix.
+	{
+		matrix<long> a(4, 4, 1l);
+
+		const bareiss<long> f(a);
+
+		assert(f.is_singular());
+		assert(f.det() == 0);
+		assert(det_modular(a) == 0);
+
+		matrix<long> b(4, 1, 0l);
+		assert_exception(f.solve(b), std::runtime_error);
+	}
+
+	// Rationals.
+	{
+		typedef rational<long> q;
+
+		matrix<q> a(4, 4);
+		for (size_t i = 0; i < 4; ++i)
+		{
+			for (size_t j = 0; j < 4; ++j)
+			{
+				a(i, j) = q(1, long(i + j + 1));
+			}
+		}
+
+		// Determinant of the Hilbert matrix of order 4.
+		assert(is_equal(a.det(), q(1, 6048000)));
+
+		const matrix<q> inverse = a.inverse();
+		const matrix<q> p = a.mprod(inverse);
+		for (size_t i = 0; i < 4; ++i)
+		{
+			for (size_t j = 0; j < 4; ++j)
+			{
+				assert(is_equal(p(i, j), q(i == j ? 1 : 0)));
+			}
+		}
+		assert(is_equal(inverse(0, 0), q(16)));
+	}
+
+	return EXIT_SUCCESS;
+}
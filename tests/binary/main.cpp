@@ -0,0 +1,262 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/binary.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <contracts.h>
+
+#include <jfcpp/array.hpp>
+#include <jfcpp/array_view.hpp>
+#include <jfcpp/mapped_matrix.hpp>
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/matrix/view.hpp>
+
+using jfcpp::array;
+using jfcpp::array_view;
+using jfcpp::column_major;
+using jfcpp::const_matrix_view;
+using jfcpp::mapped_matrix;
+using jfcpp::matrix;
+
+namespace binary = jfcpp::binary;
+
+const char *const path = "binary.tmp";
+
+/**
+ * Fills m with 10 × i + j.
+ */
+template <class M>
+void
+fill(M &m)
+{
+	for (size_t i = 0; i < m.rows(); ++i)
+	{
+		for (size_t j = 0; j < m.columns(); ++j)
+		{
+			m(i, j) = typename M::value_type(10 * i + j);
+		}
+	}
+}
+
+/**
+ * Whether reading the first record of the file as a matrix<T> fails.
+ */
+template <typename T>
+bool
+is_rejected()
+{
+	const int fd = ::open(path, O_RDONLY);
+	assert(fd != -1);
+
+	bool thrown = false;
+	try
+	{
+		matrix<T> m;
+		binary::read(fd, m);
+	}
+	catch (const std::runtime_error &)
+	{
+		thrown = true;
+	}
+
+	::close(fd);
+
+	return thrown;
+}
+
+int main()
+{
+	matrix<double> a(3, 5);
+	fill(a);
+
+	matrix<double, jfcpp::aligned_allocator<double>, column_major> b(4, 2);
+	fill(b);
+
+	array<int, 3> c;
+	c[0] = 1;
+	c[1] = -2;
+	c[2] = 3;
+
+	float d_values[] = {.5f, 1.5f};
+	const array_view<float> d(2, d_values);
+
+	// Record sizes are multiples of 64 bytes.
+	assert(binary::record_size<double>(0) == 64);
+	assert(binary::record_size<double>(8) == 128);
+	assert(binary::record_size<double>(15) == 192);
+
+	// Buffers and zero-copy loading.
+	{
+		std::vector<char> buffer;
+		binary::write(buffer, a);
+		binary::write(buffer, b);
+		binary::write(buffer, const_matrix_view<double>(a).strided(2, 2));
+		binary::write(buffer, c);
+		binary::write(buffer, d);
+		assert(buffer.size() == 192 + 128 + 128 + 128 + 128);
+
+		const char *first = &buffer[0], *last = first + buffer.size();
+
+		const const_matrix_view<double> a2 =
+			binary::load_matrix<double>(first, last);
+		assert(a2.data() == reinterpret_cast<const double *>(&buffer[64]));
+		assert(matrix<double>(a2) == a);
+
+		const const_matrix_view<double> b2 =
+			binary::load_matrix<double>(first, last);
+		assert(b2.rows() == 4);
+		assert(b2.row_stride() == 1);
+		assert(b2(3, 1) == 31.);
+
+		const const_matrix_view<double> s =
+			binary::load_matrix<double>(first, last);
+		assert(s.rows() == 2);
+		assert(s.columns() == 3);
+		assert(s(1, 2) == 24.);
+
+		const array_view<const int> c2 = binary::load_array<int>(first, last);
+		assert(c2.size() == 3);
+		assert(c2[1] == -2);
+
+		// The type is checked.
+		const char *p = first;
+		bool thrown = false;
+		try
+		{
+			binary::load_array<double>(p, last);
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+		assert(p == first);
+
+		const array_view<const float> d2 =
+			binary::load_array<float>(first, last);
+		assert(d2 == d);
+		assert(first == last);
+
+		// Truncated buffer.
+		first = &buffer[0];
+		thrown = false;
+		try
+		{
+			binary::load_matrix<double>(first, first + 100);
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	// Dimensions whose product overflows are rejected instead of giving a
+	// view larger than the record.
+	{
+		std::vector<char> buffer;
+		binary::write(buffer, a);
+
+		binary::details::header h;
+		std::memcpy(&h, &buffer[0], sizeof(h));
+		h.rows = uint64_t(1) << 62;
+		h.columns = 4;
+		std::memcpy(&buffer[0], &h, sizeof(h));
+
+		const char *first = &buffer[0];
+		bool thrown = false;
+		try
+		{
+			binary::load_matrix<double>(first, first + buffer.size());
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+		assert(first == &buffer[0]);
+
+		const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+		assert(fd != -1);
+		assert(::write(fd, &buffer[0], buffer.size())
+		       == static_cast<ssize_t>(buffer.size()));
+		::close(fd);
+
+		assert(is_rejected<double>());
+	}
+
+	// File descriptors.
+	{
+		int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+		assert(fd != -1);
+		binary::write(fd, a);
+		binary::write(fd, b);
+		binary::write(fd, c);
+		binary::write(fd, d);
+		::close(fd);
+
+		fd = ::open(path, O_RDONLY);
+		assert(fd != -1);
+
+		// The layout of the record is converted.
+		matrix<double, jfcpp::aligned_allocator<double>, column_major> a2;
+		binary::read(fd, a2);
+		assert(a2 == a);
+
+		matrix<double> b2;
+		binary::read(fd, b2);
+		assert(b2 == b);
+
+		array<int, 3> c2;
+		binary::read(fd, c2);
+		assert(c2 == c);
+
+		float d2_values[2];
+		binary::read(fd, array_view<float>(2, d2_values));
+		assert(d2_values[1] == 1.5f);
+
+		// End of file.
+		bool thrown = false;
+		try
+		{
+			binary::read(fd, b2);
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+
+		::close(fd);
+
+		// The header is checked.
+		assert(!is_rejected<double>());
+		assert(is_rejected<float>());
+		assert(is_rejected<long>());
+	}
+
+	// A mapped matrix is a record.
+	{
+		{
+			const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+			assert(fd != -1);
+			binary::write(fd, a);
+			::close(fd);
+		}
+
+		const mapped_matrix<double> m(path);
+		assert(m.view() == a);
+	}
+
+	std::remove(path);
+
+	return 0;
+}
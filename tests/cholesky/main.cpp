@@ -0,0 +1,254 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/cholesky.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+#include "../matrix_checks.hpp"
+
+using jfcpp::aligned_allocator;
+using jfcpp::cholesky;
+using jfcpp::column_major;
+using jfcpp::matrix;
+using jfcpp::thread_pool;
+
+/**
+ * A random symmetric positive-definite matrix: B × Bᵀ + n × I.
+ */
+matrix<double>
+make(size_t n)
+{
+	matrix<double> b(n, n);
+	for (size_t i = 0; i < b.size(); ++i)
+	{
+		b(i) = double(rand() % 201) / 100 - 1;
+	}
+
+	const matrix<double> bt = b.transpose();
+	matrix<double> a = b.mprod(bt);
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < i; ++j)
+		{
+			a(i, j) = a(j, i);
+		}
+		a(i, i) += double(n);
+	}
+	assert(a.is_symmetric());
+
+	return a;
+}
+
+/**
+ * Rebuilds A from the factors.
+ */
+matrix<double>
+rebuild(const cholesky<double> &c)
+{
+	const size_t n = c.dimension();
+	const matrix<double> &f = c.factors();
+
+	matrix<double> l(n, n, 0.), r(n, n, 0.);
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j <= i; ++j)
+		{
+			l(i, j) = f(i, j);
+		}
+	}
+
+	if (c.is_ldlt())
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			l(i, i) = 1;
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			for (size_t j = 0; j <= i; ++j)
+			{
+				r(j, i) = l(i, j) * f(j, j);
+			}
+		}
+	}
+	else
+	{
+		r = l.transpose();
+	}
+
+	return l.mprod(r);
+}
+
+int main()
+{
+	// Known decomposition.
+	{
+		matrix<double> a(2, 2);
+		a(0, 0) = 4; a(0, 1) = 2;
+		a(1, 0) = 2; a(1, 1) = 5;
+
+		const cholesky<double> c(a);
+		assert(c.factors()(0, 0) == 2);
+		assert(c.factors()(1, 0) == 1);
+		assert(c.factors()(1, 1) == 2);
+		assert(c.factors()(0, 1) == 2);
+		assert(std::fabs(c.det() - 16) < 1e-12);
+
+		const cholesky<double> d(a, true);
+		assert(d.is_ldlt());
+		assert(d.factors()(0, 0) == 4);
+		assert(d.factors()(1, 0) == 0.5);
+		assert(d.factors()(1, 1) == 4);
+		assert(std::fabs(d.det() - 16) < 1e-12);
+	}
+
+	// Several blocks, in parallel.
+	{
+		const size_t n = 300;
+		const matrix<double> a = make(n);
+
+		thread_pool pool(4);
+
+		const cholesky<double> c(a, false, pool), d(a, true);
+		assert(is_close(rebuild(c), a));
+		assert(is_close(rebuild(d), a));
+		assert(is_close(cholesky<double>(a).factors(), c.factors()));
+
+		matrix<double> x(n, 3), b, y;
+		for (size_t i = 0; i < x.size(); ++i)
+		{
+			x(i) = double(rand() % 21) - 10;
+		}
+		b = a.mprod(x);
+
+		y = b;
+		c.solve(y, pool);
+		assert(is_close(y, x));
+
+		y = b;
+		d.solve(y);
+		assert(is_close(y, x));
+
+		// “matrix::solve()” takes the same path.
+		y = b;
+		a.solve(y);
+		assert(is_close(y, x));
+
+		int sign;
+		const double l = c.log_det(sign);
+		assert(sign == 1);
+		assert(std::fabs(l - d.log_det(sign)) < 1e-9 * std::fabs(l));
+		assert(sign == 1);
+	}
+
+	// Only the lower triangle is read.
+	{
+		matrix<double> a = make(50), b(a);
+		for (size_t i = 0; i < 50; ++i)
+		{
+			for (size_t j = i + 1; j < 50; ++j)
+			{
+				b(i, j) = -1e6;
+			}
+		}
+
+		const cholesky<double> c(a), d(b);
+		for (size_t i = 0; i < 50; ++i)
+		{
+			for (size_t j = 0; j <= i; ++j)
+			{
+				assert(c.factors()(i, j) == d.factors()(i, j));
+			}
+		}
+	}
+
+	// Indefinite matrices.
+	{
+		const size_t n = 200;
+
+		// Symmetric with a negative eigenvalue.
+		matrix<double> a = make(n);
+		a(150, 150) = -1e4;
+		const matrix<double> original(a);
+
+		try
+		{
+			cholesky<double> c(a);
+			assert(false);
+		}
+		catch (const std::runtime_error &)
+		{}
+
+		// The L × D × Lᵀ decomposition still exists.
+		const cholesky<double> d(a, true);
+		assert(is_close(rebuild(d), a));
+		int sign;
+		d.log_det(sign);
+		assert(sign == -1);
+
+		// The detection restores the matrix.
+		cholesky<double> c;
+		assert(!c.try_factorize_perf(a));
+		assert(a == original);
+		assert(c.dimension() == 0);
+
+		// “matrix::solve()” falls back to the LU decomposition.
+		matrix<double> x(n, 1), b;
+		for (size_t i = 0; i < n; ++i)
+		{
+			x(i) = double(rand() % 21) - 10;
+		}
+		b = a.mprod(x);
+		a.solve(b);
+		assert(is_close(b, x));
+
+		// On success, the storage is taken.
+		matrix<double> s = make(n);
+		assert(c.try_factorize_perf(s));
+		assert(s.size() == 0);
+		assert(c.dimension() == n);
+	}
+
+	// A column-major matrix is decomposed in its layout.
+	{
+		typedef matrix<double, aligned_allocator<double>, column_major> cm;
+		typedef cholesky<double, aligned_allocator<double>, column_major> cc;
+
+		const size_t n = 300;
+		const matrix<double> a = make(n);
+		matrix<double> b(n, 2);
+		for (size_t i = 0; i < b.size(); ++i)
+		{
+			b(i) = double(rand() % 21) - 10;
+		}
+
+		thread_pool pool(4);
+
+		for (int ldlt = 0; ldlt < 2; ++ldlt)
+		{
+			const cholesky<double> c(a, ldlt);
+			const cc d(cm(a), ldlt, pool);
+			assert(is_close(matrix<double>(d.factors()), c.factors()));
+
+			matrix<double> x(b);
+			cm y(b);
+			c.solve(x);
+			d.solve(y);
+			assert(is_close(matrix<double>(y), x));
+		}
+
+		// “matrix::solve()” uses it for symmetric matrices.
+		cm s(a), y(b);
+		s.solve(y);
+		assert(is_close(a.mprod(matrix<double>(y)), b));
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,220 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/fixed_matrix.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+#include <contracts.h>
+
+#include <jfcpp/array.hpp>
+#include <jfcpp/math/quaternion.hpp>
+#include <jfcpp/matrix.hpp>
+
+using jfcpp::array;
+using jfcpp::fixed_matrix;
+using jfcpp::matrix;
+
+typedef fixed_matrix<double, 2> matrix2;
+typedef fixed_matrix<double, 3> matrix3;
+typedef fixed_matrix<double, 4> matrix4;
+typedef fixed_matrix<double, 5> matrix5;
+
+/**
+ * Whether two matrices are equal up to a small error.
+ */
+template <size_t R, size_t C>
+bool
+is_close(const fixed_matrix<double, R, C> &a,
+         const fixed_matrix<double, R, C> &b)
+{
+	for (size_t i = 0; i < R * C; ++i)
+	{
+		if (std::fabs(a(i) - b(i)) > 1e-9)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Fills a N × N matrix with small integers, the diagonal is dominant so the
+ * matrix is invertible.
+ */
+template <size_t N>
+fixed_matrix<double, N>
+make()
+{
+	fixed_matrix<double, N> m;
+
+	for (size_t i = 0; i < N; ++i)
+	{
+		for (size_t j = 0; j < N; ++j)
+		{
+			m(i, j) = double((i * 7 + j * 3) % 5) - 2;
+		}
+		m(i, i) += 4 * double(N);
+	}
+
+	return m;
+}
+
+/**
+ * Compares the determinant and the inverse with the dynamic matrix.
+ */
+template <size_t N>
+void
+test_square()
+{
+	typedef fixed_matrix<double, N> matrix_type;
+
+	const matrix_type m = make<N>();
+	const matrix<double> d(m);
+
+	assert(std::fabs(m.det() - d.det()) <= 1e-9 * std::fabs(d.det()));
+	assert(is_close(m.inverse(), matrix_type(d.inverse())));
+	assert(is_close(m.mprod(m.inverse()), matrix_type::identity()));
+	assert(is_close(m.inverse().mprod(m), matrix_type::identity()));
+
+	// A matrix with two equal rows is singular.
+	matrix_type s(m);
+	for (size_t j = 0; j < N; ++j)
+	{
+		s(N - 1, j) = s(0, j);
+	}
+	assert(N == 1 || s.det() == 0);
+	if (N > 1)
+	{
+		bool thrown = false;
+		try
+		{
+			s.inverse();
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+}
+
+int main()
+{
+	// Dimensions.
+	{
+		typedef fixed_matrix<int, 2, 3> matrix23;
+
+		assert(matrix23::rows() == 2);
+		assert(matrix23::columns() == 3);
+		assert(matrix23::size() == 6);
+		assert(!matrix23::is_square());
+		assert(matrix3::is_square());
+		assert(sizeof(matrix23) == 6 * sizeof(int));
+	}
+
+	// Products, transpose and conversions.
+	{
+		array<int, 6> v;
+		for (size_t i = 0; i < v.size(); ++i)
+		{
+			v[i] = int(i) + 1;
+		}
+
+		const fixed_matrix<int, 2, 3> a(v);
+		const fixed_matrix<int, 3, 2> b = a.transpose();
+
+		assert(b(0, 1) == 4);
+		assert(b(2, 0) == 3);
+		assert(b.transpose() == a);
+
+		const fixed_matrix<int, 2, 2> p = a.mprod(b);
+		assert(p(0, 0) == 14);
+		assert(p(0, 1) == 32);
+		assert(p(1, 0) == 32);
+		assert(p(1, 1) == 77);
+		assert(p.trace() == 91);
+
+		array<int, 3> w(0);
+		w[0] = 1;
+		w[2] = -1;
+
+		const array<int, 2> r = a.mprod(w);
+		assert(r[0] == -2);
+		assert(r[1] == -2);
+
+		assert(a.row(1)[2] == 6);
+		assert(a.column(1)[1] == 5);
+		assert(a.to_array()[4] == 5);
+
+		// With the dynamic matrices.
+		const matrix<int> d(a);
+		assert(d.rows() == 2);
+		assert(d.columns() == 3);
+		assert(d(1, 2) == 6);
+		assert(matrix<int>(p) == d.mprod(matrix<int>(b)));
+		assert((fixed_matrix<int, 2, 3>(d) == a));
+	}
+
+	// Element-wise operations.
+	{
+		matrix2 a(1.), b(matrix2::identity());
+
+		assert((a + b)(0, 0) == 2);
+		assert((a - b)(0, 1) == 1);
+		assert((a * 3.)(1, 1) == 3);
+		assert((a / 2.)(1, 0) == .5);
+		assert((-a)(0, 0) == -1);
+		assert(a != b);
+
+		a += b;
+		assert(a(0, 0) == 2);
+		assert(a(0, 1) == 1);
+	}
+
+	// Determinants and inverses (explicit formulas and the general case).
+	test_square<1>();
+	test_square<2>();
+	test_square<3>();
+	test_square<4>();
+	test_square<5>();
+	test_square<8>();
+
+	// The general case must pivot.
+	{
+		matrix5 m(0.);
+		m(0, 1) = m(1, 0) = m(2, 2) = m(3, 4) = m(4, 3) = 2;
+		assert(m.det() == 2 * 2 * 2 * 2 * 2);
+		assert(is_close(m.inverse(), m / 4.));
+	}
+
+	// Same format as the dynamic matrix.
+	{
+		const matrix4 m = make<4>();
+		std::ostringstream f, d;
+
+		f << m;
+		d << matrix<double>(m);
+
+		assert(f.str() == d.str());
+	}
+
+	// Rotation of a quarter turn around z.
+	{
+		matrix3 m(0.);
+		m(0, 1) = -1;
+		m(1, 0) = 1;
+		m(2, 2) = 1;
+
+		const jfcpp::math::quaternion<double>
+			q = jfcpp::math::quaternion_from_rotation(m),
+			r = jfcpp::math::quaternion_from_rotation(matrix<double>(m));
+
+		assert(q == r);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+// GMP must be included first, to enable the specializations of
+// “math/gmp.hpp”.
+#include <gmpxx.h>
+
+#include <jfcpp/math.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/matrix/bareiss.hpp>
+#include <jfcpp/matrix/modular.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::bareiss;
+using jfcpp::det_modular;
+using jfcpp::matrix;
+using jfcpp::thread_pool;
+
+namespace math = jfcpp::math;
+
+int main()
+{
+	// Residues, in [0, n) even for negative numbers.
+	{
+		assert(math::mod<mpz_class>(mpz_class(17), 5) == 2);
+		assert(math::mod<mpz_class>(mpz_class(-7), 5) == 3);
+
+		const mpz_class big = (mpz_class(1) << 100) + 3;
+		assert(math::mod<mpz_class>(big, 1000003)
+		       == mpz_class(big % 1000003).get_ui());
+		assert(math::mod<mpz_class>(-big, 1000003)
+		       == 1000003 - mpz_class(big % 1000003).get_ui());
+	}
+
+	// A determinant which does not fit in a machine integer: A = L × U
+	// where L has a unit diagonal, so det(A) is the product of the diagonal
+	// of U.
+	{
+		const size_t n = 12;
+
+		matrix<mpz_class> l(n, n, mpz_class(0)), u(n, n, mpz_class(0));
+		mpz_class expected(1);
+		for (size_t i = 0; i < n; ++i)
+		{
+			l(i, i) = 1;
+			u(i, i) = mpz_class(1000000007) + mpz_class(i) * 1000;
+			expected *= u(i, i);
+			for (size_t j = 0; j < i; ++j)
+			{
+				l(i, j) = long(rand() % 21) - 10;
+				u(j, i) = long(rand() % 2001) - 1000;
+			}
+		}
+		matrix<mpz_class> a = l.mprod(u);
+
+		const bareiss<mpz_class> f(a);
+		assert(!f.is_singular());
+		assert(f.det() == expected);
+		assert(a.det() == expected);
+		assert(det_modular(a) == expected);
+
+		thread_pool pool(4);
+		a.swap_rows(0, 1);
+		assert(det_modular(a, pool) == -expected);
+
+		// d × X has integer values.
+		matrix<mpz_class> x(n, 2), b;
+		for (size_t i = 0; i < x.size(); ++i)
+		{
+			x(i) = long(rand() % 21) - 10;
+		}
+		b = a.mprod(x);
+		a.solve(b);
+		assert(b == x);
+	}
+
+	// Singular matrix.
+	{
+		matrix<mpz_class> a(3, 3, mpz_class(2));
+
+		assert(bareiss<mpz_class>(a).is_singular());
+		assert(det_modular(a) == 0);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/iterative.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/sparse_matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::identity_preconditioner;
+using jfcpp::ilu0_preconditioner;
+using jfcpp::iterative_parameters;
+using jfcpp::iterative_statistics;
+using jfcpp::jacobi_preconditioner;
+using jfcpp::matrix;
+using jfcpp::sparse_builder;
+using jfcpp::sparse_matrix;
+using jfcpp::thread_pool;
+
+typedef iterative_statistics<double> statistics;
+
+/**
+ * Finite differences of “-Δu + c ∂u/∂x” on a n × n grid (upwind scheme),
+ * symmetric if c is 0.
+ */
+sparse_matrix<double>
+make(size_t n, double c)
+{
+	sparse_builder<double> builder(n * n, n * n);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < n; ++j)
+		{
+			const size_t k = i * n + j;
+
+			builder.add(k, k, 4 + c);
+			if (j > 0) builder.add(k, k - 1, -1 - c);
+			if (j + 1 < n) builder.add(k, k + 1, -1);
+			if (i > 0) builder.add(k, k - n, -1);
+			if (i + 1 < n) builder.add(k, k + n, -1);
+		}
+	}
+
+	return sparse_matrix<double>(builder);
+}
+
+/**
+ * ‖b - A × x‖ / ‖b‖.
+ */
+double
+residual(const sparse_matrix<double> &a, const std::vector<double> &b,
+         const std::vector<double> &x)
+{
+	std::vector<double> r(b.size());
+
+	a.mprod(&x[0], &r[0]);
+
+	double nr = 0, nb = 0;
+	for (size_t i = 0; i < b.size(); ++i)
+	{
+		nr += (b[i] - r[i]) * (b[i] - r[i]);
+		nb += b[i] * b[i];
+	}
+
+	return std::sqrt(nr / nb);
+}
+
+/**
+ * Checks the statistics and the solution.
+ */
+void
+check(const statistics &s, const sparse_matrix<double> &a,
+      const std::vector<double> &b, const std::vector<double> &x,
+      const iterative_parameters<double> &p)
+{
+	assert(s.converged);
+	assert(s.iterations > 0);
+	assert(s.residuals.size() > 1);
+	assert(s.residuals.front() == 1);
+	assert(s.residuals.back() <= p.tolerance);
+	assert(residual(a, b, x) <= 10 * p.tolerance);
+}
+
+int main()
+{
+	const size_t n = 24, size = n * n;
+
+	iterative_parameters<double> p;
+	p.tolerance = 1e-10;
+
+	std::vector<double> b(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		b[i] = double(rand() % 19) - 9;
+	}
+
+	thread_pool pool(4);
+
+	// Symmetric positive definite: conjugate gradient.
+	{
+		const sparse_matrix<double> a = make(n, 0);
+
+		std::vector<double> x(size, 0.);
+		const statistics s1 = jfcpp::conjugate_gradient(
+			a, identity_preconditioner<double>(size), &b[0], &x[0], p);
+		check(s1, a, b, x, p);
+		assert(s1.residuals.size() == s1.iterations + 1);
+
+		std::fill(x.begin(), x.end(), 0.);
+		const statistics s2 = jfcpp::conjugate_gradient(
+			a, ilu0_preconditioner<double>(a), &b[0], &x[0], p, pool);
+		check(s2, a, b, x, p);
+		assert(s2.iterations < s1.iterations);
+
+		// Same system with a dense matrix.
+		const matrix<double> d(a);
+
+		std::fill(x.begin(), x.end(), 0.);
+		const statistics s3 = jfcpp::conjugate_gradient(
+			d, jacobi_preconditioner<double>(d), &b[0], &x[0], p, pool);
+		check(s3, a, b, x, p);
+
+		// Starts from the solution.
+		const statistics s4 = jfcpp::conjugate_gradient(
+			a, jacobi_preconditioner<double>(a), &b[0], &x[0], p);
+		assert(s4.converged);
+		assert(s4.iterations == 0);
+
+		// The right-hand side zero gives the solution zero.
+		const std::vector<double> zero(size, 0.);
+		const statistics s5 = jfcpp::conjugate_gradient(
+			a, jacobi_preconditioner<double>(a), &zero[0], &x[0], p);
+		assert(s5.converged);
+		assert(x == zero);
+	}
+
+	// Non-symmetric: BiCGSTAB and GMRES.
+	{
+		const sparse_matrix<double> a = make(n, 2);
+		const ilu0_preconditioner<double> ilu(a);
+
+		std::vector<double> x(size, 0.);
+		check(jfcpp::bicgstab(a, jacobi_preconditioner<double>(a), &b[0],
+		                      &x[0], p), a, b, x, p);
+
+		std::fill(x.begin(), x.end(), 0.);
+		check(jfcpp::bicgstab(a, ilu, &b[0], &x[0], p, pool), a, b, x, p);
+
+		std::fill(x.begin(), x.end(), 0.);
+		const statistics s1 = jfcpp::gmres(
+			a, identity_preconditioner<double>(size), &b[0], &x[0], p);
+		check(s1, a, b, x, p);
+
+		std::fill(x.begin(), x.end(), 0.);
+		const statistics s2 = jfcpp::gmres(a, ilu, &b[0], &x[0], p, pool);
+		check(s2, a, b, x, p);
+		assert(s2.iterations < s1.iterations);
+
+		// Restarts often.
+		p.restart = 5;
+		std::fill(x.begin(), x.end(), 0.);
+		check(jfcpp::gmres(a, ilu, &b[0], &x[0], p), a, b, x, p);
+
+		// Stops at the maximum number of iterations.
+		p.max_iterations = 3;
+		std::fill(x.begin(), x.end(), 0.);
+		const statistics s3 = jfcpp::gmres(
+			a, identity_preconditioner<double>(size), &b[0], &x[0], p);
+		assert(!s3.converged);
+		assert(s3.iterations == 3);
+	}
+
+	// BiCGSTAB breakdown: r0 is orthogonal to A × r0 for a rotation, the
+	// iteration stops without dividing by zero.
+	{
+		matrix<double> a(2, 2, 0.);
+		a(0, 1) = 1;
+		a(1, 0) = -1;
+
+		const double r[] = {1, 0};
+		std::vector<double> x(2, 0.);
+		const statistics s = jfcpp::bicgstab(
+			a, identity_preconditioner<double>(2), r, &x[0], p);
+		assert(!s.converged);
+		assert((x[0] == 0) && (x[1] == 0));
+	}
+
+	// A NaN residual has not converged and stops the iteration.
+	{
+		const matrix<double> a = matrix<double>::identity(2);
+		const identity_preconditioner<double> m(2);
+
+		const double r[] = {1, std::numeric_limits<double>::quiet_NaN()};
+		std::vector<double> x(2, 0.);
+
+		const statistics s1 = jfcpp::conjugate_gradient(a, m, r, &x[0], p);
+		assert(!s1.converged);
+		assert(s1.iterations <= 1);
+
+		x.assign(2, 0.);
+		const statistics s2 = jfcpp::bicgstab(a, m, r, &x[0], p);
+		assert(!s2.converged);
+		assert(s2.iterations <= 1);
+
+		x.assign(2, 0.);
+		const statistics s3 = jfcpp::gmres(a, m, r, &x[0], p);
+		assert(!s3.converged);
+		assert(s3.iterations <= 1);
+	}
+
+	// ILU(0) of a matrix without fill-in is its LU decomposition.
+	{
+		matrix<double> d(3, 3, 0.);
+		d(0, 0) = 4; d(0, 1) = 1;
+		d(1, 0) = 2; d(1, 1) = 5; d(1, 2) = 1;
+		d(2, 1) = 3; d(2, 2) = 6;
+
+		const ilu0_preconditioner<double> ilu(d);
+
+		const double r[] = {1, 2, 3};
+		double z[3];
+		ilu.apply(r, z);
+
+		matrix<double> expected(3, 1);
+		expected(0) = 1;
+		expected(1) = 2;
+		expected(2) = 3;
+		d.solve(expected);
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			assert(std::fabs(z[i] - expected(i)) < 1e-12);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
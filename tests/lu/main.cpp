@@ -0,0 +1,244 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/lu.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#include <contracts.h>
+
+#include <jfcpp/math/rational.hpp>
+
+#include "../matrix_checks.hpp"
+
+using jfcpp::aligned_allocator;
+using jfcpp::column_major;
+using jfcpp::lu;
+using jfcpp::matrix;
+using jfcpp::thread_pool;
+using jfcpp::math::rational;
+
+int main()
+{
+	// A null first pivot (the previous implementation divided by 0).
+	{
+		matrix<double> a(3, 3, 0.);
+		a(0, 1) = 2; a(0, 2) = 1;
+		a(1, 0) = 1; a(1, 1) = 1; a(1, 2) = 1;
+		a(2, 0) = 4; a(2, 1) = 1; a(2, 2) = 3;
+
+		const lu<double> f(a);
+
+		assert(!f.is_singular());
+		assert(f.dimension() == 3);
+		assert(std::fabs(f.det() - a.det()) < 1e-12);
+
+		assert(is_close(a.mprod(f.inverse()), matrix<double>::identity(3)));
+		assert(is_close(a.inverse().mprod(a), matrix<double>::identity(3)));
+
+		// Several right-hand sides.
+		matrix<double> x(3, 4), b;
+		for (size_t i = 0; i < x.size(); ++i)
+		{
+			x(i) = double(rand() % 21) - 10;
+		}
+		b = a.mprod(x);
+		f.solve(b);
+		assert(is_close(b, x));
+
+		b = a.mprod(x);
+		a.solve(b);
+		assert(is_close(b, x));
+
+		// In-place variant.
+		matrix<double> c(a);
+		b = a.mprod(x);
+		c.solve_perf(b);
+		assert(is_close(b, x));
+		assert(c.size() == 0);
+	}
+
+	// Larger random matrix.
+	{
+		const size_t n = 57;
+
+		matrix<double> a(n, n);
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			a(i) = double(rand() % 2001) / 100 - 10;
+		}
+
+		lu<double> f;
+		f.factorize(a);
+
+		// L × U = P × A.
+		const matrix<double> &packed = f.factors();
+		matrix<double> l(n, n, 0.), u(n, n, 0.), pa(a);
+		for (size_t i = 0; i < n; ++i)
+		{
+			l(i, i) = 1;
+			for (size_t j = 0; j < n; ++j)
+			{
+				(j < i ? l(i, j) : u(i, j)) = packed(i, j);
+			}
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			if (f.pivots()[i] != i)
+			{
+				pa.swap_rows(i, f.pivots()[i]);
+			}
+		}
+		assert(is_close(l.mprod(u), pa));
+
+		assert(is_close(a.mprod(f.inverse()), matrix<double>::identity(n)));
+
+		// Factorizing without copy.
+		matrix<double> c(a);
+		f.factorize_perf(c);
+		assert(c.size() == 0);
+		assert(is_close(f.inverse().mprod(a), matrix<double>::identity(n)));
+	}
+
+	// Several blocks, in parallel.
+	{
+		const size_t n = 300;
+
+		matrix<double> a(n, n);
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			a(i) = double(rand() % 2001) / 100 - 10;
+		}
+
+		thread_pool pool(4);
+
+		const lu<double> f(a, pool), g(a);
+		assert(f.pivots() == g.pivots());
+		assert(is_close(f.factors(), g.factors()));
+
+		matrix<double> x(n, 3), b;
+		for (size_t i = 0; i < x.size(); ++i)
+		{
+			x(i) = double(rand() % 21) - 10;
+		}
+		b = a.mprod(x);
+		f.solve(b, pool);
+		assert(is_close(b, x));
+
+		assert(is_close(a.mprod(a.inverse(pool)), matrix<double>::identity(n)));
+	}
+
+	// Determinant of any dimension.
+	{
+		// Rows of a triangular matrix in an odd order.
+		matrix<double> a(5, 5, 0.);
+		const size_t order[] = {3, 0, 4, 1, 2};
+		for (size_t i = 0; i < 5; ++i)
+		{
+			for (size_t j = order[i]; j < 5; ++j)
+			{
+				a(i, j) = double(j + 1);
+			}
+		}
+		assert(std::fabs(a.det() - (-120)) < 1e-9);
+
+		int sign;
+		assert(std::fabs(a.log_det(sign) - std::log(120.)) < 1e-12);
+		assert(sign == -1);
+
+		assert(matrix<double>(0, 0).det() == 1);
+
+		// The determinant overflows but not its logarithm.
+		matrix<double> b = matrix<double>::identity(400, 0, 10);
+		b.swap_rows(0, 1);
+		assert(b.det() == -std::numeric_limits<double>::infinity());
+		assert(std::fabs(b.log_det(sign) - 400 * std::log(10.)) < 1e-9);
+		assert(sign == -1);
+
+		matrix<double> c(4, 4, 1.);
+		assert(c.det() == 0);
+		assert(c.log_det(sign) == -std::numeric_limits<double>::infinity());
+		assert(sign == 0);
+	}
+
+	// Singular matrix.
+	{
+		matrix<double> a(3, 3, 1.);
+
+		const lu<double> f(a);
+
+		assert(f.is_singular());
+		assert(f.det() == 0);
+		assert_exception(f.inverse(), std::runtime_error);
+		assert_exception(a.inverse(), std::runtime_error);
+	}
+
+	// A column-major matrix is decomposed in its layout (blocked panels
+	// included) and gives the same factors.
+	{
+		typedef matrix<double, aligned_allocator<double>, column_major> cm;
+
+		const size_t n = 200;
+		matrix<double> a(n, n), b(n, 3);
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			a(i) = double(rand() % 2001) / 100 - 10;
+		}
+		for (size_t i = 0; i < b.size(); ++i)
+		{
+			b(i) = double(rand() % 21) - 10;
+		}
+
+		const lu<double> f(a);
+		const lu<double, aligned_allocator<double>, column_major> g((cm(a)));
+		assert(is_close(matrix<double>(g.factors()), f.factors()));
+		assert(g.pivots() == f.pivots());
+
+		// Right-hand sides of both layouts, solved in place.
+		matrix<double> x(b), y(b);
+		cm z(b);
+		f.solve(x);
+		g.solve(y);
+		g.solve(z);
+		assert(is_close(y, x));
+		assert(is_close(matrix<double>(z), x));
+
+		cm c(a);
+		int sign, c_sign;
+		const double log_det = a.log_det(sign);
+		assert(std::fabs(c.log_det(c_sign) - log_det)
+		       <= 1e-9 * std::fabs(log_det));
+		assert(c_sign == sign);
+		assert(is_close(matrix<double>(c.inverse()), a.inverse()));
+		z = b;
+		c.solve(z);
+		assert(is_close(matrix<double>(z), x));
+	}
+
+	// Exact types: the result is exact.
+	{
+		typedef rational<long> q;
+
+		matrix<q> a(3, 3);
+		a(0, 0) = q(0); a(0, 1) = q(1, 2); a(0, 2) = q(3);
+		a(1, 0) = q(2); a(1, 1) = q(1);    a(1, 2) = q(-1);
+		a(2, 0) = q(1); a(2, 1) = q(1, 3); a(2, 2) = q(2);
+
+		const lu<q> f(a);
+
+		assert(is_equal(f.det(), a.det()));
+
+		const matrix<q> p(a.mprod(f.inverse()));
+		for (size_t i = 0; i < 3; ++i)
+		{
+			for (size_t j = 0; j < 3; ++j)
+			{
+				assert(is_equal(p(i, j), q(i == j ? 1 : 0)));
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/mapped_matrix.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+
+using jfcpp::column_major;
+using jfcpp::mapped_matrix;
+using jfcpp::mapping;
+using jfcpp::matrix;
+
+const char *const path = "mapped_matrix.tmp";
+
+/**
+ * Whether opening the file as a mapped_matrix<T, Layout> fails.
+ */
+template <typename T, class Layout>
+bool
+is_rejected()
+{
+	try
+	{
+		const mapped_matrix<T, Layout> m(path);
+	}
+	catch (const std::runtime_error &)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+int main()
+{
+	// Creation and reopening.
+	{
+		{
+			mapped_matrix<double> m(path, 3, 4);
+			assert(m.rows() == 3);
+			assert(m.columns() == 4);
+			assert(m.is_writable());
+
+			// A new matrix is filled with zeros.
+			assert(m(2, 3) == 0.);
+
+			for (size_t i = 0; i < 3; ++i)
+			{
+				for (size_t j = 0; j < 4; ++j)
+				{
+					m(i, j) = double(10 * i + j);
+				}
+			}
+
+			m.flush();
+		}
+
+		const mapped_matrix<double> m(path);
+		assert(!m.is_writable());
+		assert(m.rows() == 3);
+		assert(m.columns() == 4);
+		assert(m(2, 1) == 21.);
+		assert(m.data()[4] == 10.);
+
+		// Loading it in memory.
+		const matrix<double> loaded(m.view());
+		assert(loaded(1, 3) == 13.);
+		assert(m.block(1, 1, 2, 2)(1, 0) == 21.);
+
+		// The header is checked.
+		assert((is_rejected<float, jfcpp::row_major>()));
+		assert((is_rejected<long, jfcpp::row_major>()));
+		assert((is_rejected<double, column_major>()));
+		assert((!is_rejected<double, jfcpp::row_major>()));
+	}
+
+	// Modification through views.
+	{
+		{
+			mapped_matrix<double> m(path, mapping::read_write);
+			m.view() *= 2.;
+			m.block(0, 0, 1, 4) = 1.;
+		}
+
+		const mapped_matrix<double> m(path);
+		assert(m(0, 3) == 1.);
+		assert(m(2, 3) == 46.);
+	}
+
+	// A read-only mapping held by a non-const object: the const views
+	// work, the mutable accessors throw.
+	{
+		mapped_matrix<double> m(path);
+		assert(!m.is_writable());
+		assert(m.const_view()(2, 3) == 46.);
+		assert(m.const_block(1, 1, 2, 2)(1, 0) == 42.);
+
+		bool thrown = false;
+		try
+		{
+			m.block(0, 0, 1, 1);
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+
+		thrown = false;
+		try
+		{
+			m(0, 0) = 2.;
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	// Column-major storage.
+	{
+		{
+			mapped_matrix<int, column_major> m(path, 2, 3);
+			m(1, 0) = 7;
+			m(0, 2) = 5;
+		}
+
+		const mapped_matrix<int, column_major> m(path);
+		assert(m.data()[1] == 7);
+		assert(m.data()[4] == 5);
+		assert(m.view().row_stride() == 1);
+		assert(m.view()(0, 2) == 5);
+	}
+
+	// Streaming a product by panels of rows.
+	{
+		const size_t n = 300, k = 40, panel = 64;
+
+		matrix<double> b(k, k);
+		for (size_t i = 0; i < b.size(); ++i)
+		{
+			b(i) = double(i % 7) - 3;
+		}
+
+		mapped_matrix<double> a(path, n, k);
+		for (size_t i = 0; i < n; ++i)
+		{
+			for (size_t j = 0; j < k; ++j)
+			{
+				a(i, j) = double((i + 2 * j) % 5);
+			}
+		}
+
+		matrix<double> c(n, k);
+		for (size_t i = 0; i < n; i += panel)
+		{
+			const size_t rows = std::min(panel, n - i);
+
+			a.prefetch(i, 0, rows, k);
+			c.block(i, 0, rows, k).gemm(1., a.block(i, 0, rows, k), b.view(),
+			                            0.);
+			a.release(i, 0, rows, k);
+		}
+
+		assert(c == matrix<double>(a.view()).mprod(b));
+
+		// Released pages are read again.
+		assert(a(n - 1, k - 1) == double((n - 1 + 2 * (k - 1)) % 5));
+	}
+
+	// Errors.
+	{
+		bool thrown = false;
+		try
+		{
+			const mapped_matrix<double> m("no/such/directory/matrix");
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+
+		// Truncated file.
+		{
+			const mapped_matrix<double> m(path, 10, 10);
+		}
+		assert(::truncate(path, 100) == 0);
+		assert((is_rejected<double, jfcpp::row_major>()));
+
+		// Dimensions whose product overflows.
+		{
+			mapped_matrix<double> m(path, 2, 2);
+			reinterpret_cast<jfcpp::binary::details::header *>(
+				reinterpret_cast<char *>(m.data())
+				- sizeof(jfcpp::binary::details::header))->rows =
+				uint64_t(1) << 62;
+		}
+		assert((is_rejected<double, jfcpp::row_major>()));
+
+		thrown = false;
+		try
+		{
+			const mapped_matrix<double> m(path, size_t(1) << 62, 4);
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	std::remove(path);
+
+	return 0;
+}
@@ -4,7 +4,9 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <memory>
 #include <stdexcept>
+#include <utility>
 
 #include <contracts.h>
 
@@ -29,6 +31,37 @@ struct RandomGenerator
 	}
 };
 
+/**
+ * Counts the allocations.
+ */
+template <typename T>
+struct counting_allocator : public jfcpp::aligned_allocator<T>
+{
+	static size_t allocations;
+
+	T *
+	allocate(size_t n)
+	{
+		++allocations;
+		return jfcpp::aligned_allocator<T>::allocate(n);
+	}
+};
+
+template <typename T>
+size_t counting_allocator<T>::allocations = 0;
+
+/**
+ * An allocator with a state, which must follow the matrices.
+ */
+template <typename T>
+struct tagged_allocator : public jfcpp::aligned_allocator<T>
+{
+	explicit tagged_allocator(int t = 0) : tag(t)
+	{}
+
+	int tag;
+};
+
 #include <iostream>
 
 int main()
@@ -317,6 +350,184 @@ int main()
 		}
 	}
 
+	// Expressions.
+	{
+		matrix<int> a(4, 7), b(4, 7), c(4, 7);
+
+		RandomGenerator::fill(a);
+		RandomGenerator::fill(b);
+		RandomGenerator::fill(c);
+
+		const matrix<int> r(a + b - c * 2 + 3 * a / 2 % 5);
+
+		for (size_t i = 0; i < r.size(); ++i)
+		{
+			assert(r(i) == a(i) + b(i) - c(i) * 2 + a(i) * 3 / 2 % 5);
+		}
+		assert(r == a + b - c * 2 + 3 * a / 2 % 5);
+		assert((a + b - c * 2 + 3 * a / 2 % 5) == r);
+		assert(r != a + b);
+
+		// Compound assignments.
+		matrix<int> s(a);
+		s += b - c;
+		s -= a;
+		assert(s == b - c);
+
+		// Mixed types: the type of the result is the one of the left operand.
+		assert((a * 0.5) == a / 2);
+		const matrix<double> h(matrix<double>(a) * 0.5 + a);
+		for (size_t i = 0; i < h.size(); ++i)
+		{
+			assert(h(i) == a(i) * 1.5);
+		}
+
+		// Aliasing.
+		{
+			matrix<int> t(a);
+			t = t + t * 2;
+			assert(t == a * 3);
+
+			// Non-square transpose.
+			t = t.transposed();
+			assert(t.rows() == a.columns());
+			assert(t == (a * 3).transposed());
+
+			t = t.transposed() + t.transposed();
+			assert(t == a * 6);
+
+			matrix<int> q(5);
+			RandomGenerator::fill(q);
+			const matrix<int> q0(q);
+
+			q = q.transposed() + q;
+			for (size_t i = 0; i < q.rows(); ++i)
+			{
+				for (size_t j = 0; j < q.columns(); ++j)
+				{
+					assert(q(i, j) == q0(j, i) + q0(i, j));
+				}
+			}
+
+			q -= q.transposed();
+			assert(q == matrix<int>(5, 5, 0));
+		}
+
+		// “transpose()” gives a matrix.
+		{
+			const matrix<int> b = a * 2;
+
+			const matrix<int> p = a.mprod(b.transpose());
+			assert(p.rows() == a.rows());
+			assert(p.columns() == a.rows());
+			for (size_t i = 0; i < p.rows(); ++i)
+			{
+				for (size_t j = 0; j < p.columns(); ++j)
+				{
+					int sum = 0;
+					for (size_t k = 0; k < a.columns(); ++k)
+					{
+						sum += a(i, k) * b(j, k);
+					}
+					assert(p(i, j) == sum);
+				}
+			}
+
+			const matrix<int> r = a.transpose().mprod(b);
+			assert(r.rows() == a.columns());
+			assert(r.columns() == a.columns());
+			assert(r(2, 5) == a(0, 2) * b(0, 5) + a(1, 2) * b(1, 5)
+			       + a(2, 2) * b(2, 5) + a(3, 2) * b(3, 5));
+			assert(!a.transpose().is_square());
+			assert(p.transpose().is_square());
+
+			matrix<double> d(3);
+			d(0, 0) = 2; d(0, 1) = 1; d(0, 2) = 0;
+			d(1, 0) = 4; d(1, 1) = 3; d(1, 2) = 1;
+			d(2, 0) = 0; d(2, 1) = 5; d(2, 2) = 7;
+			assert(d.transpose().det() == d.det());
+		}
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+		// Move semantics: the storage of a temporary left operand is reused.
+		{
+			matrix<int> t(a);
+			const int *p = t.begin();
+
+			matrix<int> u(std::move(t) + b - c * 2);
+			assert(t.size() == 0);
+			assert(u.begin() == p);
+			assert(u == a + b - c * 2);
+
+			u = 2 * std::move(u) - a;
+			assert(u.begin() == p);
+			assert(u == a + b * 2 - c * 4);
+
+			t = std::move(u);
+			assert(t.begin() == p);
+			assert(u.size() == 0);
+		}
+#endif
+	}
+
+	// Storage.
+	{
+		matrix<double> a(3, 5, 1.);
+
+		assert(reinterpret_cast<size_t>(a.begin()) % 64 == 0);
+		assert(a.end() == a.begin() + 15);
+		assert(&a(2, 1) == a.begin() + 11);
+
+		typedef matrix<int, counting_allocator<int> > counted;
+
+		counted b(4, 6, 1), c(b);
+		assert(counting_allocator<int>::allocations == 2);
+
+		c = b + b;
+		assert(counting_allocator<int>::allocations == 2);
+
+		// Same size: the storage is reused.
+		c.resize(6, 4);
+		assert(counting_allocator<int>::allocations == 2);
+
+		c.resize(5, 5);
+		assert(counting_allocator<int>::allocations == 3);
+
+		counted d(0, 0);
+		assert(d.begin() == d.end());
+		assert(counting_allocator<int>::allocations == 3);
+
+		// Other allocators can be mixed.
+		assert(matrix<int>(b) == b);
+		typedef matrix<double, std::allocator<double> > standard;
+		assert((a * 2) == standard(3, 5, 2.));
+
+		// The results keep the allocator of their (left) operand.
+		typedef matrix<double, tagged_allocator<double> > tagged;
+		typedef matrix<double, tagged_allocator<double>, jfcpp::column_major>
+			tagged_columns;
+
+		const tagged e(3, 3, 1., tagged_allocator<double>(7));
+		const tagged f(3, 2, 2., tagged_allocator<double>(8));
+
+		assert(e.mprod(f).get_allocator().tag == 7);
+		assert(e.mprod(f, 2).get_allocator().tag == 7);
+		assert(f.transpose().mprod(e).get_allocator().tag == 8);
+		assert(tagged(e + e * 2).get_allocator().tag == 7);
+		assert(tagged(f.transposed()).get_allocator().tag == 8);
+		assert(tagged_columns(e).get_allocator().tag == 7);
+		assert(tagged(a).get_allocator().tag == 0);
+		assert((-e).get_allocator().tag == 7);
+
+		// Assigning keeps the allocator of the target.
+		tagged g(3, 3, 0., tagged_allocator<double>(9));
+		g = e + e;
+		assert(g.get_allocator().tag == 9);
+		g = g.transposed() + e;
+		assert(g.get_allocator().tag == 9);
+		assert(g == e * 3);
+	}
+
 	// Test on a square matrix.
 	{
 		matrix<int> m(10);
@@ -333,6 +544,19 @@ int main()
 			matrix<int> p(m.mprod(m));
 
 			assert(p.has_same_dimensions(m));
+
+			for (size_t i = 0; i < m.rows(); ++i)
+			{
+				for (size_t j = 0; j < m.columns(); ++j)
+				{
+					int tmp = 0;
+					for (size_t k = 0; k < m.columns(); ++k)
+					{
+						tmp += m(i, k) * m(k, j);
+					}
+					assert(p(i, j) == tmp);
+				}
+			}
 		}
 
 		// Trace
@@ -348,5 +572,118 @@ int main()
 		}
 	}
 
+	// Blocked matrix product: the dimensions are chosen to cross the blocking
+	// boundaries and to be multiple of nothing.
+	{
+		matrix<double> a(131, 263), b(263, 75);
+
+		RandomGenerator::fill(a);
+		RandomGenerator::fill(b);
+
+		const matrix<double> p(a.mprod(b));
+
+		assert(p.rows() == a.rows());
+		assert(p.columns() == b.columns());
+
+		for (size_t i = 0; i < p.rows(); ++i)
+		{
+			for (size_t j = 0; j < p.columns(); ++j)
+			{
+				double tmp = 0;
+				for (size_t k = 0; k < a.columns(); ++k)
+				{
+					tmp += a(i, k) * b(k, j);
+				}
+				assert(p(i, j) == tmp); // Exact because values are integers.
+			}
+		}
+
+		// Parallel product (with more threads than processors to force the
+		// work-stealing).
+		{
+			jfcpp::thread_pool pool(4);
+
+			assert(a.mprod(b, pool) == p);
+			assert(a.mprod(b, 3) == p);
+			assert(a.mprod(b, 1) == p);
+
+			matrix<int> ai(a), bi(b);
+			assert(ai.mprod(bi, pool) == matrix<int>(p));
+		}
+
+		// Element-wise operations (SIMD kernels for “double”).
+		{
+			matrix<double> c(a), d(a);
+
+			RandomGenerator::fill(d);
+
+			c += d;
+			c *= 2;
+			c -= d;
+			c /= 4.;
+
+			for (size_t i = 0; i < a.size(); ++i)
+			{
+				assert(c(i) == (((a(i) + d(i)) * 2) - d(i)) / 4);
+			}
+
+			c *= d;
+			c /= d;
+			c += 1.5;
+			c -= 1.5;
+			assert(c == (a + a + d) / 4);
+		}
+
+		// Inner dimension of zero.
+		const matrix<double> z(matrix<double>(3, 0).mprod(matrix<double>(0, 4)));
+		assert(z == matrix<double>(3, 4, 0));
+	}
+
+	// Transposition: sizes around the tiles and the SIMD blocks.
+	{
+		const size_t sizes[][2] = {
+			{1, 1}, {1, 70}, {3, 70}, {70, 3}, {33, 33}, {67, 129}, {128, 128},
+			{200, 201}
+		};
+
+		for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k)
+		{
+			const size_t rows = sizes[k][0], columns = sizes[k][1];
+
+			matrix<double> a(rows, columns);
+			matrix<float> b(rows, columns);
+			matrix<int> c(rows, columns);
+			for (size_t i = 0; i < a.size(); ++i)
+			{
+				a(i) = double(i);
+				b(i) = float(i);
+				c(i) = int(i);
+			}
+
+			const matrix<double> ta(a.transpose());
+			const matrix<float> tb(b.transpose());
+			const matrix<int> tc(c.transpose());
+
+			assert(ta.rows() == columns && ta.columns() == rows);
+			for (size_t i = 0; i < rows; ++i)
+			{
+				for (size_t j = 0; j < columns; ++j)
+				{
+					assert(ta(j, i) == a(i, j));
+					assert(tb(j, i) == b(i, j));
+					assert(tc(j, i) == c(i, j));
+				}
+			}
+
+			// In place, square or not.
+			matrix<double> d(a);
+			d.transpose_in_place();
+			assert(d == ta);
+
+			c.transpose_in_place();
+			assert(c == tc);
+		}
+	}
+
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,186 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix_batch.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+#include <jfcpp/fixed_matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::fixed_matrix;
+using jfcpp::matrix_batch;
+using jfcpp::thread_pool;
+
+/**
+ * Whether two matrices are equal up to a relative error.
+ */
+template <typename T, size_t R, size_t C>
+bool
+is_close(const fixed_matrix<T, R, C> &a, const fixed_matrix<T, R, C> &b,
+         T tolerance)
+{
+	for (size_t i = 0; i < R * C; ++i)
+	{
+		if (std::fabs(a(i) - b(i)) > tolerance * (1 + std::fabs(b(i))))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * A batch of n random matrices, diagonally dominant so that they are well
+ * conditioned.
+ */
+template <typename T, size_t R, size_t C>
+matrix_batch<T, R, C>
+make(size_t n)
+{
+	matrix_batch<T, R, C> batch(n);
+
+	for (size_t b = 0; b < n; ++b)
+	{
+		for (size_t i = 0; i < R; ++i)
+		{
+			for (size_t j = 0; j < C; ++j)
+			{
+				batch(b, i, j) = T(rand() % 2001) / 1000 - 1 + (i == j ? 4 : 0);
+			}
+		}
+	}
+
+	return batch;
+}
+
+/**
+ * Compares the batch operations with the ones of “fixed_matrix”.
+ */
+template <typename T, size_t N>
+void
+test(T tolerance)
+{
+	// Not a whole number of blocks.
+	const size_t n = 1000 + 7;
+	const matrix_batch<T, N> a = make<T, N, N>(n);
+	const matrix_batch<T, N, 2> b = make<T, N, 2>(n);
+
+	assert(a.size() == n);
+	assert(a.rows() == N);
+	assert(a.columns() == N);
+
+	const std::vector<T> dets = a.det();
+	const matrix_batch<T, N> inverses = a.inverse();
+	const matrix_batch<T, N, 2> products = a.mprod(b);
+	matrix_batch<T, N, 2> x(b);
+	a.solve(x);
+
+	assert(dets.size() == n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		const fixed_matrix<T, N> m = a.get(i);
+
+		assert(std::fabs(dets[i] - m.det()) <= tolerance * std::fabs(m.det()));
+		assert(is_close(inverses.get(i), m.inverse(), tolerance));
+		assert(is_close(products.get(i), m.mprod(b.get(i)), tolerance));
+		assert(is_close(m.mprod(x.get(i)), b.get(i), 10 * tolerance));
+	}
+
+	// In parallel (enough blocks for several slices).
+	thread_pool pool(3);
+
+	const matrix_batch<T, N> big = make<T, N, N>(20000);
+	const matrix_batch<T, N> big_inverses = big.inverse(pool);
+	const std::vector<T> big_dets = big.det(pool);
+	const matrix_batch<T, N> identities = big.mprod(big_inverses, pool);
+
+	matrix_batch<T, N> y(big);
+	big.solve(y, pool);
+
+	matrix_batch<T, N> z(big);
+	const matrix_batch<T, N> in_place = z.inverse_perf(pool);
+	assert(z.size() == 0);
+	assert(in_place.size() == big.size());
+	for (size_t i = 0; i < big.size(); i += 97)
+	{
+		const fixed_matrix<T, N> id = fixed_matrix<T, N>::identity();
+
+		assert(std::fabs(big_dets[i] - big.get(i).det())
+		       <= tolerance * std::fabs(big_dets[i]));
+		assert(is_close(identities.get(i), id, 10 * tolerance));
+		assert(is_close(y.get(i), id, 10 * tolerance));
+		assert(in_place.get(i) == big_inverses.get(i));
+	}
+}
+
+int main()
+{
+	test<double, 2>(1e-12);
+	test<double, 3>(1e-12);
+	test<double, 4>(1e-12);
+	test<float, 3>(1e-4f);
+	test<float, 4>(1e-4f);
+
+	// Element access, set() and get().
+	{
+		matrix_batch<double, 2, 3> batch(20, 1.);
+
+		fixed_matrix<double, 2, 3> m;
+		for (size_t i = 0; i < 6; ++i)
+		{
+			m(i) = double(i);
+		}
+
+		batch.set(17, m);
+		assert(batch.get(17) == m);
+		assert(batch(17, 1, 2) == 5);
+		assert(batch(16, 1, 2) == 1);
+		assert(batch(18, 1, 2) == 1);
+	}
+
+	// A singular matrix.
+	{
+		matrix_batch<double, 3> batch = make<double, 3, 3>(50);
+		for (size_t i = 0; i < 3; ++i)
+		{
+			for (size_t j = 0; j < 3; ++j)
+			{
+				batch(42, i, j) = double((i % 2) + j);
+			}
+		}
+		assert(batch.det()[42] == 0);
+
+		try
+		{
+			batch.inverse();
+			assert(false);
+		}
+		catch (const std::runtime_error &)
+		{}
+
+		matrix_batch<double, 3, 1> b(50);
+		try
+		{
+			batch.solve(b);
+			assert(false);
+		}
+		catch (const std::runtime_error &)
+		{}
+	}
+
+	// Empty batch.
+	{
+		const matrix_batch<double, 4> batch;
+		assert(batch.size() == 0);
+		assert(batch.det().empty());
+		assert(batch.inverse().size() == 0);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+#ifndef H_JFCPP_TESTS_MATRIX_CHECKS
+#define H_JFCPP_TESTS_MATRIX_CHECKS
+
+// Helpers shared by the tests of the decompositions.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+
+#include <jfcpp/math/rational.hpp>
+#include <jfcpp/matrix.hpp>
+
+/**
+ * A random m × n matrix, whose values are in [-10, 10].
+ */
+inline
+jfcpp::matrix<double>
+random_matrix(size_t m, size_t n)
+{
+	jfcpp::matrix<double> a(m, n);
+
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		a(i) = double(rand() % 2001) / 100 - 10;
+	}
+
+	return a;
+}
+
+/**
+ * Whether two matrices are equal up to a small relative error.
+ */
+inline
+bool
+is_close(const jfcpp::matrix<double> &a, const jfcpp::matrix<double> &b)
+{
+	if (!a.has_same_dimensions(b))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		if (std::fabs(a(i) - b(i)) > 1e-9 * (1 + std::fabs(b(i))))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Whether two matrices are equal up to an absolute error.
+ */
+inline
+bool
+is_close(const jfcpp::matrix<double> &a, const jfcpp::matrix<double> &b,
+         double tolerance)
+{
+	if (!a.has_same_dimensions(b))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		if (std::fabs(a(i) - b(i)) > tolerance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Whether two rationals are equal, “rational” does not reduce the results of
+ * its operations.
+ */
+inline
+bool
+is_equal(const jfcpp::math::rational<long> &a,
+         const jfcpp::math::rational<long> &b)
+{
+	return ((a.numerator() * b.denominator())
+	        == (b.numerator() * a.denominator()));
+}
+
+#endif // H_JFCPP_TESTS_MATRIX_CHECKS
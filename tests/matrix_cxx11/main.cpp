@@ -0,0 +1,3 @@
+// The tests of “matrix” built in C++11 (see “../GNUmakefile”), where the move
+// constructor and assignment are compiled.
+#include "../matrix/main.cpp"
@@ -0,0 +1,309 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/layout.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <sstream>
+
+#include <contracts.h>
+
+#include <jfcpp/aligned_allocator.hpp>
+#include <jfcpp/iterative.hpp>
+#include <jfcpp/math/rational.hpp>
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/sparse_matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::aligned_allocator;
+using jfcpp::column_major;
+using jfcpp::const_matrix_view;
+using jfcpp::matrix;
+using jfcpp::sparse_matrix;
+using jfcpp::thread_pool;
+using jfcpp::math::rational;
+
+/**
+ * Column-major matrix of T.
+ */
+template <typename T>
+struct cm
+{
+	typedef matrix<T, aligned_allocator<T>, column_major> type;
+};
+
+/**
+ * Fills a matrix: the element (i, j) is 10 × i + j.
+ */
+template <class M>
+M
+make(size_t rows, size_t columns)
+{
+	M m(rows, columns);
+
+	for (size_t i = 0; i < rows; ++i)
+	{
+		for (size_t j = 0; j < columns; ++j)
+		{
+			m(i, j) = typename M::value_type(10 * i + j);
+		}
+	}
+
+	return m;
+}
+
+template <class M1, class M2>
+bool
+same(const M1 &a, const M2 &b)
+{
+	if ((a.rows() != b.rows()) || (a.columns() != b.columns()))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.rows(); ++i)
+	{
+		for (size_t j = 0; j < a.columns(); ++j)
+		{
+			if (!(a(i, j) == b(i, j)))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+template <typename T>
+bool
+near(const T &a, const T &b)
+{
+	return (std::abs(a - b) <= 1e-9 * (1 + std::abs(b)));
+}
+
+int main()
+{
+	typedef cm<int>::type imatrix;
+	typedef cm<double>::type dmatrix;
+	typedef cm<rational<long> >::type qmatrix;
+
+	// Storage order.
+	{
+		const imatrix m = make<imatrix>(3, 4);
+
+		assert(m(2, 1) == 21);
+		assert(m(1) == 10);   // (1, 0)
+		assert(m(3) == 1);    // (0, 1)
+		assert(*(m.end() - 1) == 23);
+
+		// The column iterator walks the storage.
+		int expected = 0;
+		for (imatrix::const_column_iterator it = m.cbegin(); it != m.cend();
+		     ++it, ++expected)
+		{
+			assert(*it == m(expected));
+		}
+
+		// The row iterator of a row-major matrix too.
+		const matrix<int> r = make<matrix<int> >(3, 4);
+		matrix<int>::const_column_iterator it = r.cbegin();
+		++it;
+		assert(*it == 10);
+
+		std::ostringstream a, b;
+		a << m;
+		b << r;
+		assert(a.str() == b.str());
+	}
+
+	// Layout conversions.
+	{
+		// Cache-oblivious transposition (SIMD kernels for double).
+		const matrix<double> r = make<matrix<double> >(67, 45);
+		const dmatrix c(r);
+		assert(same(c, r));
+		assert(c == r);
+		assert(r == c);
+
+		matrix<double> back;
+		back = c;
+		assert(back == r);
+
+		// Generic types and type conversions.
+		const qmatrix q(make<matrix<int> >(5, 7));
+		assert(q(4, 6) == rational<long>(46));
+		assert(matrix<rational<long> >(q)
+		       == matrix<rational<long> >(make<matrix<int> >(5, 7)));
+
+		// Assigning a transpose.
+		dmatrix t;
+		t = c.transposed();
+		assert(t.rows() == 45);
+		assert(same(t, r.transpose()));
+		t = r.transposed();
+		assert(same(t, r.transpose()));
+
+		back = c.transposed();
+		assert(same(back, r.transpose()));
+	}
+
+	// Element-wise operations.
+	{
+		const imatrix a = make<imatrix>(4, 3);
+		const matrix<int> b = make<matrix<int> >(4, 3);
+
+		imatrix c(a);
+		c += a;
+		assert(same(c, b * 2));
+		c -= b;
+		assert(same(c, b));
+
+		// Same layout: single pass over the storage.
+		imatrix d;
+		d = a * 3 + c;
+		assert(same(d, b * 4));
+
+		// Mixed layouts.
+		d = a + b;
+		assert(same(d, b * 2));
+		matrix<int> e;
+		e = b - a + a.transposed().transposed();
+		assert(e == b);
+
+		d = -a;
+		assert(same(d, b * -1));
+
+		assert(a == b * 1);
+	}
+
+	// Rows and columns.
+	{
+		imatrix m = make<imatrix>(3, 4);
+
+		m.swap_columns(0, 3);
+		assert(m(2, 0) == 23);
+		assert(m(2, 3) == 20);
+
+		m.swap_rows(0, 2);
+		assert(m(0, 0) == 23);
+		assert(m(2, 3) == 0);
+
+		m.op_column(1, 2, std::negate<int>());
+		assert(m(0, 2) == -21);
+
+		m.op_column(0, 1, 3, std::plus<int>());
+		assert(m(1, 3) == 13 + 11);
+
+		m.op_row(0, 1, std::negate<int>());
+		assert(m(1, 0) == -23);
+
+		m.op_row(0, 2, 1, std::minus<int>());
+		assert(m(1, 1) == 21 - 1);
+
+		// Rectangular transposition in place.
+		imatrix t = make<imatrix>(3, 5);
+		t.transpose_in_place();
+		assert(t.rows() == 5);
+		assert(same(t, make<imatrix>(3, 5).transpose()));
+	}
+
+	// Products.
+	{
+		const matrix<double> a = make<matrix<double> >(37, 29);
+		const matrix<double> b = make<matrix<double> >(29, 41);
+		const matrix<double> expected = a.mprod(b);
+
+		const dmatrix ca(a), cb(b);
+		assert(same(ca.mprod(cb), expected));
+		assert(same(ca.mprod(b), expected));
+		assert(a.mprod(cb) == expected);
+
+		thread_pool pool(3);
+		assert(same(ca.mprod(cb, pool), expected));
+
+		// Generic product.
+		const qmatrix qa(make<matrix<int> >(4, 3));
+		const matrix<rational<long> > qb(make<matrix<int> >(3, 2));
+		assert(same(qa.mprod(qb),
+		            make<matrix<int> >(4, 3).mprod(make<matrix<int> >(3, 2))));
+	}
+
+	// Decompositions (on row-major copies).
+	{
+		matrix<double> r(4, 4);
+		const double values[] = {
+			4, 1, 2, 0,
+			1, 5, 0, 1,
+			2, 0, 6, 1,
+			0, 1, 1, 3
+		};
+		for (size_t i = 0; i < 16; ++i)
+		{
+			r(i) = values[i];
+		}
+		const dmatrix c(r);
+
+		assert(near(c.det(), r.det()));
+
+		int s1, s2;
+		assert(near(c.log_det(s1), r.log_det(s2)));
+		assert(s1 == s2);
+
+		const dmatrix inverse = c.inverse();
+		assert(same(inverse, r.inverse()));
+
+		const dmatrix id = c.mprod(inverse);
+		for (size_t i = 0; i < 4; ++i)
+		{
+			for (size_t j = 0; j < 4; ++j)
+			{
+				assert(near(id(i, j), (i == j) ? 1. : 0.));
+			}
+		}
+
+		dmatrix B(4, 2, 1.);
+		c.solve(B);
+		matrix<double> rB(4, 2, 1.);
+		r.solve(rB);
+		assert(same(B, rB));
+
+		// Closed forms and exact elimination.
+		for (size_t n = 2; n <= 5; ++n)
+		{
+			const matrix<rational<long> > q(make<matrix<int> >(n, n)
+			                                + matrix<int>::identity(n));
+			assert(qmatrix(q).det() == q.det());
+		}
+	}
+
+	// Other algorithms.
+	{
+		const imatrix m = make<imatrix>(4, 5);
+
+		const const_matrix_view<int> v = m.block(1, 2, 2, 3);
+		assert(v.row_stride() == 1);
+		assert(v.column_stride() == 4);
+		assert(v(1, 2) == 24);
+
+		assert(same(sparse_matrix<int>(m), m));
+
+		// Iterative solver on a column-major dense matrix.
+		dmatrix a(3, 3, 0.);
+		a(0, 0) = 4;
+		a(0, 1) = a(1, 0) = 1;
+		a(1, 1) = 3;
+		a(2, 2) = 2;
+		const double b[] = {1, 2, 3};
+		double x[] = {0, 0, 0};
+
+		const jfcpp::iterative_statistics<double> stats =
+			jfcpp::conjugate_gradient(a, jfcpp::jacobi_preconditioner<double>(a),
+			                          b, x);
+		assert(stats.converged);
+		assert(near(x[2], 1.5));
+		assert(near(4 * x[0] + x[1], 1.));
+	}
+
+	return 0;
+}
@@ -0,0 +1,280 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/view.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+
+#include <contracts.h>
+
+#include <jfcpp/math/rational.hpp>
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::const_matrix_view;
+using jfcpp::matrix;
+using jfcpp::matrix_view;
+using jfcpp::thread_pool;
+using jfcpp::math::rational;
+
+/**
+ * A rows × columns matrix whose element (i, j) is 10 × i + j.
+ */
+template <typename T>
+matrix<T>
+make(size_t rows, size_t columns)
+{
+	matrix<T> m(rows, columns);
+
+	for (size_t i = 0; i < rows; ++i)
+	{
+		for (size_t j = 0; j < columns; ++j)
+		{
+			m(i, j) = T(10 * i + j);
+		}
+	}
+
+	return m;
+}
+
+int main()
+{
+	// Sub-views.
+	{
+		const matrix<int> m = make<int>(5, 6);
+
+		const const_matrix_view<int> b = m.block(1, 2, 3, 2);
+		assert(b.rows() == 3);
+		assert(b.columns() == 2);
+		assert(b.row_stride() == 6);
+		assert(b(0, 0) == 12);
+		assert(b(2, 1) == 33);
+		assert(!b.is_contiguous());
+		assert(m.view().is_contiguous());
+
+		assert(b.row(1)(0, 1) == 23);
+		assert(b.column(1)(2, 0) == 33);
+
+		const const_matrix_view<int> s = m.view().strided(2, 3);
+		assert(s.rows() == 3);
+		assert(s.columns() == 2);
+		assert(s(2, 1) == 43);
+
+		const const_matrix_view<int> t = b.transposed_view();
+		assert(t.rows() == 2);
+		assert(t(1, 2) == 33);
+
+		// Views are expressions.
+		const matrix<int> c(b);
+		assert(c.rows() == 3);
+		assert(c(2, 1) == 33);
+
+		matrix<int> d;
+		d = b * 2 + t.transposed_view();
+		assert(d(1, 0) == 66);
+		assert(d == c * 3);
+		assert(matrix<int>(b.transpose()) == matrix<int>(t));
+	}
+
+	// Modification through views.
+	{
+		matrix<int> m = make<int>(4, 4);
+
+		matrix_view<int> b = m.block(1, 1, 2, 2);
+		b = 0;
+		assert(m(1, 1) == 0);
+		assert(m(2, 2) == 0);
+		assert(m(1, 3) == 13);
+
+		b += m.block(0, 0, 2, 2);
+		assert(m(1, 1) == 0);
+		assert(m(1, 2) == 1);
+		assert(m(2, 1) == 10);
+
+		m.block(3, 0, 1, 4) *= 2;
+		assert(m(3, 3) == 66);
+
+		m.view().column(0) = m.view().column(3);
+		assert(m(0, 0) == 3);
+		assert(m(3, 0) == 66);
+
+		// Overlapping source and destination (shifted).
+		matrix<int> n = make<int>(3, 4);
+		n.block(0, 1, 3, 3) = n.block(0, 0, 3, 3);
+		assert(n(0, 0) == 0);
+		assert(n(0, 1) == 0);
+		assert(n(0, 2) == 1);
+		assert(n(2, 3) == 22);
+
+		// Overlapping in the other direction, with an expression.
+		n = make<int>(3, 4);
+		n.block(0, 0, 3, 3) -= n.block(0, 1, 3, 3) * 1;
+		assert(n(0, 0) == -1);
+		assert(n(2, 2) == -1);
+
+		// A transposed view of a square matrix onto itself.
+		matrix<int> q = make<int>(3, 3);
+		q.view() = q.view().transposed_view();
+		assert(q == make<int>(3, 3).transpose());
+
+		// Assigning a view copies the values.
+		matrix<int> x(2, 2, 0), y(2, 2, 7);
+		matrix_view<int> vx = x.view(), vy = y.view();
+		vx = vy;
+		assert(x == y);
+		assert(vx.data() == x.begin());
+	}
+
+	// Products.
+	{
+		const matrix<double> a = make<double>(70, 80), b = make<double>(90, 60);
+
+		const matrix<double> expected =
+			matrix<double>(a.block(3, 5, 40, 50)).mprod(
+				matrix<double>(b.block(10, 2, 50, 30)));
+
+		assert(a.block(3, 5, 40, 50).mprod(b.block(10, 2, 50, 30))
+		       == expected);
+
+		thread_pool pool(4);
+
+		assert(a.block(3, 5, 40, 50).mprod(b.block(10, 2, 50, 30), pool)
+		       == expected);
+
+		// Transposed operand without copy.
+		assert(a.view().transposed_view().mprod(a.view())
+		       == matrix<double>(a.transpose()).mprod(a));
+
+		// In place in a block of a bigger matrix: C = 2 A B + C.
+		matrix<double> c(50, 50, 1.);
+		c.block(5, 5, 40, 30).gemm(2., a.block(3, 5, 40, 50),
+		                           b.block(10, 2, 50, 30), 1., pool);
+		assert(c(0, 0) == 1);
+		assert(c(5, 5) == 2 * expected(0, 0) + 1);
+		assert(c(44, 34) == 2 * expected(39, 29) + 1);
+		assert(c(45, 34) == 1);
+
+		// Generic types.
+		const matrix<rational<long> > r(make<int>(3, 3));
+		const matrix<rational<long> > p = r.block(0, 0, 2, 3).mprod(r.view());
+		assert(p(1, 2) == rational<long>(10 * 2 + 11 * 12 + 12 * 22));
+	}
+
+	// Resolution.
+	{
+		matrix<double> a(4, 4, 0.);
+		for (size_t i = 0; i < 3; ++i)
+		{
+			a(i + 1, i + 1) = double(i + 2);
+			a(i + 1, 1) += 1;
+		}
+
+		matrix<double> b = make<double>(4, 3);
+		a.block(1, 1, 3, 3).solve(b.block(1, 0, 3, 1));
+
+		assert(b(0, 0) == 0);
+		assert(b(0, 1) == 1);
+		assert(std::fabs(b(1, 0) - 10. / 3) < 1e-12);
+		assert(std::fabs(b(2, 0) - (20 - 10. / 3) / 3) < 1e-12);
+		assert(std::fabs(b(3, 0) - (30 - 10. / 3) / 4) < 1e-12);
+		assert(b(1, 1) == 11);
+	}
+
+	// Triangular kernels: every side, part and diagonal against the product
+	// by the explicit triangle, with several blocks and tiles.
+	{
+		const size_t n = 150, m = 300;
+
+		// The other triangle must not be read.  Small off-diagonal values
+		// keep the unit triangles well conditioned.
+		matrix<double> a(n, n);
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			a(i) = (double(rand() % 2001) / 1000 - 1) / double(n);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			a(i, i) = 2 + double(i % 3);
+		}
+
+		matrix<double> b(n, m);
+		for (size_t i = 0; i < b.size(); ++i)
+		{
+			b(i) = double(rand() % 2001) / 100 - 10;
+		}
+
+		thread_pool pool(3);
+
+		for (int k = 0; k < 8; ++k)
+		{
+			const jfcpp::triangular_side side =
+				(k & 1) ? jfcpp::right_side : jfcpp::left_side;
+			const jfcpp::triangular_part part =
+				(k & 2) ? jfcpp::upper_part : jfcpp::lower_part;
+			const jfcpp::triangular_diagonal diagonal =
+				(k & 4) ? jfcpp::unit_diagonal : jfcpp::non_unit_diagonal;
+
+			matrix<double> t(n, n, 0.);
+			for (size_t i = 0; i < n; ++i)
+			{
+				for (size_t j = 0; j < n; ++j)
+				{
+					if ((part == jfcpp::upper_part) ? (j > i) : (j < i))
+					{
+						t(i, j) = a(i, j);
+					}
+				}
+				t(i, i) = (diagonal == jfcpp::unit_diagonal) ? 1 : a(i, i);
+			}
+
+			// B and Bᵀ, the latter through a transposed view (the columns
+			// are not contiguous).
+			const matrix<double> x = (side == jfcpp::left_side)
+				? b : matrix<double>(b.transpose());
+			const matrix<double> expected = (side == jfcpp::left_side)
+				? t.mprod(x) : x.mprod(t);
+			matrix<double> bt(x.columns(), x.rows());
+			bt.view().transposed_view() = x;
+
+			matrix<double> y(x);
+			y.trmm(side, part, diagonal, 2., a);
+			for (size_t i = 0; i < y.size(); ++i)
+			{
+				assert(std::fabs(y(i) - 2 * expected(i)) < 1e-9);
+			}
+
+			y.trsm(side, part, diagonal, .5, a, pool);
+			for (size_t i = 0; i < y.size(); ++i)
+			{
+				assert(std::fabs(y(i) - x(i)) < 1e-9);
+			}
+
+			matrix_view<double> v = bt.view().transposed_view();
+			v.trmm(side, part, diagonal, 1., a, pool);
+			v.trsm(side, part, diagonal, 1., a);
+			for (size_t i = 0; i < x.rows(); ++i)
+			{
+				for (size_t j = 0; j < x.columns(); ++j)
+				{
+					assert(std::fabs(bt(j, i) - x(i, j)) < 1e-9);
+				}
+			}
+		}
+
+		// Generic types, exactly.
+		matrix<rational<long> > r(make<int>(3, 3)), c(make<int>(3, 2));
+		r(0, 0) = r(1, 1) = r(2, 2) = 1;
+
+		const matrix<rational<long> > d(c);
+		c.trsm(jfcpp::left_side, jfcpp::lower_part, jfcpp::non_unit_diagonal,
+		       rational<long>(1), r);
+		assert(c(2, 1) == rational<long>(21) - rational<long>(20)
+		       * rational<long>(1) - rational<long>(21)
+		       * (rational<long>(11) - rational<long>(10)));
+		c.trmm(jfcpp::left_side, jfcpp::lower_part, jfcpp::non_unit_diagonal,
+		       rational<long>(1), r);
+		assert(c == d);
+	}
+
+	return EXIT_SUCCESS;
+}
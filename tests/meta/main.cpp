@@ -1,6 +1,8 @@
 // To properly test inclusion, the tested file must be the first included.
 #include <jfcpp/meta/enable_if.hpp>
 #include <jfcpp/meta/is_a.hpp>
+#include <jfcpp/meta/is_arithmetic.hpp>
+#include <jfcpp/meta/is_same.hpp>
 #include <jfcpp/meta/logic.hpp>
 
 #include <cstdlib>
@@ -10,6 +12,10 @@
 using jfcpp::meta::and_;
 using jfcpp::meta::enable_if;
 using jfcpp::meta::is_a;
+using jfcpp::meta::is_arithmetic;
+using jfcpp::meta::is_floating_point;
+using jfcpp::meta::is_integral;
+using jfcpp::meta::is_same;
 using jfcpp::meta::or_;
 
 template <bool B>
@@ -68,5 +74,18 @@ int main()
 	cmp(is_a<A, C>::value, false);
 	cmp(is_a<C, A>::value, false);
 
+	cmp(is_same<A, A>::value, true);
+	cmp(is_same<A, B>::value, false);
+	cmp(is_same<int, const int>::value, false);
+
+	cmp(is_floating_point<double>::value, true);
+	cmp(is_floating_point<int>::value, false);
+	cmp(is_integral<unsigned long int>::value, true);
+	cmp(is_integral<float>::value, false);
+	cmp(is_integral<bool>::value, false);
+	cmp(is_arithmetic<float>::value, true);
+	cmp(is_arithmetic<const int>::value, true);
+	cmp(is_arithmetic<A>::value, false);
+
 	return EXIT_SUCCESS;
 }
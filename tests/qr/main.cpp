@@ -0,0 +1,209 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/qr.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+#include "../matrix_checks.hpp"
+
+using jfcpp::aligned_allocator;
+using jfcpp::column_major;
+using jfcpp::matrix;
+using jfcpp::qr;
+using jfcpp::thread_pool;
+
+/**
+ * Checks “Q × R = A × P”, “Qᵀ × Q = I” and the shape of R.
+ */
+void
+check(const matrix<double> &a, const qr<double> &f)
+{
+	const size_t m = a.rows(), n = a.columns(), k = std::min(m, n);
+	const matrix<double> q = f.Q(), r = f.R();
+
+	assert(q.rows() == m);
+	assert(q.columns() == k);
+	assert(r.rows() == k);
+	assert(r.columns() == n);
+
+	for (size_t i = 0; i < k; ++i)
+	{
+		for (size_t j = 0; j < i; ++j)
+		{
+			assert(r(i, j) == 0);
+		}
+	}
+
+	matrix<double> ap(m, n);
+	for (size_t i = 0; i < m; ++i)
+	{
+		for (size_t j = 0; j < n; ++j)
+		{
+			ap(i, j) = a(i, f.permutation()[j]);
+		}
+	}
+	assert(is_close(q.mprod(r), ap, 1e-10 * n));
+
+	const matrix<double> qt = q.transpose();
+	assert(is_close(qt.mprod(q), matrix<double>::identity(k), 1e-13 * m));
+}
+
+int main()
+{
+	// Square system: same solution as the LU decomposition.
+	{
+		const matrix<double> a = random_matrix(40, 40), b = random_matrix(40, 3);
+
+		const qr<double> f(a);
+		assert(f.rows() == 40);
+		assert(f.columns() == 40);
+		assert(!f.is_pivoted());
+		assert(f.rank() == 40);
+		check(a, f);
+
+		matrix<double> x(b);
+		a.solve(x);
+		assert(is_close(f.least_squares(b), x, 1e-9));
+	}
+
+	// Overdetermined system, several panels: the residual is orthogonal to
+	// the columns of A.
+	{
+		const size_t m = 300, n = 100;
+		const matrix<double> a = random_matrix(m, n), b = random_matrix(m, 2);
+
+		const qr<double> f(a);
+		check(a, f);
+
+		const matrix<double> x = f.least_squares(b);
+		assert(x.rows() == n);
+		assert(x.columns() == 2);
+
+		const matrix<double> at = a.transpose();
+		const matrix<double> residual = a.mprod(x) - b;
+		assert(is_close(at.mprod(residual), matrix<double>(n, 2, 0.), 1e-8));
+
+		// A consistent system is solved exactly.
+		const matrix<double> y = random_matrix(n, 2);
+		assert(is_close(f.least_squares(a.mprod(y)), y, 1e-9));
+
+		// In parallel.
+		thread_pool pool(4);
+
+		const qr<double> g(a, false, pool);
+		assert(is_close(g.R(), f.R(), 1e-9));
+		assert(is_close(g.Q(pool), f.Q(), 1e-12));
+		assert(is_close(g.least_squares(b, pool), x, 1e-9));
+
+		// With pivoting.
+		const qr<double> h(a, true, pool);
+		assert(h.is_pivoted());
+		assert(h.rank() == n);
+		check(a, h);
+		assert(is_close(h.least_squares(b, pool), x, 1e-9));
+	}
+
+	// Rank-deficient matrix.
+	{
+		const size_t m = 60, n = 12;
+
+		// The columns 8 to 11 are combinations of the first ones.
+		matrix<double> a = random_matrix(m, n);
+		for (size_t i = 0; i < m; ++i)
+		{
+			for (size_t j = 8; j < n; ++j)
+			{
+				a(i, j) = a(i, j - 8) - 2 * a(i, j - 7);
+			}
+		}
+
+		const qr<double> f(a, true);
+		assert(f.rank() == 8);
+		check(a, f);
+
+		// The diagonal of R decreases.
+		const matrix<double> r = f.R();
+		for (size_t i = 1; i < n; ++i)
+		{
+			assert(std::fabs(r(i, i)) <= std::fabs(r(i - 1, i - 1)) * 1.000001);
+		}
+
+		// Basic solution of a consistent system.
+		const matrix<double> x = random_matrix(n, 1), b = a.mprod(x);
+		const matrix<double> y = f.least_squares(b);
+		assert(is_close(a.mprod(y), b, 1e-9));
+
+		size_t zeros = 0;
+		for (size_t j = 0; j < n; ++j)
+		{
+			zeros += (y(j, 0) == 0);
+		}
+		assert(zeros == n - 8);
+
+		// A null column cannot be solved without pivoting.
+		matrix<double> c = random_matrix(m, 3);
+		for (size_t i = 0; i < m; ++i)
+		{
+			c(i, 1) = 0;
+		}
+
+		const qr<double> g(c);
+		try
+		{
+			g.least_squares(b);
+			assert(false);
+		}
+		catch (const std::runtime_error &)
+		{}
+		assert(qr<double>(c, true).rank() == 2);
+	}
+
+	// Underdetermined system.
+	{
+		const matrix<double> a = random_matrix(5, 8), b = random_matrix(5, 2);
+
+		const qr<double> f(a, true);
+		assert(f.rank() == 5);
+		check(a, f);
+		assert(is_close(a.mprod(f.least_squares(b)), b, 1e-9));
+	}
+
+	// A column-major matrix is decomposed in its layout.
+	{
+		typedef matrix<double, aligned_allocator<double>, column_major> cm;
+		typedef qr<double, aligned_allocator<double>, column_major> cq;
+
+		const matrix<double> a = random_matrix(90, 40), b = random_matrix(90, 3);
+
+		for (int pivoting = 0; pivoting < 2; ++pivoting)
+		{
+			const qr<double> f(a, pivoting);
+			const cq g(cm(a), pivoting);
+
+			assert(g.permutation() == f.permutation());
+			assert(is_close(matrix<double>(g.Q()), f.Q(), 1e-12));
+			assert(is_close(matrix<double>(g.R()), f.R(), 1e-12));
+			assert(is_close(matrix<double>(g.least_squares(cm(b))),
+			                f.least_squares(b), 1e-12));
+			assert(is_close(g.least_squares(b), f.least_squares(b), 1e-12));
+		}
+	}
+
+	// Empty matrix.
+	{
+		const qr<double> f(matrix<double>(0, 3));
+		assert(f.rank() == 0);
+		assert(f.R().size() == 0);
+		assert(f.least_squares(matrix<double>(0, 2)).rows() == 3);
+	}
+
+	return EXIT_SUCCESS;
+}
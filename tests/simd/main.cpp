@@ -0,0 +1,203 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/simd.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include <contracts.h>
+
+using jfcpp::simd::instruction_set;
+using jfcpp::simd::kernels;
+
+/**
+ * Compares the kernels of every supported instruction set with the generic
+ * ones.
+ *
+ * Values are small integers so that results are exact whatever the order of
+ * the operations.
+ */
+template <typename T>
+void
+test()
+{
+	const kernels<T> reference(jfcpp::simd::generic);
+
+	assert(reference.isa == jfcpp::simd::generic);
+	assert(kernels<T>::get().isa == jfcpp::simd::detect());
+
+	for (int i = jfcpp::simd::generic; i <= jfcpp::simd::avx512; ++i)
+	{
+		const kernels<T> k(static_cast<instruction_set>(i));
+
+		assert(k.isa <= jfcpp::simd::detect());
+
+		// Sizes which are not multiple of any vector size.
+		for (size_t n = 0; n < 70; n += 7)
+		{
+			std::vector<T> x(n + 1), y(n + 1), expected, result;
+
+			for (size_t j = 0; j < n; ++j)
+			{
+				x[j] = T(rand() % 100);
+				y[j] = T(rand() % 100 + 1);
+			}
+
+#			define CHECK(KERNEL, ARG) \
+			expected = result = x; \
+			reference.KERNEL(n, &expected[0], ARG); \
+			k.KERNEL(n, &result[0], ARG); \
+			assert(expected == result)
+
+			CHECK(add, &y[0]);
+			CHECK(subtract, &y[0]);
+			CHECK(multiply, &y[0]);
+			CHECK(divide, &y[0]);
+			CHECK(add_scalar, T(3));
+			CHECK(subtract_scalar, T(3));
+			CHECK(multiply_scalar, T(3));
+			CHECK(divide_scalar, T(4));
+
+#			undef CHECK
+
+			assert(reference.dot(n, &x[0], &y[0]) == k.dot(n, &x[0], &y[0]));
+
+			expected = result = y;
+			reference.axpy(n, T(3), &x[0], &expected[0]);
+			k.axpy(n, T(3), &x[0], &result[0]);
+			assert(expected == result);
+
+			std::vector<T> rx(x), ry(y), ex(x), ey(y);
+			reference.rotate(n, T(3), T(2), &ex[0], &ey[0]);
+			k.rotate(n, T(3), T(2), &rx[0], &ry[0]);
+			assert(ex == rx);
+			assert(ey == ry);
+		}
+
+		// GEMM micro-kernel, whose shape depends on the instruction set.
+		{
+			const size_t
+				kc = 37,
+				mr = k.mr,
+				nr = k.nr;
+
+			std::vector<T>
+				a(kc * mr),
+				b(kc * nr),
+				expected(mr * nr, T(0)),
+				result(mr * nr);
+
+			for (size_t j = 0; j < a.size(); ++j)
+			{
+				a[j] = T(rand() % 10);
+			}
+			for (size_t j = 0; j < b.size(); ++j)
+			{
+				b[j] = T(rand() % 10);
+			}
+
+			for (size_t p = 0; p < kc; ++p)
+			{
+				for (size_t i = 0; i < mr; ++i)
+				{
+					for (size_t j = 0; j < nr; ++j)
+					{
+						expected[i * nr + j] += a[p * mr + i] * b[p * nr + j];
+					}
+				}
+			}
+
+			k.gemm(kc, &a[0], &b[0], &result[0]);
+
+			assert(expected == result);
+		}
+
+		// Transpose kernel, inside larger matrices.
+		{
+			const size_t
+				tb = kernels<T>::TB,
+				lda = tb + 3,
+				ldb = tb + 5;
+
+			std::vector<T>
+				a(tb * lda),
+				expected(tb * ldb, T(-1)),
+				result(expected);
+
+			for (size_t j = 0; j < a.size(); ++j)
+			{
+				a[j] = T(j);
+			}
+
+			reference.transpose(&a[0], lda, &expected[0], ldb);
+			k.transpose(&a[0], lda, &result[0], ldb);
+
+			assert(expected == result);
+			assert(result[ldb] == a[1]);
+			assert(result[ldb - 1] == T(-1));
+		}
+
+		// Batch kernels, on two blocks of n × n matrices (and n × 2 for
+		// the product).
+		for (size_t n = 1; n <= 4; ++n)
+		{
+			const size_t blocks = 2, count = blocks * kernels<T>::BL;
+
+			std::vector<T>
+				a(count * n * n),
+				b(count * n * 2),
+				expected(count * n * n),
+				result(expected),
+				expected_det(count),
+				result_det(count);
+
+			for (size_t j = 0; j < a.size(); ++j)
+			{
+				a[j] = T(rand() % 10);
+			}
+			for (size_t j = 0; j < b.size(); ++j)
+			{
+				b[j] = T(rand() % 10);
+			}
+
+			reference.batch_det(blocks, n, &a[0], &expected_det[0]);
+			k.batch_det(blocks, n, &a[0], &result_det[0]);
+			assert(expected_det == result_det);
+
+			reference.batch_inverse(blocks, n, &a[0], &expected[0],
+			                        &expected_det[0]);
+			k.batch_inverse(blocks, n, &a[0], &result[0], &result_det[0]);
+			assert(expected_det == result_det);
+			for (size_t j = 0; j < count; ++j)
+			{
+				// Singular matrices give non-finite values.
+				if (expected_det[j] != T(0))
+				{
+					for (size_t e = 0; e < n * n; ++e)
+					{
+						const size_t offset = (j / kernels<T>::BL) * n * n
+							* kernels<T>::BL + e * kernels<T>::BL
+							+ j % kernels<T>::BL;
+
+						assert(expected[offset] == result[offset]);
+					}
+				}
+			}
+
+			expected.assign(count * n * 2, T(0));
+			result = expected;
+			reference.batch_mprod(blocks, n, n, 2, &a[0], &b[0],
+			                      &expected[0]);
+			k.batch_mprod(blocks, n, n, 2, &a[0], &b[0], &result[0]);
+			assert(expected == result);
+		}
+	}
+}
+
+int main()
+{
+	test<float>();
+	test<double>();
+
+	return EXIT_SUCCESS;
+}
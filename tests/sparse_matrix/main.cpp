@@ -0,0 +1,179 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/sparse_matrix.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::matrix;
+using jfcpp::sparse_builder;
+using jfcpp::sparse_matrix;
+using jfcpp::thread_pool;
+
+/**
+ * The 5-point Laplacian of a n × n grid (finite differences).
+ */
+sparse_matrix<double>
+laplacian(size_t n)
+{
+	sparse_builder<double> builder(n * n, n * n);
+
+	builder.reserve(5 * n * n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < n; ++j)
+		{
+			const size_t k = i * n + j;
+
+			// In reverse order to exercise the sort.
+			if (j + 1 < n) builder.add(k, k + 1, -1);
+			if (i + 1 < n) builder.add(k, k + n, -1);
+			builder.add(k, k, 4);
+			if (j > 0) builder.add(k, k - 1, -1);
+			if (i > 0) builder.add(k, k - n, -1);
+		}
+	}
+
+	return sparse_matrix<double>(builder);
+}
+
+int main()
+{
+	// Builder: duplicates are summed, zeros dropped and columns sorted.
+	{
+		sparse_builder<int> builder(3, 4);
+
+		builder.add(2, 3, 1);
+		builder.add(0, 2, 5);
+		builder.add(2, 0, 7);
+		builder.add(0, 2, -2);
+		builder.add(1, 1, 4);
+		builder.add(1, 1, -4);
+
+		assert(builder.size() == 6);
+
+		const sparse_matrix<int> s(builder);
+
+		assert(s.rows() == 3);
+		assert(s.columns() == 4);
+		assert(s.non_zeros() == 3);
+		assert(s(0, 2) == 3);
+		assert(s(1, 1) == 0);
+		assert(s(2, 0) == 7);
+		assert(s(2, 3) == 1);
+		assert(s(2, 2) == 0);
+
+		assert(s.row_offsets()[1] == 1);
+		assert(s.row_offsets()[2] == 1);
+		assert(s.column_indices()[1] == 0);
+		assert(s.column_indices()[2] == 3);
+
+		// Conversions.
+		const matrix<int> d(s);
+
+		assert(d.rows() == 3);
+		assert(d.columns() == 4);
+		assert(d(0, 2) == 3);
+		assert(d(1, 1) == 0);
+		assert(sparse_matrix<int>(d) == s);
+
+		// Column view: column 0 holds (2, 0), column 2 (0, 2) and column 3
+		// (2, 3).
+		assert(s.column_offsets().size() == 5);
+		assert(s.column_offsets()[1] == 1);
+		assert(s.column_offsets()[2] == 1);
+		assert(s.column_offsets()[4] == 3);
+		assert(s.row_indices()[0] == 2);
+		assert(s.row_indices()[1] == 0);
+		assert(s.row_indices()[2] == 2);
+		for (size_t j = 0; j < s.columns(); ++j)
+		{
+			for (size_t k = s.column_offsets()[j];
+			     k < s.column_offsets()[j + 1]; ++k)
+			{
+				assert(s.values()[s.column_positions()[k]]
+				       == s(s.row_indices()[k], j));
+				assert(s.column_indices()[s.column_positions()[k]] == j);
+			}
+		}
+
+		// The transpose is built from the column view.
+		const sparse_matrix<int> t = s.transpose();
+
+		assert(t.rows() == 4);
+		assert(t.columns() == 3);
+		assert(t(3, 2) == 1);
+		assert(t.column_indices()[0] == 2);
+		assert(t.transpose() == s);
+
+		// The column view of the transpose is the row view of s.
+		assert(t.column_offsets() == s.row_offsets());
+		assert(t.row_indices() == s.column_indices());
+		for (size_t k = 0; k < t.non_zeros(); ++k)
+		{
+			assert(t.values()[t.column_positions()[k]] == s.values()[k]);
+		}
+		assert(matrix<int>(t) == d.transpose());
+	}
+
+	// Empty matrices.
+	{
+		const sparse_matrix<double> s(3, 2);
+		const matrix<double> x(2, 1, 1.);
+
+		assert(s.non_zeros() == 0);
+		assert(s.mprod(x) == matrix<double>(3, 1, 0.));
+		assert(sparse_matrix<double>().transpose() == sparse_matrix<double>());
+		assert(s.column_offsets() == std::vector<size_t>(3, 0));
+		assert(s.row_indices().empty());
+		assert(s.transpose() == sparse_matrix<double>(2, 3));
+	}
+
+	// Products, sequential and parallel.
+	{
+		const size_t n = 40;
+
+		const sparse_matrix<double> s = laplacian(n);
+		const matrix<double> d(s);
+
+		assert(s.non_zeros() == 5 * n * n - 4 * n);
+
+		matrix<double> x(n * n, 3);
+		for (size_t i = 0; i < x.size(); ++i)
+		{
+			x(i) = double(rand() % 19) - 9;
+		}
+
+		const matrix<double> expected = d.mprod(x);
+
+		thread_pool pool(4);
+
+		assert(s.mprod(x) == expected);
+		assert(s.mprod(x, pool) == expected);
+
+		std::vector<double> v(n * n), y(n * n, -1.);
+		for (size_t i = 0; i < v.size(); ++i)
+		{
+			v[i] = x(i, 1);
+		}
+
+		s.mprod(&v[0], &y[0], pool);
+		for (size_t i = 0; i < y.size(); ++i)
+		{
+			assert(y[i] == expected(i, 1));
+		}
+
+		s.mprod(&v[0], &y[0]);
+		for (size_t i = 0; i < y.size(); ++i)
+		{
+			assert(y[i] == expected(i, 1));
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,234 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/svd.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+#include "../matrix_checks.hpp"
+
+using jfcpp::matrix;
+using jfcpp::svd;
+using jfcpp::thread_pool;
+
+/**
+ * Whether the columns of a matrix are orthonormal.
+ */
+bool
+is_orthonormal(const matrix<double> &q, double tolerance)
+{
+	const matrix<double> qt = q.transpose();
+
+	return is_close(qt.mprod(q), matrix<double>::identity(q.columns()),
+	                tolerance);
+}
+
+/**
+ * U × Σ × Vᵀ.
+ */
+matrix<double>
+product(const svd<double> &f)
+{
+	const matrix<double> &u = f.U();
+	const std::vector<double> &s = f.values();
+
+	matrix<double> us(u);
+	for (size_t i = 0; i < us.rows(); ++i)
+	{
+		for (size_t j = 0; j < us.columns(); ++j)
+		{
+			us(i, j) *= s[j];
+		}
+	}
+
+	const matrix<double> vt = f.V().transpose();
+
+	return us.mprod(vt);
+}
+
+/**
+ * Checks the full decomposition of a.
+ */
+void
+check(const matrix<double> &a, const svd<double> &f)
+{
+	const size_t m = a.rows(), n = a.columns(), k = std::min(m, n);
+	const std::vector<double> &s = f.values();
+
+	assert(s.size() == k);
+	assert(f.U().rows() == m);
+	assert(f.U().columns() == k);
+	assert(f.V().rows() == n);
+	assert(f.V().columns() == k);
+
+	for (size_t j = 1; j < k; ++j)
+	{
+		assert(s[j] <= s[j - 1]);
+	}
+	assert(is_orthonormal(f.U(), 1e-12));
+	assert(is_orthonormal(f.V(), 1e-12));
+	assert(is_close(product(f), a, 1e-10 * s[0]));
+}
+
+int main()
+{
+	// Known values: the singular values of a diagonal matrix.
+	{
+		matrix<double> a(3, 3, 0.);
+		a(0, 0) = 2;
+		a(1, 1) = -5;
+		a(2, 2) = 3;
+
+		const svd<double> f(a);
+		assert(std::fabs(f.values()[0] - 5) < 1e-15);
+		assert(std::fabs(f.values()[1] - 3) < 1e-15);
+		assert(std::fabs(f.values()[2] - 2) < 1e-15);
+		check(a, f);
+		assert(f.rank() == 3);
+	}
+
+	// Square, tall and wide matrices; the values are the square roots of
+	// the eigenvalues of Aᵀ × A.
+	{
+		const size_t shapes[][2] = { { 50, 50 }, { 120, 30 }, { 25, 70 } };
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const matrix<double> a = random_matrix(shapes[i][0], shapes[i][1]);
+
+			const svd<double> f(a);
+			check(a, f);
+			assert(is_orthonormal(f.U(), 1e-12));
+
+			const svd<double> g(a, false);
+			assert(g.U().size() == 0);
+			assert(g.V().size() == 0);
+			for (size_t j = 0; j < f.values().size(); ++j)
+			{
+				assert(std::fabs(g.values()[j] - f.values()[j])
+				       < 1e-12 * f.values()[0]);
+			}
+
+			// In parallel.
+			thread_pool pool(3);
+
+			const svd<double> h(a, true, pool);
+			check(a, h);
+			for (size_t j = 0; j < f.values().size(); ++j)
+			{
+				assert(std::fabs(h.values()[j] - f.values()[j])
+				       < 1e-12 * f.values()[0]);
+			}
+		}
+	}
+
+	// Rank-deficient matrix: the extra values are (numerically) null.
+	{
+		const size_t m = 40, n = 10;
+
+		matrix<double> a = random_matrix(m, n);
+		for (size_t i = 0; i < m; ++i)
+		{
+			for (size_t j = 7; j < n; ++j)
+			{
+				a(i, j) = a(i, j - 7) + 3 * a(i, j - 6);
+			}
+		}
+
+		const svd<double> f(a);
+		assert(f.rank() == 7);
+		assert(is_close(product(f), a, 1e-10 * f.values()[0]));
+	}
+
+	// Exactly null singular values: U and V stay orthonormal.
+	{
+		matrix<double> a(3, 2, 0.);
+		a(0, 0) = 1;
+		a(1, 0) = 2;
+		a(2, 0) = 2;
+
+		const svd<double> f(a);
+		assert(std::fabs(f.values()[0] - 3) < 1e-12);
+		assert(f.values()[1] == 0);
+		assert(f.rank() == 1);
+		assert(is_orthonormal(f.U(), 1e-12));
+		assert(is_orthonormal(f.V(), 1e-12));
+		assert(is_close(product(f), a, 1e-12));
+
+		// diag(1, 2, 0, 0), square and wide.
+		matrix<double> d(4, 4, 0.);
+		d(0, 0) = 1;
+		d(1, 1) = 2;
+
+		const svd<double> g(d);
+		assert(g.values()[0] == 2);
+		assert(g.values()[1] == 1);
+		assert(g.values()[2] == 0);
+		assert(g.values()[3] == 0);
+		check(d, g);
+
+		matrix<double> w(3, 5, 0.);
+		w(0, 1) = 4;
+		w(2, 3) = 1;
+		check(w, svd<double>(w));
+	}
+
+	// Randomized: a matrix of rank 8 plus a little noise, the top values
+	// are found.
+	{
+		const size_t m = 400, n = 150, r = 8;
+		const matrix<double> x = random_matrix(m, r), y = random_matrix(r, n);
+
+		matrix<double> a = x.mprod(y);
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			a(i) += double(rand() % 2001) / 1e6 - 1e-3;
+		}
+
+		const svd<double> exact(a, false);
+
+		thread_pool pool(2);
+		svd<double> f;
+		f.compute_randomized(a, 5, 10, 2, 1, pool);
+		assert(f.values().size() == 5);
+		assert(f.U().rows() == m);
+		assert(f.U().columns() == 5);
+		assert(f.V().rows() == n);
+		assert(f.V().columns() == 5);
+		assert(is_orthonormal(f.U(), 1e-12));
+		assert(is_orthonormal(f.V(), 1e-12));
+		for (size_t j = 0; j < 5; ++j)
+		{
+			assert(std::fabs(f.values()[j] - exact.values()[j])
+			       < 1e-8 * exact.values()[0]);
+		}
+
+		// The same seed gives the same result.
+		svd<double> g;
+		g.compute_randomized(a, 5, 10, 2, 1);
+		assert(is_close(g.U(), f.U(), 1e-10));
+
+		// A rank-r matrix is reproduced exactly with k = r.
+		const matrix<double> b = x.mprod(y);
+
+		g.compute_randomized(b, r);
+		assert(is_close(product(g), b, 1e-9 * g.values()[0]));
+	}
+
+	// Empty matrix.
+	{
+		const svd<double> f(matrix<double>(0, 4));
+		assert(f.values().empty());
+		assert(f.rank() == 0);
+		assert(f.V().rows() == 4);
+	}
+
+	return EXIT_SUCCESS;
+}
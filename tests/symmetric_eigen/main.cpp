@@ -0,0 +1,279 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/matrix/symmetric_eigen.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include <contracts.h>
+
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::matrix;
+using jfcpp::symmetric_eigen;
+using jfcpp::thread_pool;
+
+/**
+ * A random symmetric matrix.
+ */
+matrix<double>
+make(size_t n)
+{
+	matrix<double> a(n, n);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = i; j < n; ++j)
+		{
+			a(i, j) = a(j, i) = double(rand() % 2001) / 100 - 10;
+		}
+	}
+
+	return a;
+}
+
+/**
+ * Checks “A × V = V × Λ”, “Vᵀ × V = I”, the order of the eigenvalues and
+ * the sign of the eigenvectors.
+ */
+template <typename T>
+void
+check(const matrix<T> &a, const symmetric_eigen<T> &s, T tolerance)
+{
+	const matrix<T> &v = s.vectors();
+	const size_t n = a.rows(), k = s.values().size();
+
+	assert(s.dimension() == n);
+	assert(v.rows() == n);
+	assert(v.columns() == k);
+
+	T norm(0);
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		norm = std::max(norm, T(std::fabs(a(i))));
+	}
+	tolerance *= T(n) * (1 + norm);
+
+	const matrix<T> vt = v.transpose();
+	const matrix<T> av = a.mprod(v), g = vt.mprod(v);
+
+	for (size_t j = 0; j < k; ++j)
+	{
+		if (j != 0)
+		{
+			assert(s.values()[j] <= s.values()[j - 1]);
+		}
+
+		size_t greatest = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			assert(std::fabs(av(i, j) - s.values()[j] * v(i, j))
+			       <= tolerance);
+
+			if (std::fabs(v(i, j)) > std::fabs(v(greatest, j)))
+			{
+				greatest = i;
+			}
+		}
+		assert(v(greatest, j) > 0);
+
+		for (size_t i = 0; i < k; ++i)
+		{
+			assert(std::fabs(g(i, j) - T(i == j)) <= tolerance);
+		}
+	}
+}
+
+int main()
+{
+	// Known decomposition.
+	{
+		matrix<double> a(2, 2, 2.);
+		a(0, 1) = a(1, 0) = 1;
+
+		const symmetric_eigen<double> s(a);
+		assert(s.values().size() == 2);
+		assert(std::fabs(s.values()[0] - 3) < 1e-12);
+		assert(std::fabs(s.values()[1] - 1) < 1e-12);
+		assert(std::fabs(s.vectors()(0, 0) - std::sqrt(0.5)) < 1e-12);
+		assert(std::fabs(s.vectors()(1, 0) - std::sqrt(0.5)) < 1e-12);
+		check(a, s, 1e-12);
+	}
+
+	// Trivial dimensions.
+	{
+		const symmetric_eigen<double> s(matrix<double>(1, 1, -4.));
+		assert(s.values().size() == 1);
+		assert(s.values()[0] == -4);
+		assert(s.vectors()(0, 0) == 1);
+
+		symmetric_eigen<double> t(matrix<double>(0, 0));
+		assert(t.dimension() == 0);
+		assert(t.values().empty());
+	}
+
+	// Only the upper triangle is read.
+	{
+		matrix<double> a = make(20), b(a);
+		for (size_t i = 1; i < 20; ++i)
+		{
+			for (size_t j = 0; j < i; ++j)
+			{
+				b(i, j) = 1e6;
+			}
+		}
+
+		const symmetric_eigen<double> s(a), t(b);
+		for (size_t j = 0; j < 20; ++j)
+		{
+			assert(std::fabs(s.values()[j] - t.values()[j]) < 1e-12);
+		}
+	}
+
+	// Several panels and blocks of reflectors.
+	{
+		const size_t n = 150;
+		const matrix<double> a = make(n);
+
+		const symmetric_eigen<double> s(a);
+		assert(s.values().size() == n);
+		check(a, s, 1e-13);
+
+		// The trace is the sum of the eigenvalues.
+		double trace = 0, sum = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			trace += a(i, i);
+			sum += s.values()[i];
+		}
+		assert(std::fabs(trace - sum) < 1e-9);
+
+		// Values only.
+		symmetric_eigen<double> t(a, false);
+		assert(t.values() == s.values());
+		assert(t.vectors().size() == 0);
+
+		// The k largest.
+		t.compute_largest(a, 7, true);
+		assert(t.values().size() == 7);
+		for (size_t j = 0; j < 7; ++j)
+		{
+			assert(t.values()[j] == s.values()[j]);
+		}
+		check(a, t, 1e-13);
+
+		// In parallel.
+		thread_pool pool(4);
+
+		const symmetric_eigen<double> u(a, true, pool);
+		for (size_t j = 0; j < n; ++j)
+		{
+			assert(std::fabs(u.values()[j] - s.values()[j]) < 1e-10);
+		}
+		check(a, u, 1e-13);
+	}
+
+	// Multiple eigenvalues: the eigenvectors must still be orthogonal.
+	{
+		const size_t n = 80;
+
+		// I + x × xᵀ + y × yᵀ: 1 is an eigenvalue of multiplicity n - 2.
+		matrix<double> a = matrix<double>::identity(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			for (size_t j = 0; j < n; ++j)
+			{
+				a(i, j) += double((i + 1) * (j + 1)) / (n * n)
+					+ double(((i % 3) + 1) * ((j % 3) + 1)) / n;
+			}
+		}
+
+		const symmetric_eigen<double> s(a);
+		check(a, s, 1e-13);
+		for (size_t j = 2; j < n; ++j)
+		{
+			assert(std::fabs(s.values()[j] - 1) < 1e-12);
+		}
+	}
+
+	// Rank-deficient: B × Bᵀ has n - r zero eigenvalues.
+	{
+		const size_t n = 120, r = 30;
+
+		matrix<double> b(n, r);
+		for (size_t i = 0; i < b.size(); ++i)
+		{
+			b(i) = double(rand() % 2001) / 1000 - 1;
+		}
+
+		const matrix<double> bt = b.transpose();
+		const matrix<double> a = b.mprod(bt);
+
+		const symmetric_eigen<double> s(a);
+		check(a, s, 1e-13);
+		for (size_t j = r; j < n; ++j)
+		{
+			assert(std::fabs(s.values()[j]) < 1e-11);
+		}
+	}
+
+	// Sample covariance of more features than samples.
+	{
+		const size_t features = 200, samples = 50;
+
+		matrix<double> x(samples, features);
+		for (size_t j = 0; j < features; ++j)
+		{
+			double mean = 0;
+			for (size_t i = 0; i < samples; ++i)
+			{
+				x(i, j) = double(rand() % 2001) / 1000 - 1;
+				mean += x(i, j);
+			}
+			mean /= samples;
+			for (size_t i = 0; i < samples; ++i)
+			{
+				x(i, j) -= mean;
+			}
+		}
+
+		const matrix<double> xt = x.transpose();
+		matrix<double> c = xt.mprod(x);
+		for (size_t i = 0; i < c.size(); ++i)
+		{
+			c(i) /= samples - 1;
+		}
+
+		const symmetric_eigen<double> s(c);
+		check(c, s, 1e-13);
+
+		symmetric_eigen<double> t;
+		t.compute_largest(c, 5);
+		for (size_t j = 0; j < 5; ++j)
+		{
+			assert(std::fabs(t.values()[j] - s.values()[j]) < 1e-12);
+		}
+		check(c, t, 1e-13);
+	}
+
+	// Single precision.
+	{
+		const size_t n = 70;
+
+		matrix<float> a(n, n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			for (size_t j = i; j < n; ++j)
+			{
+				a(i, j) = a(j, i) = float(rand() % 201) / 100 - 1;
+			}
+		}
+
+		const symmetric_eigen<float> s(a);
+		check(a, s, 1e-5f);
+	}
+
+	return EXIT_SUCCESS;
+}
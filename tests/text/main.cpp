@@ -0,0 +1,318 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/text.hpp>
+
+#include <clocale>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <contracts.h>
+
+#include <jfcpp/array.hpp>
+#include <jfcpp/array_view.hpp>
+#include <jfcpp/matrix.hpp>
+#include <jfcpp/thread_pool.hpp>
+
+using jfcpp::array;
+using jfcpp::array_view;
+using jfcpp::matrix;
+using jfcpp::thread_pool;
+
+namespace text = jfcpp::text;
+
+const char *const path = "text.tmp";
+
+/**
+ * Whether s is entirely parsed as a T equal to expected.
+ */
+template <typename T>
+bool
+parses(const char *s, T expected)
+{
+	const char *last = s + std::strlen(s);
+
+	T value;
+	return ((text::parse(s, last, value) == last) && (value == expected));
+}
+
+/**
+ * Whether s is not a valid T.
+ */
+template <typename T>
+bool
+is_invalid(const char *s)
+{
+	T value;
+	return (text::parse(s, s + std::strlen(s), value) == s);
+}
+
+/**
+ * Whether parsing s as a matrix fails.
+ */
+bool
+is_rejected(const char *s, const char *message)
+{
+	try
+	{
+		text::parse_matrix<double>(s, s + std::strlen(s));
+	}
+	catch (const std::runtime_error &e)
+	{
+		return (std::string(e.what()) == message);
+	}
+
+	return false;
+}
+
+/**
+ * Formats and parses back a value.
+ */
+template <typename T>
+bool
+round_trips(T value)
+{
+	char buffer[text::details::max_length<T>::value];
+	char *end = text::format(buffer, buffer + sizeof(buffer), value);
+
+	T parsed;
+	return ((text::parse(buffer, end, parsed) == end) && (parsed == value));
+}
+
+int main()
+{
+	// Integers.
+	assert(parses("42", 42));
+	assert(parses("-17", -17));
+	assert(parses("+3", 3u));
+	assert(parses("-128", static_cast<signed char>(-128)));
+	assert(parses("18446744073709551615",
+	              std::numeric_limits<uint64_t>::max()));
+	assert(is_invalid<int>(""));
+	assert(is_invalid<int>("-"));
+	assert(is_invalid<int>("x1"));
+	assert(is_invalid<unsigned>("-1"));
+	assert(is_invalid<signed char>("128"));
+	assert(is_invalid<uint64_t>("18446744073709551616"));
+	{
+		// The parsing stops at the first invalid character.
+		const char s[] = "12ab";
+		int value;
+		assert(text::parse(s, s + 4, value) == s + 2);
+		assert(value == 12);
+	}
+
+	// Floating point numbers, exact and slow paths.
+	assert(parses("0.1", 0.1));
+	assert(parses("-2.5e-3", -2.5e-3));
+	assert(parses(".5", .5));
+	assert(parses("5.", 5.));
+	assert(parses("1E22", 1e22));
+	assert(parses("0.000000000000000000000000000001", 1e-30));
+	assert(parses("1.7976931348623157e308",
+	              std::numeric_limits<double>::max()));
+	assert(parses("4.9406564584124654e-324",
+	              std::numeric_limits<double>::denorm_min()));
+	assert(parses("3.14159265358979323846264338327950288", 3.141592653589793));
+	assert(parses("0.1", 0.1f));
+	assert(parses("16777217", 16777216.f));
+	assert(parses("-inf", -std::numeric_limits<double>::infinity()));
+	assert(is_invalid<double>("1e999"));
+	assert(is_invalid<double>("e5"));
+	assert(is_invalid<double>("-."));
+	{
+		const char s[] = "nan";
+		double value;
+		assert(text::parse(s, s + 3, value) == s + 3);
+		assert(value != value);
+
+		// An exponent without digits is not part of the number.
+		const char t[] = "2e+";
+		assert(text::parse(t, t + 3, value) == t + 1);
+		assert(value == 2.);
+	}
+
+	// Same results as strtod() on random decimals.
+	std::srand(42);
+	for (size_t i = 0; i < 10000; ++i)
+	{
+		char s[64];
+		std::sprintf(s, "%d.%de%d", std::rand() % 100000, std::rand(),
+		             std::rand() % 60 - 30);
+		assert(parses(s, std::strtod(s, NULL)));
+	}
+
+	// Formatting.
+	{
+		char buffer[text::details::max_length<double>::value];
+
+		char *end = text::format(buffer, buffer + sizeof(buffer), 0.1);
+		assert(std::string(buffer, end) == "0.1");
+
+		end = text::format(buffer, buffer + sizeof(buffer), -1234567);
+		assert(std::string(buffer, end) == "-1234567");
+
+		end = text::format(buffer, buffer + sizeof(buffer),
+		                   std::numeric_limits<int64_t>::min());
+		assert(std::string(buffer, end) == "-9223372036854775808");
+
+		end = text::format(buffer, buffer + sizeof(buffer), 0u);
+		assert(std::string(buffer, end) == "0");
+	}
+	assert(round_trips(1. / 3.));
+	assert(round_trips(std::numeric_limits<double>::max()));
+	assert(round_trips(std::numeric_limits<double>::denorm_min()));
+	assert(round_trips(1.f / 3.f));
+	assert(round_trips(1.L / 3.L));
+	for (size_t i = 0; i < 10000; ++i)
+	{
+		assert(round_trips(double(std::rand()) / double(std::rand() + 1)));
+	}
+
+	// A locale whose decimal separator is a comma, when one is installed:
+	// the output must not depend on it.
+	{
+		const char *const names[] = {
+			"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "de_DE",
+			"fr_FR"
+		};
+
+		for (size_t i = 0; i < sizeof(names) / sizeof(*names); ++i)
+		{
+			if (std::setlocale(LC_NUMERIC, names[i]) == NULL)
+			{
+				continue;
+			}
+
+			char buffer[text::details::max_length<double>::value];
+			char *end = text::format(buffer, buffer + sizeof(buffer), 0.1);
+			assert(std::string(buffer, end) == "0.1");
+
+			// The shortest form is kept when it round-trips.
+			end = text::format(buffer, buffer + sizeof(buffer), 2.5);
+			assert(std::string(buffer, end) == "2.5");
+
+			assert(round_trips(1. / 3.));
+			assert(round_trips(1.f / 3.f));
+			assert(parses("-2.5e-3", -2.5e-3));
+
+			std::setlocale(LC_NUMERIC, "C");
+			break;
+		}
+	}
+
+	// Arrays.
+	{
+		const char s[] = " 1  2\t3\n4 ";
+		const char *last = s + sizeof(s) - 1;
+
+		int values[3];
+		assert(text::parse(s, last, array_view<int>(3, values)) == s + 7);
+		assert(values[2] == 3);
+
+		const array<int> a = text::parse_array<int>(s, last);
+		assert(a.size() == 4);
+		assert(a[3] == 4);
+
+		std::vector<char> buffer;
+		text::format(buffer, a);
+		assert(std::string(buffer.begin(), buffer.end()) == "1 2 3 4\n");
+
+		bool thrown = false;
+		try
+		{
+			int more[5];
+			text::parse(s, last, array_view<int>(5, more));
+		}
+		catch (const std::runtime_error &e)
+		{
+			thrown = (std::string(e.what()) == "text: missing value at line 2");
+		}
+		assert(thrown);
+	}
+
+	// Matrices.
+	{
+		const char s[] = "\n1 2 3\r\n4 5 6\n\n";
+		const matrix<double> m = text::parse_matrix<double>(s, s + sizeof(s) - 1);
+		assert(m.rows() == 2);
+		assert(m.columns() == 3);
+		assert(m(1, 2) == 6.);
+
+		std::vector<char> buffer;
+		text::format(buffer, m);
+		assert(std::string(buffer.begin(), buffer.end()) == "1 2 3\n4 5 6\n");
+
+		assert(text::parse_matrix<int>(s, s).rows() == 0);
+
+		assert(is_rejected("1 2\n3\n", "text: wrong number of values at line 2"));
+		assert(is_rejected("1 2\n3 4 5\n", "text: wrong number of values at line 2"));
+		assert(is_rejected("1 2\n3 x\n", "text: invalid value at line 2"));
+		assert(is_rejected("1 2,3\n", "text: invalid value at line 1"));
+	}
+
+	// Large matrices are parsed in parallel chunks.
+	{
+		matrix<double> m(2000, 50);
+		for (size_t i = 0; i < m.size(); ++i)
+		{
+			m.begin()[i] = double(std::rand()) / 1000.;
+		}
+
+		std::vector<char> buffer;
+		text::format(buffer, m);
+
+		thread_pool pool(4);
+		const char *first = &buffer[0], *last = first + buffer.size();
+		assert(text::parse_matrix<double>(first, last, pool) == m);
+		assert(text::parse_array<double>(first, last, pool).size() == m.size());
+
+		// An error in any chunk is reported.
+		buffer[buffer.size() - 3] = '?';
+		bool thrown = false;
+		try
+		{
+			text::parse_matrix<double>(first, last, pool);
+		}
+		catch (const std::runtime_error &e)
+		{
+			thrown = (std::string(e.what())
+			          == "text: invalid value at line 2000");
+		}
+		assert(thrown);
+	}
+
+	// Files.
+	{
+		std::FILE *file = std::fopen(path, "w");
+		assert(file != NULL);
+		std::fputs("1.5 2\n3 4\n", file);
+		std::fclose(file);
+
+		const matrix<double> m = text::load_matrix<double>(path);
+		assert(m(0, 0) == 1.5);
+		assert(m(1, 1) == 4.);
+
+		thread_pool pool(2);
+		assert(text::load_array<float>(path, pool)[2] == 3.f);
+
+		std::remove(path);
+
+		bool thrown = false;
+		try
+		{
+			text::load_matrix<double>(path);
+		}
+		catch (const std::runtime_error &)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	return 0;
+}
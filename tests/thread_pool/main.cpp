@@ -0,0 +1,145 @@
+// To properly test inclusion, the tested file must be the first included.
+#include <jfcpp/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <contracts.h>
+
+using jfcpp::executor;
+using jfcpp::parallel_task;
+using jfcpp::sequential_executor;
+using jfcpp::thread_pool;
+
+/**
+ * Counts how many times each index is visited.
+ */
+struct counter : public parallel_task
+{
+	counter(size_t n) : visits(n, 0)
+	{}
+
+	void
+	operator()(size_t i)
+	{
+		// Each index must be visited by only one thread, no need to lock.
+		++visits[i];
+	}
+
+	bool
+	all_once() const
+	{
+		for (size_t i = 0; i < visits.size(); ++i)
+		{
+			if (visits[i] != 1)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::vector<int> visits;
+};
+
+/**
+ * Runs a parallel task from a parallel task.
+ */
+struct nested : public parallel_task
+{
+	nested(executor &e) : e(e), inner(10 * 100)
+	{}
+
+	void
+	operator()(size_t i)
+	{
+		offset_counter c(inner, i * 100);
+		e.run(c, 100);
+	}
+
+	struct offset_counter : public parallel_task
+	{
+		offset_counter(counter &c, size_t offset) : c(c), offset(offset)
+		{}
+
+		void
+		operator()(size_t i)
+		{
+			c(offset + i);
+		}
+
+		counter &c;
+		size_t offset;
+	};
+
+	executor &e;
+	counter inner;
+};
+
+struct thrower : public parallel_task
+{
+	void
+	operator()(size_t i)
+	{
+		if (i == 42)
+		{
+			throw std::logic_error("42");
+		}
+	}
+};
+
+int main()
+{
+	assert(thread_pool::hardware_concurrency() >= 1);
+
+	{
+		sequential_executor e;
+		counter c(1000);
+
+		assert(e.concurrency() == 1);
+		e.run(c, c.visits.size());
+		assert(c.all_once());
+	}
+
+	{
+		thread_pool pool(4);
+
+		assert(pool.concurrency() == 4);
+
+		// Several runs with the same pool.
+		for (size_t n = 0; n < 2000; n += 97)
+		{
+			counter c(n);
+			pool.run(c, n);
+			assert(c.all_once());
+		}
+
+		// Nested runs are executed sequentially.
+		{
+			nested t(pool);
+			pool.run(t, 10);
+			assert(t.inner.all_once());
+		}
+
+		// Exceptions are reported to the caller.
+		{
+			thrower t;
+			assert_exception(pool.run(t, 100), std::runtime_error);
+
+			// The pool is still usable.
+			counter c(100);
+			pool.run(c, 100);
+			assert(c.all_once());
+		}
+	}
+
+	{
+		counter c(100);
+		thread_pool::instance().run(c, 100);
+		assert(c.all_once());
+	}
+
+	return EXIT_SUCCESS;
+}